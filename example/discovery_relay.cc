@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <ignition/transport.hh>
+
+/// \brief Default discovery port used by ignition transport.
+static const int kDiscPort = 11317;
+
+/// \brief Flag used to break the relay loop and terminate the program.
+static std::atomic<bool> g_terminate(false);
+
+//////////////////////////////////////////////////
+/// \brief Function callback executed when a SIGINT or SIGTERM signals are
+/// captured. This is used to break the infinite loop and exit the program
+/// smoothly.
+void signal_handler(int _signal)
+{
+  if (_signal == SIGINT || _signal == SIGTERM)
+    g_terminate = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Usage: discovery_relay <port> [<host>:<port> ...]
+/// Relay the discovery traffic of this network segment to the relays of
+/// other segments. The discovery of topics and services is relayed on <port>.
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: discovery_relay <port> [<host>:<port> ...]"
+              << std::endl;
+    return -1;
+  }
+
+  // Install a signal handler for SIGINT and SIGTERM.
+  std::signal(SIGINT,  signal_handler);
+  std::signal(SIGTERM, signal_handler);
+
+  int port = std::atoi(argv[1]);
+  ignition::transport::DiscoveryRelay relay(kDiscPort, port);
+
+  for (int i = 2; i < argc; ++i)
+  {
+    std::string remote = argv[i];
+    if (remote.rfind(':') == std::string::npos)
+    {
+      std::cerr << "Invalid relay address [" << remote << "]" << std::endl;
+      return -1;
+    }
+
+    if (!relay.AddRelay(remote))
+      return -1;
+  }
+
+  if (!relay.Start())
+    return -1;
+
+  while (!g_terminate)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::cout << "Messages forwarded: " << relay.NumForwarded() << std::endl;
+
+  return 0;
+}
@@ -56,12 +56,18 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <random>
+#include <set>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "ignition/transport/Helpers.hh"
@@ -75,213 +81,69 @@ namespace ignition
 {
   namespace transport
   {
-    /// \class Discovery Discovery.hh ignition/transport/Discovery.hh
-    /// \brief A discovery class that implements a distributed topic discovery
-    /// protocol. It uses UDP broadcast for sending/receiving messages and
-    /// stores updated topic information. The discovery clients can request
-    /// the discovery of a topic or the advertisement of a local topic. The
-    /// discovery uses heartbeats to track the state of other peers in the
-    /// network. The discovery clients can register callbacks to detect when
-    /// new topics are discovered or topics are no longer available.
+    /// \brief Properties of each kind of publisher handled by the discovery.
     template<typename Pub>
-    class IGNITION_TRANSPORT_VISIBLE Discovery
+    struct DiscoveryKind;
+
+    /// \brief Topics.
+    template<>
+    struct DiscoveryKind<MessagePublisher>
+    {
+      /// \brief Position of the kind in the discovery stores.
+      static const size_t kIndex = 0;
+
+      /// \brief Header flags of the messages about this kind.
+      static const uint16_t kFlags = 0;
+    };
+
+    /// \brief Services.
+    template<>
+    struct DiscoveryKind<ServicePublisher>
+    {
+      /// \brief Position of the kind in the discovery stores.
+      static const size_t kIndex = 1;
+
+      /// \brief Header flags of the messages about this kind.
+      static const uint16_t kFlags = SrvFlag;
+    };
+
+    /// \class DiscoveryEngine Discovery.hh ignition/transport/Discovery.hh
+    /// \brief The engine that implements a distributed discovery protocol
+    /// for topics and services. It uses UDP broadcast for sending/receiving
+    /// messages and stores updated topic information. The processes of the
+    /// same user and host also exchange their messages through a local
+    /// registry of Unix sockets. Both kinds of publishers share the sockets,
+    /// the threads, the heartbeats and the version of the discovery state of
+    /// the process; the SrvFlag header flag tells them apart on the wire. The
+    /// engine is used through the typed views Discovery<MessagePublisher> and
+    /// Discovery<ServicePublisher>.
+    class IGNITION_TRANSPORT_VISIBLE DiscoveryEngine
     {
       /// \brief Constructor.
       /// \param[in] _pUuid This discovery instance will run inside a
       /// transport process. This parameter is the transport process' UUID.
       /// \param[in] _port UDP port used for discovery traffic.
       /// \param[in] _verbose true for enabling verbose mode.
-      public: Discovery(const std::string &_pUuid,
-                        const int _port,
-                        const bool _verbose = false)
-        : port(_port),
-          hostAddr(determineHost()),
-          pUuid(_pUuid),
-          silenceInterval(kDefSilenceInterval),
-          activityInterval(kDefActivityInterval),
-          heartbeatInterval(kDefHeartbeatInterval),
-          connectionCb(nullptr),
-          disconnectionCb(nullptr),
-          verbose(_verbose),
-          initialized(false),
-          numHeartbeatsUninitialized(0),
-          exit(false),
-          enabled(false)
-      {
-        std::string ignIp;
-        if (env("IGN_IP", ignIp) && !ignIp.empty())
-          this->hostInterfaces = {ignIp};
-        else
-        {
-          // Get the list of network interfaces in this host.
-          this->hostInterfaces = determineInterfaces();
-        }
-
-#ifdef _WIN32
-        WORD wVersionRequested;
-        WSADATA wsaData;
-
-        // Request WinSock v2.2.
-        wVersionRequested = MAKEWORD(2, 2);
-        // Load WinSock DLL.
-        if (WSAStartup(wVersionRequested, &wsaData) != 0)
-        {
-          std::cerr << "Unable to load WinSock DLL" << std::endl;
-          return;
-        }
-#endif
-        for (const auto &netIface : this->hostInterfaces)
-        {
-          auto succeed = this->RegisterNetIface(netIface);
-
-          // If the IP address that we're selecting as the main IP address of
-          // the host is invalid, we change it to 127.0.0.1 .
-          // This is probably because IGN_IP is set to a wrong value.
-          if (netIface == this->hostAddr && !succeed)
-          {
-            this->RegisterNetIface("127.0.0.1");
-            std::cerr << "Did you set the environment variable IGN_IP with a "
-                      << "correct IP address? " << std::endl
-                      << "  [" << netIface << "] seems an invalid local IP "
-                      << "address." << std::endl
-                      << "  Using 127.0.0.1 as hostname." << std::endl;
-            this->hostAddr = "127.0.0.1";
-          }
-        }
-
-        // Socket option: SO_REUSEADDR. This options is used only for receiving
-        // data. We can reuse the same socket for receiving multicast data from
-        // multiple interfaces. We will use the socket at position 0 for
-        // receiving data.
-        int reuseAddr = 1;
-        if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_REUSEADDR,
-            reinterpret_cast<const char *>(&reuseAddr), sizeof(reuseAddr)) != 0)
-        {
-          std::cerr << "Error setting socket option (SO_REUSEADDR)."
-                    << std::endl;
-          return;
-        }
-
-#ifdef SO_REUSEPORT
-        // Socket option: SO_REUSEPORT. This options is used only for receiving
-        // data. We can reuse the same socket for receiving multicast data from
-        // multiple interfaces. We will use the socket at position 0 for
-        // receiving data.
-        int reusePort = 1;
-        if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_REUSEPORT,
-            reinterpret_cast<const char *>(&reusePort), sizeof(reusePort)) != 0)
-        {
-          std::cerr << "Error setting socket option (SO_REUSEPORT)."
-                    << std::endl;
-          return;
-        }
-#endif
-        // Bind the first socket to the discovery port.
-        sockaddr_in localAddr;
-        memset(&localAddr, 0, sizeof(localAddr));
-        localAddr.sin_family = AF_INET;
-        localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
-        localAddr.sin_port = htons(static_cast<u_short>(this->port));
-
-        if (bind(this->sockets.at(0),
-          reinterpret_cast<sockaddr *>(&localAddr), sizeof(sockaddr_in)) < 0)
-        {
-          std::cerr << "Binding to a local port failed." << std::endl;
-          return;
-        }
-
-        // Set 'mcastAddr' to the multicast discovery group.
-        memset(&this->mcastAddr, 0, sizeof(this->mcastAddr));
-        this->mcastAddr.sin_family = AF_INET;
-        this->mcastAddr.sin_addr.s_addr =
-          inet_addr(this->kMulticastGroup.c_str());
-        this->mcastAddr.sin_port = htons(static_cast<u_short>(this->port));
-
-        if (this->verbose)
-          this->PrintCurrentState();
-      }
+      public: DiscoveryEngine(const std::string &_pUuid,
+                              const int _port,
+                              const bool _verbose = false);
 
       /// \brief Destructor.
-      public: virtual ~Discovery()
-      {
-        // Tell the service thread to terminate.
-        this->exitMutex.lock();
-        this->exit = true;
-        this->exitMutex.unlock();
-
-        // Don't join on Windows, because it can hang when this object
-        // is destructed on process exit (e.g., when it's a global static).
-        // I think that it's due to this bug:
-        // https://connect.microsoft.com/VisualStudio/feedback/details/747145/std-thread-join-hangs-if-called-after-main-exits-when-using-vs2012-rc
-#ifndef _WIN32
-        // Wait for the service threads to finish before exit.
-        if (this->threadReception.joinable())
-          this->threadReception.join();
-#else
-        bool exitLoop = false;
-        while (!exitLoop)
-        {
-          std::lock_guard<std::mutex> lock(this->exitMutex);
-          {
-            if (this->threadReceptionExiting)
-            {
-              exitLoop = true;
-            }
-          }
-          std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-#endif
-        // Broadcast a BYE message to trigger the remote cancellation of
-        // all our advertised topics.
-        this->SendMsg(ByeType,
-          Publisher("", "", this->pUuid, "", Scope_t::ALL));
-
-        // Close sockets.
-        for (const auto &sock : this->sockets)
-        {
-#ifdef _WIN32
-          closesocket(sock);
-          WSACleanup();
-#else
-          close(sock);
-#endif
-        }
-      }
+      public: virtual ~DiscoveryEngine();
 
       /// \brief Start the discovery service. You probably want to register the
       /// callbacks for receiving discovery notifications before starting the
       /// service.
-      public: void Start()
-      {
-        {
-          std::lock_guard<std::mutex> lock(this->mutex);
-
-          // The service is already running.
-          if (this->enabled)
-            return;
-
-          this->enabled = true;
-        }
-
-        auto now = std::chrono::steady_clock::now();
-        this->timeNextHeartbeat = now;
-        this->timeNextActivity = now;
-
-        // Start the thread that receives discovery information.
-        this->threadReception = std::thread(&Discovery::RecvMessages, this);
+      public: void Start();
 
-#ifdef _WIN32
-        this->threadReceptionExiting = false;
-        this->threadReception.detach();
-#endif
-      }
-
-      /// \brief Advertise a new message.
+      /// \brief Advertise a new topic or service.
       /// \param[in] _publisher Publisher's information to advertise.
       /// \return True if the method succeed or false otherwise
       /// (e.g. if the discovery has not been started).
-      public: bool Advertise(const Pub &_publisher)
+      public: template<typename Pub>
+      bool Advertise(const Pub &_publisher)
       {
+        uint32_t version;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -289,18 +151,25 @@ namespace ignition
             return false;
 
           // Add the addressing information (local publisher).
-          this->info.AddPublisher(_publisher);
+          bool added = this->Store<Pub>().info.AddPublisher(_publisher);
+
+          version = this->stateVersion;
+          if (added && _publisher.Scope() != Scope_t::PROCESS)
+            version = this->AddStateChange(AdvType, _publisher);
         }
 
         // Only advertise a message outside this process if the scope
         // is not 'Process'
         if (_publisher.Scope() != Scope_t::PROCESS)
-          this->SendMsg(AdvType, _publisher);
+        {
+          this->SendMsg(AdvType, _publisher, version,
+            DiscoveryKind<Pub>::kFlags);
+        }
 
         return true;
       }
 
-      /// \brief Request discovery information about a topic.
+      /// \brief Request discovery information about a topic or service.
       /// When using this method, the user might want to use
       /// SetConnectionsCb() and SetDisconnectionCb(), that registers callbacks
       /// that will be executed when the topic address is discovered or when the
@@ -310,11 +179,13 @@ namespace ignition
       /// \param[in] _topic Topic name requested.
       /// \return True if the method succeeded or false otherwise
       /// (e.g. if the discovery has not been started).
-      public: bool Discover(const std::string &_topic) const
+      public: template<typename Pub>
+      bool Discover(const std::string &_topic) const
       {
         DiscoveryCallback<Pub> cb;
         bool found;
         Addresses_M<Pub> addresses;
+        uint32_t version;
 
         {
           std::lock_guard<std::mutex> lock(this->mutex);
@@ -322,20 +193,21 @@ namespace ignition
           if (!this->enabled)
             return false;
 
-          cb = this->connectionCb;
+          cb = this->Store<Pub>().connectionCb;
+          version = this->stateVersion;
         }
 
         Pub pub;
         pub.SetTopic(_topic);
-        pub.SetPUuid(this->pUuid);
+        pub.SetPUuid(this->processUuid);
         pub.SetScope(Scope_t::ALL);
 
         // Send a discovery request.
-        this->SendMsg(SubType, pub);
+        this->SendMsg(SubType, pub, version, DiscoveryKind<Pub>::kFlags);
 
         {
           std::lock_guard<std::mutex> lock(this->mutex);
-          found = this->info.Publishers(_topic, addresses);
+          found = this->Store<Pub>().info.Publishers(_topic, addresses);
         }
 
         if (found)
@@ -359,23 +231,25 @@ namespace ignition
         return true;
       }
 
-      /// \brief Get the discovery information.
+      /// \brief Get the discovery information of a kind of publisher.
       /// \return Reference to the discovery information object.
-      public: const TopicStorage<Pub> &Info() const
+      public: template<typename Pub>
+      const TopicStorage<Pub> &Info() const
       {
         std::lock_guard<std::mutex> lock(this->mutex);
-        return this->info;
+        return this->Store<Pub>().info;
       }
 
       /// \brief Get all the publishers' information known for a given topic.
       /// \param[in] _topic Topic name.
       /// \param[out] _publishers Publishers requested.
       /// \return True if the topic is found and there is at least one publisher
-      public: bool Publishers(const std::string &_topic,
-                              Addresses_M<Pub> &_publishers) const
+      public: template<typename Pub>
+      bool Publishers(const std::string &_topic,
+                      Addresses_M<Pub> &_publishers) const
       {
         std::lock_guard<std::mutex> lock(this->mutex);
-        return this->info.Publishers(_topic, _publishers);
+        return this->Store<Pub>().info.Publishers(_topic, _publishers);
       }
 
       /// \brief Unadvertise a new message. Broadcast a discovery
@@ -385,10 +259,11 @@ namespace ignition
       /// \param[in] _nUuid Node UUID.
       /// \return True if the method succeeded or false otherwise
       /// (e.g. if the discovery has not been started).
-      public: bool Unadvertise(const std::string &_topic,
-                               const std::string &_nUuid)
+      public: template<typename Pub>
+      bool Unadvertise(const std::string &_topic, const std::string &_nUuid)
       {
         Pub inf;
+        uint32_t version;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -396,263 +271,340 @@ namespace ignition
             return false;
 
           // Don't do anything if the topic is not advertised by any of my nodes
-          if (!this->info.Publisher(_topic, this->pUuid, _nUuid, inf))
+          auto &info = this->Store<Pub>().info;
+          Uuid nUuid(_nUuid);
+          if (!info.Publisher(_topic, this->processUuid, nUuid, inf))
             return true;
 
           // Remove the topic information.
-          this->info.DelPublisherByNode(_topic, this->pUuid, _nUuid);
+          info.DelPublisherByNode(_topic, this->processUuid, nUuid);
+
+          version = this->stateVersion;
+          if (inf.Scope() != Scope_t::PROCESS)
+            version = this->AddStateChange(UnadvType, inf);
         }
 
         // Only unadvertise a message outside this process if the scope
         // is not 'Process'.
         if (inf.Scope() != Scope_t::PROCESS)
-          this->SendMsg(UnadvType, inf);
+          this->SendMsg(UnadvType, inf, version, DiscoveryKind<Pub>::kFlags);
 
         return true;
       }
 
       /// \brief Get the IP address of this host.
       /// \return A string with this host's IP address.
-      public: std::string HostAddr() const
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        return this->hostAddr;
-      }
+      public: std::string HostAddr() const;
+
+      /// \brief Send our discovery messages by unicast to a peer, in addition
+      /// to the multicast group. It's useful in networks without multicast
+      /// support. The peer can be another process using the same discovery
+      /// port or a DiscoveryRelay. Note that a process only receives messages
+      /// from its static peers if they also list it as a static peer, so
+      /// the lists should be symmetric (or all point to the same relay).
+      /// \param[in] _addr Address of the peer with the format "host[:port]".
+      /// The discovery port is used by default.
+      /// \return True if the peer was added or false if the address is
+      /// invalid.
+      public: bool AddStaticPeer(const std::string &_addr);
+
+      /// \brief Set the size of the kernel buffer that stores the discovery
+      /// datagrams until they are processed. A bigger buffer absorbs the
+      /// bursts of messages generated when many processes start at the same
+      /// time. Note that the kernel may cap the value (net.core.rmem_max in
+      /// Linux).
+      /// \param[in] _size Size in bytes.
+      /// \return True if the size was set or false otherwise.
+      /// \sa ReceiveBufferSize.
+      public: bool SetReceiveBufferSize(const int _size);
+
+      /// \brief Get the size of the kernel buffer that stores the discovery
+      /// datagrams until they are processed. Linux reports twice the value
+      /// requested, because it accounts for its bookkeeping overhead.
+      /// \return The size in bytes or -1 on error.
+      /// \sa SetReceiveBufferSize.
+      public: int ReceiveBufferSize() const;
+
+      /// \brief Get the number of discovery datagrams dropped by the kernel
+      /// because the receive buffer was full. The counter is only available
+      /// in Linux (SO_RXQ_OVFL) and it's updated when the next datagram is
+      /// received.
+      /// \return The number of datagrams dropped.
+      /// \sa SetReceiveBufferSize.
+      public: uint64_t DroppedDatagrams() const;
+
+      /// \brief Get the number of discovery datagrams that couldn't be
+      /// delivered to the processes of this host through the local registry
+      /// because their queue was full.
+      /// \return The number of datagrams dropped.
+      public: uint64_t DroppedLocalDatagrams() const;
+
+      /// \brief Get the number of discovery datagrams that were never sent
+      /// because the queue of datagrams waiting for the send rate was full.
+      /// \return The number of datagrams dropped.
+      /// \sa SetMaxSendRate.
+      public: uint64_t DroppedSendDatagrams() const;
+
+      /// \brief Get the number of discovery datagrams sent.
+      /// \return The number of datagrams sent.
+      public: uint64_t SentDatagrams() const;
+
+      /// \brief Get the number of bytes of the discovery datagrams sent. A
+      /// datagram sent to several destinations is only counted once.
+      /// \return The number of bytes sent.
+      public: uint64_t SentBytes() const;
+
+      /// \brief Get the number of discovery datagrams received, including
+      /// our own messages and the duplicated copies that are discarded.
+      /// \return The number of datagrams received.
+      public: uint64_t ReceivedDatagrams() const;
+
+      /// \brief Get the number of bytes of the discovery datagrams received.
+      /// \return The number of bytes received.
+      /// \sa ReceivedDatagrams.
+      public: uint64_t ReceivedBytes() const;
+
+      /// \brief Set the maximum rate of discovery datagrams sent by this
+      /// process. The rate is enforced with a token bucket that allows short
+      /// bursts (a fifth of the rate). The datagrams over the rate are queued
+      /// and sent by the sender thread, so the callers never wait.
+      /// \param[in] _rate Maximum number of datagrams per second or 0 for
+      /// no limit.
+      /// \sa MaxSendRate.
+      public: void SetMaxSendRate(const unsigned int _rate);
+
+      /// \brief Get the maximum rate of discovery datagrams sent by this
+      /// process.
+      /// \return Maximum number of datagrams per second or 0 for no limit.
+      /// \sa SetMaxSendRate.
+      public: unsigned int MaxSendRate() const;
 
       /// \brief The discovery checks the validity of the topic information
       /// every 'activity interval' milliseconds.
       /// \sa SetActivityInterval.
       /// \return The value in milliseconds.
-      public: unsigned int ActivityInterval() const
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        return this->activityInterval;
-      }
+      public: unsigned int ActivityInterval() const;
 
       /// \brief Each node broadcasts periodic heartbeats to keep its topic
       /// information alive in other nodes. A heartbeat message is sent after
       /// 'heartbeat interval' milliseconds.
       /// \sa SetHeartbeatInterval.
       /// \return The value in milliseconds.
-      public: unsigned int HeartbeatInterval() const
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        return this->heartbeatInterval;
-      }
+      public: unsigned int HeartbeatInterval() const;
 
       /// \brief Get the maximum time allowed without receiving any discovery
       /// information from a node before canceling its entries.
       /// \sa SetSilenceInterval.
       /// \return The value in milliseconds.
-      public: unsigned int SilenceInterval() const
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        return this->silenceInterval;
-      }
+      public: unsigned int SilenceInterval() const;
 
       /// \brief Set the activity interval.
       /// \sa ActivityInterval.
       /// \param[in] _ms New value in milliseconds.
-      public: void SetActivityInterval(const unsigned int _ms)
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        this->activityInterval = _ms;
-      }
+      public: void SetActivityInterval(const unsigned int _ms);
 
       /// \brief Set the heartbeat interval.
       /// \sa HeartbeatInterval.
       /// \param[in] _ms New value in milliseconds.
-      public: void SetHeartbeatInterval(const unsigned int _ms)
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        this->heartbeatInterval = _ms;
-      }
+      public: void SetHeartbeatInterval(const unsigned int _ms);
 
       /// \brief Set the maximum silence interval.
       /// \sa SilenceInterval.
       /// \param[in] _ms New value in milliseconds.
-      public: void SetSilenceInterval(const unsigned int _ms)
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        this->silenceInterval = _ms;
-      }
+      public: void SetSilenceInterval(const unsigned int _ms);
 
       /// \brief Register a callback to receive discovery connection events.
       /// Each time a new topic is connected, the callback will be executed.
+      /// The callback runs in a thread of the discovery dedicated to the
+      /// notifications, so it never delays the reception of discovery
+      /// messages.
       /// This version uses a free function as callback.
       /// \param[in] _cb Function callback.
-      public: void ConnectionsCb(const DiscoveryCallback<Pub> &_cb)
+      public: template<typename Pub>
+      void ConnectionsCb(const DiscoveryCallback<Pub> &_cb)
       {
         std::lock_guard<std::mutex> lock(this->mutex);
-        this->connectionCb = _cb;
+        this->Store<Pub>().connectionCb = _cb;
       }
 
       /// \brief Register a callback to receive discovery disconnection events.
       /// Each time a topic is no longer active, the callback will be executed.
+      /// The callback runs in a thread of the discovery dedicated to the
+      /// notifications, so it never delays the reception of discovery
+      /// messages.
       /// This version uses a free function as callback.
       /// \param[in] _cb Function callback.
-      public: void DisconnectionsCb(const DiscoveryCallback<Pub> &_cb)
+      public: template<typename Pub>
+      void DisconnectionsCb(const DiscoveryCallback<Pub> &_cb)
       {
         std::lock_guard<std::mutex> lock(this->mutex);
-        this->disconnectionCb = _cb;
+        this->Store<Pub>().disconnectionCb = _cb;
       }
 
-      /// \brief Print the current discovery state.
-      public: void PrintCurrentState() const
-      {
-        std::lock_guard<std::mutex> lock(this->mutex);
-
-        std::cout << "---------------" << std::endl;
-        std::cout << std::boolalpha << "Enabled: "
-                  << this->enabled << std::endl;
-        std::cout << "Discovery state" << std::endl;
-        std::cout << "\tUUID: " << this->pUuid << std::endl;
-        std::cout << "Settings" << std::endl;
-        std::cout << "\tActivity: " << this->activityInterval
-                  << " ms." << std::endl;
-        std::cout << "\tHeartbeat: " << this->heartbeatInterval
-                  << "ms." << std::endl;
-        std::cout << "\tSilence: " << this->silenceInterval
-                  << " ms." << std::endl;
-        std::cout << "Known information: " << std::endl;
-        this->info.Print();
-
-        // Used to calculate the elapsed time.
-        Timestamp now = std::chrono::steady_clock::now();
-
-        std::cout << "Activity" << std::endl;
-        if (this->activity.empty())
-          std::cout << "\t<empty>" << std::endl;
-        else
-        {
-          for (auto &proc : this->activity)
-          {
-            // Elapsed time since the last update from this publisher.
-            std::chrono::duration<double> elapsed = now - proc.second;
+      /// \brief Declare a remote process as gone without waiting for the
+      /// silence interval. This is useful when the transport layer detects
+      /// that the process closed its connections (e.g.: it crashed).
+      /// All the entries of the process are removed and the disconnection
+      /// callbacks of both kinds of publishers are queued. If the process is
+      /// still alive, its next heartbeat will trigger a new synchronization
+      /// of its topics.
+      /// \param[in] _pUuid UUID of the remote process.
+      /// \return True if the process was known or false otherwise.
+      public: bool PeerDisconnected(const std::string &_pUuid);
+
+      /// \brief Remove a remote process as if it hadn't sent anything for the
+      /// silence interval.
+      /// \param[in] _pUuid UUID of the remote process.
+      /// \return True if the process was known or false otherwise.
+      /// \sa PeerDisconnected(const std::string &).
+      public: bool PeerDisconnected(const Uuid &_pUuid);
+
+      /// \brief Check if we are receiving discovery messages from a remote
+      /// process.
+      /// \param[in] _pUuid UUID of the remote process.
+      /// \return True if the process is alive or false otherwise.
+      public: bool PeerActive(const std::string &_pUuid) const;
 
-            std::cout << "\t" << proc.first << std::endl;
-            std::cout << "\t\t" << "Since: " << std::chrono::duration_cast<
-              std::chrono::milliseconds>(elapsed).count() << " ms. ago. "
-              << std::endl;
-          }
-        }
-        std::cout << "---------------" << std::endl;
-      }
+      /// \brief Print the current discovery state.
+      public: void PrintCurrentState() const;
 
-      /// \brief Get the list of topics currently advertised in the network.
+      /// \brief Get the list of topics or services currently advertised in
+      /// the network.
       /// \param[out] _topics List of advertised topics.
-      public: void TopicList(std::vector<std::string> &_topics) const
+      public: template<typename Pub>
+      void TopicList(std::vector<std::string> &_topics) const
       {
         this->WaitForInit();
         std::lock_guard<std::mutex> lock(this->mutex);
-        this->info.TopicList(_topics);
+        this->Store<Pub>().info.TopicList(_topics);
       }
 
       /// \brief Check if ready/initialized. If not, then wait on the
-      /// initializedCv condition variable.
-      public: void WaitForInit() const
-      {
-        std::unique_lock<std::mutex> lk(this->mutex);
-
-        if (!this->initialized)
-        {
-          this->initializedCv.wait(lk, [this]{return this->initialized;});
-        }
-      }
+      /// initializedCv condition variable. The initialization finishes when
+      /// the answers to our QUERY message stop arriving.
+      public: void WaitForInit() const;
 
       /// \brief Check the validity of the topic information. Each topic update
       /// has its own timestamp. This method iterates over the list of topics
       /// and invalids the old topics.
-      private: void UpdateActivity()
+      private: void UpdateActivity();
+
+      /// \brief Remove all the entries of a remote process and notify that
+      /// it's gone. The notifications don't carry topic information, so the
+      /// clients know that the process is gone even if they were not
+      /// interested in its topics. The mutex should be locked by the caller.
+      /// \param[in] _pUuid UUID of the remote process.
+      private: void RemovePeer(const Uuid &_pUuid);
+
+      /// \brief Check if a message of a process of this host was already
+      /// received through the other path (local registry or multicast
+      /// group), and remember it otherwise. The mutex should be locked by
+      /// the caller.
+      /// \param[in] _pUuid UUID of the sender.
+      /// \param[in] _msg Raw message.
+      /// \param[in] _len Length of the message in bytes.
+      /// \param[in] _now Current time.
+      /// \return True if the message is a copy of a recent message.
+      private: bool DuplicatedLocalMsg(const Uuid &_pUuid,
+                                       const char *_msg,
+                                       const size_t _len,
+                                       const Timestamp &_now);
+
+      /// \brief Remove the publishers of a remote process and queue a
+      /// disconnection event. The mutex should be locked by the caller.
+      /// \param[in] _pUuid UUID of the remote process.
+      private: template<typename Pub>
+      void RemovePublishers(const Uuid &_pUuid)
       {
-        Timestamp now = std::chrono::steady_clock::now();
-
-        std::lock_guard<std::mutex> lock(this->mutex);
-
-        if (now < this->timeNextActivity)
-          return;
-
-        for (auto it = this->activity.cbegin(); it != this->activity.cend();)
-        {
-          // Elapsed time since the last update from this publisher.
-          auto elapsed = now - it->second;
+        auto &store = this->Store<Pub>();
+        store.info.DelPublishersByProc(_pUuid);
+        store.snapshots.erase(_pUuid);
 
-          // This publisher has expired.
-          if (std::chrono::duration_cast<std::chrono::milliseconds>
-               (elapsed).count() > this->silenceInterval)
-          {
-            // Remove all the info entries for this process UUID.
-            this->info.DelPublishersByProc(it->first);
-
-            // Notify without topic information. This is useful to inform the
-            // client that a remote node is gone, even if we were not
-            // interested in its topics.
-            Pub publisher;
-            publisher.SetPUuid(it->first);
-            publisher.SetScope(Scope_t::ALL);
-            this->disconnectionCb(publisher);
-
-            // Remove the activity entry.
-            this->activity.erase(it++);
-          }
-          else
-            ++it;
-        }
-
-        this->timeNextActivity = std::chrono::steady_clock::now() +
-          std::chrono::milliseconds(this->activityInterval);
+        Pub pub;
+        pub.SetPUuid(_pUuid);
+        pub.SetScope(Scope_t::ALL);
+        this->QueueEvent(false, pub);
       }
 
       /// \brief Broadcast periodic heartbeats.
-      private: void UpdateHeartbeat()
-      {
-        Timestamp now = std::chrono::steady_clock::now();
-
-        {
-          std::lock_guard<std::mutex> lock(this->mutex);
-
-          if (now < this->timeNextHeartbeat)
-            return;
-        }
+      private: void UpdateHeartbeat();
 
-        Publisher pub("", "", this->pUuid, "", Scope_t::ALL);
-        this->SendMsg(HeartbeatType, pub);
+      /// \brief Answer the SUBSCRIBE requests whose delay has expired.
+      private: void UpdateAnswers();
 
-        std::map<std::string, std::vector<Pub>> nodes;
+      /// \brief Answer the SUBSCRIBE requests about a kind of publisher
+      /// whose delay has expired.
+      private: template<typename Pub>
+      void UpdateAnswers()
+      {
+        std::vector<std::vector<Pub>> answers;
+        uint32_t version;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
 
-          // Re-advertise topics that are advertised inside this process.
-          this->info.PublishersByProc(this->pUuid, nodes);
-        }
-
-        for (const auto &topic : nodes)
-        {
-          for (const auto &node : topic.second)
-            this->SendMsg(AdvType, node);
-        }
-
-        {
-          std::lock_guard<std::mutex> lock(this->mutex);
-          if (!this->initialized)
+          auto now = std::chrono::steady_clock::now();
+          version = this->stateVersion;
+          auto &store = this->Store<Pub>();
+          for (auto it = store.pendingAnswers.begin();
+               it != store.pendingAnswers.end();)
           {
-            ++this->numHeartbeatsUninitialized;
-            if (this->numHeartbeatsUninitialized == 2)
+            if (now < it->second)
             {
-              // We consider the discovery initialized after two cycles of
-              // heartbeats sent.
-              this->initialized = true;
+              ++it;
+              continue;
+            }
+
+            const std::string &topic = it->first.first;
+            const bool local = it->first.second;
 
-              // Notify anyone waiting for the initialization phase to finish.
-              this->initializedCv.notify_all();
+            Addresses_M<Pub> addresses;
+            std::vector<Pub> pubs;
+            if (store.info.Publishers(topic, addresses))
+            {
+              for (const auto &nodeInfo : addresses[this->pUuid])
+              {
+                // Check scope of the topic.
+                if ((nodeInfo.Scope() == Scope_t::PROCESS) ||
+                    (nodeInfo.Scope() == Scope_t::HOST && !local))
+                {
+                  continue;
+                }
+
+                pubs.push_back(nodeInfo);
+              }
             }
-          }
 
-          this->timeNextHeartbeat = std::chrono::steady_clock::now() +
-            std::chrono::milliseconds(this->heartbeatInterval);
+            if (!pubs.empty())
+              answers.push_back(pubs);
+
+            store.pendingAnswers.erase(it++);
+          }
         }
+
+        // Answer with the publishers of all my nodes.
+        for (const auto &pubs : answers)
+          this->SendAdvBatch(pubs, version);
       }
 
+      /// \brief Get a random duration. The mutex should be locked by the
+      /// caller.
+      /// \param[in] _min Minimum duration (ms.).
+      /// \param[in] _max Maximum duration (ms.).
+      /// \return A duration uniformly distributed in [_min, _max].
+      private: std::chrono::microseconds RandomDuration(const double _min,
+                                                        const double _max);
+
+      /// \brief Finish the initialization phase when its deadline expires.
+      /// \sa ExtendInit.
+      private: void UpdateInit();
+
+      /// \brief Postpone the end of the initialization phase after receiving
+      /// an answer to our QUERY message. We keep waiting twice the time that
+      /// the answer took to arrive (at least kMinInitWait ms.), but never
+      /// longer than one heartbeat interval since the query was sent. The
+      /// mutex should be locked by the caller.
+      private: void ExtendInit();
+
       /// \brief Calculate the next timeout. There are three main activities to
       /// perform by the discovery component:
       /// 1. Receive discovery messages.
@@ -660,142 +612,93 @@ namespace ignition
       /// 3. Maintain the discovery information up to date.
       ///
       /// Tasks (2) and (3) need to be checked at fixed intervals. This function
-      /// calculates the next timeout to satisfy (2) and (3).
+      /// calculates the next timeout to satisfy (2) and (3), as well as the
+      /// end of the initialization phase and the delayed answers.
       /// \return A timeout (milliseconds).
-      private: int NextTimeout() const
-      {
-        auto now = std::chrono::steady_clock::now();
-        auto timeUntilNextHeartbeat = this->timeNextHeartbeat - now;
-        auto timeUntilNextActivity = this->timeNextActivity - now;
-
-        int t = static_cast<int>(
-          std::chrono::duration_cast<std::chrono::milliseconds>
-            (std::min(timeUntilNextHeartbeat, timeUntilNextActivity)).count());
-        int t2 = std::min(t, this->kTimeout);
-        return std::max(t2, 0);
-      }
+      private: int NextTimeout() const;
 
       /// \brief Receive discovery messages.
-      private: void RecvMessages()
-      {
-        bool timeToExit = false;
-        while (!timeToExit)
-        {
-          // Poll socket for a reply, with timeout.
-          zmq::pollitem_t items[] =
-          {
-            {0, this->sockets.at(0), ZMQ_POLLIN, 0},
-          };
-
-          // Calculate the timeout.
-          int timeout = this->NextTimeout();
-
-          try
-          {
-            zmq::poll(&items[0], sizeof(items) / sizeof(items[0]), timeout);
-          }
-          catch(...)
-          {
-            continue;
-          }
-
-          //  If we got a reply, process it.
-          if (items[0].revents & ZMQ_POLLIN)
-          {
-            this->RecvDiscoveryUpdate();
-
-            if (this->verbose)
-              this->PrintCurrentState();
-          }
-
-          this->UpdateHeartbeat();
-          this->UpdateActivity();
-
-          // Is it time to exit?
-          {
-            std::lock_guard<std::mutex> lock(this->exitMutex);
-            if (this->exit)
-              timeToExit = true;
-          }
-        }
-#ifdef _WIN32
-        std::lock_guard<std::mutex> lock(this->exitMutex);
-        this->threadReceptionExiting = true;
+      private: void RecvMessages();
+
+      /// \brief Method in charge of receiving the discovery updates. When
+      /// recvmmsg() is available, a batch of datagrams is read with a single
+      /// system call.
+      private: void RecvDiscoveryUpdate();
+
+#ifdef __linux__
+      /// \brief Receive up to kMaxDatagramBatch discovery updates with
+      /// recvmmsg().
+      /// \param[in] _sock UDP socket or socket of the local registry.
+      /// \param[in] _local True if _sock is the socket of the local registry.
+      /// \return False if recvmmsg() is not supported by the system.
+      private: bool RecvDiscoveryBatch(const int _sock, const bool _local);
+
+      /// \brief Update the number of datagrams dropped by the kernel with the
+      /// value attached to a received datagram (SO_RXQ_OVFL).
+      /// \param[in] _hdr Header of the received datagram.
+      private: void UpdateDroppedDatagrams(msghdr &_hdr);
 #endif
-      }
-
-      /// \brief Method in charge of receiving the discovery updates.
-      private: void RecvDiscoveryUpdate()
-      {
-        char rcvStr[Discovery::kMaxRcvStr];
-        std::string srcAddr;
-        uint16_t srcPort;
-        sockaddr_in clntAddr;
-        socklen_t addrLen = sizeof(clntAddr);
-
-        if ((recvfrom(this->sockets.at(0),
-              reinterpret_cast<raw_type *>(rcvStr),
-              this->kMaxRcvStr, 0,
-              reinterpret_cast<sockaddr *>(&clntAddr),
-              reinterpret_cast<socklen_t *>(&addrLen))) < 0)
-        {
-          std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
-                    << std::endl;
-          return;
-        }
-        srcAddr = inet_ntoa(clntAddr.sin_addr);
-        srcPort = ntohs(clntAddr.sin_port);
 
-        if (this->verbose)
-        {
-          std::cout << "\nReceived discovery update from " << srcAddr << ": "
-                    << srcPort << std::endl;
-        }
+      /// \brief Dispatch a datagram received through the UDP socket.
+      /// \param[in] _addr Address of the sender.
+      /// \param[in] _msg Received datagram.
+      /// \param[in] _len Length of the datagram in bytes.
+      private: void DispatchDatagram(const sockaddr_in &_addr,
+                                     char *_msg,
+                                     const size_t _len);
 
-        this->DispatchDiscoveryMsg(srcAddr, rcvStr);
-      }
 
+#ifndef _WIN32
+      /// \brief Receive a discovery update from a process of this host.
+      private: void RecvLocalUpdate();
+#endif
 
       /// \brief Parse a discovery message received via the UDP broadcast socket
+      /// or the local registry.
       /// \param[in] _fromIp IP address of the message sender.
       /// \param[in] _msg Received message.
+      /// \param[in] _len Length of the received message in bytes.
+      /// \param[in] _local True if the message was received through the
+      /// local registry.
       private: void DispatchDiscoveryMsg(const std::string &_fromIp,
-                                         char *_msg)
+                                         char *_msg,
+                                         const size_t _len,
+                                         const bool _local = false);
+
+      /// \brief Parse a discovery message about a kind of publisher
+      /// (ADVERTISE, ADVERTISE_BATCH, SUBSCRIBE or UNADVERTISE).
+      /// \param[in] _header Header of the message.
+      /// \param[in] _fromIp IP address of the message sender or an empty
+      /// string if the message was forwarded by a relay.
+      /// \param[in] _body Body of the message.
+      /// \param[in] _len Length of the whole message in bytes.
+      private: template<typename Pub>
+      void DispatchPublisherMsg(const Header &_header,
+                                const std::string &_fromIp,
+                                char *_body,
+                                const size_t _len)
       {
-        Header header;
-        char *pBody = _msg;
-
-        // Create the header from the raw bytes.
-        header.Unpack(_msg);
-        pBody += header.HeaderLength();
-
-        // Discard the message if the wire protocol is different than mine.
-        if (this->kWireVersion != header.Version())
-          return;
-
-        auto recvPUuid = header.PUuid();
-
-        // Discard our own discovery messages.
-        if (recvPUuid == this->pUuid)
-          return;
-
-        // Update timestamp and cache the callbacks.
-        DiscoveryCallback<Pub> connectCb;
-        DiscoveryCallback<Pub> disconnectCb;
-        {
-          std::lock_guard<std::mutex> lock(this->mutex);
-          this->activity[recvPUuid] = std::chrono::steady_clock::now();
-          connectCb = this->connectionCb;
-          disconnectCb = this->disconnectionCb;
-        }
+        const auto &recvPUuid = _header.ProcessUuid();
+        auto &store = this->Store<Pub>();
+        size_t headerLen = static_cast<size_t>(_header.HeaderLength());
+        size_t bodyLen = _len > headerLen ? _len - headerLen : 0;
 
-        switch (header.Type())
+        switch (_header.Type())
         {
           case AdvType:
           {
             // Read the rest of the fields.
             transport::AdvertiseMessage<Pub> advMsg;
-            advMsg.Unpack(pBody);
+            if (advMsg.Unpack(_body, bodyLen) == 0)
+            {
+              std::cerr << "Discovery::DispatchDiscoveryMsg() Invalid "
+                        << "ADVERTISE message" << std::endl;
+              break;
+            }
+
+            // Discard the changes already applied.
+            if (!this->AcceptStateChange(recvPUuid, _header.StateVersion()))
+              return;
 
             // Check scope of the topic.
             if ((advMsg.Publisher().Scope() == Scope_t::PROCESS) ||
@@ -809,79 +712,88 @@ namespace ignition
             bool added;
             {
               std::lock_guard<std::mutex> lock(this->mutex);
-              added = this->info.AddPublisher(advMsg.Publisher());
+              added = store.info.AddPublisher(advMsg.Publisher());
             }
 
-            if (added && connectCb)
+            if (added)
             {
-              // Execute the client's callback.
-              connectCb(advMsg.Publisher());
+              // Notify the client.
+              this->QueueEvent(true, advMsg.Publisher());
             }
 
             break;
           }
-          case SubType:
+          case AdvBatchType:
           {
-            // Read the rest of the fields.
-            SubscriptionMsg subMsg;
-            subMsg.Unpack(pBody);
-            auto recvTopic = subMsg.Topic();
-
-            // Check if at least one of my nodes advertises the topic requested.
-            Addresses_M<Pub> addresses;
+            // Read all the publishers.
+            transport::AdvertiseBatchMessage<Pub> batchMsg;
+            if (batchMsg.Unpack(_body, bodyLen) == 0)
             {
-              std::lock_guard<std::mutex> lock(this->mutex);
-              if (!this->info.HasAnyPublishers(recvTopic, this->pUuid))
-              {
-                break;
-              }
+              std::cerr << "Discovery::DispatchDiscoveryMsg() Invalid "
+                        << "ADVERTISE_BATCH message" << std::endl;
+              break;
+            }
 
-              if (!this->info.Publishers(recvTopic, addresses))
-                break;
+            // Part of a snapshot requested with a SYNC message.
+            if (_header.Flags() & SyncFlag)
+            {
+              this->ApplySnapshot(_fromIp, recvPUuid, _header.StateVersion(),
+                batchMsg);
+              break;
             }
 
-            for (const auto &nodeInfo : addresses[this->pUuid])
+            for (const auto &pub : batchMsg.Publishers())
             {
               // Check scope of the topic.
-              if ((nodeInfo.Scope() == Scope_t::PROCESS) ||
-                  (nodeInfo.Scope() == Scope_t::HOST &&
+              if ((pub.Scope() == Scope_t::PROCESS) ||
+                  (pub.Scope() == Scope_t::HOST &&
                    _fromIp != this->hostAddr))
               {
                 continue;
               }
 
-              // Answer an ADVERTISE message.
-              this->SendMsg(AdvType, nodeInfo);
+              // Register an advertised address for the topic.
+              bool added;
+              {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                added = store.info.AddPublisher(pub);
+              }
+
+              if (added)
+              {
+                // Notify the client.
+                this->QueueEvent(true, pub);
+              }
             }
 
             break;
           }
-          case HeartbeatType:
-          {
-            // The timestamp has already been updated.
-            break;
-          }
-          case ByeType:
+          case SubType:
           {
-            // Remove the activity entry for this publisher.
+            // Read the rest of the fields.
+            SubscriptionMsg subMsg;
+            if (subMsg.Unpack(_body, bodyLen) == 0)
             {
-              std::lock_guard<std::mutex> lock(this->mutex);
-              this->activity.erase(recvPUuid);
+              std::cerr << "Discovery::DispatchDiscoveryMsg() Invalid "
+                        << "SUBSCRIBE message" << std::endl;
+              break;
             }
+            auto recvTopic = subMsg.Topic();
 
-            if (disconnectCb)
-            {
-              Pub pub;
-              pub.SetPUuid(recvPUuid);
-              pub.SetScope(Scope_t::ALL);
-              // Notify the new disconnection.
-              disconnectCb(pub);
-            }
+            std::lock_guard<std::mutex> lock(this->mutex);
 
-            // Remove the address entry for this topic.
+            // Check if at least one of my nodes advertises the topic requested.
+            if (!store.info.HasAnyPublishers(recvTopic, this->processUuid))
+              break;
+
+            // Many processes usually ask for the same topic at the same time.
+            // The answer is delayed a random time and a single answer serves
+            // all the requests received meanwhile (see UpdateAnswers).
+            auto key = std::make_pair(recvTopic, _fromIp == this->hostAddr);
+            if (store.pendingAnswers.find(key) == store.pendingAnswers.end())
             {
-              std::lock_guard<std::mutex> lock(this->mutex);
-              this->info.DelPublishersByProc(recvPUuid);
+              store.pendingAnswers[key] = std::chrono::steady_clock::now() +
+                this->RandomDuration(kMinAnswerDelay, kMaxAnswerDelay);
             }
 
             break;
@@ -890,7 +802,16 @@ namespace ignition
           {
             // Read the address.
             transport::AdvertiseMessage<Pub> advMsg;
-            advMsg.Unpack(pBody);
+            if (advMsg.Unpack(_body, bodyLen) == 0)
+            {
+              std::cerr << "Discovery::DispatchDiscoveryMsg() Invalid "
+                        << "UNADVERTISE message" << std::endl;
+              break;
+            }
+
+            // Discard the changes already applied.
+            if (!this->AcceptStateChange(recvPUuid, _header.StateVersion()))
+              return;
 
             // Check scope of the topic.
             if ((advMsg.Publisher().Scope() == Scope_t::PROCESS) ||
@@ -900,47 +821,44 @@ namespace ignition
               return;
             }
 
-            if (disconnectCb)
-            {
-              // Notify the new disconnection.
-              disconnectCb(advMsg.Publisher());
-            }
-
-            // Remove the address entry for this topic.
+            // Remove the address entry for this topic before notifying, so
+            // the callback doesn't see it anymore.
             {
               std::lock_guard<std::mutex> lock(this->mutex);
-              this->info.DelPublisherByNode(advMsg.Publisher().Topic(),
-                advMsg.Publisher().PUuid(), advMsg.Publisher().NUuid());
+              store.info.DelPublisherByNode(advMsg.Publisher().Topic(),
+                advMsg.Publisher().ProcessUuid(),
+                advMsg.Publisher().NodeUuid());
             }
 
+            // Notify the new disconnection.
+            this->QueueEvent(false, advMsg.Publisher());
+
             break;
           }
           default:
-          {
-            std::cerr << "Unknown message type [" << header.Type() << "]\n";
             break;
-          }
         }
       }
 
-      /// \brief Broadcast a discovery message.
+      /// \brief Serialize a discovery message.
       /// \param[in] _type Message type.
       /// \param[in] _pub Publishers's information to send.
-      /// \param[in] _flags Optional flags. Currently, the flags are not used
-      /// but they will in the future for specifying things like compression,
-      /// or encryption.
+      /// \param[in] _stateVersion Version of our discovery state. For the
+      /// ADVERTISE and UNADVERTISE messages, it's the version after the
+      /// change.
+      /// \param[in] _flags Optional flags (e.g.: SrvFlag).
+      /// \return The serialized message or an empty buffer on error.
       private: template<typename T>
-      void SendMsg(const uint8_t _type,
-                   const T &_pub,
-                   const uint16_t _flags = 0) const
+      std::vector<char> PackMsg(const uint8_t _type,
+                                const T &_pub,
+                                const uint32_t _stateVersion,
+                                const uint16_t _flags = 0) const
       {
-        // Create the header.
-        Header header(this->Version(), _pub.PUuid(), _type, _flags);
-        auto msgLength = 0;
+        // Create the header. Every message sent identifies this process.
+        Header header(this->Version(), this->processUuid, _type, _flags);
+        header.SetStateVersion(_stateVersion);
         std::vector<char> buffer;
 
-        std::string topic = _pub.Topic();
-
         switch (_type)
         {
           case AdvType:
@@ -952,132 +870,552 @@ namespace ignition
             // Allocate a buffer and serialize the message.
             buffer.resize(advMsg.MsgLength());
             advMsg.Pack(reinterpret_cast<char*>(&buffer[0]));
-            msgLength = static_cast<int>(advMsg.MsgLength());
             break;
           }
           case SubType:
           {
             // Create the [UN]SUBSCRIBE message.
-            SubscriptionMsg subMsg(header, topic);
+            SubscriptionMsg subMsg(header, _pub.Topic());
 
             // Allocate a buffer and serialize the message.
             buffer.resize(subMsg.MsgLength());
             subMsg.Pack(reinterpret_cast<char*>(&buffer[0]));
-            msgLength = static_cast<int>(subMsg.MsgLength());
             break;
           }
           case HeartbeatType:
           case ByeType:
+          case QueryType:
           {
             // Allocate a buffer and serialize the message.
             buffer.resize(header.HeaderLength());
             header.Pack(reinterpret_cast<char*>(&buffer[0]));
-            msgLength = header.HeaderLength();
             break;
           }
           default:
             std::cerr << "Discovery::SendMsg() error: Unrecognized message"
                       << " type [" << _type << "]" << std::endl;
-            return;
+            break;
         }
 
-        // Send the discovery message to the multicast group through all the
-        // sockets.
-        for (const auto &sock : this->Sockets())
+        return buffer;
+      }
+
+      /// \brief Broadcast a discovery message.
+      /// \param[in] _type Message type.
+      /// \param[in] _pub Publishers's information to send.
+      /// \param[in] _stateVersion Version of our discovery state. For the
+      /// ADVERTISE and UNADVERTISE messages, it's the version after the
+      /// change.
+      /// \param[in] _flags Optional flags: SrvFlag when _pub is a service.
+      private: template<typename T>
+      void SendMsg(const uint8_t _type,
+                   const T &_pub,
+                   const uint32_t _stateVersion,
+                   const uint16_t _flags = 0) const
+      {
+        std::vector<char> buffer =
+          this->PackMsg(_type, _pub, _stateVersion, _flags);
+        if (buffer.empty() ||
+            !this->Broadcast(buffer, static_cast<int>(buffer.size())))
+        {
+          return;
+        }
+
+        if (this->Verbose())
+        {
+          std::cout << "\t* Sending " << MsgTypesStr[_type]
+                    << " msg [" << _pub.Topic() << "]" << std::endl;
+        }
+      }
+
+      /// \brief Split a list of publishers in groups that fit in an
+      /// ADVERTISE_BATCH datagram. Each datagram is limited to
+      /// kMaxAdvBatchSize bytes, unless a single publisher doesn't fit in it.
+      /// \param[in] _pubs Publishers.
+      /// \return The groups of publishers.
+      private: template<typename Pub>
+      std::vector<std::vector<Pub>> GroupPublishers(
+        const std::vector<Pub> &_pubs) const
+      {
+        Header header(this->Version(), this->processUuid, AdvBatchType);
+        size_t emptyLength = AdvertiseBatchMessage<Pub>(header).MsgLength();
+        size_t groupLength = emptyLength;
+        std::vector<std::vector<Pub>> groups;
+        for (const auto &pub : _pubs)
         {
-          if (sendto(sock, reinterpret_cast<const raw_type *>(
-            reinterpret_cast<unsigned char*>(&buffer[0])),
-            msgLength, 0,
-            reinterpret_cast<const sockaddr *>(this->MulticastAddr()),
-            sizeof(*(this->MulticastAddr()))) != msgLength)
+          size_t pubLength = pub.MsgLength();
+          if (groups.empty() ||
+              (!groups.back().empty() &&
+               groupLength + pubLength > kMaxAdvBatchSize))
           {
-            std::cerr << "Exception sending a message" << std::endl;
-            return;
+            groups.push_back(std::vector<Pub>());
+            groupLength = emptyLength;
           }
+
+          groups.back().push_back(pub);
+          groupLength += pubLength;
+        }
+
+        return groups;
+      }
+
+      /// \brief Serialize groups of publishers as ADVERTISE_BATCH messages.
+      /// \param[in] _groups Groups of publishers, one per message.
+      /// \param[in] _stateVersion Version of our discovery state.
+      /// \param[in] _flags SyncFlag if the publishers are part of a complete
+      /// snapshot of our state or 0 otherwise.
+      /// \param[in] _firstPart Part number of the first group.
+      /// \param[in] _numParts Total number of parts of the batch.
+      /// \param[out] _buffers The serialized messages are appended here.
+      /// \return True on success or false otherwise.
+      private: template<typename Pub>
+      bool PackAdvBatch(const std::vector<std::vector<Pub>> &_groups,
+                        const uint32_t _stateVersion,
+                        const uint16_t _flags,
+                        const size_t _firstPart,
+                        const size_t _numParts,
+                        std::vector<std::vector<char>> &_buffers) const
+      {
+        Header header(this->Version(), this->processUuid, AdvBatchType,
+          _flags | DiscoveryKind<Pub>::kFlags);
+        header.SetStateVersion(_stateVersion);
+
+        for (size_t i = 0; i < _groups.size(); ++i)
+        {
+          AdvertiseBatchMessage<Pub> batchMsg(header);
+          batchMsg.SetPart(static_cast<uint16_t>(_firstPart + i),
+            static_cast<uint16_t>(_numParts));
+          for (const auto &pub : _groups[i])
+            batchMsg.AddPublisher(pub);
+
+          _buffers.push_back(std::vector<char>(batchMsg.MsgLength()));
+          if (batchMsg.Pack(&_buffers.back()[0]) == 0)
+            return false;
+        }
+
+        return true;
+      }
+
+      /// \brief Broadcast a list of publishers of this process using as few
+      /// ADVERTISE_BATCH messages as possible.
+      /// \param[in] _pubs Publishers to advertise.
+      /// \param[in] _stateVersion Version of our discovery state.
+      private: template<typename Pub>
+      void SendAdvBatch(const std::vector<Pub> &_pubs,
+                        const uint32_t _stateVersion) const
+      {
+        auto groups = this->GroupPublishers(_pubs);
+        if (groups.size() > UINT16_MAX)
+        {
+          std::cerr << "Discovery::SendAdvBatch() error: Too many publishers"
+                    << std::endl;
+          return;
         }
 
+        std::vector<std::vector<char>> buffers;
+        if (!this->PackAdvBatch(groups, _stateVersion, 0, 0, groups.size(),
+              buffers))
+        {
+          return;
+        }
+
+        // All the parts are sent together.
+        if (!this->Broadcast(buffers))
+          return;
+
         if (this->Verbose())
         {
-          std::cout << "\t* Sending " << MsgTypesStr[_type]
-                    << " msg [" << topic << "]" << std::endl;
+          for (const auto &group : groups)
+          {
+            std::cout << "\t* Sending " << MsgTypesStr[AdvBatchType]
+                      << " msg [" << group.size() << " publishers]"
+                      << std::endl;
+          }
         }
       }
 
-      /// \brief Get the list of sockets used for discovery.
-      /// \return The list of sockets.
-      private: const std::vector<int> &Sockets() const
+      /// \brief Broadcast a complete snapshot of the discovery state of this
+      /// process: the topics and the services, numbered as the parts of a
+      /// single batch.
+      /// \param[in] _msgPubs Topics advertised.
+      /// \param[in] _srvPubs Services advertised.
+      /// \param[in] _stateVersion Version of our discovery state.
+      private: void SendSnapshot(const std::vector<MessagePublisher> &_msgPubs,
+        const std::vector<ServicePublisher> &_srvPubs,
+        const uint32_t _stateVersion) const;
+
+      /// \brief Register a change in the discovery state of this process. The
+      /// mutex should be locked by the caller.
+      /// \param[in] _type AdvType or UnadvType.
+      /// \param[in] _pub Publisher advertised or unadvertised.
+      /// \return The new version of the discovery state.
+      private: template<typename Pub>
+      uint32_t AddStateChange(const uint8_t _type, const Pub &_pub)
       {
-        return this->sockets;
+        ++this->stateVersion;
+
+        // The change is stored serialized: topics and services share the
+        // same history.
+        StateChange change;
+        change.version = this->stateVersion;
+        change.buffer = this->PackMsg(_type, _pub, this->stateVersion,
+          DiscoveryKind<Pub>::kFlags);
+        this->stateChanges.push_back(change);
+
+        if (this->stateChanges.size() > kMaxStateChanges)
+          this->stateChanges.pop_front();
+
+        return this->stateVersion;
       }
 
-      /// \brief Get the data structure used for multicast communication.
-      /// \return The data structure containing the multicast information.
-      private: const sockaddr_in *MulticastAddr() const
+      /// \brief Check the version of a change (ADVERTISE or UNADVERTISE)
+      /// received from a remote process. A synchronization is requested when
+      /// some previous changes were missed.
+      /// \param[in] _pUuid Process UUID of the sender.
+      /// \param[in] _version Version of the sender's state after the change.
+      /// \return True if the change should be applied or false if it was
+      /// already applied.
+      private: bool AcceptStateChange(const Uuid &_pUuid,
+                                      const uint32_t _version);
+
+      /// \brief Ask a remote process for the changes in its discovery state.
+      /// Consecutive requests to the same process are rate limited.
+      /// \param[in] _pUuid Process UUID of the remote process.
+      /// \param[in] _knownVersion Version of its state already known or 0
+      /// for requesting a complete snapshot.
+      private: void RequestSync(const Uuid &_pUuid,
+                                const uint32_t _knownVersion);
+
+      /// \brief Schedule the answer to a SYNC or QUERY request. Many processes
+      /// usually ask for our state at the same time (e.g.: when they start
+      /// together), so the answer is delayed a random time and a single
+      /// answer serves all the requests received meanwhile: it starts at the
+      /// lowest version known by the requesters (see UpdateState).
+      /// \param[in] _knownVersion Version of our state known by the
+      /// requester or 0 for a complete snapshot.
+      private: void ScheduleState(uint32_t _knownVersion);
+
+      /// \brief Answer the pending SYNC and QUERY requests when their delay
+      /// has expired.
+      /// \sa ScheduleState.
+      private: void UpdateState();
+
+      /// \brief Answer a SYNC request. If the changes since the version known
+      /// by the requester are still available, they're sent again. Otherwise,
+      /// a complete snapshot of our state is sent.
+      /// \param[in] _knownVersion Version of our state known by the
+      /// requester.
+      private: void SendState(const uint32_t _knownVersion);
+
+      /// \brief Get the publishers of this process visible outside of it.
+      /// The mutex should be locked by the caller.
+      /// \param[out] _pubs The publishers are appended here.
+      private: template<typename Pub>
+      void LocalPublishers(std::vector<Pub> &_pubs) const
       {
-        return &this->mcastAddr;
+        std::map<std::string, std::vector<Pub>> nodes;
+        this->Store<Pub>().info.PublishersByProc(this->processUuid, nodes);
+        for (const auto &topic : nodes)
+        {
+          for (const auto &node : topic.second)
+          {
+            if (node.Scope() != Scope_t::PROCESS)
+              _pubs.push_back(node);
+          }
+        }
       }
 
-      /// \brief Get the verbose mode.
-      /// \return True when verbose mode is enabled or false otherwise.
-      private: bool Verbose() const
+      /// \brief Process a part of a snapshot of the discovery state of a
+      /// remote process. When all the parts are received, the snapshot
+      /// replaces the information known about the process.
+      /// \param[in] _fromIp IP address of the sender.
+      /// \param[in] _pUuid Process UUID of the sender.
+      /// \param[in] _version Version of the sender's state.
+      /// \param[in] _batchMsg Part of the snapshot.
+      private: template<typename Pub>
+      void ApplySnapshot(const std::string &_fromIp,
+                         const Uuid &_pUuid,
+                         const uint32_t _version,
+                         const AdvertiseBatchMessage<Pub> &_batchMsg)
       {
-        return this->verbose;
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto &peer = this->peers[_pUuid];
+
+        // It might be an answer to our QUERY message.
+        this->ExtendInit();
+
+        // We already know this state or a newer one.
+        if (peer.synced && _version <= peer.version)
+          return;
+
+        // Start collecting a new snapshot.
+        if (peer.receivedParts.empty() ||
+            peer.snapshotVersion != _version ||
+            peer.snapshotParts != _batchMsg.NumParts())
+        {
+          peer.snapshotVersion = _version;
+          peer.snapshotParts = _batchMsg.NumParts();
+          peer.receivedParts.clear();
+          this->Store<MessagePublisher>().snapshots.erase(_pUuid);
+          this->Store<ServicePublisher>().snapshots.erase(_pUuid);
+        }
+
+        // Duplicated part.
+        if (!peer.receivedParts.insert(_batchMsg.Part()).second)
+          return;
+
+        auto &snapshot = this->Store<Pub>().snapshots[_pUuid];
+        for (const auto &pub : _batchMsg.Publishers())
+        {
+          // Check scope of the topic.
+          if ((pub.Scope() == Scope_t::PROCESS) ||
+              (pub.Scope() == Scope_t::HOST && _fromIp != this->hostAddr))
+          {
+            continue;
+          }
+
+          snapshot.push_back(pub);
+        }
+
+        if (peer.receivedParts.size() < peer.snapshotParts)
+          return;
+
+        // The snapshot is complete.
+        this->ReplacePublishers<MessagePublisher>(_pUuid);
+        this->ReplacePublishers<ServicePublisher>(_pUuid);
+
+        peer.synced = true;
+        peer.version = _version;
+        peer.receivedParts.clear();
       }
 
-      /// \brief Get the discovery protocol version.
-      /// \return The discovery version.
-      private: uint8_t Version() const
+      /// \brief Replace the publishers known of a remote process with the
+      /// ones of the snapshot just received. The mutex should be locked by
+      /// the caller.
+      /// \param[in] _pUuid Process UUID of the remote process.
+      private: template<typename Pub>
+      void ReplacePublishers(const Uuid &_pUuid)
       {
-        return this->kWireVersion;
+        auto &store = this->Store<Pub>();
+        std::vector<Pub> snapshot = store.snapshots[_pUuid];
+        store.snapshots.erase(_pUuid);
+
+        // Remove the publishers that are gone.
+        std::set<std::pair<std::string, Uuid>> current;
+        for (const auto &pub : snapshot)
+          current.insert(std::make_pair(pub.Topic(), pub.NodeUuid()));
+
+        std::map<std::string, std::vector<Pub>> nodes;
+        store.info.PublishersByProc(_pUuid, nodes);
+        for (const auto &topic : nodes)
+        {
+          for (const auto &node : topic.second)
+          {
+            if (current.find(std::make_pair(node.Topic(), node.NodeUuid())) ==
+                current.end())
+            {
+              store.info.DelPublisherByNode(node.Topic(), _pUuid,
+                node.NodeUuid());
+              this->QueueEvent(false, node);
+            }
+          }
+        }
+
+        // Register the new publishers.
+        for (const auto &pub : snapshot)
+        {
+          if (store.info.AddPublisher(pub))
+            this->QueueEvent(true, pub);
+        }
       }
 
-      /// \brief Register a new network interface in the discovery system.
-      /// \param[in] _ip IP address to register.
-      /// \return True when the interface was successfully registered or false
-      /// otherwise (e.g.: invalid IP address).
-      private: bool RegisterNetIface(const std::string &_ip)
+      /// \brief Queue a discovery notification for the event thread. An
+      /// event identical to one still waiting to be delivered is discarded,
+      /// so the bursts of duplicated messages (e.g.: a snapshot and the
+      /// incremental changes that it already contains) only trigger one
+      /// callback.
+      /// \param[in] _connection True for a connection or false for a
+      /// disconnection.
+      /// \param[in] _pub Publisher connected or disconnected.
+      private: template<typename Pub>
+      void QueueEvent(const bool _connection, const Pub &_pub)
       {
-        // Make a new socket for sending discovery information.
-        int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (sock < 0)
+        // The events of each publisher keep their order.
+        std::string key = _pub.PUuid() + "/" + _pub.NUuid() + "/" +
+          _pub.Topic();
         {
-          std::cerr << "Socket creation failed." << std::endl;
-          return false;
+          std::lock_guard<std::mutex> lock(this->eventsMutex);
+          auto &store = this->Store<Pub>();
+
+          auto &pending = store.pendingEvents[key];
+          if (pending.queued > 0 && pending.connection == _connection &&
+              pending.pub == _pub)
+          {
+            return;
+          }
+
+          ++pending.queued;
+          pending.connection = _connection;
+          pending.pub = _pub;
+
+          DiscoveryEvent<Pub> event;
+          event.connection = _connection;
+          event.pub = _pub;
+          event.key = key;
+          store.events.push_back(event);
         }
+        this->eventsCv.notify_one();
+      }
 
-        // Socket option: IP_MULTICAST_IF.
-        // This socket option needs to be applied to each socket used to send
-        // data. This option selects the source interface for outgoing messages.
-        struct in_addr ifAddr;
-        ifAddr.s_addr = inet_addr(_ip.c_str());
-        if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF,
-          reinterpret_cast<const char*>(&ifAddr), sizeof(ifAddr)) != 0)
+      /// \brief Execute the callbacks for the queued discovery events. It
+      /// runs in its own thread, so the callbacks never delay the reception
+      /// of discovery messages.
+      private: void DispatchEvents();
+
+      /// \brief Execute the callback for the next discovery event of a kind
+      /// of publisher, if any.
+      private: template<typename Pub>
+      void DispatchEvent()
+      {
+        DiscoveryEvent<Pub> event;
         {
-          std::cerr << "Error setting socket option (IP_MULTICAST_IF)."
-                    << std::endl;
-          return false;
+          std::lock_guard<std::mutex> lock(this->eventsMutex);
+          auto &store = this->Store<Pub>();
+          if (this->eventsExit || store.events.empty())
+            return;
+
+          event = store.events.front();
+          store.events.pop_front();
+
+          auto it = store.pendingEvents.find(event.key);
+          if (it != store.pendingEvents.end() && --it->second.queued == 0)
+            store.pendingEvents.erase(it);
         }
 
-        this->sockets.push_back(sock);
-
-        // Join the multicast group. We have to do it for each network interface
-        // but we can do it on the same socket. We will use the socket at
-        // position 0 for receiving multicast information.
-        struct ip_mreq group;
-        group.imr_multiaddr.s_addr =
-          inet_addr(this->kMulticastGroup.c_str());
-        group.imr_interface.s_addr = inet_addr(_ip.c_str());
-        if (setsockopt(this->sockets.at(0), IPPROTO_IP, IP_ADD_MEMBERSHIP,
-          reinterpret_cast<const char*>(&group), sizeof(group)) != 0)
+        DiscoveryCallback<Pub> cb;
         {
-          std::cerr << "Error setting socket option (IP_ADD_MEMBERSHIP)."
-                    << std::endl;
-          return false;
+          std::lock_guard<std::mutex> lock(this->mutex);
+          auto &store = this->Store<Pub>();
+          cb = event.connection ? store.connectionCb : store.disconnectionCb;
         }
 
-        return true;
+        if (cb)
+          cb(event.pub);
       }
 
+      /// \brief Send a serialized discovery message to the multicast group
+      /// through all the sockets.
+      /// \param[in] _buffer Serialized message.
+      /// \param[in] _msgLength Length of the message in bytes.
+      /// \return True if the message was sent or false otherwise.
+      private: bool Broadcast(const std::vector<char> &_buffer,
+                              const int _msgLength) const;
+
+      /// \brief Send a list of serialized discovery messages to the multicast
+      /// group through all the sockets. When the token bucket doesn't allow
+      /// sending them now, they're queued for the sender thread.
+      /// \param[in] _buffers Serialized messages.
+      /// \return True if the messages were sent or queued or false otherwise.
+      /// \sa SetMaxSendRate.
+      private: bool Broadcast(
+        const std::vector<std::vector<char>> &_buffers) const;
+
+      /// \brief Send a list of serialized discovery messages to the multicast
+      /// group through all the sockets, without checking the send rate.
+      /// \param[in] _buffers Serialized messages.
+      /// \return True if the messages were sent or false otherwise.
+      private: bool SendNow(
+        const std::vector<std::vector<char>> &_buffers) const;
+
+      /// \brief Send the messages queued by Broadcast() as soon as the token
+      /// bucket allows it. It runs in its own thread, so the discovery
+      /// reception and the callers of Advertise() and friends never wait for
+      /// the tokens. The thread finishes once the queue is empty after the
+      /// destructor asks for it; the messages still queued at that point are
+      /// sent without checking the rate.
+      private: void RunSender();
+
+      /// \brief Add the tokens earned since the last refill to the token
+      /// bucket. The send rate mutex should be locked by the caller.
+      private: void RefillSendTokens() const;
+
+      /// \brief Get the capacity of the token bucket. The send rate mutex
+      /// should be locked by the caller.
+      /// \return The maximum number of tokens.
+      private: double SendBurst() const;
+
+      /// \brief Send a list of datagrams to a list of destinations. When
+      /// sendmmsg() is available, the datagrams are sent with as few system
+      /// calls as possible.
+      /// \param[in] _sock Socket used for sending.
+      /// \param[in] _buffers Datagrams to send.
+      /// \param[in] _dsts Destinations of every datagram.
+      /// \return True if all the datagrams were sent or false otherwise.
+      private: bool SendDatagrams(
+        const int _sock,
+        const std::vector<std::vector<char>> &_buffers,
+        const std::vector<sockaddr_in> &_dsts) const;
+
+#ifndef _WIN32
+      /// \brief Join the local registry: a private directory shared by all
+      /// the processes of this user using the same discovery port. Each
+      /// process binds a Unix datagram socket named after its process UUID
+      /// inside the directory, so the local processes exchange the discovery
+      /// messages without depending on multicast. The registry is only used
+      /// if the directory is a real directory owned by the user and not
+      /// writable by anyone else.
+      private: void RegisterLocal();
+
+      /// \brief Update the list of processes registered in the local
+      /// registry, at most once every kLocalRefreshInterval ms. The processes
+      /// that send us a message through the registry are added as soon as
+      /// it's received.
+      private: void RefreshLocal();
+
+      /// \brief Queue serialized discovery messages for the other processes
+      /// registered in this host. They're sent by the local sender thread,
+      /// so this function never blocks. The messages that don't fit in the
+      /// queue are dropped, the synchronization of the discovery state
+      /// recovers them later.
+      /// \param[in] _buffers Serialized messages.
+      private: void LocalBroadcast(
+        const std::vector<std::vector<char>> &_buffers) const;
+
+      /// \brief Send the messages queued for the processes of this host. It
+      /// runs in its own thread, so a process that doesn't drain its queue
+      /// never delays the reception of discovery messages. The thread
+      /// finishes once the queue is empty after the destructor asks for it.
+      private: void RunLocalSender();
+
+      /// \brief Send serialized discovery messages to the other processes
+      /// registered in this host. The sockets of the processes that are gone
+      /// are removed from the registry.
+      /// \param[in] _buffers Serialized messages.
+      private: void LocalSend(const std::vector<std::vector<char>> &_buffers);
+#endif
+
+      /// \brief Get the list of sockets used for discovery.
+      /// \return The list of sockets.
+      private: const std::vector<int> &Sockets() const;
+
+      /// \brief Get the data structure used for multicast communication.
+      /// \return The data structure containing the multicast information.
+      private: const sockaddr_in *MulticastAddr() const;
+
+      /// \brief Get the verbose mode.
+      /// \return True when verbose mode is enabled or false otherwise.
+      private: bool Verbose() const;
+
+      /// \brief Get the discovery protocol version.
+      /// \return The discovery version.
+      private: uint8_t Version() const;
+
+      /// \brief Register a new network interface in the discovery system.
+      /// \param[in] _ip IP address to register.
+      /// \return True when the interface was successfully registered or false
+      /// otherwise (e.g.: invalid IP address).
+      private: bool RegisterNetIface(const std::string &_ip);
+
       /// \brief Default activity interval value (ms.).
       /// \sa ActivityInterval.
       /// \sa SetActivityInterval.
@@ -1102,9 +1440,178 @@ namespace ignition
       /// \brief Longest string to receive.
       private: static const int kMaxRcvStr = 65536;
 
+      /// \brief Maximum number of datagrams read with a single recvmmsg().
+      private: static const unsigned int kMaxDatagramBatch = 16;
+
+      /// \brief Default maximum rate of discovery datagrams sent (datagrams
+      /// per second).
+      /// \sa SetMaxSendRate.
+      private: static const unsigned int kDefMaxSendRate = 2000;
+
+      /// \brief Maximum deviation of the heartbeat interval, as a fraction
+      /// of the interval.
+      private: const double kHeartbeatJitter = 0.1;
+
+      /// \brief Minimum delay before answering a SUBSCRIBE, SYNC or QUERY
+      /// request (ms.).
+      private: const unsigned int kMinAnswerDelay = 5;
+
+      /// \brief Maximum delay before answering a SUBSCRIBE, SYNC or QUERY
+      /// request (ms.).
+      private: const unsigned int kMaxAnswerDelay = 20;
+
+      /// \brief Default size of the kernel receive buffer of the discovery
+      /// socket (bytes).
+      /// \sa SetReceiveBufferSize.
+      private: static const int kDefRcvBufSize = 1048576;
+
       /// \brief Wire protocol version. Bump up the version number if you modify
       /// the wire protocol (for discovery or message/service exchange).
-      private: static const uint8_t kWireVersion = 6;
+      private: static const uint8_t kWireVersion = 13;
+
+      /// \brief Maximum size of an ADVERTISE_BATCH datagram (bytes). It fits
+      /// in the MTU of an Ethernet link (1500 bytes) along with the IP and UDP
+      /// headers, so the datagrams are never fragmented.
+      private: static const size_t kMaxAdvBatchSize = 1400;
+
+      /// \brief Maximum number of changes of our discovery state stored for
+      /// answering the SYNC requests without sending a complete snapshot.
+      private: static const size_t kMaxStateChanges = 256;
+
+      /// \brief Minimum time waiting for the answers to our QUERY message
+      /// during the initialization phase (ms.).
+      private: const unsigned int kMinInitWait = 30;
+
+      /// \brief Interval between the updates of the list of processes
+      /// registered in the local registry (ms.).
+      private: const unsigned int kLocalRefreshInterval = 1000;
+
+      /// \brief Maximum time waiting for a local process to accept a message
+      /// sent through the local registry (ms.).
+      private: const unsigned int kLocalSendTimeout = 50;
+
+      /// \brief Time during which a message received from a process of this
+      /// host is remembered to discard its other copy (ms.).
+      private: const unsigned int kLocalDuplicateWindow = 250;
+
+      /// \brief Maximum number of messages remembered per process of this
+      /// host to discard their other copy.
+      private: static const size_t kMaxLocalDuplicates = 128;
+
+      /// \brief Maximum number of messages waiting to be sent through the
+      /// local registry.
+      private: static const size_t kMaxLocalQueue = 4096;
+
+      /// \brief Maximum number of messages waiting for the token bucket.
+      private: static const size_t kMaxSendQueue = 4096;
+
+      /// \brief A change in the discovery state of this process.
+      private: struct StateChange
+      {
+        /// \brief Version of the state after the change.
+        uint32_t version;
+
+        /// \brief The ADVERTISE or UNADVERTISE message, serialized.
+        std::vector<char> buffer;
+      };
+
+      /// \brief A discovery notification waiting to be delivered.
+      private: template<typename Pub>
+      struct DiscoveryEvent
+      {
+        /// \brief True for a connection or false for a disconnection.
+        bool connection = false;
+
+        /// \brief Publisher connected or disconnected.
+        Pub pub;
+
+        /// \brief Publisher identifier (process, node and topic).
+        std::string key;
+      };
+
+      /// \brief Last event queued for a publisher.
+      private: template<typename Pub>
+      struct PendingEvent
+      {
+        /// \brief Number of events of the publisher in the queue.
+        size_t queued = 0;
+
+        /// \brief True for a connection or false for a disconnection.
+        bool connection = false;
+
+        /// \brief Publisher of the last event.
+        Pub pub;
+      };
+
+      /// \brief Synchronization state of a remote process.
+      private: struct PeerState
+      {
+        /// \brief True when we know the state of the process.
+        bool synced = false;
+
+        /// \brief Version of the state of the process that we know.
+        uint32_t version = 0;
+
+        /// \brief Time of the last SYNC request sent to the process.
+        Timestamp lastSyncRequest;
+
+        /// \brief Version of the snapshot being received.
+        uint32_t snapshotVersion = 0;
+
+        /// \brief Number of parts of the snapshot being received.
+        uint16_t snapshotParts = 0;
+
+        /// \brief Parts of the snapshot already received.
+        std::set<uint16_t> receivedParts;
+      };
+
+      /// \brief Discovery information of a kind of publisher.
+      private: template<typename Pub>
+      struct DiscoveryStore
+      {
+        /// \brief Addressing information.
+        TopicStorage<Pub> info;
+
+        /// \brief Callback executed when new topics are discovered.
+        DiscoveryCallback<Pub> connectionCb;
+
+        /// \brief Callback executed when new topics are invalid.
+        DiscoveryCallback<Pub> disconnectionCb;
+
+        /// \brief SUBSCRIBE requests waiting to be answered. The key is the
+        /// topic and whether the requester is in this host. The value is the
+        /// time of the answer.
+        std::map<std::pair<std::string, bool>, Timestamp> pendingAnswers;
+
+        /// \brief Publishers of the snapshots being received. The key is the
+        /// process uuid.
+        std::map<Uuid, std::vector<Pub>> snapshots;
+
+        /// \brief Discovery events waiting to be delivered. Protected by
+        /// the events mutex.
+        std::deque<DiscoveryEvent<Pub>> events;
+
+        /// \brief Last event queued for each publisher. The key is the
+        /// publisher identifier. Protected by the events mutex.
+        std::map<std::string, PendingEvent<Pub>> pendingEvents;
+      };
+
+      /// \brief Get the discovery information of a kind of publisher.
+      /// \return The store of the kind.
+      private: template<typename Pub>
+      DiscoveryStore<Pub> &Store()
+      {
+        return std::get<DiscoveryKind<Pub>::kIndex>(this->stores);
+      }
+
+      /// \brief Get the discovery information of a kind of publisher.
+      /// \return The store of the kind.
+      private: template<typename Pub>
+      const DiscoveryStore<Pub> &Store() const
+      {
+        return std::get<DiscoveryKind<Pub>::kIndex>(this->stores);
+      }
+
 
       /// \brief Port used to broadcast the discovery messages.
       private: int port;
@@ -1118,6 +1625,10 @@ namespace ignition
       /// \brief Process UUID.
       private: std::string pUuid;
 
+      /// \brief Process UUID in its binary form, used for building the
+      /// headers without parsing the string each time.
+      private: Uuid processUuid;
+
       /// \brief Silence interval value (ms.).
       /// \sa MaxSilenceInterval.
       /// \sa SetMaxSilenceInterval.
@@ -1133,20 +1644,37 @@ namespace ignition
       /// \sa SetHeartbeatInterval.
       private: unsigned int heartbeatInterval;
 
-      /// \brief Callback executed when new topics are discovered.
-      private: DiscoveryCallback<Pub> connectionCb;
+      /// \brief Discovery information of the topics and the services.
+      private: std::tuple<DiscoveryStore<MessagePublisher>,
+                          DiscoveryStore<ServicePublisher>> stores;
+
+      /// \brief Version of the discovery state of this process. It's
+      /// increased each time a topic is advertised or unadvertised.
+      private: uint32_t stateVersion;
+
+      /// \brief Last changes of the discovery state of this process.
+      private: std::deque<StateChange> stateChanges;
 
-      /// \brief Callback executed when new topics are invalid.
-      private: DiscoveryCallback<Pub> disconnectionCb;
+      /// \brief True when a SYNC or QUERY request is waiting for its answer.
+      /// \sa ScheduleState.
+      private: bool statePending = false;
 
-      /// \brief Addressing information.
-      private: TopicStorage<Pub> info;
+      /// \brief Lowest version of our state known by the requesters waiting
+      /// for an answer or 0 for a complete snapshot.
+      private: uint32_t statePendingVersion = 0;
+
+      /// \brief Time to answer the pending SYNC and QUERY requests.
+      private: Timestamp timeStateAnswer;
+
+      /// \brief Synchronization state of the remote processes. The key is the
+      /// process uuid.
+      private: std::map<Uuid, PeerState> peers;
 
       /// \brief Activity information. Every time there is a message from a
       /// remote node, its activity information is updated. If we do not hear
       /// from a node in a while, its entries in 'info' will be invalided. The
       /// key is the process uuid.
-      protected: std::map<std::string, Timestamp> activity;
+      private: std::map<Uuid, Timestamp> activity;
 
       /// \brief Print discovery information to stdout.
       private: bool verbose;
@@ -1154,6 +1682,128 @@ namespace ignition
       /// \brief UDP socket used for sending/receiving discovery messages.
       private: std::vector<int> sockets;
 
+      /// \brief Buffer for receiving kMaxDatagramBatch datagrams.
+      private: std::unique_ptr<char[]> rcvBuffer;
+
+      /// \brief True while recvmmsg() is supported by the system.
+      private: bool recvBatchIo = true;
+
+      /// \brief True while sendmmsg() is supported by the system.
+      private: mutable std::atomic<bool> sendBatchIo{true};
+
+      /// \brief Number of datagrams dropped by the kernel because the
+      /// receive buffer was full.
+      private: std::atomic<uint64_t> droppedDatagrams{0};
+
+      /// \brief Number of datagrams dropped because the send queue was full.
+      private: mutable std::atomic<uint64_t> droppedSendDatagrams{0};
+
+      /// \brief Number of datagrams not delivered through the local registry.
+      private: mutable std::atomic<uint64_t> droppedLocalDatagrams{0};
+
+      /// \brief Number of datagrams sent.
+      private: mutable std::atomic<uint64_t> sentDatagrams{0};
+
+      /// \brief Number of bytes sent.
+      private: mutable std::atomic<uint64_t> sentBytes{0};
+
+      /// \brief Number of datagrams received.
+      private: std::atomic<uint64_t> receivedDatagrams{0};
+
+      /// \brief Number of bytes received.
+      private: std::atomic<uint64_t> receivedBytes{0};
+
+      /// \brief Maximum number of datagrams sent per second or 0 for no
+      /// limit.
+      private: unsigned int maxSendRate = kDefMaxSendRate;
+
+      /// \brief Tokens available in the token bucket.
+      private: mutable double sendTokens = 0;
+
+      /// \brief Last time the tokens were refilled.
+      private: mutable Timestamp timeLastRefill;
+
+      /// \brief Mutex to guarantee exclusive access to the token bucket and
+      /// the send queue.
+      private: mutable std::mutex sendRateMutex;
+
+      /// \brief Messages waiting for the token bucket.
+      /// \sa RunSender.
+      private: mutable std::deque<std::vector<char>> sendQueue;
+
+      /// \brief True while the sender thread is sending messages already
+      /// removed from the send queue.
+      private: bool sendInFlight = false;
+
+      /// \brief Used to wake up the sender thread.
+      private: mutable std::condition_variable sendCv;
+
+      /// \brief When true, the sender thread finishes after sending the
+      /// messages still queued.
+      private: bool sendExit = false;
+
+      /// \brief Thread in charge of sending the messages queued because of
+      /// the send rate.
+      private: std::thread threadSender;
+
+#ifdef _WIN32
+      /// \brief When the sender thread is finished (or it was never
+      /// started), this variable will be true.
+      private: bool threadSenderExiting = true;
+#endif
+
+#ifndef _WIN32
+      /// \brief Unix datagram socket registered in the local registry or -1
+      /// if the registry is not available.
+      private: int localSocket = -1;
+
+      /// \brief Directory of the local registry.
+      private: std::string localDir;
+
+      /// \brief Process UUIDs of the sockets found in the local registry.
+      private: mutable std::set<std::string> localRegistry;
+
+      /// \brief Mutex to guarantee exclusive access to the local registry.
+      private: mutable std::mutex localRegistryMutex;
+
+      /// \brief Next time to update the list of processes in the local
+      /// registry.
+      private: Timestamp timeNextLocalRefresh;
+
+      /// \brief Messages waiting to be sent through the local registry.
+      private: mutable std::deque<std::vector<char>> localQueue;
+
+      /// \brief Mutex to guarantee exclusive access to the local queue.
+      private: mutable std::mutex localSendMutex;
+
+      /// \brief Used to wake up the local sender thread.
+      private: mutable std::condition_variable localSendCv;
+
+      /// \brief When true, the local sender thread finishes after sending
+      /// the messages still queued.
+      private: bool localSendExit = false;
+
+      /// \brief Thread in charge of sending the messages through the local
+      /// registry.
+      private: std::thread threadLocalSender;
+#endif
+
+      /// \brief Static peers that receive our messages by unicast.
+      private: std::vector<sockaddr_in> staticPeers;
+
+      /// \brief Mutex to guarantee exclusive access to the static peers.
+      private: mutable std::mutex staticPeersMutex;
+
+      /// \brief Processes of this host that send their messages through the
+      /// local registry.
+      private: std::set<Uuid> localPeers;
+
+      /// \brief Hashes of the messages recently received from the processes
+      /// of this host, with their arrival time. The entries outlive the
+      /// process, so the late copy of its BYE is discarded too.
+      private: std::map<Uuid,
+        std::deque<std::pair<size_t, Timestamp>>> recentLocalMsgs;
+
       /// \brief Internet socket address for sending to the multicast group.
       private: sockaddr_in mcastAddr;
 
@@ -1172,14 +1822,16 @@ namespace ignition
       /// \brief Mutex to guarantee exclusive access to the exit variable.
       private: std::mutex exitMutex;
 
-      /// \brief Once the discovery starts, it can take up to
-      /// HeartbeatInterval milliseconds to discover the existing nodes on the
-      /// network. This variable is 'false' during the first HeartbeatInterval
-      /// period and is set to 'true' after that.
+      /// \brief Once the discovery starts, it sends a QUERY message and waits
+      /// for the answers of the existing processes. This variable is 'false'
+      /// until the answers stop arriving and is set to 'true' after that.
       private: bool initialized;
 
-      /// \brief Number of heartbeats sent while discovery is uninitialized.
-      private: unsigned int numHeartbeatsUninitialized;
+      /// \brief Time at which the QUERY message was sent.
+      private: Timestamp timeQuery;
+
+      /// \brief Time at which the initialization phase will finish.
+      private: Timestamp timeInitDeadline;
 
       /// \brief Used to block/unblock until the initialization phase finishes.
       private: mutable std::condition_variable initializedCv;
@@ -1192,8 +1844,288 @@ namespace ignition
       private: bool threadReceptionExiting = true;
 #endif
 
+      /// \brief Mutex to guarantee exclusive access to the event queues.
+      private: std::mutex eventsMutex;
+
+      /// \brief Used to wake up the event thread.
+      private: std::condition_variable eventsCv;
+
+      /// \brief When true, the event thread will finish.
+      private: bool eventsExit = false;
+
+      /// \brief Thread in charge of executing the discovery callbacks.
+      private: std::thread threadEvents;
+
+#ifdef _WIN32
+      /// \brief True when the event thread is finishing.
+      private: bool threadEventsExiting = true;
+#endif
+
       /// \brief When true, the service is enabled.
       private: bool enabled;
+
+      /// \brief Random number generator used for the jitter.
+      private: std::mt19937 randGenerator;
+    };
+
+    /// \class Discovery Discovery.hh ignition/transport/Discovery.hh
+    /// \brief A typed view of a discovery engine. The discovery clients can
+    /// request the discovery of a topic or the advertisement of a local
+    /// topic, and register callbacks to detect when new topics are
+    /// discovered or topics are no longer available. A view for topics and
+    /// a view for services can share the same engine, so both kinds of
+    /// publishers are discovered through a single socket and thread. The
+    /// settings and the statistics belong to the engine.
+    template<typename Pub>
+    class Discovery
+    {
+      /// \brief Constructor. The view creates its own engine.
+      /// \param[in] _pUuid This discovery instance will run inside a
+      /// transport process. This parameter is the transport process' UUID.
+      /// \param[in] _port UDP port used for discovery traffic.
+      /// \param[in] _verbose true for enabling verbose mode.
+      public: Discovery(const std::string &_pUuid,
+                        const int _port,
+                        const bool _verbose = false)
+        : engine(std::make_shared<DiscoveryEngine>(_pUuid, _port, _verbose))
+      {
+      }
+
+      /// \brief Constructor.
+      /// \param[in] _engine Discovery engine shared with other views.
+      public: explicit Discovery(
+        const std::shared_ptr<DiscoveryEngine> &_engine)
+        : engine(_engine)
+      {
+      }
+
+      /// \brief Destructor. The engine stops when its last view is gone.
+      public: virtual ~Discovery() = default;
+
+      /// \brief Get the engine of this view.
+      /// \return The discovery engine.
+      public: std::shared_ptr<DiscoveryEngine> Engine() const
+      {
+        return this->engine;
+      }
+
+      /// \brief Start the discovery engine, if it's not running yet.
+      /// \sa DiscoveryEngine::Start.
+      public: void Start()
+      {
+        this->engine->Start();
+      }
+
+      /// \brief Advertise a new publisher.
+      /// \sa DiscoveryEngine::Advertise.
+      /// \param[in] _publisher Publisher's information to advertise.
+      /// \return True if the method succeed or false otherwise.
+      public: bool Advertise(const Pub &_publisher)
+      {
+        return this->engine->Advertise(_publisher);
+      }
+
+      /// \brief Request discovery information about a topic.
+      /// \sa DiscoveryEngine::Discover.
+      /// \param[in] _topic Topic name requested.
+      /// \return True if the method succeeded or false otherwise.
+      public: bool Discover(const std::string &_topic) const
+      {
+        return this->engine->Discover<Pub>(_topic);
+      }
+
+      /// \brief Get the discovery information.
+      /// \return Reference to the discovery information object.
+      public: const TopicStorage<Pub> &Info() const
+      {
+        return this->engine->Info<Pub>();
+      }
+
+      /// \brief Get all the publishers' information known for a given topic.
+      /// \param[in] _topic Topic name.
+      /// \param[out] _publishers Publishers requested.
+      /// \return True if the topic is found and there is at least one publisher
+      public: bool Publishers(const std::string &_topic,
+                              Addresses_M<Pub> &_publishers) const
+      {
+        return this->engine->Publishers(_topic, _publishers);
+      }
+
+      /// \brief Unadvertise a topic advertised by a node of this process.
+      /// \sa DiscoveryEngine::Unadvertise.
+      /// \param[in] _topic Topic name to be unadvertised.
+      /// \param[in] _nUuid Node UUID.
+      /// \return True if the method succeeded or false otherwise.
+      public: bool Unadvertise(const std::string &_topic,
+                               const std::string &_nUuid)
+      {
+        return this->engine->Unadvertise<Pub>(_topic, _nUuid);
+      }
+
+      /// \brief Register a callback to receive discovery connection events.
+      /// \sa DiscoveryEngine::ConnectionsCb.
+      /// \param[in] _cb Function callback.
+      public: void ConnectionsCb(const DiscoveryCallback<Pub> &_cb)
+      {
+        this->engine->ConnectionsCb(_cb);
+      }
+
+      /// \brief Register a callback to receive discovery disconnection
+      /// events.
+      /// \sa DiscoveryEngine::DisconnectionsCb.
+      /// \param[in] _cb Function callback.
+      public: void DisconnectionsCb(const DiscoveryCallback<Pub> &_cb)
+      {
+        this->engine->DisconnectionsCb(_cb);
+      }
+
+      /// \brief Get the list of topics currently advertised in the network.
+      /// \param[out] _topics List of advertised topics.
+      public: void TopicList(std::vector<std::string> &_topics) const
+      {
+        this->engine->TopicList<Pub>(_topics);
+      }
+
+      /// \sa DiscoveryEngine::HostAddr.
+      public: std::string HostAddr() const
+      {
+        return this->engine->HostAddr();
+      }
+
+      /// \sa DiscoveryEngine::AddStaticPeer.
+      public: bool AddStaticPeer(const std::string &_addr)
+      {
+        return this->engine->AddStaticPeer(_addr);
+      }
+
+      /// \sa DiscoveryEngine::SetReceiveBufferSize.
+      public: bool SetReceiveBufferSize(const int _size)
+      {
+        return this->engine->SetReceiveBufferSize(_size);
+      }
+
+      /// \sa DiscoveryEngine::ReceiveBufferSize.
+      public: int ReceiveBufferSize() const
+      {
+        return this->engine->ReceiveBufferSize();
+      }
+
+      /// \sa DiscoveryEngine::DroppedDatagrams.
+      public: uint64_t DroppedDatagrams() const
+      {
+        return this->engine->DroppedDatagrams();
+      }
+
+      /// \sa DiscoveryEngine::DroppedLocalDatagrams.
+      public: uint64_t DroppedLocalDatagrams() const
+      {
+        return this->engine->DroppedLocalDatagrams();
+      }
+
+      /// \sa DiscoveryEngine::DroppedSendDatagrams.
+      public: uint64_t DroppedSendDatagrams() const
+      {
+        return this->engine->DroppedSendDatagrams();
+      }
+
+      /// \sa DiscoveryEngine::SentDatagrams.
+      public: uint64_t SentDatagrams() const
+      {
+        return this->engine->SentDatagrams();
+      }
+
+      /// \sa DiscoveryEngine::SentBytes.
+      public: uint64_t SentBytes() const
+      {
+        return this->engine->SentBytes();
+      }
+
+      /// \sa DiscoveryEngine::ReceivedDatagrams.
+      public: uint64_t ReceivedDatagrams() const
+      {
+        return this->engine->ReceivedDatagrams();
+      }
+
+      /// \sa DiscoveryEngine::ReceivedBytes.
+      public: uint64_t ReceivedBytes() const
+      {
+        return this->engine->ReceivedBytes();
+      }
+
+      /// \sa DiscoveryEngine::SetMaxSendRate.
+      public: void SetMaxSendRate(const unsigned int _rate)
+      {
+        this->engine->SetMaxSendRate(_rate);
+      }
+
+      /// \sa DiscoveryEngine::MaxSendRate.
+      public: unsigned int MaxSendRate() const
+      {
+        return this->engine->MaxSendRate();
+      }
+
+      /// \sa DiscoveryEngine::ActivityInterval.
+      public: unsigned int ActivityInterval() const
+      {
+        return this->engine->ActivityInterval();
+      }
+
+      /// \sa DiscoveryEngine::HeartbeatInterval.
+      public: unsigned int HeartbeatInterval() const
+      {
+        return this->engine->HeartbeatInterval();
+      }
+
+      /// \sa DiscoveryEngine::SilenceInterval.
+      public: unsigned int SilenceInterval() const
+      {
+        return this->engine->SilenceInterval();
+      }
+
+      /// \sa DiscoveryEngine::SetActivityInterval.
+      public: void SetActivityInterval(const unsigned int _ms)
+      {
+        this->engine->SetActivityInterval(_ms);
+      }
+
+      /// \sa DiscoveryEngine::SetHeartbeatInterval.
+      public: void SetHeartbeatInterval(const unsigned int _ms)
+      {
+        this->engine->SetHeartbeatInterval(_ms);
+      }
+
+      /// \sa DiscoveryEngine::SetSilenceInterval.
+      public: void SetSilenceInterval(const unsigned int _ms)
+      {
+        this->engine->SetSilenceInterval(_ms);
+      }
+
+      /// \sa DiscoveryEngine::PeerDisconnected.
+      public: bool PeerDisconnected(const std::string &_pUuid)
+      {
+        return this->engine->PeerDisconnected(_pUuid);
+      }
+
+      /// \sa DiscoveryEngine::PeerDisconnected.
+      public: bool PeerDisconnected(const Uuid &_pUuid)
+      {
+        return this->engine->PeerDisconnected(_pUuid);
+      }
+
+      /// \sa DiscoveryEngine::PrintCurrentState.
+      public: void PrintCurrentState() const
+      {
+        this->engine->PrintCurrentState();
+      }
+
+      /// \sa DiscoveryEngine::WaitForInit.
+      public: void WaitForInit() const
+      {
+        this->engine->WaitForInit();
+      }
+
+      /// \brief The engine doing the work.
+      protected: std::shared_ptr<DiscoveryEngine> engine;
     };
 
     /// \def MsgDiscovery
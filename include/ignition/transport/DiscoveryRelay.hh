@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_DISCOVERYRELAY_HH_INCLUDED__
+#define __IGN_TRANSPORT_DISCOVERYRELAY_HH_INCLUDED__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    class DiscoveryRelayPrivate;
+
+    /// \class DiscoveryRelay DiscoveryRelay.hh
+    ///     ignition/transport/DiscoveryRelay.hh
+    /// \brief A relay that connects the discovery traffic of several network
+    /// segments when multicast doesn't reach all of them (different subnets,
+    /// cloud networks). Each segment runs one relay per discovery port
+    /// (topics and services share the port). A relay listens to the
+    /// multicast discovery messages of its segment and forwards them by
+    /// unicast to the other relays, which multicast them in their own
+    /// segments. The forwarded messages are flagged, so they are
+    /// never forwarded twice and every relay should know all the others.
+    ///
+    /// Processes without multicast support can use a relay as a static peer
+    /// (see Discovery::AddStaticPeer and IGN_DISCOVERY_PEERS). The relay
+    /// forwards their messages as any other message of its segment and sends
+    /// them back the traffic of all the segments.
+    class IGNITION_TRANSPORT_VISIBLE DiscoveryRelay
+    {
+      /// \brief Constructor.
+      /// \param[in] _discoveryPort UDP port of the discovery traffic relayed.
+      /// \param[in] _relayPort UDP port used for receiving the messages sent by
+      /// the other relays and by the static peers.
+      public: DiscoveryRelay(const int _discoveryPort, const int _relayPort);
+
+      /// \brief Destructor.
+      public: virtual ~DiscoveryRelay();
+
+      /// \brief Add a remote relay.
+      /// \param[in] _addr Address of the relay with the format "host:port".
+      /// \return True if the relay was added or false if the address is
+      /// invalid.
+      public: bool AddRelay(const std::string &_addr);
+
+      /// \brief Start forwarding messages.
+      /// \return True if the relay was started or false if its sockets could
+      /// not be created.
+      public: bool Start();
+
+      /// \brief Stop forwarding messages.
+      public: void Stop();
+
+      /// \brief Get the number of messages forwarded so far.
+      /// \return Number of messages forwarded.
+      public: uint64_t NumForwarded() const;
+
+      /// \brief Receive and forward the discovery messages until the relay is
+      /// stopped.
+      private: void RunForwardingTask();
+
+      /// \brief Forward a discovery message.
+      /// \param[in] _msg Message received.
+      /// \param[in] _len Length of the message in bytes.
+      /// \param[in] _fromRelaySocket True if the message was received by
+      /// unicast or false if it was received from the multicast group.
+      /// \param[in] _src Address of the sender with the format "ip:port".
+      private: void Forward(char *_msg, const size_t _len,
+                            const bool _fromRelaySocket,
+                            const std::string &_src);
+
+      /// \internal
+      /// \brief Smart pointer to private data.
+      protected: std::unique_ptr<transport::DiscoveryRelayPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_DISCOVERYRELAYPRIVATE_HH_INCLUDED__
+#define __IGN_TRANSPORT_DISCOVERYRELAYPRIVATE_HH_INCLUDED__
+
+#ifdef _WIN32
+  #include <Winsock2.h>
+#else
+  #include <netinet/in.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class DiscoveryRelayPrivate DiscoveryRelayPrivate.hh
+    ///     ignition/transport/DiscoveryRelayPrivate.hh
+    /// \brief Private data for the DiscoveryRelay class.
+    class IGNITION_TRANSPORT_VISIBLE DiscoveryRelayPrivate
+    {
+      /// \brief Constructor.
+      public: DiscoveryRelayPrivate() = default;
+
+      /// \brief Destructor.
+      public: virtual ~DiscoveryRelayPrivate() = default;
+
+      /// \brief UDP port of the discovery traffic relayed.
+      public: int discoveryPort = 0;
+
+      /// \brief UDP port for receiving the messages of the other relays and
+      /// static peers.
+      public: int relayPort = 0;
+
+      /// \brief Socket receiving the multicast traffic of our segment.
+      public: int mcastSocket = -1;
+
+      /// \brief Socket receiving the unicast traffic.
+      public: int relaySocket = -1;
+
+      /// \brief Multicast group of our segment.
+      public: sockaddr_in mcastAddr;
+
+      /// \brief Addresses of the remote relays.
+      public: std::vector<sockaddr_in> relays;
+
+      /// \brief Static peers using this relay and the time of their last
+      /// message. The key is the address with the format "ip:port".
+      public: std::map<std::string, std::pair<sockaddr_in,
+        std::chrono::steady_clock::time_point>> clients;
+
+      /// \brief Mutex to guarantee exclusive access to the relays.
+      public: std::mutex mutex;
+
+      /// \brief Thread forwarding the messages.
+      public: std::thread thread;
+
+      /// \brief True while the thread is running.
+      public: std::atomic<bool> running{false};
+
+      /// \brief Number of messages forwarded.
+      public: std::atomic<uint64_t> numForwarded{0};
+
+      /// \brief IP Address used for multicast.
+      public: const std::string kMulticastGroup = "224.0.0.7";
+
+      /// \brief Static peers are forgotten after this time without sending
+      /// any message (ms.).
+      public: const int kClientTimeout = 10000;
+
+      /// \brief Timeout used for receiving messages (ms.).
+      public: const int kTimeout = 250;
+
+      /// \brief Longest message to receive.
+      public: static const int kMaxRcvStr = 65536;
+    };
+  }
+}
+#endif
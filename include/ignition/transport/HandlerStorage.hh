@@ -18,10 +18,14 @@
 #ifndef __IGN_TRANSPORT_HANDLERSTORAGE_HH_INCLUDED__
 #define __IGN_TRANSPORT_HANDLERSTORAGE_HH_INCLUDED__
 
+#include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -36,8 +40,8 @@ namespace ignition
       /// _data is the topic name. The value is another map, where the key is
       /// the node UUID and the value is a smart pointer to the handler.
       /// \TODO: Carlos, review this names and fix them
-      using UUIDHandler_M = std::map<std::string, std::shared_ptr<T>>;
-      using UUIDHandler_Collection_M = std::map<std::string, UUIDHandler_M>;
+      using UUIDHandler_M = std::map<Uuid, std::shared_ptr<T>>;
+      using UUIDHandler_Collection_M = std::map<Uuid, UUIDHandler_M>;
 
       /// \brief key is a topic name and value is UUIDHandler_M
       using TopicServiceCalls_M =
@@ -54,8 +58,9 @@ namespace ignition
       /// request.
       /// \param[in] _topic Topic name.
       /// \param[out] _handlers Request handlers. The key of _handlers is the
-      /// topic name. The value is another map, where the key is the node
-      /// UUID and the value is a smart pointer to the handler.
+      /// node UUID. The value is another map, where the key is the handler
+      /// UUID and the value is a smart pointer to the handler. The UUIDs are
+      /// in string format.
       /// \return true if the topic contains at least one request.
       public: bool Handlers(const std::string &_topic,
         std::map<std::string,
@@ -64,7 +69,35 @@ namespace ignition
         if (this->data.find(_topic) == this->data.end())
           return false;
 
-        _handlers = this->data.at(_topic);
+        _handlers.clear();
+        for (const auto &node : this->data.at(_topic))
+        {
+          auto &m = _handlers[node.first.ToString()];
+          for (const auto &handler : node.second)
+            m[handler.first.ToString()] = handler.second;
+        }
+        return true;
+      }
+
+      /// \brief Get the data handlers for a topic, without the UUIDs that
+      /// identify them.
+      /// \param[in] _topic Topic name.
+      /// \param[out] _handlers Handlers of the topic, in the order of their
+      /// node and handler UUIDs.
+      /// \return true if the topic contains at least one handler.
+      public: bool Handlers(const std::string &_topic,
+                            std::vector<std::shared_ptr<T>> &_handlers) const
+      {
+        _handlers.clear();
+        auto it = this->data.find(_topic);
+        if (it == this->data.end())
+          return false;
+
+        for (const auto &node : it->second)
+        {
+          for (const auto &handler : node.second)
+            _handlers.push_back(handler.second);
+        }
         return true;
       }
 
@@ -138,22 +171,41 @@ namespace ignition
                            const std::string &_hUuid,
                            std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        return this->Handler(_topic, Uuid(_nUuid), Uuid(_hUuid), _handler);
+      }
+
+      /// \brief Get a specific handler.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node UUID of the handler.
+      /// \param[in] _hUuid Handler UUID.
+      /// \param[out] _handler Handler requested.
+      /// \return true if the handler was found.
+      public: bool Handler(const std::string &_topic,
+                           const Uuid &_nUuid,
+                           const Uuid &_hUuid,
+                           std::shared_ptr<T> &_handler) const
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
           return false;
 
-        auto const &m = this->data.at(_topic);
-        if (m.find(_nUuid) == m.end())
+        auto nodeIt = topicIt->second.find(_nUuid);
+        if (nodeIt == topicIt->second.end())
           return false;
 
-        if (m.at(_nUuid).find(_hUuid) == m.at(_nUuid).end())
+        auto handlerIt = nodeIt->second.find(_hUuid);
+        if (handlerIt == nodeIt->second.end())
           return false;
 
-        _handler = m.at(_nUuid).at(_hUuid);
+        _handler = handlerIt->second;
         return true;
       }
 
       /// \brief Add a request handler to a topic. A request handler stores
       /// the callback and types associated to a service call request.
+      /// The node UUID and the handler's UUID must be the string
+      /// representation of a Uuid, otherwise the handler is not stored and
+      /// an error is printed.
       /// \param[in] _topic Topic name.
       /// \param[in] _nUuid Node's unique identifier.
       /// \param[in] _handler Request handler.
@@ -161,17 +213,32 @@ namespace ignition
                               const std::string &_nUuid,
                               const std::shared_ptr<T> &_handler)
       {
-        // Create the topic entry.
-        if (this->data.find(_topic) == this->data.end())
-          this->data[_topic] = UUIDHandler_Collection_M();
+        this->AddHandler(_topic, Uuid(_nUuid), Uuid(_handler->HandlerUuid()),
+          _handler);
+      }
 
-        // Create the Node UUID entry.
-        if (this->data[_topic].find(_nUuid) == this->data[_topic].end())
-          this->data[_topic][_nUuid] = UUIDHandler_M();
+      /// \brief Add a request handler to a topic. A request handler stores
+      /// the callback and types associated to a service call request.
+      /// The handler is not stored if any of the UUIDs is nil.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node's unique identifier.
+      /// \param[in] _hUuid Handler's unique identifier.
+      /// \param[in] _handler Request handler.
+      public: void AddHandler(const std::string &_topic,
+                              const Uuid &_nUuid,
+                              const Uuid &_hUuid,
+                              const std::shared_ptr<T> &_handler)
+      {
+        if (_nUuid.IsNil() || _hUuid.IsNil())
+        {
+          std::cerr << "HandlerStorage::AddHandler() Invalid UUID for topic ["
+                    << _topic << "]" << std::endl;
+          return;
+        }
 
-        // Add/Replace the Req handler.
-        this->data[_topic][_nUuid].insert(
-          std::make_pair(_handler->HandlerUuid(), _handler));
+        // Add the Req handler. The topic and node entries are created if
+        // needed.
+        this->data[_topic][_nUuid].insert(std::make_pair(_hUuid, _handler));
       }
 
       /// \brief Return true if we have stored at least one request for the
@@ -193,11 +260,21 @@ namespace ignition
       public: bool HasHandlersForNode(const std::string &_topic,
                                       const std::string &_nUuid) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        return this->HasHandlersForNode(_topic, Uuid(_nUuid));
+      }
+
+      /// \brief Check if a node has at least one handler.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node's unique identifier.
+      /// \return true if the node has at least one handler registered.
+      public: bool HasHandlersForNode(const std::string &_topic,
+                                      const Uuid &_nUuid) const
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
           return false;
 
-        return this->data.at(_topic).find(_nUuid) !=
-               this->data.at(_topic).end();
+        return topicIt->second.find(_nUuid) != topicIt->second.end();
       }
 
       /// \brief Remove a request handler. The node's uuid is used as a key to
@@ -210,18 +287,32 @@ namespace ignition
                                  const std::string &_nUuid,
                                  const std::string &_reqUuid)
       {
-        size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
-        {
-          if (this->data[_topic].find(_nUuid) != this->data[_topic].end())
-          {
-            counter = this->data[_topic][_nUuid].erase(_reqUuid);
-            if (this->data[_topic][_nUuid].empty())
-              this->data[_topic].erase(_nUuid);
-            if (this->data[_topic].empty())
-              this->data.erase(_topic);
-          }
-        }
+        return this->RemoveHandler(_topic, Uuid(_nUuid), Uuid(_reqUuid));
+      }
+
+      /// \brief Remove a request handler. The node's uuid is used as a key to
+      /// remove the appropriate request handler.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node's unique identifier.
+      /// \param[in] _reqUuid Request's UUID to remove.
+      /// \return True when the handler is removed or false otherwise.
+      public: bool RemoveHandler(const std::string &_topic,
+                                 const Uuid &_nUuid,
+                                 const Uuid &_reqUuid)
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return false;
+
+        auto nodeIt = topicIt->second.find(_nUuid);
+        if (nodeIt == topicIt->second.end())
+          return false;
+
+        size_t counter = nodeIt->second.erase(_reqUuid);
+        if (nodeIt->second.empty())
+          topicIt->second.erase(nodeIt);
+        if (topicIt->second.empty())
+          this->data.erase(topicIt);
 
         return counter > 0;
       }
@@ -233,20 +324,30 @@ namespace ignition
       public: bool RemoveHandlersForNode(const std::string &_topic,
                                          const std::string &_nUuid)
       {
-        size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
-        {
-          counter = this->data[_topic].erase(_nUuid);
-          if (this->data[_topic].empty())
-            this->data.erase(_topic);
-        }
+        return this->RemoveHandlersForNode(_topic, Uuid(_nUuid));
+      }
+
+      /// \brief Remove all the handlers from a given node.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _nUuid Node's unique identifier.
+      /// \return True when at least one handler was removed or false otherwise.
+      public: bool RemoveHandlersForNode(const std::string &_topic,
+                                         const Uuid &_nUuid)
+      {
+        auto topicIt = this->data.find(_topic);
+        if (topicIt == this->data.end())
+          return false;
+
+        size_t counter = topicIt->second.erase(_nUuid);
+        if (topicIt->second.empty())
+          this->data.erase(topicIt);
 
         return counter > 0;
       }
 
       /// \brief Stores all the service call data for each topic. The key of
       /// _data is the topic name. The value is another map, where the key is
-      /// the node UUID and the value is a smart pointer to the handler.
+      /// the node UUID and the value is a map of handlers keyed by their UUID.
       private: TopicServiceCalls_M data;
     };
   }
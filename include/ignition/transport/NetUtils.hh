@@ -54,6 +54,17 @@ namespace ignition
     IGNITION_TRANSPORT_VISIBLE
     std::vector<std::string> determineInterfaces();
 
+    /// \brief Parse a network address with the format "host[:port]".
+    /// \param[in] _addr Address to parse. The host can be an IP address or a
+    /// hostname.
+    /// \param[in] _defaultPort Port used when the address doesn't contain one.
+    /// \param[out] _ip IP address of the host.
+    /// \param[out] _port Port.
+    /// \return True when the address is valid or false otherwise.
+    IGNITION_TRANSPORT_VISIBLE
+    bool parseAddress(const std::string &_addr, const int _defaultPort,
+      std::string &_ip, int &_port);
+
     /// \brief Determine the computer's hostname.
     /// \return The computer's hostname.
     IGNITION_TRANSPORT_VISIBLE
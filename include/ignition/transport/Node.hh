@@ -50,7 +50,10 @@
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/RequestOptions.hh"
+#include "ignition/transport/StreamWriter.hh"
 #include "ignition/transport/SubscriptionHandler.hh"
+#include "ignition/transport/TopicStatistics.hh"
 #include "ignition/transport/TopicUtils.hh"
 #include "ignition/transport/TransportTypes.hh"
 
@@ -165,7 +168,7 @@ namespace ignition
         MessagePublisher publisher(fullyQualifiedTopic,
           this->Shared()->myAddress,
           this->Shared()->myControlAddress,
-          this->Shared()->pUuid, this->NodeUuid(), _options.Scope(),
+          this->Shared()->pUuid.ToString(), this->NodeUuid(), _options.Scope(),
           _msgTypeName);
 
         if (!this->Shared()->msgDiscovery->Advertise(publisher))
@@ -429,7 +432,7 @@ namespace ignition
         ServicePublisher publisher(fullyQualifiedTopic,
           this->Shared()->myReplierAddress,
           this->Shared()->replierId.ToString(),
-          this->Shared()->pUuid, this->NodeUuid(), _options.Scope(),
+          this->Shared()->pUuid.ToString(), this->NodeUuid(), _options.Scope(),
           T1().GetTypeName(), T2().GetTypeName());
 
         if (!this->Shared()->srvDiscovery->Advertise(publisher))
@@ -443,6 +446,70 @@ namespace ignition
         return true;
       }
 
+      /// \brief Advertise a new streaming service. The response is sent as a
+      /// sequence of messages, that the requester receives as they arrive.
+      /// The callback runs in its own thread and the writer blocks while the
+      /// requester has too many messages pending to consume.
+      /// \param[in] _topic Topic name associated to the service.
+      /// \param[in] _cb Callback to handle the service request with the
+      /// following parameters:
+      ///   \param[in] _req Protobuf message containing the request.
+      ///   \param[in] _writer Writer used to send each message of the
+      ///   response. Stop writing if StreamWriter::Write() returns false.
+      ///   \param[out] _result Service call result.
+      /// \param[in] _options Advertise options.
+      /// \return true when the topic has been successfully advertised or
+      /// false otherwise.
+      /// \sa AdvertiseOptions.
+      /// \sa RequestStream.
+      public: template<typename T1, typename T2> bool AdvertiseStream(
+        const std::string &_topic,
+        std::function<void(const T1 &_req, StreamWriter<T2> &_writer,
+          bool &_result)> &_cb,
+        const AdvertiseOptions &_options = AdvertiseOptions())
+      {
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+          this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        // Create a new streaming service reply handler.
+        std::shared_ptr<StreamRepHandler<T1, T2>> repHandlerPtr(
+          new StreamRepHandler<T1, T2>());
+
+        // Insert the callback into the handler.
+        repHandlerPtr->SetCallback(_cb);
+
+        std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+        // Add the topic to the list of advertised services.
+        this->SrvsAdvertised().insert(fullyQualifiedTopic);
+
+        // Store the replier handler.
+        this->Shared()->repliers.AddHandler(
+          fullyQualifiedTopic, this->NodeUuid(), repHandlerPtr);
+
+        // Notify the discovery service to register and advertise my responser.
+        ServicePublisher publisher(fullyQualifiedTopic,
+          this->Shared()->myReplierAddress,
+          this->Shared()->replierId.ToString(),
+          this->Shared()->pUuid.ToString(), this->NodeUuid(), _options.Scope(),
+          T1().GetTypeName(), T2().GetTypeName());
+
+        if (!this->Shared()->srvDiscovery->Advertise(publisher))
+        {
+          std::cerr << "Node::AdvertiseStream(): Error advertising a service. "
+                    << "Did you forget to start the discovery service?"
+                    << std::endl;
+          return false;
+        }
+
+        return true;
+      }
+
       /// \brief Advertise a new service without input parameter.
       /// In this version the callback is a lambda function.
       /// \param[in] _topic Topic name associated to the service.
@@ -597,11 +664,13 @@ namespace ignition
       ///   \param[in] _rep Protobuf message containing the response.
       ///   \param[in] _result Result of the service call. If false, there was
       ///   a problem executing your request.
+      /// \param[in] _options Request options (e.g.: timeout).
       /// \return true when the service call was succesfully requested.
       public: template<typename T1, typename T2> bool Request(
         const std::string &_topic,
         const T1 &_req,
-        void(*_cb)(const T2 &_rep, const bool _result))
+        void(*_cb)(const T2 &_rep, const bool _result),
+        const RequestOptions &_options = RequestOptions())
       {
         std::function<void(const T2 &, const bool)> f =
           [_cb](const T2 &_internalRep, const bool _internalResult)
@@ -609,7 +678,7 @@ namespace ignition
           (*_cb)(_internalRep, _internalResult);
         };
 
-        return this->Request<T1, T2>(_topic, _req, f);
+        return this->Request<T1, T2>(_topic, _req, f, _options);
       }
 
       /// \brief Request a new service without input parameter using a
@@ -621,13 +690,15 @@ namespace ignition
       ///   \param[in] _rep Protobuf message containing the response.
       ///   \param[in] _result Result of the service call. If false, there was
       ///   a problem executing your request.
+      /// \param[in] _options Request options (e.g.: timeout).
       /// \return true when the service call was succesfully requested.
       public: template<typename T> bool Request(
         const std::string &_topic,
-        void(*_cb)(const T &_rep, const bool _result))
+        void(*_cb)(const T &_rep, const bool _result),
+        const RequestOptions &_options = RequestOptions())
       {
         msgs::Empty req;
-        return this->Request(_topic, req, _cb);
+        return this->Request(_topic, req, _cb, _options);
       }
 
       /// \brief Request a new service using a non-blocking call.
@@ -638,12 +709,17 @@ namespace ignition
       /// The callback has the following parameters:
       ///   \param[in] _rep Protobuf message containing the response.
       ///   \param[in] _result Result of the service call. If false, there was
-      ///   a problem executing your request.
+      ///   a problem executing your request. If the response doesn't arrive
+      ///   before the timeout set in '_options', the callback is executed
+      ///   with a false result.
+      /// \param[in] _options Request options (e.g.: timeout, responder
+      /// policy or hedging).
       /// \return true when the service call was succesfully requested.
       public: template<typename T1, typename T2> bool Request(
         const std::string &_topic,
         const T1 &_req,
-        std::function<void(const T2 &_rep, const bool _result)> &_cb)
+        std::function<void(const T2 &_rep, const bool _result)> &_cb,
+        const RequestOptions &_options = RequestOptions())
       {
         std::string fullyQualifiedTopic;
         if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
@@ -684,31 +760,30 @@ namespace ignition
         // Insert the callback into the handler.
         reqHandlerPtr->SetCallback(_cb);
 
+        // Set the policy for choosing a responder.
+        reqHandlerPtr->Policy(_options.Policy());
+        reqHandlerPtr->Hedge(_options.Hedge(), _options.HedgeDelay());
+
         {
           std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
           // Store the request handler.
-          this->Shared()->requests.AddHandler(
-            fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+          this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
 
-          // If the responser's address is known, make the request.
-          SrvAddresses_M addresses;
-          if (this->Shared()->srvDiscovery->Publishers(
-            fullyQualifiedTopic, addresses))
-          {
-            this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
-              T1().GetTypeName(), T2().GetTypeName());
-          }
-          else
+          // Discard the request if the response doesn't arrive on time.
+          this->Shared()->AddRequestTimeout(fullyQualifiedTopic, reqHandlerPtr,
+            _options.Timeout());
+
+          // If a responser is known, make the request. Otherwise, discover
+          // the service responser.
+          if (!this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+                T1().GetTypeName(), T2().GetTypeName()) &&
+              !this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
           {
-            // Discover the service responser.
-            if (!this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
-            {
-              std::cerr << "Node::Request(): Error discovering a service. "
-                        << "Did you forget to start the discovery service?"
-                        << std::endl;
-              return false;
-            }
+            std::cerr << "Node::Request(): Error discovering a service. "
+                      << "Did you forget to start the discovery service?"
+                      << std::endl;
+            return false;
           }
         }
 
@@ -724,13 +799,15 @@ namespace ignition
       ///   \param[in] _rep Protobuf message containing the response.
       ///   \param[in] _result Result of the service call. If false, there was
       ///   a problem executing your request.
+      /// \param[in] _options Request options (e.g.: timeout).
       /// \return true when the service call was succesfully requested.
       public: template<typename T> bool Request(
         const std::string &_topic,
-        std::function<void(const T &_rep, const bool _result)> &_cb)
+        std::function<void(const T &_rep, const bool _result)> &_cb,
+        const RequestOptions &_options = RequestOptions())
       {
         msgs::Empty req;
-        return this->Request(_topic, req, _cb);
+        return this->Request(_topic, req, _cb, _options);
       }
 
       /// \brief Request a new service using a non-blocking call.
@@ -743,12 +820,14 @@ namespace ignition
       ///   \param[in] _result Result of the service call. If false, there was
       ///   a problem executing your request.
       /// \param[in] _obj Instance containing the member function.
+      /// \param[in] _options Request options (e.g.: timeout).
       /// \return true when the service call was succesfully requested.
       public: template<typename C, typename T1, typename T2> bool Request(
         const std::string &_topic,
         const T1 &_req,
         void(C::*_cb)(const T2 &_rep, const bool _result),
-        C *_obj)
+        C *_obj,
+        const RequestOptions &_options = RequestOptions())
       {
         std::function<void(const T2 &, const bool)> f =
           [_cb, _obj](const T2 &_internalRep, const bool _internalResult)
@@ -758,7 +837,7 @@ namespace ignition
           cb(_internalRep, _internalResult);
         };
 
-        return this->Request<T1, T2>(_topic, _req, f);
+        return this->Request<T1, T2>(_topic, _req, f, _options);
       }
 
       /// \brief Request a new service without input parameter using a
@@ -771,14 +850,16 @@ namespace ignition
       ///   \param[in] _result Result of the service call. If false, there was
       ///   a problem executing your request.
       /// \param[in] _obj Instance containing the member function.
+      /// \param[in] _options Request options (e.g.: timeout).
       /// \return true when the service call was succesfully requested.
       public: template<typename C, typename T> bool Request(
         const std::string &_topic,
         void(C::*_cb)(const T &_rep, const bool _result),
-        C *_obj)
+        C *_obj,
+        const RequestOptions &_options = RequestOptions())
       {
         msgs::Empty req;
-        return this->Request(_topic, req, _cb, _obj);
+        return this->Request(_topic, req, _cb, _obj, _options);
       }
 
       /// \brief Request a new service using a blocking call.
@@ -824,27 +905,18 @@ namespace ignition
         }
 
         // Store the request handler.
-        this->Shared()->requests.AddHandler(
-          fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+        this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
 
-        // If the responser's address is known, make the request.
-        SrvAddresses_M addresses;
-        if (this->Shared()->srvDiscovery->Publishers(
-          fullyQualifiedTopic, addresses))
-        {
-          this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
-            T1().GetTypeName(), T2().GetTypeName());
-        }
-        else
+        // If a responser is known, make the request. Otherwise, discover
+        // the service responser.
+        if (!this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+              T1().GetTypeName(), T2().GetTypeName()) &&
+            !this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
         {
-          // Discover the service responser.
-          if (!this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
-          {
-            std::cerr << "Node::Request(): Error discovering a service. "
-                      << "Did you forget to start the discovery service?"
-                      << std::endl;
-            return false;
-          }
+          std::cerr << "Node::Request(): Error discovering a service. "
+                    << "Did you forget to start the discovery service?"
+                    << std::endl;
+          return false;
         }
 
         // Wait until the REP is available.
@@ -852,7 +924,11 @@ namespace ignition
 
         // The request was not executed.
         if (!executed)
+        {
+          // Nobody is going to wait for this response anymore.
+          this->Shared()->RemoveRequest(fullyQualifiedTopic, reqHandlerPtr);
           return false;
+        }
 
         // The request was executed but did not succeed.
         if (!reqHandlerPtr->Result())
@@ -892,12 +968,320 @@ namespace ignition
         return this->Request(_topic, req, _timeout, _rep, _result);
       }
 
+      /// \brief Request a batch of services using a non-blocking call. All
+      /// the requests are sent together to the same responser, that runs
+      /// them and returns all the responses together.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _reqs Protobuf messages containing the parameters of
+      /// each request.
+      /// \param[in] _cb Lambda function executed when the responses arrive.
+      /// The callback has the following parameters:
+      ///   \param[in] _reps Protobuf messages containing the responses (one
+      ///   per request, in the same order).
+      ///   \param[in] _results Result of each service call. If false, there
+      ///   was a problem executing that request. If the responses don't
+      ///   arrive before the timeout set in '_options', the callback is
+      ///   executed with all the results set to false.
+      /// \param[in] _options Request options (e.g.: timeout or responder
+      /// policy).
+      /// \return true when the batch was succesfully requested.
+      public: template<typename T1, typename T2> bool RequestBatch(
+        const std::string &_topic,
+        const std::vector<T1> &_reqs,
+        std::function<void(const std::vector<T2> &_reps,
+          const std::vector<bool> &_results)> &_cb,
+        const RequestOptions &_options = RequestOptions())
+      {
+        if (_reqs.empty())
+        {
+          std::cerr << "Node::RequestBatch(): Empty batch of requests"
+                    << std::endl;
+          return false;
+        }
+
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+          this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        bool localResponserFound;
+        IRepHandlerPtr repHandler;
+        {
+          std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+          localResponserFound = this->Shared()->repliers.FirstHandler(
+            fullyQualifiedTopic, T1().GetTypeName(), T2().GetTypeName(),
+              repHandler);
+        }
+
+        // If the responser is within my process.
+        if (localResponserFound)
+        {
+          // There is a responser in my process, let's use it.
+          std::vector<T2> reps(_reqs.size());
+          std::vector<bool> results(_reqs.size());
+          for (size_t i = 0; i < _reqs.size(); ++i)
+          {
+            bool result;
+            repHandler->RunLocalCallback(_reqs[i], reps[i], result);
+            results[i] = result;
+          }
+
+          _cb(reps, results);
+          return true;
+        }
+
+        // Create a new request handler.
+        std::shared_ptr<BatchReqHandler<T1, T2>> reqHandlerPtr(
+          new BatchReqHandler<T1, T2>(this->NodeUuid()));
+
+        // Insert the requests' parameters.
+        reqHandlerPtr->SetMessages(_reqs);
+
+        // Insert the callback into the handler.
+        reqHandlerPtr->SetCallback(_cb);
+
+        // Set the policy for choosing a responder.
+        reqHandlerPtr->Policy(_options.Policy());
+        reqHandlerPtr->Hedge(_options.Hedge(), _options.HedgeDelay());
+
+        {
+          std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+          // Store the request handler.
+          this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
+
+          // Discard the request if the responses don't arrive on time.
+          this->Shared()->AddRequestTimeout(fullyQualifiedTopic, reqHandlerPtr,
+            _options.Timeout());
+
+          // If a responser is known, make the request. Otherwise, discover
+          // the service responser.
+          if (!this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+                T1().GetTypeName(), T2().GetTypeName()) &&
+              !this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
+          {
+            std::cerr << "Node::RequestBatch(): Error discovering a service."
+                      << " Did you forget to start the discovery service?"
+                      << std::endl;
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      /// \brief Request a batch of services using a blocking call. All the
+      /// requests are sent together to the same responser.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _reqs Protobuf messages containing the parameters of
+      /// each request.
+      /// \param[in] _timeout The batch will timeout after '_timeout' ms.
+      /// \param[out] _reps Protobuf messages containing the responses (one
+      /// per request, in the same order).
+      /// \param[out] _results Result of each service call.
+      /// \return true when the batch was executed or false if the timeout
+      /// expired.
+      public: template<typename T1, typename T2> bool RequestBatch(
+        const std::string &_topic,
+        const std::vector<T1> &_reqs,
+        const unsigned int &_timeout,
+        std::vector<T2> &_reps,
+        std::vector<bool> &_results)
+      {
+        if (_reqs.empty())
+        {
+          std::cerr << "Node::RequestBatch(): Empty batch of requests"
+                    << std::endl;
+          return false;
+        }
+
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+          this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        // Create a new request handler.
+        std::shared_ptr<BatchReqHandler<T1, T2>> reqHandlerPtr(
+          new BatchReqHandler<T1, T2>(this->NodeUuid()));
+
+        // Insert the requests' parameters.
+        reqHandlerPtr->SetMessages(_reqs);
+
+        std::unique_lock<std::recursive_mutex> lk(this->Shared()->mutex);
+
+        // If the responser is within my process.
+        IRepHandlerPtr repHandler;
+        if (this->Shared()->repliers.FirstHandler(fullyQualifiedTopic,
+          T1().GetTypeName(), T2().GetTypeName(), repHandler))
+        {
+          // There is a responser in my process, let's use it.
+          _reps.assign(_reqs.size(), T2());
+          _results.assign(_reqs.size(), false);
+          for (size_t i = 0; i < _reqs.size(); ++i)
+          {
+            bool result;
+            repHandler->RunLocalCallback(_reqs[i], _reps[i], result);
+            _results[i] = result;
+          }
+          return true;
+        }
+
+        // Store the request handler.
+        this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
+
+        // If a responser is known, make the request. Otherwise, discover
+        // the service responser.
+        if (!this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+              T1().GetTypeName(), T2().GetTypeName()) &&
+            !this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
+        {
+          std::cerr << "Node::RequestBatch(): Error discovering a service. "
+                    << "Did you forget to start the discovery service?"
+                    << std::endl;
+          return false;
+        }
+
+        // Wait until the REPs are available.
+        bool executed = reqHandlerPtr->WaitUntil(lk, _timeout);
+
+        // The batch was not executed.
+        if (!executed)
+        {
+          // Nobody is going to wait for these responses anymore.
+          this->Shared()->RemoveRequest(fullyQualifiedTopic, reqHandlerPtr);
+          return false;
+        }
+
+        _reps = reqHandlerPtr->Responses();
+        _results = reqHandlerPtr->Results();
+        return true;
+      }
+
+      /// \brief Request a streaming service using a non-blocking call. The
+      /// callback is executed for each message of the response as it arrives.
+      /// The responser doesn't send more than RequestOptions::StreamWindow()
+      /// messages ahead of the ones already consumed.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _req Protobuf message containing the request's parameters.
+      /// \param[in] _cb Lambda function executed when each message arrives.
+      /// The callback has the following parameters:
+      ///   \param[in] _rep Protobuf message containing a part of the
+      ///   response.
+      ///   \param[in] _result Result of the service call. If false, there was
+      ///   a problem executing your request.
+      ///   \param[in] _last True for the final call of the response. A
+      ///   streaming service closes the stream with an empty message that
+      ///   carries the result. If the stream doesn't finish before the
+      ///   timeout set in '_options', the callback is executed with a false
+      ///   result and '_last' set.
+      /// \param[in] _options Request options (e.g.: timeout, responder
+      /// policy or stream window). The timeout covers the whole stream.
+      /// \return true when the service call was succesfully requested.
+      /// \sa AdvertiseStream.
+      public: template<typename T1, typename T2> bool RequestStream(
+        const std::string &_topic,
+        const T1 &_req,
+        std::function<void(const T2 &_rep, const bool _result,
+          const bool _last)> &_cb,
+        const RequestOptions &_options = RequestOptions())
+      {
+        std::string fullyQualifiedTopic;
+        if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+          this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+        {
+          std::cerr << "Service [" << _topic << "] is not valid." << std::endl;
+          return false;
+        }
+
+        bool localResponserFound;
+        IRepHandlerPtr repHandler;
+        {
+          std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+          localResponserFound = this->Shared()->repliers.FirstHandler(
+            fullyQualifiedTopic, T1().GetTypeName(), T2().GetTypeName(),
+              repHandler);
+        }
+
+        // If the responser is within my process.
+        if (localResponserFound)
+        {
+          // There is a responser in my process, let's use it. Each message is
+          // delivered synchronously, so there is no need for flow control.
+          std::string data;
+          if (!_req.SerializeToString(&data))
+          {
+            std::cerr << "Node::RequestStream(): Error serializing the request"
+                      << std::endl;
+            return false;
+          }
+
+          bool result;
+          repHandler->RunStreamCallback(data,
+            [&_cb](const std::string &_chunk, const bool _last,
+                   const bool _result)
+            {
+              T2 rep;
+              rep.ParseFromString(_chunk);
+              _cb(rep, _result, _last);
+              return true;
+            }, result);
+          return true;
+        }
+
+        // Create a new request handler.
+        std::shared_ptr<StreamReqHandler<T1, T2>> reqHandlerPtr(
+          new StreamReqHandler<T1, T2>(this->NodeUuid()));
+
+        // Insert the request's parameters.
+        reqHandlerPtr->SetMessage(_req);
+        reqHandlerPtr->SetWindow(_options.StreamWindow());
+
+        // Insert the callback into the handler.
+        reqHandlerPtr->SetCallback(_cb);
+
+        // Set the policy for choosing a responder. Streams are never hedged.
+        reqHandlerPtr->Policy(_options.Policy());
+
+        {
+          std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+          // Store the request handler.
+          this->Shared()->AddRequest(fullyQualifiedTopic, reqHandlerPtr);
+
+          // Discard the request if the stream doesn't finish on time.
+          this->Shared()->AddRequestTimeout(fullyQualifiedTopic, reqHandlerPtr,
+            _options.Timeout());
+
+          // If a responser is known, make the request. Otherwise, discover
+          // the service responser.
+          if (!this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+                T1().GetTypeName(), T2().GetTypeName()) &&
+              !this->Shared()->srvDiscovery->Discover(fullyQualifiedTopic))
+          {
+            std::cerr << "Node::RequestStream(): Error discovering a "
+                      << "service. Did you forget to start the discovery "
+                      << "service?" << std::endl;
+            return false;
+          }
+        }
+
+        return true;
+      }
+
       /// \brief Request a new service without waiting for response.
       /// \param[in] _topic Topic requested.
       /// \param[in] _req Protobuf message containing the request's parameters.
+      /// \param[in] _options Request options. The timeout sets how long the
+      /// request is kept while no responser is available.
       /// \return true when the service call was succesfully requested.
       public: template<typename T> bool Request(const std::string &_topic,
-                                                const T &_req)
+        const T &_req, const RequestOptions &_options = RequestOptions())
         {
           // This callback is here for reusing the regular Request() call with
           // input and output parameters.
@@ -906,7 +1290,8 @@ namespace ignition
           {
           };
 
-          return this->Request<T, ignition::msgs::Empty>(_topic, _req, f);
+          return this->Request<T, ignition::msgs::Empty>(_topic, _req, f,
+            _options);
         }
 
       /// \brief Unadvertise a service.
@@ -929,6 +1314,18 @@ namespace ignition
       public: bool TopicInfo(const std::string &_topic,
                              std::vector<MessagePublisher> &_publishers) const;
 
+      /// \brief Get the statistics of a topic in this process: messages and
+      /// bytes sent and received, drops, latency before the callbacks and
+      /// duration of the callbacks. The counters are shared by all the nodes
+      /// of the process.
+      /// \param[in] _topic Name of the topic.
+      /// \param[out] _stats Statistics of the topic.
+      /// \return False if the topic is invalid or it hasn't been used in this
+      /// process.
+      /// \sa TopicStatistics
+      public: bool TopicStatistics(const std::string &_topic,
+                                   transport::TopicStatistics &_stats) const;
+
       /// \brief Get the list of topics currently advertised in the network.
       /// Note that this function can block for some time if the
       /// discovery is in its initialization phase.
@@ -101,6 +101,64 @@ namespace ignition
       /// \sa Partition
       public: bool SetPartition(const std::string &_partition);
 
+      /// \brief Get the heartbeat interval requested by this node.
+      /// \return The interval in milliseconds or 0 if the node doesn't
+      /// request any specific value.
+      /// \sa SetHeartbeatInterval.
+      public: unsigned int HeartbeatInterval() const;
+
+      /// \brief Set the interval between the discovery heartbeats sent by
+      /// this process. The discovery layer is shared by all the nodes of the
+      /// process, so the shortest interval requested by any node is used.
+      /// All the processes in a partition should use compatible values: the
+      /// heartbeat interval has to be shorter than the silence interval of
+      /// the remote processes.
+      /// \param[in] _ms The interval in milliseconds.
+      /// \return True when operation succeed or false if the interval was
+      /// invalid (zero).
+      /// \sa HeartbeatInterval.
+      public: bool SetHeartbeatInterval(const unsigned int _ms);
+
+      /// \brief Get the silence interval requested by this node.
+      /// \return The interval in milliseconds or 0 if the node doesn't
+      /// request any specific value.
+      /// \sa SetSilenceInterval.
+      public: unsigned int SilenceInterval() const;
+
+      /// \brief Set the maximum time allowed without receiving any discovery
+      /// information from a remote process before considering it gone. The
+      /// discovery layer is shared by all the nodes of the process, so the
+      /// shortest interval requested by any node is used. Note that a remote
+      /// process that closes its connections (e.g.: it crashed) is detected
+      /// immediately, without waiting for the silence interval.
+      /// \param[in] _ms The interval in milliseconds.
+      /// \return True when operation succeed or false if the interval was
+      /// invalid (zero).
+      /// \sa SilenceInterval.
+      public: bool SetSilenceInterval(const unsigned int _ms);
+
+      /// \brief Get the statistics interval requested by this node.
+      /// \return The interval in milliseconds or 0 if the statistics are not
+      /// published.
+      /// \sa SetStatisticsInterval.
+      public: unsigned int StatisticsInterval() const;
+
+      /// \brief Enable the periodic publication of the statistics of this
+      /// process. A compact report (msgs::StringMsg) is published on the
+      /// topic "/ign/transport/statistics" of the node's partition with the
+      /// rates, bandwidth and drops of each active topic, the depth of the
+      /// service call queues and the utilization of the reception thread.
+      /// The statistics are shared by all the nodes of the process, so the
+      /// shortest interval requested by any node is used and the partition
+      /// of the first node requesting them is kept.
+      /// It's also possible to use the environment variable IGN_STATISTICS
+      /// for setting the interval in milliseconds.
+      /// \param[in] _ms The interval in milliseconds.
+      /// \return True when operation succeed or false if the interval was
+      /// invalid (zero).
+      /// \sa StatisticsInterval.
+      public: bool SetStatisticsInterval(const unsigned int _ms);
+
       /// \internal
       /// \brief Smart pointer to private data.
       protected: std::unique_ptr<transport::NodeOptionsPrivate> dataPtr;
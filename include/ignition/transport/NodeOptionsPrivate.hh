@@ -43,6 +43,15 @@ namespace ignition
 
       /// \brief Partition for this node.
       public: std::string partition = hostname() + ":" + username();
+
+      /// \brief Heartbeat interval requested (ms.). 0 means default.
+      public: unsigned int heartbeatInterval = 0;
+
+      /// \brief Silence interval requested (ms.). 0 means default.
+      public: unsigned int silenceInterval = 0;
+
+      /// \brief Statistics interval requested (ms.). 0 means disabled.
+      public: unsigned int statisticsInterval = 0;
     };
   }
 }
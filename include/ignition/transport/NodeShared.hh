@@ -27,10 +27,16 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include "ignition/transport/Discovery.hh"
@@ -39,6 +45,10 @@
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/RequestOptions.hh"
+#include "ignition/transport/SrvRequestQueue.hh"
+#include "ignition/transport/TimerWheel.hh"
+#include "ignition/transport/TopicStatistics.hh"
 #include "ignition/transport/TopicStorage.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
@@ -47,6 +57,9 @@ namespace ignition
 {
   namespace transport
   {
+    class Node;
+    class TopicCounters;
+
     /// \class NodeShared NodeShared.hh ignition/transport/NodeShared.hh
     /// \brief Private data for the Node class. This class should not be
     /// directly used. You should use the Node class.
@@ -87,10 +100,112 @@ namespace ignition
       /// \param[in] _topic Topic name.
       /// \param[in] _reqType Type of the request in string format.
       /// \param[in] _repType Type of the response in string format.
-      public: void SendPendingRemoteReqs(const std::string &_topic,
+      /// \return True if a responder is known for the service or false if
+      /// it has to be discovered.
+      public: bool SendPendingRemoteReqs(const std::string &_topic,
                                          const std::string &_reqType,
                                          const std::string &_repType);
 
+      /// \brief Register a new service call request pending to be sent.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler Request handler.
+      public: void AddRequest(const std::string &_topic,
+                              const IReqHandlerPtr &_handler);
+
+      /// \brief Remove a pending service call request. The request won't
+      /// count anymore as outstanding for its responder.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler Request handler to remove.
+      /// \return True if the request was pending or false otherwise.
+      public: bool RemoveRequest(const std::string &_topic,
+                                 const IReqHandlerPtr &_handler);
+
+      /// \brief Get the number of service call requests sent to a responder
+      /// that are still waiting for a response.
+      /// \param[in] _responderId Socket identity of the responder.
+      /// \return The number of outstanding requests.
+      public: unsigned int OutstandingRequests(
+        const std::string &_responderId);
+
+      /// \brief Schedule the expiration of a pending service call request.
+      /// If the response hasn't arrived after '_timeout' milliseconds, the
+      /// request handler is removed and notified with a false result.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler Pending request handler.
+      /// \param[in] _timeout Timeout in milliseconds. A value of 0 means that
+      /// the request never expires.
+      public: void AddRequestTimeout(const std::string &_topic,
+                                     const IReqHandlerPtr &_handler,
+                                     const unsigned int _timeout);
+
+      /// \brief Remove all the pending service call requests whose timeout
+      /// has expired and notify their handlers.
+      public: void ExpireRequests();
+
+      /// \brief Get the number of service call requests that expired without
+      /// receiving a response since the process started.
+      /// \return The number of expired requests.
+      public: uint64_t ExpiredRequests() const;
+
+      /// \brief Send a second copy of the pending service call requests
+      /// with hedging enabled whose hedging delay has expired. The copy is
+      /// sent to a different responder and the first response wins.
+      public: void HedgeRequests();
+
+      /// \brief Get the number of hedged service call requests (requests sent
+      /// to a second responder) since the process started.
+      /// \return The number of hedged requests.
+      public: uint64_t HedgedRequests() const;
+
+      /// \brief Get the number of service call requests re-sent to another
+      /// responder because their responder was gone, since the process
+      /// started.
+      /// \return The number of re-routed requests.
+      public: uint64_t ReroutedRequests() const;
+
+      /// \brief Get the 95th percentile of the latency observed in the last
+      /// responses of a service.
+      /// \param[in] _topic Service name.
+      /// \param[out] _latency The 95th percentile latency in milliseconds.
+      /// \return True if there are latency samples for the service or false
+      /// otherwise.
+      public: bool LatencyP95(const std::string &_topic,
+                              unsigned int &_latency);
+
+      /// \brief Get the activity counters of a topic, creating them if
+      /// needed.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The counters.
+      public: std::shared_ptr<TopicCounters> Counters(
+                const std::string &_topic);
+
+      /// \brief Get the statistics of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[out] _stats Statistics of the topic.
+      /// \return True if the topic has been used in this process or false
+      /// otherwise.
+      public: bool TopicStats(const std::string &_topic,
+                              TopicStatistics &_stats);
+
+      /// \brief Request new heartbeat and silence intervals for the
+      /// discovery services of this process. The discovery is shared by all
+      /// the nodes, so the shortest interval requested so far is used.
+      /// \param[in] _heartbeat Heartbeat interval (ms.) or 0 for keeping
+      /// the current value.
+      /// \param[in] _silence Silence interval (ms.) or 0 for keeping the
+      /// current value.
+      public: void SetDiscoveryIntervals(const unsigned int _heartbeat,
+                                         const unsigned int _silence);
+
+      /// \brief Start publishing the statistics of this process
+      /// periodically. The statistics are shared by all the nodes, so the
+      /// shortest interval requested so far is used and the partition of the
+      /// first request is kept.
+      /// \param[in] _partition Partition where the statistics are published.
+      /// \param[in] _interval Publication interval (ms.).
+      public: void EnableStatistics(const std::string &_partition,
+                                    const unsigned int _interval);
+
       /// \brief Callback executed when the discovery detects new topics.
       /// \param[in] _pub Information of the publisher in charge of the topic.
       public: void OnNewConnection(const MessagePublisher &_pub);
@@ -116,6 +231,254 @@ namespace ignition
       /// \brief Timeout used for receiving messages (ms.).
       public: static const int Timeout = 250;
 
+      /// \brief Resolution of the service call request timers (ms.).
+      public: static const unsigned int RequestTimerResolution = 50;
+
+      /// \brief Hedging delay used when there are no latency samples of a
+      /// service (ms.).
+      public: static const unsigned int DefaultHedgeDelay = 100;
+
+      /// \brief Number of latency samples kept per service.
+      public: static const size_t MaxLatencySamples = 128;
+
+      /// \brief Number of completed request UUIDs remembered for discarding
+      /// duplicated responses.
+      public: static const size_t MaxCompletedRequests = 1024;
+
+      /// \brief Maximum time that a streaming service waits for new credits
+      /// before cancelling the stream (ms.).
+      public: static const unsigned int StreamCreditTimeout = 10000;
+
+      /// \brief Maximum number of streaming responses served concurrently.
+      /// Additional streaming requests fail immediately.
+      public: static const size_t MaxStreams = 64;
+
+      /// \brief Identifies a pending service call request with an associated
+      /// timer (timeout or hedging).
+      public: struct RequestTimer
+      {
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief UUID of the node that made the request.
+        Uuid nUuid;
+
+        /// \brief UUID of the request handler.
+        Uuid hUuid;
+      };
+
+      /// \brief A service call request sent to a remote responder and
+      /// waiting for its response.
+      public: struct SentRequest
+      {
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief UUID of the responder's node.
+        Uuid responderNUuid;
+
+        /// \brief Request handler.
+        IReqHandlerPtr handler;
+      };
+
+      /// \brief State of a streaming response being sent by this process.
+      public: struct SrvStream
+      {
+        /// \brief Service name.
+        std::string topic;
+
+        /// \brief Address of the requester.
+        std::string sender;
+
+        /// \brief Socket identity of the requester's response receiver.
+        std::string dstId;
+
+        /// \brief UUID of the node that made the request.
+        Uuid nodeUuid;
+
+        /// \brief UUID of the request.
+        Uuid reqUuid;
+
+        /// \brief Number of chunks that can be sent without waiting.
+        uint64_t credits = 0;
+
+        /// \brief Sequence number of the next chunk.
+        uint64_t seq = 0;
+
+        /// \brief True when the stream has been cancelled.
+        bool cancelled = false;
+      };
+
+      /// \brief Start monitoring the TCP connections of a socket. The
+      /// disconnection events are received through a monitor socket.
+      /// \param[in] _socket Socket to monitor.
+      /// \param[in] _monitor Socket that will receive the events.
+      /// \param[in] _name Name used for the inproc endpoint of the monitor.
+      /// \return True if the monitor was started or false otherwise.
+      private: bool StartMonitor(zmq::socket_t &_socket,
+                                 zmq::socket_t &_monitor,
+                                 const std::string &_name);
+
+      /// \brief Receive an event from a socket monitor. When the connection
+      /// with a remote process is lost, the process is declared gone in the
+      /// discovery without waiting for its silence interval.
+      /// \param[in] _monitor Monitor socket with a pending event.
+      private: void RecvMonitorEvent(zmq::socket_t &_monitor);
+
+      /// \brief Choose one responder among all the candidates offering a
+      /// service.
+      /// \param[in] _topic Service name.
+      /// \param[in] _responders Candidates. Should not be empty.
+      /// \param[in] _policy Policy used for choosing the responder.
+      /// \return The index of the responder chosen within _responders.
+      private: size_t SelectResponder(const std::string &_topic,
+        const std::vector<ServicePublisher> &_responders,
+        const ResponderPolicy_t _policy);
+
+      /// \brief Populate the cache of responders of a service from the
+      /// discovery information when it's empty.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request in string format.
+      /// \param[in] _repType Type of the response in string format.
+      /// \param[in, out] _queue Queue containing the cache of responders.
+      private: void UpdateResponders(const std::string &_topic,
+                                     const std::string &_reqType,
+                                     const std::string &_repType,
+                                     SrvRequestQueue &_queue);
+
+      /// \brief Re-send to another responder (or fail) the pending requests
+      /// sent to a responder that is gone.
+      /// \param[in] _pUuid Process UUID of the responder.
+      /// \param[in] _topic Service name no longer offered or empty if the
+      /// whole process is gone.
+      /// \param[in] _nUuid UUID of the node that stopped offering the
+      /// service (ignored if _topic is empty).
+      /// \param[out] _failed Requests that couldn't be re-routed. They're
+      /// already removed and should be notified with a false result.
+      private: void FailOverRequests(const Uuid &_pUuid,
+                                     const std::string &_topic,
+                                     const Uuid &_nUuid,
+                                     std::vector<IReqHandlerPtr> &_failed);
+
+      /// \brief Remember the UUID of a completed request, so duplicated
+      /// responses are discarded silently.
+      /// \param[in] _reqUuid Request UUID.
+      private: void AddCompletedRequest(const Uuid &_reqUuid);
+
+      /// \brief Send a service call request to a responder, connecting to
+      /// it if needed.
+      /// \param[in] _topic Service name.
+      /// \param[in] _responder Responder that will receive the request.
+      /// \param[in] _handler Request handler.
+      /// \param[in] _data Serialized request.
+      /// \return True if the request was sent or false otherwise.
+      private: bool SendRequest(const std::string &_topic,
+                                const ServicePublisher &_responder,
+                                const IReqHandlerPtr &_handler,
+                                const std::string &_data);
+
+      /// \brief Send the frames of a service call request (or a flow
+      /// control message of a stream) through the requester socket.
+      /// \param[in] _responderId Socket identity of the responder.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nodeUuid UUID of the node making the request.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _data Serialized request.
+      /// \param[in] _reqType Type of the request in string format.
+      /// \param[in] _repType Type of the response in string format.
+      /// \param[in] _kind Kind of request (e.g.: SingleRequest).
+      /// \return True if the frames were sent or false otherwise.
+      private: bool SendRequestFrames(const std::string &_responderId,
+                                      const std::string &_topic,
+                                      const Uuid &_nodeUuid,
+                                      const Uuid &_reqUuid,
+                                      const std::string &_data,
+                                      const std::string &_reqType,
+                                      const std::string &_repType,
+                                      const uint8_t _kind);
+
+      /// \brief Send a service call response through the replier socket,
+      /// connecting to the requester if needed.
+      /// \param[in] _sender Address of the requester.
+      /// \param[in] _dstId Socket identity of the requester's response
+      /// receiver.
+      /// \param[in] _topic Service name.
+      /// \param[in] _nodeUuid UUID of the node that made the request.
+      /// \param[in] _reqUuid UUID of the request.
+      /// \param[in] _rep Serialized response.
+      /// \param[in] _resultStr Result of the service call.
+      /// \param[in] _streamInfo Sequence number and last chunk flag of a
+      /// streaming response ("seq:last") or empty for regular responses.
+      /// \return True if the response was sent or false otherwise.
+      private: bool SendResponse(const std::string &_sender,
+                                 const std::string &_dstId,
+                                 const std::string &_topic,
+                                 const Uuid &_nodeUuid,
+                                 const Uuid &_reqUuid,
+                                 const std::string &_rep,
+                                 const std::string &_resultStr,
+                                 const std::string &_streamInfo);
+
+      /// \brief Send a flow control message (credits or cancellation) to the
+      /// responder of a streaming request.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler Streaming request handler.
+      /// \param[in] _kind StreamCredit or StreamCancel.
+      /// \param[in] _data Number of credits granted (StreamCredit).
+      /// \return True if the message was sent or false otherwise.
+      private: bool SendStreamControl(const std::string &_topic,
+                                      const IReqHandlerPtr &_handler,
+                                      const uint8_t _kind,
+                                      const std::string &_data);
+
+      /// \brief Start serving a streaming request in a separate thread.
+      /// \param[in] _handler Replier handler.
+      /// \param[in] _stream State of the new stream.
+      /// \param[in] _data Serialized request along with the initial credits.
+      private: void StartStream(const IRepHandlerPtr &_handler,
+                                const std::shared_ptr<SrvStream> &_stream,
+                                const std::string &_data);
+
+      /// \brief Run the callback of a streaming service. This function runs
+      /// in its own thread, so waiting for credits doesn't block the
+      /// reception thread.
+      /// \param[in] _handler Replier handler.
+      /// \param[in] _stream State of the stream.
+      /// \param[in] _req Serialized request.
+      private: void RunStream(IRepHandlerPtr _handler,
+                              std::shared_ptr<SrvStream> _stream,
+                              std::string _req);
+
+      /// \brief Join the threads of the streaming services already finished.
+      /// This function shouldn't be called while holding the mutex.
+      private: void JoinFinishedStreams();
+
+      /// \brief Send a chunk of a streaming response, waiting for credits if
+      /// needed.
+      /// \param[in, out] _stream State of the stream.
+      /// \param[in] _chunk Serialized chunk.
+      /// \param[in] _last True if this is the final chunk.
+      /// \param[in] _result Result of the service call.
+      /// \return True if the chunk was sent or false if the stream has been
+      /// cancelled.
+      private: bool SendStreamChunk(SrvStream &_stream,
+                                    const std::string &_chunk,
+                                    const bool _last,
+                                    const bool _result);
+
+      /// \brief Publish the statistics of this process if they are enabled
+      /// and the statistics interval has elapsed. This function runs in the
+      /// reception thread.
+      private: void PublishStatistics();
+
+      /// \brief Create the statistics report of the last period. Only the
+      /// topics with some activity during the period are included.
+      /// The caller should hold the mutex.
+      /// \param[in] _period Duration of the period (nanoseconds).
+      /// \return The report: one line for the process followed by one line
+      /// per topic, each line composed of "key=value" fields.
+      private: std::string StatisticsReport(const int64_t _period);
+
       //////////////////////////////////////////////////
       /////// Declare here other member variables //////
       //////////////////////////////////////////////////
@@ -126,8 +489,8 @@ namespace ignition
       /// \brief Replier socket identity.
       public: Uuid replierId;
 
-      /// \brief Process UUID.
-      public: std::string pUuid;
+      /// \brief Process UUID, generated when the object is created.
+      public: Uuid pUuid;
 
       /// \brief Timeout used for receiving requests.
       public: int timeout;
@@ -146,11 +509,8 @@ namespace ignition
       public: bool threadReceptionExiting;
 #endif
 
-      /// \brief Port used by the message discovery layer.
-      private: const int kMsgDiscPort = 11317;
-
-      /// \brief Port used by the service discovery layer.
-      private: const int kSrvDiscPort = 11318;
+      /// \brief Port used by the discovery layer (topics and services).
+      private: const int kDiscPort = 11317;
 
       /// \brief Mutex to guarantee exclusive access to the 'exit' variable.
       private: std::mutex exitMutex;
@@ -161,6 +521,19 @@ namespace ignition
       /// \brief List of connected zmq end points for request/response.
       private: std::vector<std::string> srvConnections;
 
+      /// \brief Process UUID of each remote endpoint we are connected to
+      /// (data and service requests). Used for translating the disconnection
+      /// events of the socket monitors.
+      private: std::map<std::string, Uuid> endpointProcs;
+
+      /// \brief Shortest heartbeat interval requested by the nodes (ms.) or
+      /// 0 if none was requested.
+      private: unsigned int heartbeatInterval;
+
+      /// \brief Shortest silence interval requested by the nodes (ms.) or
+      /// 0 if none was requested.
+      private: unsigned int silenceInterval;
+
       /// \brief Remote subscribers.
       public: TopicStorage<MessagePublisher> remoteSubscribers;
 
@@ -173,6 +546,94 @@ namespace ignition
       /// \brief Pending service call requests.
       public: HandlerStorage<IReqHandler> requests;
 
+      /// \brief Requests not sent yet and cached responders for each
+      /// service and pair of request/response types.
+      private: SrvRequestQueueStorage srvQueues;
+
+      /// \brief Streaming responses being sent, indexed by request UUID.
+      private: std::map<Uuid, std::shared_ptr<SrvStream>> srvStreams;
+
+      /// \brief Threads running the streaming services, indexed by request
+      /// UUID.
+      private: std::map<Uuid, std::thread> streamThreads;
+
+      /// \brief Request UUIDs of the streams whose thread has finished and
+      /// can be joined.
+      private: std::vector<Uuid> finishedStreams;
+
+      /// \brief Used to wake up the streams waiting for credits.
+      private: std::condition_variable_any streamCondition;
+
+      /// \brief Sequence number of the next chunk expected for each pending
+      /// streaming request, indexed by request UUID.
+      private: std::map<Uuid, uint64_t> streamSeqs;
+
+      /// \brief Requests waiting for a response, indexed by the process UUID
+      /// of their responder and the request UUID.
+      private: std::map<Uuid, std::map<Uuid, SentRequest>> sentRequests;
+
+      /// \brief Number of requests re-routed to another responder.
+      private: std::atomic<uint64_t> reroutedRequests;
+
+      /// \brief Timeouts of the pending service call requests.
+      private: TimerWheel<RequestTimer> requestTimeouts;
+
+      /// \brief Hedging timers of the pending service call requests.
+      private: TimerWheel<RequestTimer> hedgeTimers;
+
+      /// \brief Number of service call requests hedged.
+      private: std::atomic<uint64_t> hedgedRequests;
+
+      /// \brief Last response latencies (ms.) for each service name.
+      private: std::map<std::string, std::deque<unsigned int>> srvLatencies;
+
+      /// \brief UUIDs of the last completed requests that might still
+      /// receive a response (hedged or expired requests). Used for discarding
+      /// duplicated responses silently.
+      private: std::unordered_set<Uuid> completedRequests;
+
+      /// \brief Insertion order of completedRequests, used to bound its size.
+      private: std::deque<Uuid> completedRequestsOrder;
+
+      /// \brief Number of service call requests expired.
+      private: std::atomic<uint64_t> expiredRequests;
+
+      /// \brief Activity counters of each topic used in this process.
+      private: std::map<std::string,
+        std::shared_ptr<TopicCounters>> topicCounters;
+
+      /// \brief Topic where the statistics of the process are published.
+      private: const std::string kStatisticsTopic = "/ign/transport/statistics";
+
+      /// \brief Statistics publication interval (ms.) or 0 if the statistics
+      /// are disabled.
+      private: unsigned int statsInterval;
+
+      /// \brief Fully qualified name of the statistics topic.
+      private: std::string statsTopic;
+
+      /// \brief Node publishing the statistics.
+      private: std::unique_ptr<Node> statsNode;
+
+      /// \brief Time of the last statistics publication (nanoseconds).
+      private: int64_t statsLast;
+
+      /// \brief Snapshot of the topic counters taken at the last statistics
+      /// publication.
+      private: std::map<std::string, TopicStatistics> statsPrevious;
+
+      /// \brief Time spent by the reception thread handling messages and
+      /// timers since the last statistics publication (nanoseconds). Only
+      /// accessed by the reception thread.
+      private: int64_t receptionBusy;
+
+      /// \brief Number of requests waiting for a response for each responder.
+      /// The key is the socket identity of the responder.
+      private: std::map<std::string, unsigned int> outstandingRequests;
+
+      /// \brief Round-robin position for each service name.
+      private: std::map<std::string, size_t> nextResponder;
+
       /// \brief Print activity to stdout.
       public: int verbose;
 
@@ -185,6 +646,11 @@ namespace ignition
       /// \brief My requester service call address.
       public: std::string myRequesterAddress;
 
+      /// \brief Socket identity of my response receiver, sent along with each
+      /// service call request. It's kept in string format because a ZMQ
+      /// socket identity can't start with a zero byte.
+      private: std::string myResponseReceiverId;
+
       /// \brief My replier service call address.
       public: std::string myReplierAddress;
 
@@ -221,11 +687,20 @@ namespace ignition
       /// \brief ZMQ socket to receive service call requests.
       public: std::unique_ptr<zmq::socket_t> replier;
 
+      /// \brief ZMQ socket to receive the connection events of the
+      /// subscriber socket.
+      public: std::unique_ptr<zmq::socket_t> subscriberMonitor;
+
+      /// \brief ZMQ socket to receive the connection events of the
+      /// requester socket.
+      public: std::unique_ptr<zmq::socket_t> requesterMonitor;
+
       //////////////////////////////////////////////////
       /////// Declare here the discovery object  ///////
       //////////////////////////////////////////////////
 
-      /// \brief Discovery service (messages).
+      /// \brief Discovery service (messages). It shares its engine with
+      /// srvDiscovery.
       public: std::unique_ptr<MsgDiscovery> msgDiscovery;
 
       /// \brief Discovery service (services).
@@ -19,12 +19,14 @@
 #define __IGN_TRANSPORT_PACKET_HH_INCLUDED__
 
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -39,18 +41,41 @@ namespace ignition
     static const uint8_t ByeType        = 5;
     static const uint8_t NewConnection  = 6;
     static const uint8_t EndConnection  = 7;
+    static const uint8_t AdvBatchType   = 8;
+    static const uint8_t SyncType       = 9;
+    static const uint8_t QueryType      = 10;
+
+    // Header flags.
+    /// \brief The message is part of a complete snapshot of the discovery
+    /// state of the sender (answer to a SYNC or QUERY request).
+    static const uint16_t SyncFlag      = 0x0001;
+    /// \brief The message was forwarded by a discovery relay. The relays never
+    /// forward it again.
+    static const uint16_t RelayFlag     = 0x0002;
+    /// \brief The publishers carried (or requested) by the message are
+    /// services. Without it, they're topics.
+    static const uint16_t SrvFlag       = 0x0004;
+
+    // Service call request kinds (last frame of a service call request).
+    static const uint8_t SingleRequest  = 0;
+    static const uint8_t BatchRequest   = 1;
+    static const uint8_t StreamRequest  = 2;
+    static const uint8_t StreamCredit   = 3;
+    static const uint8_t StreamCancel   = 4;
 
     /// \brief Used for debugging the message type received/send.
     static const std::vector<std::string> MsgTypesStr =
     {
       "UNINITIALIZED", "ADVERTISE", "SUBSCRIBE", "UNADVERTISE", "HEARTBEAT",
-      "BYE", "NEW_CONNECTION", "END_CONNECTION"
+      "BYE", "NEW_CONNECTION", "END_CONNECTION", "ADVERTISE_BATCH", "SYNC",
+      "QUERY"
     };
 
     /// \class Header Packet.hh ignition/transport/Packet.hh
     /// \brief Header included in each discovery message containing the version
     /// of the discovery protocol, the process UUID of the sender node, the type
-    // of message (ADV, SUB, ... ) and optional flags.
+    /// of message (ADV, SUB, ... ), optional flags and the version of the
+    /// discovery state of the sender.
     class IGNITION_TRANSPORT_VISIBLE Header
     {
       /// \brief Constructor.
@@ -66,6 +91,16 @@ namespace ignition
                      const uint8_t _type,
                      const uint16_t _flags = 0);
 
+      /// \brief Constructor.
+      /// \param[in] _version Version of the discovery protocol.
+      /// \param[in] _pUuid Every process has a unique UUID.
+      /// \param[in] _type Message type (ADVERTISE, SUBSCRIPTION, ...)
+      /// \param[in] _flags Optional flags included in the header.
+      public: Header(const uint16_t _version,
+                     const Uuid &_pUuid,
+                     const uint8_t _type,
+                     const uint16_t _flags = 0);
+
       /// \brief Destructor.
       public: virtual ~Header() = default;
 
@@ -79,6 +114,11 @@ namespace ignition
       /// \sa SetPUuid.
       public: std::string PUuid() const;
 
+      /// \brief Get the process uuid without converting it to a string.
+      /// \return A unique global identifier for every process.
+      /// \sa SetPUuid.
+      public: const Uuid &ProcessUuid() const;
+
       /// \brief Get the message type.
       /// \return Message type (ADVERTISE, SUBSCRIPTION, ...)
       /// \sa SetType.
@@ -96,9 +136,16 @@ namespace ignition
 
       /// \brief Set the process uuid.
       /// \param[in] _pUuid A unique global identifier for every process.
+      /// It should be the string representation of a Uuid, which is packed
+      /// in its 16-byte binary form.
       /// \sa PUuid.
       public: void SetPUuid(const std::string &_pUuid);
 
+      /// \brief Set the process uuid.
+      /// \param[in] _pUuid A unique global identifier for every process.
+      /// \sa ProcessUuid.
+      public: void SetPUuid(const Uuid &_pUuid);
+
       /// \brief Set the message type.
       /// \param[in] _type Message type (ADVERTISE, SUBSCRIPTION, ...).
       /// \sa Type.
@@ -109,6 +156,18 @@ namespace ignition
       /// \sa Flags.
       public: void SetFlags(const uint16_t _flags);
 
+      /// \brief Get the version of the discovery state of the sender. The
+      /// version is increased each time the sender advertises or unadvertises
+      /// a topic.
+      /// \return The discovery state version.
+      /// \sa SetStateVersion.
+      public: uint32_t StateVersion() const;
+
+      /// \brief Set the version of the discovery state of the sender.
+      /// \param[in] _stateVersion The discovery state version.
+      /// \sa StateVersion.
+      public: void SetStateVersion(const uint32_t _stateVersion);
+
       /// \brief Get the header length.
       /// \return The header length in bytes.
       public: int HeaderLength() const;
@@ -135,7 +194,8 @@ namespace ignition
              << "\tVersion: " << _header.Version() << "\n"
              << "\tProcess UUID: " << _header.PUuid() << "\n"
              << "\tType: " << MsgTypesStr.at(_header.Type()) << "\n"
-             << "\tFlags: " << _header.Flags() << "\n";
+             << "\tFlags: " << _header.Flags() << "\n"
+             << "\tState version: " << _header.StateVersion() << "\n";
         return _out;
       }
 
@@ -143,13 +203,16 @@ namespace ignition
       private: uint16_t version = 0;
 
       /// \brief Global identifier. Every process has a unique guid.
-      private: std::string pUuid = "";
+      private: Uuid pUuid = Uuid("");
 
       /// \brief Message type (ADVERTISE, SUBSCRIPTION, ...).
       private: uint8_t type = Uninitialized;
 
       /// \brief Optional flags that you want to include in the header.
       private: uint16_t flags = 0;
+
+      /// \brief Version of the discovery state of the sender.
+      private: uint32_t stateVersion = 0;
     };
 
     /// \class SubscriptionMsg Packet.hh ignition/transport/Packet.hh
@@ -213,6 +276,14 @@ namespace ignition
       /// \return The number of bytes from the body.
       public: size_t Unpack(char *_buffer);
 
+      /// \brief Unserialize a stream of bytes into a Sub, without reading
+      /// past the end of the body.
+      /// \param[in] _buffer Unpack the body from the buffer.
+      /// \param[in] _size Size of the body in bytes.
+      /// \return The number of bytes from the body or 0 if the body is
+      /// invalid.
+      public: size_t Unpack(const char *_buffer, const size_t _size);
+
       /// \brief Message header.
       private: transport::Header header;
 
@@ -220,6 +291,114 @@ namespace ignition
       private: std::string topic = "";
     };
 
+    /// \class SyncMsg Packet.hh ignition/transport/Packet.hh
+    /// \brief Sync packet used in the discovery protocol for requesting the
+    /// discovery state of a remote process. The message contains the version
+    /// of the state already known, so the remote process can answer with the
+    /// changes since that version or with a complete snapshot.
+    class IGNITION_TRANSPORT_VISIBLE SyncMsg
+    {
+      /// \brief Constructor.
+      public: SyncMsg() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _header Message header.
+      /// \param[in] _target Process UUID of the process requested.
+      /// \param[in] _knownVersion Version of the state of the target already
+      /// known or 0 if nothing is known.
+      public: SyncMsg(const transport::Header &_header,
+                      const std::string &_target,
+                      const uint32_t _knownVersion);
+
+      /// \brief Constructor.
+      /// \param[in] _header Message header.
+      /// \param[in] _target Process UUID of the process requested.
+      /// \param[in] _knownVersion Version of the state of the target already
+      /// known or 0 if nothing is known.
+      public: SyncMsg(const transport::Header &_header,
+                      const Uuid &_target,
+                      const uint32_t _knownVersion);
+
+      /// \brief Get the message header.
+      /// \return Reference to the message header.
+      /// \sa SetHeader.
+      public: transport::Header Header() const;
+
+      /// \brief Get the process UUID of the process requested.
+      /// \return The process UUID.
+      /// \sa SetTarget.
+      public: std::string Target() const;
+
+      /// \brief Get the process UUID of the process requested without
+      /// converting it to a string.
+      /// \return The process UUID.
+      /// \sa SetTarget.
+      public: const Uuid &TargetUuid() const;
+
+      /// \brief Get the version of the state of the target already known.
+      /// \return The version or 0 if nothing is known.
+      /// \sa SetKnownVersion.
+      public: uint32_t KnownVersion() const;
+
+      /// \brief Set the header of the message.
+      /// \param[in] _header Message header.
+      /// \sa Header.
+      public: void SetHeader(const transport::Header &_header);
+
+      /// \brief Set the process UUID of the process requested.
+      /// \param[in] _target The process UUID, as the string representation
+      /// of a Uuid.
+      /// \sa Target.
+      public: void SetTarget(const std::string &_target);
+
+      /// \brief Set the process UUID of the process requested.
+      /// \param[in] _target The process UUID.
+      /// \sa TargetUuid.
+      public: void SetTarget(const Uuid &_target);
+
+      /// \brief Set the version of the state of the target already known.
+      /// \param[in] _knownVersion The version or 0 if nothing is known.
+      /// \sa KnownVersion.
+      public: void SetKnownVersion(const uint32_t _knownVersion);
+
+      /// \brief Get the total length of the message.
+      /// \return Return the length of the message in bytes.
+      public: size_t MsgLength() const;
+
+      /// \brief Stream insertion operator.
+      /// \param[out] _out The output stream.
+      /// \param[in] _msg SyncMsg message to write to the stream.
+      public: friend std::ostream &operator<<(std::ostream &_out,
+                                              const SyncMsg &_msg)
+      {
+        _out << _msg.Header()
+             << "Body:" << std::endl
+             << "\tTarget: [" << _msg.Target() << "]" << std::endl
+             << "\tKnown version: " << _msg.KnownVersion() << std::endl;
+
+        return _out;
+      }
+
+      /// \brief Serialize the sync message.
+      /// \param[out] _buffer Buffer where the message will be serialized.
+      /// \return The length of the serialized message in bytes.
+      public: size_t Pack(char *_buffer) const;
+
+      /// \brief Unserialize a stream of bytes into a SyncMsg.
+      /// \param[out] _buffer Unpack the body from the buffer.
+      /// \return The number of bytes from the body.
+      public: size_t Unpack(char *_buffer);
+
+      /// \brief Message header.
+      private: transport::Header header;
+
+      /// \brief Process UUID of the process requested.
+      private: Uuid target = Uuid("");
+
+      /// \brief Version of the state of the target already known.
+      private: uint32_t knownVersion = 0;
+    };
+
     /// \class AdvertiseMessage Packet.hh ignition/transport/Packet.hh
     /// \brief Advertise packet used in the discovery protocol to broadcast
     /// information about the node advertising a topic. The information sent
@@ -312,6 +491,21 @@ namespace ignition
         return this->publisher.MsgLength();
       }
 
+      /// \brief Unserialize a stream of bytes into an AdvertiseMessage,
+      /// without reading past the end of the body.
+      /// \param[in] _buffer Unpack the body from the buffer.
+      /// \param[in] _size Size of the body in bytes.
+      /// \return The number of bytes from the body or 0 if the body is
+      /// invalid.
+      public: size_t Unpack(const char *_buffer, const size_t _size)
+      {
+        // Unpack the message publisher.
+        if (this->publisher.Unpack(_buffer, _size) == 0)
+          return 0;
+
+        return this->publisher.MsgLength();
+      }
+
       /// \brief Stream insertion operator.
       /// \param[out] _out The output stream.
       /// \param[in] _msg AdvertiseMsg to write to the stream.
@@ -328,6 +522,249 @@ namespace ignition
       /// \brief Publisher information (topic, ZMQ address, UUIDs, etc.).
       private: T publisher;
     };
+
+    /// \class AdvertiseBatchMessage Packet.hh ignition/transport/Packet.hh
+    /// \brief Advertise packet containing multiple publishers. It's used for
+    /// advertising all the topics of a process with a few datagrams
+    /// instead of one datagram per topic. When the list of publishers is split
+    /// in several datagrams, each one contains its index and the total number
+    /// of datagrams. The body contains the index, the number of datagrams and
+    /// the number of publishers, followed by each serialized publisher. 'T' is
+    /// the Publisher type used inside this AdvertiseBatchMessage object.
+    template <class T> class IGNITION_TRANSPORT_VISIBLE AdvertiseBatchMessage
+    {
+      /// \brief Constructor.
+      public: AdvertiseBatchMessage() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _header Message header.
+      public: explicit AdvertiseBatchMessage(const Header &_header)
+        : header(_header)
+      {
+      }
+
+      /// \brief Get the message header.
+      /// \return The message header.
+      /// \sa SetHeader.
+      public: transport::Header Header() const
+      {
+        return this->header;
+      }
+
+      /// \brief Set the header of the message.
+      /// \param[in] _header Message header.
+      /// \sa Header.
+      public: void SetHeader(const transport::Header &_header)
+      {
+        this->header = _header;
+      }
+
+      /// \brief Get the publishers of this message.
+      /// \return The list of publishers.
+      /// \sa AddPublisher.
+      public: const std::vector<T> &Publishers() const
+      {
+        return this->publishers;
+      }
+
+      /// \brief Append a new publisher to the message.
+      /// \param[in] _publisher New publisher.
+      /// \sa Publishers.
+      public: void AddPublisher(const T &_publisher)
+      {
+        this->publishers.push_back(_publisher);
+      }
+
+      /// \brief Remove all the publishers of the message.
+      public: void Clear()
+      {
+        this->publishers.clear();
+      }
+
+      /// \brief Get the index of this message when a list of publishers is
+      /// split in several messages.
+      /// \return The index (starting at 0).
+      /// \sa SetPart.
+      public: uint16_t Part() const
+      {
+        return this->part;
+      }
+
+      /// \brief Get the number of messages in which a list of publishers is
+      /// split.
+      /// \return The number of messages.
+      /// \sa SetPart.
+      public: uint16_t NumParts() const
+      {
+        return this->numParts;
+      }
+
+      /// \brief Set the position of this message when a list of publishers is
+      /// split in several messages.
+      /// \param[in] _part Index of this message (starting at 0).
+      /// \param[in] _numParts Number of messages.
+      /// \sa Part.
+      /// \sa NumParts.
+      public: void SetPart(const uint16_t _part, const uint16_t _numParts)
+      {
+        this->part = _part;
+        this->numParts = _numParts;
+      }
+
+      /// \brief Get the total length of the message.
+      /// \return Return the length of the message in bytes.
+      public: size_t MsgLength() const
+      {
+        size_t len = this->header.HeaderLength() + 3 * sizeof(uint16_t);
+        for (const auto &pub : this->publishers)
+          len += pub.MsgLength();
+        return len;
+      }
+
+      /// \brief Serialize the advertise batch message.
+      /// \param[out] _buffer Buffer where the message will be serialized.
+      /// \return The length of the serialized message in bytes.
+      public: size_t Pack(char *_buffer) const
+      {
+        if (this->publishers.size() > UINT16_MAX ||
+            this->part >= this->numParts)
+        {
+          return 0;
+        }
+
+        size_t len = this->header.Pack(_buffer);
+        if (len == 0)
+          return 0;
+
+        _buffer += len;
+
+        memcpy(_buffer, &this->part, sizeof(this->part));
+        _buffer += sizeof(this->part);
+        memcpy(_buffer, &this->numParts, sizeof(this->numParts));
+        _buffer += sizeof(this->numParts);
+
+        uint16_t numPublishers = static_cast<uint16_t>(this->publishers.size());
+        memcpy(_buffer, &numPublishers, sizeof(numPublishers));
+        _buffer += sizeof(numPublishers);
+
+        for (const auto &pub : this->publishers)
+        {
+          len = pub.Pack(_buffer);
+          if (len == 0)
+            return 0;
+          _buffer += len;
+        }
+
+        return this->MsgLength();
+      }
+
+      /// \brief Unserialize a stream of bytes into an AdvertiseBatchMessage.
+      /// \param[in] _buffer Unpack the body from the buffer.
+      /// \param[in] _size Size of the body in bytes.
+      /// \return The number of bytes from the body or 0 if the body is
+      /// invalid.
+      public: size_t Unpack(const char *_buffer, const size_t _size)
+      {
+        this->publishers.clear();
+
+        if (!_buffer || _size < 3 * sizeof(uint16_t))
+          return 0;
+
+        memcpy(&this->part, _buffer, sizeof(this->part));
+        memcpy(&this->numParts, _buffer + sizeof(this->part),
+          sizeof(this->numParts));
+        if (this->part >= this->numParts)
+          return 0;
+
+        uint16_t numPublishers;
+        memcpy(&numPublishers, _buffer + 2 * sizeof(uint16_t),
+          sizeof(numPublishers));
+        size_t pos = 3 * sizeof(uint16_t);
+
+        for (uint16_t i = 0; i < numPublishers; ++i)
+        {
+          // The publisher can't be read past the end of the body.
+          T pub;
+          size_t len = pub.Unpack(_buffer + pos, _size - pos);
+          if (len == 0)
+          {
+            this->publishers.clear();
+            return 0;
+          }
+
+          pos += len;
+          this->publishers.push_back(pub);
+        }
+
+        return pos;
+      }
+
+      /// \brief Stream insertion operator.
+      /// \param[out] _out The output stream.
+      /// \param[in] _msg AdvertiseBatchMessage to write to the stream.
+      public: friend std::ostream &operator<<(std::ostream &_out,
+                                          const AdvertiseBatchMessage &_msg)
+      {
+        _out << _msg.header;
+        for (const auto &pub : _msg.publishers)
+          _out << pub;
+        return _out;
+      }
+
+      /// \brief Message header.
+      private: transport::Header header;
+
+      /// \brief Publishers advertised (topic, ZMQ address, UUIDs, etc.).
+      private: std::vector<T> publishers;
+
+      /// \brief Index of this message.
+      private: uint16_t part = 0;
+
+      /// \brief Number of messages in which the publishers are split.
+      private: uint16_t numParts = 1;
+    };
+
+    /// \class BatchMsg Packet.hh ignition/transport/Packet.hh
+    /// \brief Container used for sending multiple serialized service call
+    /// requests or responses inside a single ZMQ frame. Each item is prefixed
+    /// by its length.
+    class IGNITION_TRANSPORT_VISIBLE BatchMsg
+    {
+      /// \brief Constructor.
+      public: BatchMsg() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _items Serialized items.
+      public: explicit BatchMsg(const std::vector<std::string> &_items);
+
+      /// \brief Get the items stored.
+      /// \return The serialized items.
+      public: const std::vector<std::string> &Items() const;
+
+      /// \brief Append a new item.
+      /// \param[in] _item Serialized item.
+      public: void AddItem(const std::string &_item);
+
+      /// \brief Get the total length of the message.
+      /// \return Return the length of the message in bytes.
+      public: size_t MsgLength() const;
+
+      /// \brief Serialize the batch.
+      /// \param[out] _buffer Buffer where the message will be serialized. It
+      /// should have at least MsgLength() bytes.
+      /// \return The length of the serialized message in bytes.
+      public: size_t Pack(char *_buffer) const;
+
+      /// \brief Unserialize a stream of bytes into a batch. The data comes
+      /// from the network, so it's validated against the buffer size.
+      /// \param[in] _buffer Unpack the batch from the buffer.
+      /// \param[in] _size Size of the buffer in bytes.
+      /// \return The number of bytes unpacked or 0 if the buffer is invalid.
+      public: size_t Unpack(const char *_buffer, const size_t _size);
+
+      /// \brief Serialized items.
+      private: std::vector<std::string> items;
+    };
   }
 }
 
@@ -23,6 +23,7 @@
 
 #include "ignition/transport/AdvertiseOptions.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -32,6 +33,8 @@ namespace ignition
     /// ignition/transport/Publisher.hh
     /// \brief This class stores all the information about a publisher.
     /// It stores the topic name that publishes, addresses, UUIDs, scope, etc.
+    /// The process and node UUIDs are stored and packed in binary form (16
+    /// bytes each), so they should be the string representation of a Uuid.
     class IGNITION_TRANSPORT_VISIBLE Publisher
     {
       /// \brief Default constructor.
@@ -63,15 +66,25 @@ namespace ignition
       public: std::string Addr() const;
 
       /// \brief Get the process UUID of the publisher.
-      /// return Process UUID.
+      /// return Process UUID or empty string if it's not set.
       /// \sa SetPUuid.
       public: std::string PUuid() const;
 
+      /// \brief Get the process UUID without converting it to a string.
+      /// \return Process UUID (nil if it's not set).
+      /// \sa SetPUuid.
+      public: const Uuid &ProcessUuid() const;
+
       /// \brief Get the node UUID of the publisher.
-      /// \return Node UUID.
+      /// \return Node UUID or empty string if it's not set.
       /// \sa SetNUuid.
       public: std::string NUuid() const;
 
+      /// \brief Get the node UUID without converting it to a string.
+      /// \return Node UUID (nil if it's not set).
+      /// \sa SetNUuid.
+      public: const Uuid &NodeUuid() const;
+
       /// \brief Get the scope of the publisher's topic.
       /// \return Scope of the topic advertised by the publisher.
       /// \sa SetScope.
@@ -88,15 +101,27 @@ namespace ignition
       public: void SetAddr(const std::string &_addr);
 
       /// \brief Set the process UUID of the publisher.
-      /// \param[in] _pUuid New process UUID.
+      /// \param[in] _pUuid New process UUID. A string that is not the
+      /// representation of a Uuid leaves the process UUID unset.
       /// \sa PUuid.
       public: void SetPUuid(const std::string &_pUuid);
 
+      /// \brief Set the process UUID of the publisher.
+      /// \param[in] _pUuid New process UUID.
+      /// \sa ProcessUuid.
+      public: void SetPUuid(const Uuid &_pUuid);
+
       /// \brief Set the node UUID of the publisher.
-      /// \param[in] _nUuid New node UUID.
+      /// \param[in] _nUuid New node UUID. A string that is not the
+      /// representation of a Uuid leaves the node UUID unset.
       /// \sa NUuid.
       public: void SetNUuid(const std::string &_nUuid);
 
+      /// \brief Set the node UUID of the publisher.
+      /// \param[in] _nUuid New node UUID.
+      /// \sa NodeUuid.
+      public: void SetNUuid(const Uuid &_nUuid);
+
       /// \brief Set the scope of the topic advertised by this publisher.
       /// \param[in] _scope New scope.
       /// \sa Scope.
@@ -113,6 +138,14 @@ namespace ignition
       /// \param[in] _buffer Input buffer with the data to be unserialized.
       public: size_t Unpack(char *_buffer);
 
+      /// \brief Unserialize the publisher, without reading past the end of
+      /// the input buffer.
+      /// \param[in] _buffer Input buffer with the data to be unserialized.
+      /// \param[in] _size Size of the input buffer in bytes.
+      /// \return Number of bytes unserialized or 0 if the publisher doesn't
+      /// fit in the buffer.
+      public: size_t Unpack(const char *_buffer, const size_t _size);
+
       /// \brief Get the total length of the message.
       /// \return Return the length of the message in bytes.
       public: size_t MsgLength() const;
@@ -160,10 +193,10 @@ namespace ignition
       protected: std::string addr;
 
       /// \brief Process UUID of the publisher.
-      protected: std::string pUuid;
+      protected: Uuid pUuid = Uuid("");
 
       /// \brief Node UUID of the publisher.
-      protected: std::string nUuid;
+      protected: Uuid nUuid = Uuid("");
 
       /// \brief Scope of the topic advertised by this publisher.
       protected: Scope_t scope = Scope_t::ALL;
@@ -202,6 +235,9 @@ namespace ignition
       // Documentation inherited.
       public: size_t Unpack(char *_buffer);
 
+      // Documentation inherited.
+      public: size_t Unpack(const char *_buffer, const size_t _size);
+
       // Documentation inherited.
       public: size_t MsgLength() const;
 
@@ -293,6 +329,9 @@ namespace ignition
       // Documentation inherited.
       public: size_t Unpack(char *_buffer);
 
+      // Documentation inherited.
+      public: size_t Unpack(const char *_buffer, const size_t _size);
+
       // Documentation inherited.
       public: size_t MsgLength() const;
 
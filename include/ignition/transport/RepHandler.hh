@@ -32,6 +32,7 @@
 #include <string>
 
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/StreamWriter.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
@@ -70,6 +71,29 @@ namespace ignition
                                        std::string &_rep,
                                        bool &_result) = 0;
 
+      /// \brief Executes the callback registered for this handler for a
+      /// streaming request. The response is sent as a sequence of chunks.
+      /// Regular (non-streaming) handlers send their only response as the last
+      /// chunk.
+      /// \param[in] _req Serialized data received.
+      /// \param[in] _send Function used for sending each serialized chunk.
+      /// \param[out] _result Service call result.
+      public: virtual void RunStreamCallback(const std::string &_req,
+                                             const StreamChunkCallback &_send,
+                                             bool &_result)
+      {
+        std::string rep;
+        this->RunCallback(_req, rep, _result);
+        _send(rep, true, _result);
+      }
+
+      /// \brief Returns if this handler streams its responses.
+      /// \return True for streaming handlers.
+      public: virtual bool Streaming() const
+      {
+        return false;
+      }
+
       /// \brief Get the unique UUID of this handler.
       /// \return a string representation of the handler UUID.
       public: std::string HandlerUuid() const
@@ -201,6 +225,114 @@ namespace ignition
       /// \brief Callback to the function registered for this handler.
       private: std::function<void(const Req &, Rep &, bool &)> cb;
     };
+
+    /// \class StreamRepHandler RepHandler.hh
+    /// \brief It creates a streaming service reply handler. 'Req' is the
+    /// protobuf message type containing the input parameters of the service
+    /// call. 'Rep' is the protobuf message type of each chunk of the
+    /// response.
+    template <typename Req, typename Rep> class StreamRepHandler
+      : public IRepHandler
+    {
+      // Documentation inherited.
+      public: StreamRepHandler() = default;
+
+      /// \brief Set the callback for this handler.
+      /// \param[in] _cb The callback with the following parameters:
+      /// \param[in] _req Protobuf message containing the service request params
+      /// \param[in] _writer Writer used to send each chunk of the response.
+      /// \param[out] _result True when the service response is considered
+      /// successful or false otherwise.
+      public: void SetCallback(const std::function
+        <void(const Req &, StreamWriter<Rep> &, bool &)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
+      // Documentation inherited.
+      public: void RunLocalCallback(const transport::ProtoMsg &/*_msgReq*/,
+                                    transport::ProtoMsg &/*_msgRep*/,
+                                    bool &_result)
+      {
+        std::cerr << "StreamRepHandler::RunLocalCallback() error: "
+                  << "Streaming services require a streaming request"
+                  << std::endl;
+        _result = false;
+      }
+
+      // Documentation inherited.
+      public: void RunCallback(const std::string &/*_req*/,
+                               std::string &/*_rep*/,
+                               bool &_result)
+      {
+        std::cerr << "StreamRepHandler::RunCallback() error: "
+                  << "Streaming services require a streaming request"
+                  << std::endl;
+        _result = false;
+      }
+
+      // Documentation inherited.
+      public: void RunStreamCallback(const std::string &_req,
+                                     const StreamChunkCallback &_send,
+                                     bool &_result)
+      {
+        // Check if we have a callback registered.
+        if (!this->cb)
+        {
+          std::cerr << "StreamRepHandler::RunStreamCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          _result = false;
+          _send("", true, _result);
+          return;
+        }
+
+        Req msgReq;
+        if (!msgReq.ParseFromString(_req))
+        {
+          std::cerr << "StreamRepHandler::RunStreamCallback() error: "
+                    << "ParseFromString failed" << std::endl;
+          _result = false;
+          _send("", true, _result);
+          return;
+        }
+
+        // Each chunk is sent as soon as it is written.
+        StreamWriter<Rep> writer([&_send](const std::string &_data)
+          {
+            return _send(_data, false, true);
+          });
+
+        _result = false;
+        this->cb(msgReq, writer, _result);
+
+        if (writer.Cancelled())
+          return;
+
+        // Close the stream with an empty chunk carrying the result.
+        _send("", true, _result);
+      }
+
+      // Documentation inherited.
+      public: bool Streaming() const
+      {
+        return true;
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Callback to the function registered for this handler.
+      private: std::function<void(const Req &, StreamWriter<Rep> &, bool &)> cb;
+    };
   }
 }
 
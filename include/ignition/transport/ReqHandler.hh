@@ -26,12 +26,16 @@
 #pragma warning(pop)
 #endif
 
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Packet.hh"
+#include "ignition/transport/RequestOptions.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
@@ -48,9 +52,13 @@ namespace ignition
       public: explicit IReqHandler(const std::string &_nUuid)
         : rep(""),
           result(false),
-          hUuid(Uuid().ToString()),
           nUuid(_nUuid),
           requested(false),
+          removed(false),
+          policy(ResponderPolicy_t::LEAST_OUTSTANDING),
+          hedge(false),
+          hedgeDelay(0),
+          hedged(false),
           repAvailable(false)
       {
       }
@@ -67,9 +75,60 @@ namespace ignition
       public: virtual void NotifyResult(const std::string &_rep,
                                         const bool _result) = 0;
 
+      /// \brief Executes the callback registered for this handler with the
+      /// raw results received from the service call responser.
+      /// \param[in] _rep Serialized data containing the response coming from
+      /// the service call responser.
+      /// \param[in] _results Results of the service call coming from the
+      /// service call responser. It contains one character ('1' or '0') per
+      /// request item.
+      public: virtual void NotifyResults(const std::string &_rep,
+                                         const std::string &_results)
+      {
+        this->NotifyResult(_rep, _results == "1");
+      }
+
+      /// \brief Executes the callback registered for this handler with a
+      /// chunk of a streaming response.
+      /// \param[in] _rep Serialized data containing the chunk.
+      /// \param[in] _result Result of the service call.
+      /// \param[in] _last True if this is the final chunk of the stream.
+      public: virtual void NotifyChunk(const std::string &_rep,
+                                       const bool _result,
+                                       const bool /*_last*/)
+      {
+        this->NotifyResult(_rep, _result);
+      }
+
+      /// \brief Get the number of chunks of a streaming response consumed
+      /// since the last time that the responser was granted new credits.
+      /// The counter is reset when the number of credits is worth sending.
+      /// \return The number of credits to grant or 0 if there's no need to
+      /// grant credits yet.
+      public: virtual unsigned int StreamCredits()
+      {
+        return 0;
+      }
+
+      /// \brief Get the kind of request (SingleRequest, BatchRequest or
+      /// StreamRequest).
+      /// \return The request kind.
+      public: virtual uint8_t Kind() const
+      {
+        return SingleRequest;
+      }
+
       /// \brief Get the node UUID.
       /// \return The string representation of the node UUID.
       public: std::string NodeUuid() const
+      {
+        return this->nUuid.ToString();
+      }
+
+      /// \brief Get the node UUID.
+      /// \return The node UUID.
+      /// \sa NodeUuid.
+      public: const Uuid &NodeId() const
       {
         return this->nUuid;
       }
@@ -102,6 +161,158 @@ namespace ignition
         this->requested = _value;
       }
 
+      /// \brief Returns if this service call request was removed before
+      /// being sent.
+      /// \return True when the request was removed.
+      public: bool Removed() const
+      {
+        return this->removed;
+      }
+
+      /// \brief Mark the service call request as removed (or not). A removed
+      /// request still queued is skipped instead of being sent.
+      /// \param[in] _value true when the request is removed.
+      public: void Removed(const bool _value)
+      {
+        this->removed = _value;
+      }
+
+      /// \brief Get the policy used for choosing the responder of this
+      /// request.
+      /// \return The responder policy.
+      public: ResponderPolicy_t Policy() const
+      {
+        return this->policy;
+      }
+
+      /// \brief Set the policy used for choosing the responder of this
+      /// request.
+      /// \param[in] _policy The new policy.
+      public: void Policy(const ResponderPolicy_t _policy)
+      {
+        this->policy = _policy;
+      }
+
+      /// \brief Get the socket identity of the responder that received this
+      /// request.
+      /// \return The responder's socket identity or empty string if the
+      /// request has not been sent yet.
+      public: std::string Responder() const
+      {
+        return this->responder;
+      }
+
+      /// \brief Set the socket identity of the responder that received this
+      /// request.
+      /// \param[in] _responder Responder's socket identity.
+      public: void Responder(const std::string &_responder)
+      {
+        this->responder = _responder;
+      }
+
+      /// \brief Get the process UUID of the responder that received this
+      /// request.
+      /// \return The responder's process UUID or a nil UUID if the request
+      /// has not been sent yet.
+      public: const Uuid &ResponderProcess() const
+      {
+        return this->responderProcess;
+      }
+
+      /// \brief Set the process UUID of the responder that received this
+      /// request.
+      /// \param[in] _pUuid Responder's process UUID.
+      public: void ResponderProcess(const Uuid &_pUuid)
+      {
+        this->responderProcess = _pUuid;
+      }
+
+      /// \brief Forget the responders of this request, so it can be sent
+      /// again (e.g.: when the responder is gone).
+      public: void ResetResponders()
+      {
+        this->requested = false;
+        this->responder.clear();
+        this->responderProcess = Uuid("");
+        this->hedged = false;
+        this->hedgeResponder.clear();
+        this->hedgeResponderProcess = Uuid("");
+      }
+
+      /// \brief Get whether this request should be hedged.
+      /// \return True if hedging is enabled.
+      public: bool Hedge() const
+      {
+        return this->hedge;
+      }
+
+      /// \brief Enable or disable hedging for this request.
+      /// \param[in] _hedge True to enable hedging.
+      /// \param[in] _delay Hedging delay in milliseconds (0 for adaptive).
+      public: void Hedge(const bool _hedge, const unsigned int _delay)
+      {
+        this->hedge = _hedge;
+        this->hedgeDelay = _delay;
+      }
+
+      /// \brief Get the hedging delay of this request.
+      /// \return The hedging delay in milliseconds (0 means adaptive).
+      public: unsigned int HedgeDelay() const
+      {
+        return this->hedgeDelay;
+      }
+
+      /// \brief Returns if this request has already been sent to a second
+      /// responder.
+      /// \return True when the request has been hedged.
+      public: bool Hedged() const
+      {
+        return this->hedged;
+      }
+
+      /// \brief Get the socket identity of the second responder that
+      /// received this request.
+      /// \return The responder's socket identity or empty string if the
+      /// request hasn't been hedged.
+      public: std::string HedgeResponder() const
+      {
+        return this->hedgeResponder;
+      }
+
+      /// \brief Get the process UUID of the second responder that received
+      /// this request.
+      /// \return The responder's process UUID or a nil UUID if the request
+      /// hasn't been hedged.
+      public: const Uuid &HedgeResponderProcess() const
+      {
+        return this->hedgeResponderProcess;
+      }
+
+      /// \brief Mark the request as hedged.
+      /// \param[in] _responder Socket identity of the second responder.
+      /// \param[in] _pUuid Process UUID of the second responder.
+      public: void HedgeResponder(const std::string &_responder,
+                                  const Uuid &_pUuid = Uuid(""))
+      {
+        this->hedged = true;
+        this->hedgeResponder = _responder;
+        this->hedgeResponderProcess = _pUuid;
+      }
+
+      /// \brief Get the time when the request was sent.
+      /// \return Time when the request was sent.
+      public: Timestamp SentTime() const
+      {
+        return this->sentTime;
+      }
+
+      /// \brief Set the time when the request was sent.
+      /// \param[in] _time Time when the request was sent.
+      public: void SentTime(const Timestamp &_time)
+      {
+        this->sentTime = _time;
+      }
+
       /// \brief Serialize the Req protobuf message stored.
       /// \param[out] _buffer The serialized data.
       /// \return True if the serialization succeed or false otherwise.
@@ -110,6 +321,14 @@ namespace ignition
       /// \brief Returns the unique handler UUID.
       /// \return The handler's UUID.
       public: std::string HandlerUuid() const
+      {
+        return this->hUuid.ToString();
+      }
+
+      /// \brief Returns the unique handler UUID.
+      /// \return The handler's UUID.
+      /// \sa HandlerUuid.
+      public: const Uuid &HandlerId() const
       {
         return this->hUuid;
       }
@@ -152,15 +371,47 @@ namespace ignition
       protected: bool result;
 
       /// \brief Unique handler's UUID.
-      protected: std::string hUuid;
+      protected: Uuid hUuid;
 
       /// \brief Node UUID.
-      private: std::string nUuid;
+      private: Uuid nUuid;
 
       /// \brief When true, the REQ was already sent and the REP should be on
       /// its way. Used to not resend the same REQ more than one time.
       private: bool requested;
 
+      /// \brief When true, the REQ was removed before being sent.
+      private: bool removed;
+
+      /// \brief Policy for choosing the responder.
+      private: ResponderPolicy_t policy;
+
+      /// \brief Socket identity of the responder that received the REQ.
+      private: std::string responder;
+
+      /// \brief Process UUID of the responder that received the REQ.
+      private: Uuid responderProcess = Uuid("");
+
+      /// \brief When true, the REQ is sent to a second responder if the REP
+      /// doesn't arrive in time.
+      private: bool hedge;
+
+      /// \brief Hedging delay in milliseconds (0 means adaptive).
+      private: unsigned int hedgeDelay;
+
+      /// \brief True when the REQ has been sent to a second responder.
+      private: bool hedged;
+
+      /// \brief Socket identity of the second responder that received the
+      /// REQ.
+      private: std::string hedgeResponder;
+
+      /// \brief Process UUID of the second responder that received the REQ.
+      private: Uuid hedgeResponderProcess = Uuid("");
+
+      /// \brief Time when the REQ was sent.
+      private: Timestamp sentTime;
+
       /// \brief When there is a blocking service call request, the call can
       /// be unlocked when a service call REP is available. This variable
       /// captures if we have found a node that can satisty our request.
@@ -274,6 +525,295 @@ namespace ignition
       /// false otherwise.
       private: std::function<void(const Rep &_rep, const bool _result)> cb;
     };
+
+    /// \class BatchReqHandler ReqHandler.hh
+    /// \brief It creates a handler for a batch of service requests sent
+    /// together to the same responser. 'Req' is a protobuf message type
+    /// containing the input parameters of each service request. 'Rep' is a
+    /// protobuf message type that will be filled with each service response.
+    template <typename Req, typename Rep> class BatchReqHandler
+      : public IReqHandler
+    {
+      // Documentation inherited.
+      public: explicit BatchReqHandler(const std::string &_nUuid)
+        : IReqHandler(_nUuid)
+      {
+      }
+
+      /// \brief Set the callback for this handler.
+      /// \param[in] _cb The callback with the following parameters:
+      /// \param[in] _reps Protobuf messages containing the service responses.
+      /// \param[in] _results One result per request, true when the service
+      /// request was successful or false otherwise.
+      public: void SetCallback(const std::function <void(
+        const std::vector<Rep> &_reps,
+        const std::vector<bool> &_results)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
+      /// \brief Set the REQ protobuf messages for this handler.
+      /// \param[in] _reqMsgs Protobuf messages containing the input
+      /// parameters of each service request.
+      public: void SetMessages(const std::vector<Req> &_reqMsgs)
+      {
+        this->reqMsgs = _reqMsgs;
+      }
+
+      /// \brief Get the service responses received.
+      /// \return The service responses (one per request).
+      public: const std::vector<Rep> &Responses() const
+      {
+        return this->reps;
+      }
+
+      /// \brief Get the results of the service responses received.
+      /// \return The results (one per request).
+      public: const std::vector<bool> &Results() const
+      {
+        return this->results;
+      }
+
+      // Documentation inherited
+      public: bool Serialize(std::string &_buffer) const
+      {
+        BatchMsg batch;
+        for (const auto &reqMsg : this->reqMsgs)
+        {
+          std::string data;
+          if (!reqMsg.SerializeToString(&data))
+          {
+            std::cerr << "BatchReqHandler::Serialize(): Error serializing the "
+                      << "request" << std::endl;
+            return false;
+          }
+          batch.AddItem(data);
+        }
+
+        _buffer.resize(batch.MsgLength());
+        batch.Pack(&_buffer[0]);
+        return true;
+      }
+
+      // Documentation inherited.
+      public: uint8_t Kind() const
+      {
+        return BatchRequest;
+      }
+
+      // Documentation inherited.
+      public: void NotifyResult(const std::string &_rep, const bool _result)
+      {
+        this->NotifyResults(_rep,
+          std::string(this->reqMsgs.size(), _result ? '1' : '0'));
+      }
+
+      // Documentation inherited.
+      public: void NotifyResults(const std::string &_rep,
+                                 const std::string &_results)
+      {
+        BatchMsg batch;
+        batch.Unpack(_rep.data(), _rep.size());
+
+        // Missing or malformed responses are reported as failed requests.
+        std::vector<Rep> repMsgs(this->reqMsgs.size());
+        std::vector<bool> repResults(this->reqMsgs.size(), false);
+        for (size_t i = 0; i < this->reqMsgs.size(); ++i)
+        {
+          if (i >= batch.Items().size() || i >= _results.size())
+            continue;
+
+          if (!repMsgs[i].ParseFromString(batch.Items()[i]))
+          {
+            std::cerr << "BatchReqHandler::NotifyResults() error: "
+                      << "ParseFromString failed" << std::endl;
+            continue;
+          }
+          repResults[i] = _results[i] == '1';
+        }
+
+        // Execute the callback (if existing).
+        if (this->cb)
+          this->cb(repMsgs, repResults);
+        else
+        {
+          this->reps = repMsgs;
+          this->results = repResults;
+        }
+
+        this->result = std::find(repResults.begin(), repResults.end(),
+          false) == repResults.end();
+        this->repAvailable = true;
+        this->condition.notify_one();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Protobuf messages containing the requests' parameters.
+      private: std::vector<Req> reqMsgs;
+
+      /// \brief Service responses received (blocking requests).
+      private: std::vector<Rep> reps;
+
+      /// \brief Results received (blocking requests).
+      private: std::vector<bool> results;
+
+      /// \brief Callback to the function registered for this handler with the
+      /// following parameters:
+      /// \param[in] _reps Protobuf messages containing the service responses.
+      /// \param[in] _results One result per request.
+      private: std::function<void(const std::vector<Rep> &_reps,
+        const std::vector<bool> &_results)> cb;
+    };
+
+    /// \class StreamReqHandler ReqHandler.hh
+    /// \brief It creates a handler for a service request whose response is
+    /// streamed as a sequence of chunks. 'Req' is a protobuf message type
+    /// containing the input parameters of the service request. 'Rep' is the
+    /// protobuf message type of each chunk of the response.
+    template <typename Req, typename Rep> class StreamReqHandler
+      : public IReqHandler
+    {
+      // Documentation inherited.
+      public: explicit StreamReqHandler(const std::string &_nUuid)
+        : IReqHandler(_nUuid)
+      {
+      }
+
+      /// \brief Set the callback for this handler.
+      /// \param[in] _cb The callback with the following parameters:
+      /// \param[in] _rep Protobuf message containing a chunk of the response.
+      /// \param[in] _result True when the service request was successful or
+      /// false otherwise.
+      /// \param[in] _last True if this is the final chunk of the stream.
+      public: void SetCallback(const std::function <void(
+        const Rep &_rep, const bool _result, const bool _last)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
+      /// \brief Set the REQ protobuf message for this handler.
+      /// \param[in] _reqMsg Protofub message containing the input parameters of
+      /// of the service request.
+      public: void SetMessage(const Req &_reqMsg)
+      {
+        this->reqMsg = _reqMsg;
+      }
+
+      /// \brief Set the flow control window: maximum number of chunks that
+      /// the responser can send before they are consumed.
+      /// \param[in] _window Window size in chunks.
+      public: void SetWindow(const unsigned int _window)
+      {
+        this->window = _window > 0 ? _window : 1;
+      }
+
+      // Documentation inherited
+      public: bool Serialize(std::string &_buffer) const
+      {
+        std::string data;
+        if (!this->reqMsg.SerializeToString(&data))
+        {
+          std::cerr << "StreamReqHandler::Serialize(): Error serializing the "
+                    << "request" << std::endl;
+          return false;
+        }
+
+        // The request is sent along with the initial credits.
+        BatchMsg batch;
+        batch.AddItem(data);
+        batch.AddItem(std::to_string(this->window));
+
+        _buffer.resize(batch.MsgLength());
+        batch.Pack(&_buffer[0]);
+        return true;
+      }
+
+      // Documentation inherited.
+      public: uint8_t Kind() const
+      {
+        return StreamRequest;
+      }
+
+      // Documentation inherited.
+      public: void NotifyResult(const std::string &_rep, const bool _result)
+      {
+        this->NotifyChunk(_rep, _result, true);
+      }
+
+      // Documentation inherited.
+      public: void NotifyChunk(const std::string &_rep, const bool _result,
+                               const bool _last)
+      {
+        Rep msg;
+        if (!_rep.empty() && !msg.ParseFromString(_rep))
+        {
+          std::cerr << "StreamReqHandler::NotifyChunk() error: "
+                    << "ParseFromString failed" << std::endl;
+        }
+
+        // Execute the callback (if existing).
+        if (this->cb)
+          this->cb(msg, _result, _last);
+
+        // The final chunk closes the stream, there are no credits to grant.
+        if (_last)
+        {
+          this->result = _result;
+          this->repAvailable = true;
+          this->condition.notify_one();
+        }
+        else
+          ++this->consumed;
+      }
+
+      // Documentation inherited.
+      public: unsigned int StreamCredits()
+      {
+        // Grant credits in groups of half a window.
+        if (this->consumed < std::max(1u, this->window / 2))
+          return 0;
+
+        unsigned int credits = this->consumed;
+        this->consumed = 0;
+        return credits;
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Protobuf message containing the request's parameters.
+      private: Req reqMsg;
+
+      /// \brief Flow control window (chunks).
+      private: unsigned int window = RequestOptions::kDefaultStreamWindow;
+
+      /// \brief Chunks consumed since the last credits were granted.
+      private: unsigned int consumed = 0;
+
+      /// \brief Callback to the function registered for this handler.
+      private: std::function<void(const Rep &_rep, const bool _result,
+        const bool _last)> cb;
+    };
   }
 }
 
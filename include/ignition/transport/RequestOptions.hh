@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_REQUESTOPTIONS_HH_INCLUDED__
+#define __IGN_TRANSPORT_REQUESTOPTIONS_HH_INCLUDED__
+
+#include <memory>
+
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    class RequestOptionsPrivate;
+
+    /// \def ResponderPolicy_t This strongly typed enum defines the different
+    /// policies for choosing a responder when multiple service providers
+    /// offer the same service.
+    enum class ResponderPolicy_t
+    {
+      /// \brief Use each responder in turn.
+      ROUND_ROBIN,
+      /// \brief Use the responder with the lowest number of requests waiting
+      /// for a response (default policy). Ties are broken in round-robin.
+      LEAST_OUTSTANDING,
+      /// \brief Prefer responders running in the same machine as the
+      /// requester. Within the same group, use the responder with the lowest
+      /// number of requests waiting for a response.
+      SAME_HOST_FIRST
+    };
+
+    /// \class RequestOptions RequestOptions.hh
+    /// ignition/transport/RequestOptions.hh
+    /// \brief A class for customizing the behavior of a non-blocking service
+    /// call request.
+    /// E.g.: Set the maximum time to wait for the response or the policy for
+    /// choosing a responder.
+    class IGNITION_TRANSPORT_VISIBLE RequestOptions
+    {
+      /// \brief Default timeout of a non-blocking request (milliseconds).
+      public: static const unsigned int kDefaultTimeout = 60000;
+
+      /// \brief Default number of chunks of a streaming response that can be
+      /// in flight.
+      public: static const unsigned int kDefaultStreamWindow = 16;
+
+      /// \brief Constructor.
+      public: RequestOptions();
+
+      /// \brief Copy constructor.
+      /// \param[in] _other RequestOptions to copy.
+      public: RequestOptions(const RequestOptions &_other);
+
+      /// \brief Destructor.
+      public: virtual ~RequestOptions();
+
+      /// \brief Assignment operator.
+      /// \param[in] _other The new RequestOptions.
+      /// \return A reference to this instance.
+      public: RequestOptions &operator=(const RequestOptions &_other);
+
+      /// \brief Get the maximum time to wait for a service response. When the
+      /// timeout expires, the request is discarded and its callback is
+      /// executed with a false result. A value of 0 means that the request
+      /// never expires.
+      /// \return The timeout in milliseconds.
+      /// \sa SetTimeout.
+      public: unsigned int Timeout() const;
+
+      /// \brief Set the maximum time to wait for a service response.
+      /// \param[in] _timeout The new timeout in milliseconds. Use 0 for
+      /// disabling the timeout.
+      /// \sa Timeout.
+      public: void SetTimeout(const unsigned int _timeout);
+
+      /// \brief Get the policy used for choosing a responder when multiple
+      /// service providers are available.
+      /// \return The responder policy.
+      /// \sa SetPolicy.
+      /// \sa ResponderPolicy_t.
+      public: const ResponderPolicy_t &Policy() const;
+
+      /// \brief Set the policy used for choosing a responder.
+      /// \param[in] _policy The new policy.
+      /// \sa Policy.
+      /// \sa ResponderPolicy_t.
+      public: void SetPolicy(const ResponderPolicy_t &_policy);
+
+      /// \brief Get whether hedging is enabled. A hedged request is sent to
+      /// a second responder (when available) if the response hasn't arrived
+      /// after the hedging delay. The first response received wins.
+      /// \return True if hedging is enabled.
+      /// \sa SetHedge.
+      /// \sa HedgeDelay.
+      public: bool Hedge() const;
+
+      /// \brief Enable or disable hedging. It's disabled by default.
+      /// \param[in] _hedge True to enable hedging.
+      /// \sa Hedge.
+      public: void SetHedge(const bool _hedge);
+
+      /// \brief Get the time to wait before sending the request to a
+      /// second responder. A value of 0 means that the delay is the 95th
+      /// percentile of the latency observed in the service.
+      /// \return The hedging delay in milliseconds.
+      /// \sa SetHedgeDelay.
+      public: unsigned int HedgeDelay() const;
+
+      /// \brief Set the time to wait before sending the request to a
+      /// second responder.
+      /// \param[in] _delay The new delay in milliseconds. Use 0 for using
+      /// the 95th percentile of the latency observed.
+      /// \sa HedgeDelay.
+      public: void SetHedgeDelay(const unsigned int _delay);
+
+      /// \brief Get the flow control window of a streaming request: the
+      /// maximum number of response chunks that the responser can send
+      /// before the requester consumes them. Ignored by regular requests.
+      /// \return The window size in chunks.
+      /// \sa SetStreamWindow.
+      public: unsigned int StreamWindow() const;
+
+      /// \brief Set the flow control window of a streaming request.
+      /// \param[in] _window The new window size in chunks. A value of 0 is
+      /// treated as 1.
+      /// \sa StreamWindow.
+      public: void SetStreamWindow(const unsigned int _window);
+
+      /// \internal
+      /// \brief Smart pointer to private data.
+      protected: std::unique_ptr<transport::RequestOptionsPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_REQUESTOPTIONSPRIVATE_HH_INCLUDED__
+#define __IGN_TRANSPORT_REQUESTOPTIONSPRIVATE_HH_INCLUDED__
+
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/RequestOptions.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \internal
+    /// \brief Private data for RequestOptions class.
+    class RequestOptionsPrivate
+    {
+      /// \brief Constructor.
+      public: RequestOptionsPrivate() = default;
+
+      /// \brief Destructor.
+      public: virtual ~RequestOptionsPrivate() = default;
+
+      /// \brief Maximum time to wait for a response (milliseconds).
+      public: unsigned int timeout = RequestOptions::kDefaultTimeout;
+
+      /// \brief Policy for choosing a responder.
+      public: ResponderPolicy_t policy = ResponderPolicy_t::LEAST_OUTSTANDING;
+
+      /// \brief When true, the request is hedged.
+      public: bool hedge = false;
+
+      /// \brief Hedging delay (milliseconds). 0 means adaptive.
+      public: unsigned int hedgeDelay = 0;
+
+      /// \brief Flow control window of a streaming request (chunks).
+      public: unsigned int streamWindow = RequestOptions::kDefaultStreamWindow;
+    };
+  }
+}
+#endif
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_SRVREQUESTQUEUE_HH_INCLUDED__
+#define __IGN_TRANSPORT_SRVREQUESTQUEUE_HH_INCLUDED__
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class SrvRequestQueue SrvRequestQueue.hh
+    /// ignition/transport/SrvRequestQueue.hh
+    /// \brief Requests not sent yet and responders available for a service
+    /// with a particular pair of request/response types. A request removed
+    /// while waiting (e.g.: expired) stays in the queue, marked as removed,
+    /// and it's skipped when popped. That way, removing a request doesn't
+    /// need to search the queue.
+    class IGNITION_TRANSPORT_VISIBLE SrvRequestQueue
+    {
+      /// \brief Add a request at the end of the queue.
+      /// \param[in] _handler Request handler.
+      public: void Push(const IReqHandlerPtr &_handler)
+      {
+        this->unsent.push_back(_handler);
+      }
+
+      /// \brief Add requests at the front of the queue, keeping their
+      /// order. Used for retrying the requests that couldn't be sent before
+      /// the ones that arrived later.
+      /// \param[in] _handlers Request handlers.
+      public: void PushFront(const std::vector<IReqHandlerPtr> &_handlers)
+      {
+        this->unsent.insert(this->unsent.begin(), _handlers.begin(),
+          _handlers.end());
+      }
+
+      /// \brief Take the oldest request that hasn't been removed. The
+      /// removed requests found before it are discarded.
+      /// \param[out] _handler Request handler.
+      /// \return True if a request was taken or false if the queue is empty.
+      public: bool Pop(IReqHandlerPtr &_handler)
+      {
+        while (!this->unsent.empty())
+        {
+          auto handler = this->unsent.front();
+          this->unsent.pop_front();
+
+          if (handler->Removed())
+          {
+            --this->removed;
+            continue;
+          }
+
+          _handler = handler;
+          return true;
+        }
+
+        return false;
+      }
+
+      /// \brief Mark a request of this queue as removed.
+      /// \param[in] _handler Request handler. It should be in the queue.
+      public: void Remove(const IReqHandlerPtr &_handler)
+      {
+        if (_handler->Removed())
+          return;
+
+        _handler->Removed(true);
+        ++this->removed;
+      }
+
+      /// \brief Get the number of requests waiting, without the removed
+      /// ones.
+      /// \return Number of requests waiting.
+      public: size_t Size() const
+      {
+        return this->unsent.size() - this->removed;
+      }
+
+      /// \brief Returns if there are no requests waiting.
+      /// \return True when all the requests have been taken or removed.
+      public: bool Empty() const
+      {
+        return this->Size() == 0;
+      }
+
+      /// \brief Returns if the queue can be forgotten: no requests waiting
+      /// and no responders cached.
+      /// \return True when the queue is idle.
+      public: bool Idle() const
+      {
+        return this->Empty() && this->responders.empty();
+      }
+
+      /// \brief Get the cache of the responders offering the service.
+      /// \return The responders cached.
+      public: const std::vector<ServicePublisher> &Responders() const
+      {
+        return this->responders;
+      }
+
+      /// \brief Add a responder to the cache, unless it's already cached.
+      /// \param[in] _responder Responder offering the service.
+      /// \return True if the responder was added or false otherwise.
+      public: bool AddResponder(const ServicePublisher &_responder)
+      {
+        if (std::find(this->responders.begin(), this->responders.end(),
+              _responder) != this->responders.end())
+        {
+          return false;
+        }
+
+        this->responders.push_back(_responder);
+        return true;
+      }
+
+      /// \brief Remove from the cache the responders of a node or process.
+      /// \param[in] _pUuid Process UUID of the responders.
+      /// \param[in] _topic Service name no longer offered or empty for
+      /// removing all the responders of the process.
+      /// \param[in] _nUuid UUID of the node that stopped offering the service
+      /// (ignored if _topic is empty).
+      public: void RemoveResponders(const Uuid &_pUuid,
+                                    const std::string &_topic,
+                                    const Uuid &_nUuid)
+      {
+        this->responders.erase(std::remove_if(this->responders.begin(),
+          this->responders.end(),
+          [&](const ServicePublisher &_responder)
+          {
+            return _responder.ProcessUuid() == _pUuid &&
+              (_topic.empty() ||
+               (_responder.Topic() == _topic &&
+                _responder.NodeUuid() == _nUuid));
+          }), this->responders.end());
+      }
+
+      /// \brief Forget all the responders cached, so they are refreshed
+      /// from the discovery.
+      public: void ClearResponders()
+      {
+        this->responders.clear();
+      }
+
+      /// \brief Requests waiting for a responder, in arrival order.
+      private: std::deque<IReqHandlerPtr> unsent;
+
+      /// \brief Number of removed requests still in 'unsent'.
+      private: size_t removed = 0;
+
+      /// \brief Cache of the responders offering the service.
+      private: std::vector<ServicePublisher> responders;
+    };
+
+    /// \class SrvRequestQueueStorage SrvRequestQueue.hh
+    /// ignition/transport/SrvRequestQueue.hh
+    /// \brief Store a SrvRequestQueue for each service and pair of
+    /// request/response types. The idle queues are forgotten, so the storage
+    /// doesn't grow with the services called only once.
+    class IGNITION_TRANSPORT_VISIBLE SrvRequestQueueStorage
+    {
+      /// \brief Key of a queue: service name, request type and response
+      /// type.
+      public: using Key = std::tuple<std::string, std::string, std::string>;
+
+      /// \brief Get the queue of a service, creating it if needed.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \return The queue.
+      public: SrvRequestQueue &Queue(const std::string &_topic,
+                                     const std::string &_reqType,
+                                     const std::string &_repType)
+      {
+        return this->queues[std::make_tuple(_topic, _reqType, _repType)];
+      }
+
+      /// \brief Get the queue of a service, if it exists.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \return The queue or nullptr if there is no queue for the service.
+      public: SrvRequestQueue *Find(const std::string &_topic,
+                                    const std::string &_reqType,
+                                    const std::string &_repType)
+      {
+        auto it = this->queues.find(
+          std::make_tuple(_topic, _reqType, _repType));
+        if (it == this->queues.end())
+          return nullptr;
+
+        return &it->second;
+      }
+
+      /// \brief Returns if there is a responder cached for a service.
+      /// \param[in] _topic Service name.
+      /// \param[in] _reqType Type of the request.
+      /// \param[in] _repType Type of the response.
+      /// \return True if at least one responder is cached.
+      public: bool HasResponders(const std::string &_topic,
+                                 const std::string &_reqType,
+                                 const std::string &_repType) const
+      {
+        auto it = this->queues.find(
+          std::make_tuple(_topic, _reqType, _repType));
+        return it != this->queues.end() && !it->second.Responders().empty();
+      }
+
+      /// \brief Mark a request waiting in its queue as removed. The queue is
+      /// forgotten if it becomes idle.
+      /// \param[in] _topic Service name.
+      /// \param[in] _handler Request handler.
+      /// \return True if the queue of the request was found.
+      public: bool RemoveRequest(const std::string &_topic,
+                                 const IReqHandlerPtr &_handler)
+      {
+        auto it = this->queues.find(std::make_tuple(_topic,
+          _handler->ReqTypeName(), _handler->RepTypeName()));
+        if (it == this->queues.end())
+          return false;
+
+        it->second.Remove(_handler);
+        if (it->second.Idle())
+          this->queues.erase(it);
+        return true;
+      }
+
+      /// \brief Remove from all the caches the responders of a node or
+      /// process. The queues that become idle are forgotten.
+      /// \param[in] _pUuid Process UUID of the responders.
+      /// \param[in] _topic Service name no longer offered or empty for
+      /// removing all the responders of the process.
+      /// \param[in] _nUuid UUID of the node that stopped offering the service
+      /// (ignored if _topic is empty).
+      public: void RemoveResponders(const Uuid &_pUuid,
+                                    const std::string &_topic,
+                                    const Uuid &_nUuid)
+      {
+        for (auto it = this->queues.begin(); it != this->queues.end();)
+        {
+          it->second.RemoveResponders(_pUuid, _topic, _nUuid);
+          if (it->second.Idle())
+            it = this->queues.erase(it);
+          else
+            ++it;
+        }
+      }
+
+      /// \brief Get the number of requests waiting in all the queues.
+      /// \return Number of requests waiting.
+      public: size_t Unsent() const
+      {
+        size_t unsent = 0;
+        for (const auto &queue : this->queues)
+          unsent += queue.second.Size();
+        return unsent;
+      }
+
+      /// \brief Get the number of queues stored.
+      /// \return Number of queues.
+      public: size_t Size() const
+      {
+        return this->queues.size();
+      }
+
+      /// \brief Queues indexed by service and pair of request/response types.
+      private: std::map<Key, SrvRequestQueue> queues;
+    };
+  }
+}
+
+#endif
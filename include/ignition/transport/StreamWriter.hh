@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_STREAMWRITER_HH_INCLUDED__
+#define __IGN_TRANSPORT_STREAMWRITER_HH_INCLUDED__
+
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class StreamWriter StreamWriter.hh ignition/transport/StreamWriter.hh
+    /// \brief Object passed to the callback of a streaming service for
+    /// sending the response as a sequence of protobuf messages of type 'T'.
+    /// Each message written is delivered to the requester's callback as it
+    /// arrives. Write() blocks while the requester has too many chunks
+    /// pending to consume (flow control).
+    template <typename T> class StreamWriter
+    {
+      /// \brief Constructor.
+      /// \param[in] _send Function used to send each serialized message. It
+      /// should return false if the stream has been cancelled.
+      public: explicit StreamWriter(
+        const std::function<bool(const std::string &_data)> &_send)
+        : send(_send)
+      {
+      }
+
+      /// \brief Send a new message of the stream.
+      /// \param[in] _msg Protobuf message to send.
+      /// \return True if the message was sent or false if the stream was
+      /// cancelled (e.g.: the requester is gone). The callback should stop
+      /// writing when this function returns false.
+      public: bool Write(const T &_msg)
+      {
+        if (this->cancelled)
+          return false;
+
+        std::string data;
+        if (!_msg.SerializeToString(&data))
+        {
+          std::cerr << "StreamWriter::Write(): Error serializing the message"
+                    << std::endl;
+          return false;
+        }
+
+        this->cancelled = !this->send(data);
+        return !this->cancelled;
+      }
+
+      /// \brief Returns if the stream has been cancelled.
+      /// \return True when the stream was cancelled.
+      public: bool Cancelled() const
+      {
+        return this->cancelled;
+      }
+
+      /// \brief Function used to send each serialized message.
+      private: std::function<bool(const std::string &_data)> send;
+
+      /// \brief True when the stream has been cancelled.
+      private: bool cancelled = false;
+    };
+  }
+}
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TIMERWHEEL_HH_INCLUDED__
+#define __IGN_TRANSPORT_TIMERWHEEL_HH_INCLUDED__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "ignition/transport/TransportTypes.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class TimerWheel TimerWheel.hh ignition/transport/TimerWheel.hh
+    /// \brief A hashed timing wheel used to expire elements after a deadline.
+    /// Inserting an element and advancing the wheel are constant time
+    /// operations (amortized), independently of the number of pending
+    /// elements. Each slot covers '_resolution' milliseconds, so an element
+    /// might expire up to one resolution period after its deadline (never
+    /// before). Deadlines beyond one revolution of the wheel stay in their
+    /// slot until the wheel reaches their tick. Elements can't be removed from
+    /// the wheel, the owner is responsible of ignoring the expired elements
+    /// that are no longer relevant.
+    template<typename T> class TimerWheel
+    {
+      /// \brief Constructor.
+      /// \param[in] _resolution Time covered by each slot (milliseconds).
+      /// \param[in] _numSlots Number of slots in the wheel.
+      public: explicit TimerWheel(const unsigned int _resolution = 50,
+                                  const size_t _numSlots = 512)
+        : resolution(_resolution > 0 ? _resolution : 1),
+          slots(_numSlots > 0 ? _numSlots : 1),
+          start(std::chrono::steady_clock::now())
+      {
+      }
+
+      /// \brief Destructor.
+      public: virtual ~TimerWheel() = default;
+
+      /// \brief Insert a new element in the wheel.
+      /// \param[in] _deadline Time at which the element should expire.
+      /// \param[in] _value Element to store.
+      public: void Add(const Timestamp &_deadline, const T &_value)
+      {
+        // Round up to the next tick, an element never expires before its
+        // deadline.
+        uint64_t tick = this->Tick(_deadline) + 1;
+
+        // The element has already expired, schedule it for the next advance.
+        if (tick <= this->current)
+          tick = this->current + 1;
+
+        Entry entry;
+        entry.tick = tick;
+        entry.value = _value;
+
+        this->slots[tick % this->slots.size()].push_back(entry);
+
+        // Keep the next tick up to date. It's only known when the wheel was
+        // empty or it was already known.
+        if (this->count == 0 || (this->nextKnown && tick < this->next))
+        {
+          this->next = tick;
+          this->nextKnown = true;
+        }
+        ++this->count;
+      }
+
+      /// \brief Advance the wheel until a given time, collecting all the
+      /// elements that expired.
+      /// \param[in] _now Current time.
+      /// \param[out] _expired Elements that expired. The new elements are
+      /// appended to the vector.
+      /// \return The number of elements that expired.
+      public: size_t Advance(const Timestamp &_now, std::vector<T> &_expired)
+      {
+        size_t numExpired = 0;
+        uint64_t target = this->Tick(_now);
+
+        // Don't visit the same slot more than once per call. All the elements
+        // in a slot are checked against the target tick, so skipping complete
+        // revolutions is safe.
+        uint64_t first = this->current + 1;
+        if (target > this->current + this->slots.size())
+          first = target - this->slots.size() + 1;
+
+        for (uint64_t t = first; t <= target; ++t)
+        {
+          auto &slot = this->slots[t % this->slots.size()];
+          for (auto it = slot.begin(); it != slot.end();)
+          {
+            if (it->tick > target)
+            {
+              ++it;
+              continue;
+            }
+
+            _expired.push_back(it->value);
+            it = slot.erase(it);
+            --this->count;
+            ++numExpired;
+          }
+        }
+
+        if (target > this->current)
+          this->current = target;
+
+        // The next tick has to be searched again once it's reached.
+        if (this->nextKnown && this->next <= target)
+          this->nextKnown = false;
+
+        return numExpired;
+      }
+
+      /// \brief Get the time at which the next element will expire. The
+      /// elements that are no longer relevant for the owner count too.
+      /// The result is cached, the slots are only searched again after the
+      /// cached deadline is reached.
+      /// \param[out] _deadline Time at which the next element expires.
+      /// \return False if the wheel is empty or true otherwise.
+      public: bool NextDeadline(Timestamp &_deadline)
+      {
+        if (this->count == 0)
+          return false;
+
+        if (!this->nextKnown)
+        {
+          // Look for the first slot with an element in its current
+          // revolution. Otherwise, all the elements are beyond one
+          // revolution and the earliest one is used.
+          bool found = false;
+          uint64_t earliest = UINT64_MAX;
+          for (uint64_t t = this->current + 1;
+               !found && t <= this->current + this->slots.size(); ++t)
+          {
+            for (const auto &entry : this->slots[t % this->slots.size()])
+            {
+              if (entry.tick == t)
+              {
+                earliest = t;
+                found = true;
+                break;
+              }
+              earliest = std::min(earliest, entry.tick);
+            }
+          }
+
+          this->next = earliest;
+          this->nextKnown = true;
+        }
+
+        _deadline = this->start +
+          std::chrono::milliseconds(this->next * this->resolution);
+        return true;
+      }
+
+      /// \brief Get the number of elements stored in the wheel.
+      /// \return The number of pending elements.
+      public: size_t Size() const
+      {
+        return this->count;
+      }
+
+      /// \brief Check whether the wheel has pending elements.
+      /// \return True if there are no elements stored.
+      public: bool Empty() const
+      {
+        return this->count == 0;
+      }
+
+      /// \brief Get the time covered by each slot.
+      /// \return The resolution in milliseconds.
+      public: unsigned int Resolution() const
+      {
+        return this->resolution;
+      }
+
+      /// \brief Convert a time point into a tick of the wheel.
+      /// \param[in] _t Time point.
+      /// \return The number of ticks elapsed since the creation of the wheel.
+      private: uint64_t Tick(const Timestamp &_t) const
+      {
+        if (_t <= this->start)
+          return 0;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          _t - this->start).count();
+        return static_cast<uint64_t>(elapsed) / this->resolution;
+      }
+
+      /// \brief An element stored in the wheel.
+      private: struct Entry
+      {
+        /// \brief Tick in which the element expires.
+        uint64_t tick;
+
+        /// \brief Element stored.
+        T value;
+      };
+
+      /// \brief Time covered by each slot (milliseconds).
+      private: unsigned int resolution;
+
+      /// \brief Slots of the wheel.
+      private: std::vector<std::vector<Entry>> slots;
+
+      /// \brief Time at which the wheel was created (tick 0).
+      private: Timestamp start;
+
+      /// \brief Last tick processed.
+      private: uint64_t current = 0;
+
+      /// \brief Number of elements stored.
+      private: size_t count = 0;
+
+      /// \brief Tick of the next element to expire (valid if nextKnown).
+      private: uint64_t next = 0;
+
+      /// \brief True when next is up to date.
+      private: bool nextKnown = false;
+    };
+  }
+}
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TOPICSTATISTICS_HH_INCLUDED__
+#define __IGN_TRANSPORT_TOPICSTATISTICS_HH_INCLUDED__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ignition/transport/Helpers.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    class TopicStatisticsPrivate;
+
+    /// \class TopicStatistics TopicStatistics.hh
+    /// ignition/transport/TopicStatistics.hh
+    /// \brief Snapshot of the activity of a topic in this process since it
+    /// was first used: messages and bytes sent and received, drops, and
+    /// timing of the subscription callbacks. The rates are averages over the
+    /// whole period; the difference between two snapshots gives the rates
+    /// of the period between them.
+    class IGNITION_TRANSPORT_VISIBLE TopicStatistics
+    {
+      /// \brief Number of buckets of the callback duration histogram.
+      /// Bucket 0 counts the callbacks shorter than 1 us, bucket i counts
+      /// the callbacks in [2^(i-1), 2^i) us and the last bucket also counts
+      /// all the longer ones.
+      public: static const size_t HistogramBuckets = 20;
+
+      /// \brief Default constructor. All the values are zero.
+      public: TopicStatistics();
+
+      /// \internal
+      /// \brief Constructor from the values of a snapshot.
+      /// \param[in] _data The values.
+      public: explicit TopicStatistics(const TopicStatisticsPrivate &_data);
+
+      /// \brief Copy constructor.
+      /// \param[in] _other TopicStatistics to copy.
+      public: TopicStatistics(const TopicStatistics &_other);
+
+      /// \brief Destructor.
+      public: virtual ~TopicStatistics();
+
+      /// \brief Assignment operator.
+      /// \param[in] _other The new TopicStatistics.
+      /// \return A reference to this instance.
+      public: TopicStatistics &operator=(const TopicStatistics &_other);
+
+      /// \brief Get the number of messages published by this process.
+      /// \return Number of messages.
+      public: uint64_t SentMessages() const;
+
+      /// \brief Get the number of bytes published by this process.
+      /// \return Number of bytes (serialized messages).
+      public: uint64_t SentBytes() const;
+
+      /// \brief Get the number of messages received by this process, from
+      /// other processes or from publishers of this process.
+      /// \return Number of messages.
+      public: uint64_t ReceivedMessages() const;
+
+      /// \brief Get the number of bytes received by this process.
+      /// \return Number of bytes (serialized messages).
+      public: uint64_t ReceivedBytes() const;
+
+      /// \brief Get the number of messages dropped: messages that couldn't
+      /// be sent and messages received that no callback could handle (e.g.
+      /// type mismatch).
+      /// \return Number of messages.
+      public: uint64_t Dropped() const;
+
+      /// \brief Get the number of subscription callbacks executed.
+      /// \return Number of callbacks.
+      public: uint64_t Callbacks() const;
+
+      /// \brief Get the time elapsed since the topic was first used.
+      /// \return Time (ms.).
+      public: uint64_t Duration() const;
+
+      /// \brief Get the average rate of messages published.
+      /// \return Messages per second.
+      public: double SentRate() const;
+
+      /// \brief Get the average rate of messages received.
+      /// \return Messages per second.
+      public: double ReceivedRate() const;
+
+      /// \brief Get the mean time elapsed between the reception of a message
+      /// (or its publication, for subscribers of the same process) and the
+      /// start of its callbacks.
+      /// \return Latency (us) or 0 if no callback was executed.
+      public: double MeanLatency() const;
+
+      /// \brief Get the maximum time elapsed between the reception of a
+      /// message and the start of one of its callbacks.
+      /// \return Latency (us).
+      public: double MaxLatency() const;
+
+      /// \brief Get the histogram of the duration of the callbacks.
+      /// \return Number of callbacks in each bucket (see HistogramBuckets).
+      public: std::vector<uint64_t> CallbackDurations() const;
+
+      /// \internal
+      /// \brief Smart pointer to private data.
+      protected: std::unique_ptr<transport::TopicStatisticsPrivate> dataPtr;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef __IGN_TRANSPORT_TOPICSTATISTICSPRIVATE_HH_INCLUDED__
+#define __IGN_TRANSPORT_TOPICSTATISTICSPRIVATE_HH_INCLUDED__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/TopicStatistics.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    /// \class TopicStatisticsPrivate TopicStatisticsPrivate.hh
+    ///     ignition/transport/TopicStatisticsPrivate.hh
+    /// \brief Private data for the TopicStatistics class.
+    class IGNITION_TRANSPORT_VISIBLE TopicStatisticsPrivate
+    {
+      /// \brief Constructor.
+      public: TopicStatisticsPrivate() = default;
+
+      /// \brief Destructor.
+      public: virtual ~TopicStatisticsPrivate() = default;
+
+      /// \brief Messages published.
+      public: uint64_t sentMsgs = 0;
+
+      /// \brief Bytes published.
+      public: uint64_t sentBytes = 0;
+
+      /// \brief Messages received.
+      public: uint64_t recvMsgs = 0;
+
+      /// \brief Bytes received.
+      public: uint64_t recvBytes = 0;
+
+      /// \brief Messages dropped.
+      public: uint64_t dropped = 0;
+
+      /// \brief Callbacks executed.
+      public: uint64_t callbacks = 0;
+
+      /// \brief Time elapsed since the topic was first used (ns).
+      public: uint64_t duration = 0;
+
+      /// \brief Sum of the latencies before the callbacks (ns).
+      public: uint64_t latencySum = 0;
+
+      /// \brief Maximum latency before a callback (ns).
+      public: uint64_t latencyMax = 0;
+
+      /// \brief Callback duration histogram.
+      public: std::vector<uint64_t> histogram =
+        std::vector<uint64_t>(TopicStatistics::HistogramBuckets, 0);
+    };
+
+    /// \class TopicCounters TopicStatisticsPrivate.hh
+    ///     ignition/transport/TopicStatisticsPrivate.hh
+    /// \brief Counters of the activity of a topic, updated with atomic
+    /// operations, so the publication and reception paths don't need any
+    /// extra lock.
+    class IGNITION_TRANSPORT_VISIBLE TopicCounters
+    {
+      /// \brief Constructor.
+      public: TopicCounters();
+
+      /// \brief Count a message published.
+      /// \param[in] _bytes Size of the serialized message.
+      public: void AddSent(const uint64_t _bytes);
+
+      /// \brief Count a message received.
+      /// \param[in] _bytes Size of the serialized message.
+      public: void AddReceived(const uint64_t _bytes);
+
+      /// \brief Count a message dropped.
+      public: void AddDropped();
+
+      /// \brief Count a callback executed.
+      /// \param[in] _latency Time between the reception of the message and
+      /// the start of the callback (ns).
+      /// \param[in] _duration Duration of the callback (ns).
+      public: void AddCallback(const int64_t _latency,
+                               const int64_t _duration);
+
+      /// \brief Get a snapshot of the counters.
+      /// \return The statistics.
+      public: TopicStatistics Snapshot() const;
+
+      /// \brief Current time of the steady clock in nanoseconds.
+      /// \return The time.
+      public: static int64_t Now();
+
+      /// \brief Messages published.
+      private: std::atomic<uint64_t> sentMsgs;
+
+      /// \brief Bytes published.
+      private: std::atomic<uint64_t> sentBytes;
+
+      /// \brief Messages received.
+      private: std::atomic<uint64_t> recvMsgs;
+
+      /// \brief Bytes received.
+      private: std::atomic<uint64_t> recvBytes;
+
+      /// \brief Messages dropped.
+      private: std::atomic<uint64_t> dropped;
+
+      /// \brief Callbacks executed.
+      private: std::atomic<uint64_t> callbacks;
+
+      /// \brief Sum of the latencies before the callbacks (ns).
+      private: std::atomic<uint64_t> latencySum;
+
+      /// \brief Maximum latency before a callback (ns).
+      private: std::atomic<uint64_t> latencyMax;
+
+      /// \brief Callback duration histogram.
+      private: std::array<std::atomic<uint64_t>,
+        TopicStatistics::HistogramBuckets> histogram;
+
+      /// \brief Time when the counters were created (ns).
+      private: const int64_t start;
+    };
+  }
+}
+
+#endif
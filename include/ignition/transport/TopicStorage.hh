@@ -20,12 +20,14 @@
 
 #include <algorithm>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "ignition/transport/Helpers.hh"
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
 
 namespace ignition
 {
@@ -43,30 +45,35 @@ namespace ignition
       public: virtual ~TopicStorage() = default;
 
       /// \brief Add a new address associated to a given topic and node UUID.
+      /// The process and node UUIDs of the publisher must be the string
+      /// representation of a Uuid, otherwise the publisher is not stored.
       /// \param[in] _publisher New publisher.
       /// \return true if the new entry is added or false if not (because it
-      /// was already stored).
+      /// was already stored or its process or node UUID is not valid).
       public: bool AddPublisher(const T &_publisher)
       {
+        const Uuid &pUuid = _publisher.ProcessUuid();
+        if (pUuid.IsNil() || _publisher.NodeUuid().IsNil())
+          return false;
+
         // The topic does not exist.
         if (this->data.find(_publisher.Topic()) == this->data.end())
         {
           // VS2013 is buggy with initializer list here {}
-          this->data[_publisher.Topic()] =
-            std::map<std::string, std::vector<T>>();
+          this->data[_publisher.Topic()] = std::map<Uuid, std::vector<T>>();
         }
 
         // Check if the process uuid exists.
         auto &m = this->data[_publisher.Topic()];
-        if (m.find(_publisher.PUuid()) != m.end())
+        if (m.find(pUuid) != m.end())
         {
           // Check that the Publisher does not exist.
-          auto &v = m[_publisher.PUuid()];
+          auto &v = m[pUuid];
           auto found = std::find_if(v.begin(), v.end(),
             [&](const T &_pub)
             {
-              return _pub.Addr()  == _publisher.Addr() &&
-                     _pub.NUuid() == _publisher.NUuid();
+              return _pub.Addr()     == _publisher.Addr() &&
+                     _pub.NodeUuid() == _publisher.NodeUuid();
             });
 
           // The publisher was already existing, just exit.
@@ -75,7 +82,11 @@ namespace ignition
         }
 
         // Add a new Publisher entry.
-        m[_publisher.PUuid()].push_back(T(_publisher));
+        m[pUuid].push_back(T(_publisher));
+
+        // Update the reverse indices.
+        this->procTopics[pUuid].insert(_publisher.Topic());
+        ++this->addrRefs[_publisher.Addr()];
         return true;
       }
 
@@ -95,6 +106,18 @@ namespace ignition
       /// process UUID.
       public: bool HasAnyPublishers(const std::string &_topic,
                                     const std::string &_pUuid) const
+      {
+        return this->HasAnyPublishers(_topic, Uuid(_pUuid));
+      }
+
+      /// \brief Return if there is any publisher stored for the given topic and
+      /// process UUID.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _pUuid Process UUID of the publisher.
+      /// \return True if there is at least one address stored for the topic and
+      /// process UUID.
+      public: bool HasAnyPublishers(const std::string &_topic,
+                                    const Uuid &_pUuid) const
       {
         if (!this->HasTopic(_topic))
           return false;
@@ -108,18 +131,7 @@ namespace ignition
       /// \return true if the publisher's address is stored.
       public: bool HasPublisher(const std::string &_addr) const
       {
-        for (auto &topic : this->data)
-        {
-          for (auto &proc : topic.second)
-          {
-            for (auto &pub : proc.second)
-            {
-              if (pub.Addr() == _addr)
-                return true;
-            }
-          }
-        }
-        return false;
+        return this->addrRefs.find(_addr) != this->addrRefs.end();
       }
 
       /// \brief Get the address information for a given topic and node UUID.
@@ -132,6 +144,20 @@ namespace ignition
                              const std::string &_pUuid,
                              const std::string &_nUuid,
                              T &_publisher) const
+      {
+        return this->Publisher(_topic, Uuid(_pUuid), Uuid(_nUuid), _publisher);
+      }
+
+      /// \brief Get the address information for a given topic and node UUID.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _pUuid Process UUID of the publisher.
+      /// \param[in] _nUuid Node UUID of the publisher.
+      /// \param[out] _publisher Publisher's information requested.
+      /// \return true if a publisher is found for the given topic and UUID pair
+      public: bool Publisher(const std::string &_topic,
+                             const Uuid &_pUuid,
+                             const Uuid &_nUuid,
+                             T &_publisher) const
       {
         // Topic not found.
         if (this->data.find(_topic) == this->data.end())
@@ -149,7 +175,7 @@ namespace ignition
         auto found = std::find_if(v.begin(), v.end(),
           [&](const T &_pub)
           {
-            return _pub.NUuid() == _nUuid;
+            return _pub.NodeUuid() == _nUuid;
           });
         // Address found!
         if (found != v.end())
@@ -164,7 +190,8 @@ namespace ignition
 
       /// \brief Get the map of publishers stored for a given topic.
       /// \param[in] _topic Topic name.
-      /// \param[out] _info Map of publishers requested.
+      /// \param[out] _info Map of publishers requested. The keys are the
+      /// process UUIDs in string format.
       /// \return true if at least there is one publisher stored.
       public: bool Publishers(const std::string &_topic,
                              std::map<std::string, std::vector<T>> &_info) const
@@ -172,7 +199,9 @@ namespace ignition
         if (!this->HasTopic(_topic))
           return false;
 
-        _info = this->data.at(_topic);
+        _info.clear();
+        for (const auto &proc : this->data.at(_topic))
+          _info[proc.first.ToString()] = proc.second;
         return true;
       }
 
@@ -184,6 +213,18 @@ namespace ignition
       public: bool DelPublisherByNode(const std::string &_topic,
                                       const std::string &_pUuid,
                                       const std::string &_nUuid)
+      {
+        return this->DelPublisherByNode(_topic, Uuid(_pUuid), Uuid(_nUuid));
+      }
+
+      /// \brief Remove a publisher associated to a given topic and UUID pair.
+      /// \param[in] _topic Topic name
+      /// \param[in] _pUuid Process UUID of the publisher.
+      /// \param[in] _nUuid Node UUID of the publisher.
+      /// \return True when the publisher was removed or false otherwise.
+      public: bool DelPublisherByNode(const std::string &_topic,
+                                      const Uuid &_pUuid,
+                                      const Uuid &_nUuid)
       {
         size_t counter = 0;
 
@@ -199,17 +240,29 @@ namespace ignition
             // Vector of 0MQ known addresses for a given topic and pUuid.
             auto &v = m[_pUuid];
             auto priorSize = v.size();
-            v.erase(std::remove_if(v.begin(), v.end(),
+            // The publishers removed are moved to the end. Unlike
+            // std::remove_if(), their values are preserved, so the references
+            // to their addresses can be released.
+            auto last = std::stable_partition(v.begin(), v.end(),
               [&](const T &_pub)
               {
-                return _pub.NUuid() == _nUuid;
-              }),
-              v.end());
+                return _pub.NodeUuid() != _nUuid;
+              });
+            for (auto it = last; it != v.end(); ++it)
+              this->DelAddrRef(it->Addr());
+            v.erase(last, v.end());
             counter = priorSize - v.size();
 
             if (v.empty())
+            {
               m.erase(_pUuid);
 
+              auto &topics = this->procTopics[_pUuid];
+              topics.erase(_topic);
+              if (topics.empty())
+                this->procTopics.erase(_pUuid);
+            }
+
             if (m.empty())
               this->data.erase(_topic);
           }
@@ -223,21 +276,33 @@ namespace ignition
       /// \return True when at least one address was removed or false otherwise.
       public: bool DelPublishersByProc(const std::string &_pUuid)
       {
-        size_t counter = 0;
+        return this->DelPublishersByProc(Uuid(_pUuid));
+      }
 
-        // Iterate over all the topics.
-        for (auto it = this->data.begin(); it != this->data.end();)
+      /// \brief Remove all the publishers associated to a given process.
+      /// \param[in] _pUuid Process' UUID of the publisher.
+      /// \return True when at least one address was removed or false otherwise.
+      public: bool DelPublishersByProc(const Uuid &_pUuid)
+      {
+        auto procIt = this->procTopics.find(_pUuid);
+        if (procIt == this->procTopics.end())
+          return false;
+
+        // Iterate over the topics of the process.
+        for (auto &topic : procIt->second)
         {
           // m is {pUUID=>Publisher}.
-          auto &m = it->second;
-          counter += m.erase(_pUuid);
+          auto &m = this->data[topic];
+          for (auto &pub : m[_pUuid])
+            this->DelAddrRef(pub.Addr());
+
+          m.erase(_pUuid);
           if (m.empty())
-            this->data.erase(it++);
-          else
-            ++it;
+            this->data.erase(topic);
         }
 
-        return counter > 0;
+        this->procTopics.erase(procIt);
+        return true;
       }
 
       /// \brief Given a process UUID, the function returns the list of
@@ -247,22 +312,31 @@ namespace ignition
       /// and the value is its address information.
       public: void PublishersByProc(const std::string &_pUuid,
                              std::map<std::string, std::vector<T>> &_pubs) const
+      {
+        this->PublishersByProc(Uuid(_pUuid), _pubs);
+      }
+
+      /// \brief Given a process UUID, the function returns the list of
+      /// publishers contained in this process UUID with its address information
+      /// \param[in] _pUuid Process UUID.
+      /// \param[out] _pubs Map of publishers where the keys are the node UUIDs
+      /// and the value is its address information.
+      public: void PublishersByProc(const Uuid &_pUuid,
+                             std::map<std::string, std::vector<T>> &_pubs) const
       {
         _pubs.clear();
 
-        // Iterate over all the topics.
-        for (auto &topic : this->data)
+        auto procIt = this->procTopics.find(_pUuid);
+        if (procIt == this->procTopics.end())
+          return;
+
+        // Iterate over the topics of the process.
+        for (auto &topic : procIt->second)
         {
           // m is {pUUID=>Publisher}.
-          auto &m = topic.second;
-          if (m.find(_pUuid) != m.end())
-          {
-            auto &v = m.at(_pUuid);
-            for (auto &pub : v)
-            {
-              _pubs[topic.first].push_back(T(pub));
-            }
-          }
+          auto &v = this->data.at(topic).at(_pUuid);
+          for (auto &pub : v)
+            _pubs[topic].push_back(T(pub));
         }
       }
 
@@ -294,10 +368,26 @@ namespace ignition
         }
       }
 
+      /// \brief Decrease the number of publishers using an address.
+      /// \param[in] _addr Publisher's address.
+      private: void DelAddrRef(const std::string &_addr)
+      {
+        auto it = this->addrRefs.find(_addr);
+        if (it != this->addrRefs.end() && --it->second == 0)
+          this->addrRefs.erase(it);
+      }
+
       /// \brief  The keys are topics. The values are another map, where the key
       /// is the process UUID and the value a vector of publishers.
-      private: std::map<std::string,
-                        std::map<std::string, std::vector<T>>> data;
+      private: std::map<std::string, std::map<Uuid, std::vector<T>>> data;
+
+      /// \brief Reverse index of 'data'. The keys are process UUIDs and the
+      /// values are the topics with at least one publisher in the process.
+      private: std::map<Uuid, std::set<std::string>> procTopics;
+
+      /// \brief Reverse index of 'data'. The keys are publisher addresses and
+      /// the values are the number of publishers using each address.
+      private: std::map<std::string, size_t> addrRefs;
     };
   }
 }
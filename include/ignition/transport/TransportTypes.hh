@@ -115,6 +115,15 @@ namespace ignition
     using SrvDiscoveryCallback =
       std::function<void(const ServicePublisher &_publisher)>;
 
+    /// \def StreamChunkCallback
+    /// \brief Function used by a streaming service to send each serialized
+    /// response chunk. '_last' is true for the final chunk, that also carries
+    /// the result of the service call. Streaming services close the stream
+    /// with an empty final chunk. It returns false when the stream has been
+    /// cancelled and no more chunks should be sent.
+    using StreamChunkCallback = std::function<bool(const std::string &_chunk,
+      const bool _last, const bool _result)>;
+
     /// \def Timestamp
     /// \brief Used to evaluate the validity of a discovery entry.
     using Timestamp = std::chrono::steady_clock::time_point;
@@ -18,6 +18,9 @@
 #ifndef __IGN_TRANSPORT_UUID_HH_INCLUDED__
 #define __IGN_TRANSPORT_UUID_HH_INCLUDED__
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
 
@@ -37,19 +40,60 @@ namespace ignition
   namespace transport
   {
     /// \class Uuid Uuid.hh ignition/transport/Uuid.hh
-    /// \brief A portable class for representing a Universally Unique Identifier
+    /// \brief A portable class for representing a Universally Unique
+    /// Identifier. It's a comparable and hashable value that can be used as a
+    /// key of a map and is serialized as 16 bytes (network byte order).
     class IGNITION_TRANSPORT_VISIBLE Uuid
     {
-      /// \brief Constructor.
+      /// \brief Constructor. Generates a new random UUID.
       public: Uuid();
 
-      /// \brief Destructor.
-      public: virtual ~Uuid();
+      /// \brief Constructor from the string representation of a UUID.
+      /// \param[in] _str UUID in string format. If the string is not a valid
+      /// UUID, the nil UUID (all zeros) is created.
+      /// \sa IsNil.
+      public: explicit Uuid(const std::string &_str);
 
       /// \brief Return the string representation of the Uuid.
       /// \return the UUID in string format.
       public: std::string ToString() const;
 
+      /// \brief Check if this is the nil UUID (all zeros).
+      /// \return True if the UUID is nil.
+      public: bool IsNil() const;
+
+      /// \brief Serialize the UUID.
+      /// \param[out] _buffer Destination buffer of ByteLength bytes.
+      /// \return Number of bytes serialized or 0 if the buffer is NULL.
+      public: size_t Pack(char *_buffer) const;
+
+      /// \brief Unserialize the UUID.
+      /// \param[in] _buffer Source buffer of ByteLength bytes.
+      /// \return Number of bytes read or 0 if the buffer is NULL.
+      public: size_t Unpack(const char *_buffer);
+
+      /// \brief Get a hash value of the UUID.
+      /// \return The hash value.
+      public: size_t Hash() const;
+
+      /// \brief Equality operator.
+      /// \param[in] _other UUID to compare.
+      /// \return True if both UUIDs are equal.
+      public: bool operator==(const Uuid &_other) const;
+
+      /// \brief Inequality operator.
+      /// \param[in] _other UUID to compare.
+      /// \return True if the UUIDs are different.
+      public: bool operator!=(const Uuid &_other) const;
+
+      /// \brief Less than operator, for using the UUID as a key.
+      /// \param[in] _other UUID to compare.
+      /// \return True if this UUID is ordered before _other.
+      public: bool operator<(const Uuid &_other) const;
+
+      /// \brief Length of a serialized UUID.
+      public: static const size_t ByteLength = 16;
+
       /// \brief Stream insertion operator.
       /// \param[out] _out The output stream.
       /// \param[in] _uuid UUID to write to the stream.
@@ -68,9 +112,25 @@ namespace ignition
       /// To summarize: 36 octets + \0 = 37 octets.
       private: static const int UuidStrLen = 37;
 
-      /// \brief Internal representation.
-      private: portable_uuid_t data;
+      /// \brief Internal representation (network byte order).
+      private: unsigned char data[ByteLength];
     };
   }
 }
+
+namespace std
+{
+  /// \brief Hash function for using a Uuid in the unordered containers.
+  template<>
+  struct hash<ignition::transport::Uuid>
+  {
+    /// \brief Get the hash value of a UUID.
+    /// \param[in] _uuid The UUID.
+    /// \return The hash value.
+    size_t operator()(const ignition::transport::Uuid &_uuid) const
+    {
+      return _uuid.Hash();
+    }
+  };
+}
 #endif
@@ -0,0 +1,1996 @@
+/*
+ * Copyright (C) 2014 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _WIN32
+  // For socket(), connect(), send(), and recv().
+  #include <Winsock2.h>
+  #include <Ws2def.h>
+  #include <Ws2ipdef.h>
+  #include <Ws2tcpip.h>
+#else
+  // For inet_addr()
+  #include <arpa/inet.h>
+  // For opendir() and readdir()
+  #include <dirent.h>
+  // For sockaddr_in
+  #include <netinet/in.h>
+  // For socket(), connect(), send(), and recv()
+  #include <sys/socket.h>
+  // For mkdir() and chmod()
+  #include <sys/stat.h>
+  #include <sys/types.h>
+  // For sockaddr_un
+  #include <sys/un.h>
+  // For close()
+  #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+  #pragma warning(push, 0)
+#endif
+#include <zmq.hpp>
+#ifdef _WIN32
+  #pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/NetUtils.hh"
+#include "ignition/transport/Packet.hh"
+
+using namespace ignition;
+using namespace transport;
+
+#ifndef _WIN32
+namespace
+{
+  /// \brief Get the address of the local socket of a process.
+  /// \param[in] _dir Directory of the local registry.
+  /// \param[in] _pUuid Process UUID.
+  /// \param[out] _addr Address of the socket.
+  /// \return True if the address is valid or false if the path is too
+  /// long.
+  bool localAddr(const std::string &_dir, const std::string &_pUuid,
+    sockaddr_un &_addr)
+  {
+    std::string path = _dir + "/" + _pUuid;
+    if (path.size() >= sizeof(_addr.sun_path))
+      return false;
+
+    memset(&_addr, 0, sizeof(_addr));
+    _addr.sun_family = AF_UNIX;
+    memcpy(_addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+  }
+
+  /// \brief Check if an entry of the local registry is a socket of a
+  /// process of this user named after its process UUID.
+  /// \param[in] _dir Directory of the local registry.
+  /// \param[in] _name Name of the entry.
+  /// \return True if the entry is a valid socket of the registry.
+  bool isLocalSocket(const std::string &_dir, const std::string &_name)
+  {
+    Uuid uuid(_name);
+    if (uuid.IsNil() || uuid.ToString() != _name)
+      return false;
+
+    struct stat info;
+    std::string path = _dir + "/" + _name;
+    return lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode) &&
+           info.st_uid == geteuid();
+  }
+}
+#endif
+
+//////////////////////////////////////////////////
+DiscoveryEngine::DiscoveryEngine(const std::string &_pUuid,
+                                 const int _port,
+                                 const bool _verbose)
+  : port(_port),
+    hostAddr(determineHost()),
+    pUuid(_pUuid),
+    processUuid(_pUuid),
+    silenceInterval(kDefSilenceInterval),
+    activityInterval(kDefActivityInterval),
+    heartbeatInterval(kDefHeartbeatInterval),
+    stateVersion(0),
+    verbose(_verbose),
+    initialized(false),
+    exit(false),
+    enabled(false),
+    randGenerator(std::random_device {}())
+{
+  std::string ignIp;
+  if (env("IGN_IP", ignIp) && !ignIp.empty())
+    this->hostInterfaces = {ignIp};
+  else
+  {
+    // Get the list of network interfaces in this host.
+    this->hostInterfaces = determineInterfaces();
+  }
+
+#ifdef _WIN32
+  WORD wVersionRequested;
+  WSADATA wsaData;
+
+  // Request WinSock v2.2.
+  wVersionRequested = MAKEWORD(2, 2);
+  // Load WinSock DLL.
+  if (WSAStartup(wVersionRequested, &wsaData) != 0)
+  {
+    std::cerr << "Unable to load WinSock DLL" << std::endl;
+    return;
+  }
+#endif
+  for (const auto &netIface : this->hostInterfaces)
+  {
+    auto succeed = this->RegisterNetIface(netIface);
+
+    // If the IP address that we're selecting as the main IP address of
+    // the host is invalid, we change it to 127.0.0.1 .
+    // This is probably because IGN_IP is set to a wrong value.
+    if (netIface == this->hostAddr && !succeed)
+    {
+      this->RegisterNetIface("127.0.0.1");
+      std::cerr << "Did you set the environment variable IGN_IP with a "
+                << "correct IP address? " << std::endl
+                << "  [" << netIface << "] seems an invalid local IP "
+                << "address." << std::endl
+                << "  Using 127.0.0.1 as hostname." << std::endl;
+      this->hostAddr = "127.0.0.1";
+    }
+  }
+
+  // Socket option: SO_REUSEADDR. This options is used only for receiving
+  // data. We can reuse the same socket for receiving multicast data from
+  // multiple interfaces. We will use the socket at position 0 for
+  // receiving data.
+  int reuseAddr = 1;
+  if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_REUSEADDR,
+      reinterpret_cast<const char *>(&reuseAddr), sizeof(reuseAddr)) != 0)
+  {
+    std::cerr << "Error setting socket option (SO_REUSEADDR)."
+              << std::endl;
+    return;
+  }
+
+#ifdef SO_REUSEPORT
+  // Socket option: SO_REUSEPORT. This options is used only for receiving
+  // data. We can reuse the same socket for receiving multicast data from
+  // multiple interfaces. We will use the socket at position 0 for
+  // receiving data.
+  int reusePort = 1;
+  if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_REUSEPORT,
+      reinterpret_cast<const char *>(&reusePort), sizeof(reusePort)) != 0)
+  {
+    std::cerr << "Error setting socket option (SO_REUSEPORT)."
+              << std::endl;
+    return;
+  }
+#endif
+  // Bind the first socket to the discovery port.
+  sockaddr_in localAddr;
+  memset(&localAddr, 0, sizeof(localAddr));
+  localAddr.sin_family = AF_INET;
+  localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+  localAddr.sin_port = htons(static_cast<u_short>(this->port));
+
+  if (bind(this->sockets.at(0),
+    reinterpret_cast<sockaddr *>(&localAddr), sizeof(sockaddr_in)) < 0)
+  {
+    std::cerr << "Binding to a local port failed." << std::endl;
+    return;
+  }
+
+  // Set 'mcastAddr' to the multicast discovery group.
+  memset(&this->mcastAddr, 0, sizeof(this->mcastAddr));
+  this->mcastAddr.sin_family = AF_INET;
+  this->mcastAddr.sin_addr.s_addr =
+    inet_addr(this->kMulticastGroup.c_str());
+  this->mcastAddr.sin_port = htons(static_cast<u_short>(this->port));
+
+  // Socket option: SO_RCVBUF. The default receive buffer overflows when
+  // many processes start at the same time.
+  this->SetReceiveBufferSize(kDefRcvBufSize);
+
+#ifdef SO_RXQ_OVFL
+  // Socket option: SO_RXQ_OVFL. The kernel attaches to each datagram
+  // the number of datagrams dropped because the receive buffer was full.
+  int rxqOvfl = 1;
+  if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_RXQ_OVFL,
+      reinterpret_cast<const char *>(&rxqOvfl), sizeof(rxqOvfl)) != 0 &&
+      this->verbose)
+  {
+    std::cerr << "Error setting socket option (SO_RXQ_OVFL)."
+              << std::endl;
+  }
+#endif
+
+  // Room for a batch of datagrams. The pages are only touched when the
+  // datagrams arrive.
+  this->rcvBuffer.reset(new char[kMaxDatagramBatch * kMaxRcvStr]);
+
+  // Start the thread that sends the messages over the send rate.
+#ifdef _WIN32
+  this->threadSenderExiting = false;
+#endif
+  this->threadSender = std::thread(&DiscoveryEngine::RunSender, this);
+#ifdef _WIN32
+  this->threadSender.detach();
+#endif
+
+#ifndef _WIN32
+  this->RegisterLocal();
+#endif
+
+  if (this->verbose)
+    this->PrintCurrentState();
+}
+
+//////////////////////////////////////////////////
+DiscoveryEngine::~DiscoveryEngine()
+{
+  // Tell the service thread to terminate.
+  this->exitMutex.lock();
+  this->exit = true;
+  this->exitMutex.unlock();
+
+  // Don't join on Windows, because it can hang when this object
+  // is destructed on process exit (e.g., when it's a global static).
+  // I think that it's due to this bug:
+  // https://connect.microsoft.com/VisualStudio/feedback/details/747145/std-thread-join-hangs-if-called-after-main-exits-when-using-vs2012-rc
+#ifndef _WIN32
+  // Wait for the service threads to finish before exit.
+  if (this->threadReception.joinable())
+    this->threadReception.join();
+#else
+  bool exitLoop = false;
+  while (!exitLoop)
+  {
+    std::lock_guard<std::mutex> lock(this->exitMutex);
+    {
+      if (this->threadReceptionExiting)
+      {
+        exitLoop = true;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+#endif
+
+  // Tell the event thread to terminate. The events still queued are
+  // discarded.
+  {
+    std::lock_guard<std::mutex> lock(this->eventsMutex);
+    this->eventsExit = true;
+  }
+  this->eventsCv.notify_all();
+#ifndef _WIN32
+  if (this->threadEvents.joinable())
+    this->threadEvents.join();
+#else
+  exitLoop = false;
+  while (!exitLoop)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->eventsMutex);
+      exitLoop = this->threadEventsExiting;
+    }
+    if (!exitLoop)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+#endif
+
+  // Broadcast a BYE message to trigger the remote cancellation of
+  // all our advertised topics.
+  this->SendMsg(ByeType,
+    Publisher("", "", this->pUuid, "", Scope_t::ALL),
+    this->stateVersion);
+
+  // Send the messages still queued, BYE included.
+  {
+    std::lock_guard<std::mutex> lock(this->sendRateMutex);
+    this->sendExit = true;
+  }
+  this->sendCv.notify_all();
+#ifndef _WIN32
+  if (this->threadSender.joinable())
+    this->threadSender.join();
+#else
+  exitLoop = false;
+  while (!exitLoop)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->sendRateMutex);
+      exitLoop = this->threadSenderExiting;
+    }
+    if (!exitLoop)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+#endif
+
+  // Close sockets.
+  for (const auto &sock : this->sockets)
+  {
+#ifdef _WIN32
+    closesocket(sock);
+    WSACleanup();
+#else
+    close(sock);
+#endif
+  }
+
+#ifndef _WIN32
+  // Deliver the BYE message to the local processes too.
+  {
+    std::lock_guard<std::mutex> lock(this->localSendMutex);
+    this->localSendExit = true;
+  }
+  this->localSendCv.notify_all();
+  if (this->threadLocalSender.joinable())
+    this->threadLocalSender.join();
+
+  // Leave the local registry.
+  if (this->localSocket >= 0)
+  {
+    close(this->localSocket);
+    sockaddr_un addr;
+    if (localAddr(this->localDir, this->pUuid, addr))
+      unlink(addr.sun_path);
+  }
+#endif
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::Start()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // The service is already running.
+    if (this->enabled)
+      return;
+
+    this->enabled = true;
+  }
+
+  uint32_t version;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    // Start at a random phase of the heartbeat cycle, so the processes
+    // launched together don't send their heartbeats at the same time.
+    this->timeNextHeartbeat = now +
+      this->RandomDuration(0, this->heartbeatInterval);
+    this->timeNextActivity = now;
+    this->timeQuery = now;
+    this->timeInitDeadline = now +
+      std::chrono::milliseconds(kMinInitWait);
+    version = this->stateVersion;
+  }
+
+  // Start the thread that executes the discovery callbacks.
+  this->threadEvents =
+    std::thread(&DiscoveryEngine::DispatchEvents, this);
+
+  // Start the thread that receives discovery information.
+  this->threadReception =
+    std::thread(&DiscoveryEngine::RecvMessages, this);
+
+#ifdef _WIN32
+  this->threadEventsExiting = false;
+  this->threadEvents.detach();
+  this->threadReceptionExiting = false;
+  this->threadReception.detach();
+#endif
+
+  // Ask the existing processes for their state instead of waiting for
+  // their heartbeats.
+  this->SendMsg(QueryType,
+    Publisher("", "", this->pUuid, "", Scope_t::ALL), version);
+}
+
+//////////////////////////////////////////////////
+std::string DiscoveryEngine::HostAddr() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hostAddr;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::AddStaticPeer(const std::string &_addr)
+{
+  std::string ip;
+  int peerPort;
+  if (!parseAddress(_addr, this->port, ip, peerPort))
+  {
+    std::cerr << "Discovery::AddStaticPeer() error: Invalid address ["
+              << _addr << "]" << std::endl;
+    return false;
+  }
+
+  sockaddr_in peerAddr;
+  memset(&peerAddr, 0, sizeof(peerAddr));
+  peerAddr.sin_family = AF_INET;
+  peerAddr.sin_addr.s_addr = inet_addr(ip.c_str());
+  peerAddr.sin_port = htons(static_cast<u_short>(peerPort));
+
+  std::lock_guard<std::mutex> lock(this->staticPeersMutex);
+  this->staticPeers.push_back(peerAddr);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::SetReceiveBufferSize(const int _size)
+{
+  if (_size <= 0 || this->sockets.empty())
+    return false;
+
+  if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_RCVBUF,
+      reinterpret_cast<const char *>(&_size), sizeof(_size)) != 0)
+  {
+    std::cerr << "Error setting socket option (SO_RCVBUF)." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+int DiscoveryEngine::ReceiveBufferSize() const
+{
+  int size = -1;
+  socklen_t len = sizeof(size);
+  if (this->sockets.empty() ||
+      getsockopt(this->sockets.at(0), SOL_SOCKET, SO_RCVBUF,
+        reinterpret_cast<char *>(&size), &len) != 0)
+  {
+    return -1;
+  }
+
+  return size;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::DroppedDatagrams() const
+{
+  return this->droppedDatagrams;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::DroppedLocalDatagrams() const
+{
+  return this->droppedLocalDatagrams;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::DroppedSendDatagrams() const
+{
+  return this->droppedSendDatagrams;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::SentDatagrams() const
+{
+  return this->sentDatagrams;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::SentBytes() const
+{
+  return this->sentBytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::ReceivedDatagrams() const
+{
+  return this->receivedDatagrams;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryEngine::ReceivedBytes() const
+{
+  return this->receivedBytes;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SetMaxSendRate(const unsigned int _rate)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->sendRateMutex);
+    this->maxSendRate = _rate;
+    this->sendTokens = this->SendBurst();
+    this->timeLastRefill = std::chrono::steady_clock::now();
+  }
+  this->sendCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoveryEngine::MaxSendRate() const
+{
+  std::lock_guard<std::mutex> lock(this->sendRateMutex);
+  return this->maxSendRate;
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoveryEngine::ActivityInterval() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->activityInterval;
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoveryEngine::HeartbeatInterval() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->heartbeatInterval;
+}
+
+//////////////////////////////////////////////////
+unsigned int DiscoveryEngine::SilenceInterval() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->silenceInterval;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SetActivityInterval(const unsigned int _ms)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->activityInterval = _ms;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SetHeartbeatInterval(const unsigned int _ms)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->heartbeatInterval = _ms;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SetSilenceInterval(const unsigned int _ms)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->silenceInterval = _ms;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::PeerDisconnected(const std::string &_pUuid)
+{
+  return this->PeerDisconnected(Uuid(_pUuid));
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::PeerDisconnected(const Uuid &_pUuid)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (_pUuid == this->processUuid ||
+      this->activity.find(_pUuid) == this->activity.end())
+  {
+    return false;
+  }
+
+  this->RemovePeer(_pUuid);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::PeerActive(const std::string &_pUuid) const
+{
+  Uuid pUuid(_pUuid);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->activity.find(pUuid) != this->activity.end();
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::PrintCurrentState() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  std::cout << "---------------" << std::endl;
+  std::cout << std::boolalpha << "Enabled: "
+            << this->enabled << std::endl;
+  std::cout << "Discovery state" << std::endl;
+  std::cout << "\tUUID: " << this->pUuid << std::endl;
+  std::cout << "Settings" << std::endl;
+  std::cout << "\tActivity: " << this->activityInterval
+            << " ms." << std::endl;
+  std::cout << "\tHeartbeat: " << this->heartbeatInterval
+            << "ms." << std::endl;
+  std::cout << "\tSilence: " << this->silenceInterval
+            << " ms." << std::endl;
+  std::cout << "Known topics: " << std::endl;
+  this->Store<MessagePublisher>().info.Print();
+  std::cout << "Known services: " << std::endl;
+  this->Store<ServicePublisher>().info.Print();
+
+  // Used to calculate the elapsed time.
+  Timestamp now = std::chrono::steady_clock::now();
+
+  std::cout << "Activity" << std::endl;
+  if (this->activity.empty())
+    std::cout << "\t<empty>" << std::endl;
+  else
+  {
+    for (auto &proc : this->activity)
+    {
+      // Elapsed time since the last update from this publisher.
+      std::chrono::duration<double> elapsed = now - proc.second;
+
+      std::cout << "\t" << proc.first << std::endl;
+      std::cout << "\t\t" << "Since: " << std::chrono::duration_cast<
+        std::chrono::milliseconds>(elapsed).count() << " ms. ago. "
+        << std::endl;
+    }
+  }
+  std::cout << "---------------" << std::endl;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::WaitForInit() const
+{
+  std::unique_lock<std::mutex> lk(this->mutex);
+
+  if (!this->initialized)
+  {
+    this->initializedCv.wait(lk, [this]{return this->initialized;});
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateActivity()
+{
+  Timestamp now = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (now < this->timeNextActivity)
+    return;
+
+  std::vector<Uuid> expired;
+  for (const auto &proc : this->activity)
+  {
+    // Elapsed time since the last update from this publisher.
+    auto elapsed = now - proc.second;
+
+    // This publisher has expired.
+    if (std::chrono::duration_cast<std::chrono::milliseconds>
+         (elapsed).count() > this->silenceInterval)
+    {
+      expired.push_back(proc.first);
+    }
+  }
+
+  for (const auto &proc : expired)
+    this->RemovePeer(proc);
+
+  // Forget the local messages that can't be duplicated anymore.
+  auto window = std::chrono::milliseconds(kLocalDuplicateWindow);
+  for (auto it = this->recentLocalMsgs.begin();
+       it != this->recentLocalMsgs.end();)
+  {
+    if (it->second.empty() || now - it->second.back().second > window)
+      it = this->recentLocalMsgs.erase(it);
+    else
+      ++it;
+  }
+
+  this->timeNextActivity = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(this->activityInterval);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RemovePeer(const Uuid &_pUuid)
+{
+  this->activity.erase(_pUuid);
+  this->peers.erase(_pUuid);
+  this->localPeers.erase(_pUuid);
+  this->RemovePublishers<MessagePublisher>(_pUuid);
+  this->RemovePublishers<ServicePublisher>(_pUuid);
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::DuplicatedLocalMsg(const Uuid &_pUuid,
+                                         const char *_msg,
+                                         const size_t _len,
+                                         const Timestamp &_now)
+{
+  auto &recent = this->recentLocalMsgs[_pUuid];
+
+  auto window = std::chrono::milliseconds(kLocalDuplicateWindow);
+  while (!recent.empty() && _now - recent.front().second > window)
+    recent.pop_front();
+
+  size_t hash = std::hash<std::string>()(std::string(_msg, _len));
+  for (const auto &entry : recent)
+  {
+    if (entry.first == hash)
+      return true;
+  }
+
+  // A burst might not fit. A copy applied twice is harmless, the state
+  // changes are versioned.
+  if (recent.size() >= kMaxLocalDuplicates)
+    recent.pop_front();
+  recent.push_back(std::make_pair(hash, _now));
+  return false;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateHeartbeat()
+{
+  Timestamp now = std::chrono::steady_clock::now();
+  uint32_t version;
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    if (now < this->timeNextHeartbeat)
+      return;
+
+    version = this->stateVersion;
+  }
+
+  // The heartbeat contains the version of our discovery state. The
+  // topics are not re-advertised, the remote processes request a
+  // synchronization when they detect that they missed some changes.
+  Publisher pub("", "", this->pUuid, "", Scope_t::ALL);
+  this->SendMsg(HeartbeatType, pub, version);
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // The jitter prevents the heartbeats of different processes from
+    // getting phase-locked.
+    this->timeNextHeartbeat = std::chrono::steady_clock::now() +
+      this->RandomDuration(
+        this->heartbeatInterval * (1.0 - this->kHeartbeatJitter),
+        this->heartbeatInterval * (1.0 + this->kHeartbeatJitter));
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateAnswers()
+{
+  this->UpdateAnswers<MessagePublisher>();
+  this->UpdateAnswers<ServicePublisher>();
+}
+
+//////////////////////////////////////////////////
+std::chrono::microseconds DiscoveryEngine::RandomDuration(const double _min,
+                                                          const double _max)
+{
+  std::uniform_real_distribution<double> d(_min * 1000, _max * 1000);
+  return std::chrono::microseconds(
+    static_cast<int64_t>(d(this->randGenerator)));
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateInit()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  if (this->initialized ||
+      std::chrono::steady_clock::now() < this->timeInitDeadline)
+  {
+    return;
+  }
+
+  this->initialized = true;
+
+  // Notify anyone waiting for the initialization phase to finish.
+  this->initializedCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::ExtendInit()
+{
+  if (this->initialized)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  auto wait = std::max(2 * (now - this->timeQuery),
+    std::chrono::steady_clock::duration(
+      std::chrono::milliseconds(kMinInitWait)));
+  auto maxDeadline = this->timeQuery +
+    std::chrono::milliseconds(this->heartbeatInterval);
+
+  this->timeInitDeadline = std::min(maxDeadline,
+    std::max(this->timeInitDeadline, now + wait));
+}
+
+//////////////////////////////////////////////////
+int DiscoveryEngine::NextTimeout() const
+{
+  auto now = std::chrono::steady_clock::now();
+  auto timeUntilNextHeartbeat = this->timeNextHeartbeat - now;
+  auto timeUntilNextActivity = this->timeNextActivity - now;
+  auto timeUntilNext =
+    std::min(timeUntilNextHeartbeat, timeUntilNextActivity);
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->initialized)
+    {
+      timeUntilNext =
+        std::min(timeUntilNext, this->timeInitDeadline - now);
+    }
+
+    for (const auto &answer : this->Store<MessagePublisher>().
+           pendingAnswers)
+    {
+      timeUntilNext = std::min(timeUntilNext, answer.second - now);
+    }
+
+    for (const auto &answer : this->Store<ServicePublisher>().
+           pendingAnswers)
+    {
+      timeUntilNext = std::min(timeUntilNext, answer.second - now);
+    }
+
+    if (this->statePending)
+    {
+      timeUntilNext =
+        std::min(timeUntilNext, this->timeStateAnswer - now);
+    }
+  }
+
+  int t = static_cast<int>(
+    std::chrono::duration_cast<std::chrono::milliseconds>
+      (timeUntilNext).count());
+  int t2 = std::min(t, this->kTimeout);
+  return std::max(t2, 0);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RecvMessages()
+{
+  bool timeToExit = false;
+  while (!timeToExit)
+  {
+    // Poll socket for a reply, with timeout.
+    zmq::pollitem_t items[] =
+    {
+      {0, this->sockets.at(0), ZMQ_POLLIN, 0},
+#ifndef _WIN32
+      {0, this->localSocket, ZMQ_POLLIN, 0},
+#endif
+    };
+
+    // Calculate the timeout.
+    int timeout = this->NextTimeout();
+
+    try
+    {
+      zmq::poll(&items[0], sizeof(items) / sizeof(items[0]), timeout);
+    }
+    catch(...)
+    {
+      continue;
+    }
+
+    //  If we got a reply, process it.
+    if (items[0].revents & ZMQ_POLLIN)
+    {
+      this->RecvDiscoveryUpdate();
+
+      if (this->verbose)
+        this->PrintCurrentState();
+    }
+
+#ifndef _WIN32
+    if (items[1].revents & ZMQ_POLLIN)
+    {
+      this->RecvLocalUpdate();
+
+      if (this->verbose)
+        this->PrintCurrentState();
+    }
+#endif
+
+    this->UpdateHeartbeat();
+    this->UpdateAnswers();
+    this->UpdateState();
+    this->UpdateActivity();
+    this->UpdateInit();
+#ifndef _WIN32
+    this->RefreshLocal();
+#endif
+
+    // Is it time to exit?
+    {
+      std::lock_guard<std::mutex> lock(this->exitMutex);
+      if (this->exit)
+        timeToExit = true;
+    }
+  }
+#ifdef _WIN32
+  std::lock_guard<std::mutex> lock(this->exitMutex);
+  this->threadReceptionExiting = true;
+#endif
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RecvDiscoveryUpdate()
+{
+#ifdef __linux__
+  if (this->recvBatchIo &&
+      this->RecvDiscoveryBatch(this->sockets.at(0), false))
+  {
+    return;
+  }
+#endif
+  char *rcvStr = this->rcvBuffer.get();
+  sockaddr_in clntAddr;
+  socklen_t addrLen = sizeof(clntAddr);
+
+  auto received = recvfrom(this->sockets.at(0),
+    reinterpret_cast<raw_type *>(rcvStr),
+    this->kMaxRcvStr, 0,
+    reinterpret_cast<sockaddr *>(&clntAddr),
+    reinterpret_cast<socklen_t *>(&addrLen));
+  if (received < 0)
+  {
+    std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
+              << std::endl;
+    return;
+  }
+
+  this->DispatchDatagram(clntAddr, rcvStr,
+    static_cast<size_t>(received));
+}
+
+#ifdef __linux__
+//////////////////////////////////////////////////
+bool DiscoveryEngine::RecvDiscoveryBatch(const int _sock, const bool _local)
+{
+  mmsghdr msgs[kMaxDatagramBatch];
+  iovec iovecs[kMaxDatagramBatch];
+  sockaddr_in addrs[kMaxDatagramBatch];
+  char controls[kMaxDatagramBatch][CMSG_SPACE(sizeof(uint32_t))];
+
+  memset(msgs, 0, sizeof(msgs));
+  for (unsigned int i = 0; i < kMaxDatagramBatch; ++i)
+  {
+    iovecs[i].iov_base = this->rcvBuffer.get() + i * kMaxRcvStr;
+    iovecs[i].iov_len = kMaxRcvStr;
+    if (!_local)
+    {
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    }
+    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = controls[i];
+    msgs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+  }
+
+  // Don't block: poll() reported at least one datagram, but we only
+  // take what's already queued.
+  int received = recvmmsg(_sock, msgs, kMaxDatagramBatch, MSG_DONTWAIT,
+    nullptr);
+  if (received < 0)
+  {
+    if (errno == ENOSYS)
+    {
+      this->recvBatchIo = false;
+      return false;
+    }
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+      std::cerr << "Discovery::RecvDiscoveryUpdate() recvmmsg error"
+                << std::endl;
+    }
+    return true;
+  }
+
+  for (int i = 0; i < received; ++i)
+  {
+    char *msg = static_cast<char *>(iovecs[i].iov_base);
+    if (_local)
+    {
+      this->DispatchDiscoveryMsg(this->hostAddr, msg, msgs[i].msg_len,
+        true);
+      continue;
+    }
+
+    this->UpdateDroppedDatagrams(msgs[i].msg_hdr);
+    this->DispatchDatagram(addrs[i], msg, msgs[i].msg_len);
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateDroppedDatagrams(msghdr &_hdr)
+{
+#ifdef SO_RXQ_OVFL
+  for (cmsghdr *cmsg = CMSG_FIRSTHDR(&_hdr); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&_hdr, cmsg))
+  {
+    if (cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SO_RXQ_OVFL)
+    {
+      uint32_t dropped;
+      memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+      if (dropped != this->droppedDatagrams && this->verbose)
+      {
+        std::cerr << "Discovery: " << dropped << " datagrams dropped "
+                  << "because the receive buffer was full" << std::endl;
+      }
+      this->droppedDatagrams = dropped;
+    }
+  }
+#else
+  static_cast<void>(_hdr);
+#endif
+}
+
+#endif
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::DispatchDatagram(const sockaddr_in &_addr,
+                                       char *_msg,
+                                       const size_t _len)
+{
+  char srcAddr[INET_ADDRSTRLEN];
+  if (!inet_ntop(AF_INET, const_cast<in_addr *>(&_addr.sin_addr),
+        srcAddr, sizeof(srcAddr)))
+  {
+    return;
+  }
+
+  if (this->verbose)
+  {
+    std::cout << "\nReceived discovery update from " << srcAddr << ": "
+              << ntohs(_addr.sin_port) << std::endl;
+  }
+
+  this->DispatchDiscoveryMsg(srcAddr, _msg, _len);
+}
+
+#ifndef _WIN32
+//////////////////////////////////////////////////
+void DiscoveryEngine::RecvLocalUpdate()
+{
+#ifdef __linux__
+  if (this->recvBatchIo &&
+      this->RecvDiscoveryBatch(this->localSocket, true))
+  {
+    return;
+  }
+#endif
+  char *rcvStr = this->rcvBuffer.get();
+
+  auto received = recv(this->localSocket, rcvStr, this->kMaxRcvStr, 0);
+  if (received < 0)
+  {
+    std::cerr << "Discovery::RecvLocalUpdate() recv error" << std::endl;
+    return;
+  }
+
+  if (this->verbose)
+    std::cout << "\nReceived local discovery update" << std::endl;
+
+  this->DispatchDiscoveryMsg(this->hostAddr, rcvStr,
+    static_cast<size_t>(received), true);
+}
+
+#endif
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::DispatchDiscoveryMsg(const std::string &_fromIp,
+                                           char *_msg,
+                                           const size_t _len,
+                                           const bool _local)
+{
+  Header header;
+  char *pBody = _msg;
+
+  ++this->receivedDatagrams;
+  this->receivedBytes += _len;
+
+  // Discard truncated messages.
+  if (_len < static_cast<size_t>(header.HeaderLength()))
+    return;
+
+  // Create the header from the raw bytes.
+  header.Unpack(_msg);
+  pBody += header.HeaderLength();
+
+  // Discard the message if the wire protocol is different than mine.
+  if (this->kWireVersion != header.Version())
+    return;
+
+  const auto &recvPUuid = header.ProcessUuid();
+
+  // The messages forwarded by a relay come from another network
+  // segment, whatever the IP address of the relay is.
+  std::string fromIp = _fromIp;
+  if (header.Flags() & RelayFlag)
+    fromIp.clear();
+
+  // Discard our own discovery messages.
+  if (recvPUuid == this->processUuid)
+    return;
+
+  // Update timestamp.
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Timestamp now = std::chrono::steady_clock::now();
+
+    // The registry is only updated for the processes that we didn't know.
+    if (_local && this->localPeers.insert(recvPUuid).second)
+    {
+#ifndef _WIN32
+      std::lock_guard<std::mutex> registryLock(this->localRegistryMutex);
+      this->localRegistry.insert(recvPUuid.ToString());
+#endif
+    }
+
+    // The processes of this host send every message through the local
+    // registry and the multicast group, and either copy might be lost.
+    // Both copies keep the process alive, but only the first one is
+    // applied.
+    if ((this->localPeers.find(recvPUuid) != this->localPeers.end() ||
+         this->recentLocalMsgs.find(recvPUuid) !=
+           this->recentLocalMsgs.end()) &&
+        this->DuplicatedLocalMsg(recvPUuid, _msg, _len, now))
+    {
+      auto it = this->activity.find(recvPUuid);
+      if (it != this->activity.end())
+        it->second = now;
+      return;
+    }
+
+    this->activity[recvPUuid] = now;
+  }
+
+  switch (header.Type())
+  {
+    case AdvType:
+    case AdvBatchType:
+    case SubType:
+    case UnadvType:
+    {
+      if (header.Flags() & SrvFlag)
+      {
+        this->DispatchPublisherMsg<ServicePublisher>(header, fromIp,
+          pBody, _len);
+      }
+      else
+      {
+        this->DispatchPublisherMsg<MessagePublisher>(header, fromIp,
+          pBody, _len);
+      }
+      break;
+    }
+    case HeartbeatType:
+    {
+      // The timestamp has already been updated. Check if we missed
+      // some changes in the state of the sender.
+      uint32_t version = header.StateVersion();
+      uint32_t known;
+      bool sync;
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto &peer = this->peers[recvPUuid];
+
+        // The sender never advertised anything.
+        if (!peer.synced && version == 0)
+          peer.synced = true;
+
+        sync = !peer.synced || peer.version < version;
+        known = peer.synced ? peer.version : 0;
+      }
+
+      if (sync)
+        this->RequestSync(recvPUuid, known);
+
+      break;
+    }
+    case SyncType:
+    {
+      // Discard truncated messages.
+      if (_len < static_cast<size_t>(header.HeaderLength()) +
+          Uuid::ByteLength + sizeof(uint32_t))
+      {
+        std::cerr << "Discovery::DispatchDiscoveryMsg() Invalid "
+                  << "SYNC message" << std::endl;
+        break;
+      }
+
+      // Read the rest of the fields.
+      SyncMsg syncMsg;
+      syncMsg.Unpack(pBody);
+
+      // Answer only the requests addressed to me.
+      if (syncMsg.TargetUuid() == this->processUuid)
+        this->ScheduleState(syncMsg.KnownVersion());
+
+      break;
+    }
+    case QueryType:
+    {
+      // A new process wants to know our complete state.
+      this->ScheduleState(0);
+      break;
+    }
+    case ByeType:
+    {
+      // Remove the activity and address entries for this publisher
+      // before notifying, so the callback doesn't see them anymore.
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->RemovePeer(recvPUuid);
+      break;
+    }
+    default:
+    {
+      std::cerr << "Unknown message type [" << header.Type() << "]\n";
+      break;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SendSnapshot(
+  const std::vector<MessagePublisher> &_msgPubs,
+  const std::vector<ServicePublisher> &_srvPubs,
+  const uint32_t _stateVersion) const
+{
+  auto msgGroups = this->GroupPublishers(_msgPubs);
+  auto srvGroups = this->GroupPublishers(_srvPubs);
+
+  // An empty snapshot is still meaningful.
+  if (msgGroups.empty() && srvGroups.empty())
+    msgGroups.push_back(std::vector<MessagePublisher>());
+
+  size_t numParts = msgGroups.size() + srvGroups.size();
+  if (numParts > UINT16_MAX)
+  {
+    std::cerr << "Discovery::SendSnapshot() error: Too many publishers"
+              << std::endl;
+    return;
+  }
+
+  std::vector<std::vector<char>> buffers;
+  if (!this->PackAdvBatch(msgGroups, _stateVersion, SyncFlag, 0,
+        numParts, buffers) ||
+      !this->PackAdvBatch(srvGroups, _stateVersion, SyncFlag,
+        msgGroups.size(), numParts, buffers))
+  {
+    return;
+  }
+
+  // All the parts are sent together.
+  if (!this->Broadcast(buffers))
+    return;
+
+  if (this->Verbose())
+  {
+    std::cout << "\t* Sending " << MsgTypesStr[AdvBatchType]
+              << " snapshot [" << _msgPubs.size() << " topics, "
+              << _srvPubs.size() << " services]" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::AcceptStateChange(const Uuid &_pUuid,
+                                        const uint32_t _version)
+{
+  uint32_t known;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto &peer = this->peers[_pUuid];
+    known = peer.synced ? peer.version : 0;
+
+    if (peer.synced && _version <= known)
+      return false;
+
+    // The next change expected.
+    if (_version == known + 1)
+    {
+      peer.synced = true;
+      peer.version = _version;
+      return true;
+    }
+  }
+
+  // Apply the change but ask for the ones that we missed.
+  this->RequestSync(_pUuid, known);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RequestSync(const Uuid &_pUuid,
+                                  const uint32_t _knownVersion)
+{
+  uint32_t version;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto now = std::chrono::steady_clock::now();
+    auto &peer = this->peers[_pUuid];
+    if (now - peer.lastSyncRequest <
+        std::chrono::milliseconds(this->heartbeatInterval / 2))
+    {
+      return;
+    }
+
+    peer.lastSyncRequest = now;
+    version = this->stateVersion;
+  }
+
+  Header header(this->Version(), this->processUuid, SyncType);
+  header.SetStateVersion(version);
+  SyncMsg syncMsg(header, _pUuid, _knownVersion);
+
+  std::vector<char> buffer(syncMsg.MsgLength());
+  int msgLength = static_cast<int>(syncMsg.Pack(&buffer[0]));
+  if (msgLength == 0 || !this->Broadcast(buffer, msgLength))
+    return;
+
+  if (this->Verbose())
+  {
+    std::cout << "\t* Sending " << MsgTypesStr[SyncType] << " msg ["
+              << _pUuid << ":" << _knownVersion << "]" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::ScheduleState(uint32_t _knownVersion)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // The requester is up to date.
+  if (_knownVersion == this->stateVersion)
+    return;
+
+  // A requester that knows a version that we never had needs a
+  // complete snapshot.
+  if (_knownVersion > this->stateVersion)
+    _knownVersion = 0;
+
+  if (this->statePending)
+  {
+    this->statePendingVersion =
+      std::min(this->statePendingVersion, _knownVersion);
+    return;
+  }
+
+  this->statePending = true;
+  this->statePendingVersion = _knownVersion;
+  this->timeStateAnswer = std::chrono::steady_clock::now() +
+    this->RandomDuration(kMinAnswerDelay, kMaxAnswerDelay);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::UpdateState()
+{
+  uint32_t knownVersion;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->statePending ||
+        std::chrono::steady_clock::now() < this->timeStateAnswer)
+    {
+      return;
+    }
+
+    this->statePending = false;
+    knownVersion = this->statePendingVersion;
+  }
+
+  this->SendState(knownVersion);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::SendState(const uint32_t _knownVersion)
+{
+  std::vector<std::vector<char>> changes;
+  std::vector<MessagePublisher> msgPubs;
+  std::vector<ServicePublisher> srvPubs;
+  uint32_t version;
+  bool full;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    version = this->stateVersion;
+
+    // The requester is up to date.
+    if (_knownVersion == version)
+      return;
+
+    full = _knownVersion == 0 || _knownVersion > version ||
+      this->stateChanges.empty() ||
+      _knownVersion + 1 < this->stateChanges.front().version;
+
+    if (full)
+    {
+      this->LocalPublishers(msgPubs);
+      this->LocalPublishers(srvPubs);
+    }
+    else
+    {
+      for (const auto &change : this->stateChanges)
+      {
+        if (change.version > _knownVersion && !change.buffer.empty())
+          changes.push_back(change.buffer);
+      }
+    }
+  }
+
+  if (full)
+  {
+    this->SendSnapshot(msgPubs, srvPubs, version);
+    return;
+  }
+
+  if (!changes.empty() && this->Broadcast(changes) && this->Verbose())
+  {
+    std::cout << "\t* Sending " << changes.size() << " changes"
+              << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::DispatchEvents()
+{
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->eventsMutex);
+      this->eventsCv.wait(lock, [this]
+      {
+        return this->eventsExit ||
+          !this->Store<MessagePublisher>().events.empty() ||
+          !this->Store<ServicePublisher>().events.empty();
+      });
+
+      if (this->eventsExit)
+        break;
+    }
+
+    // Both kinds of events take turns.
+    this->DispatchEvent<MessagePublisher>();
+    this->DispatchEvent<ServicePublisher>();
+  }
+#ifdef _WIN32
+  std::lock_guard<std::mutex> lock(this->eventsMutex);
+  this->threadEventsExiting = true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::Broadcast(const std::vector<char> &_buffer,
+                                const int _msgLength) const
+{
+  std::vector<std::vector<char>> buffers =
+    {std::vector<char>(_buffer.begin(), _buffer.begin() + _msgLength)};
+  return this->Broadcast(buffers);
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::Broadcast(
+  const std::vector<std::vector<char>> &_buffers) const
+{
+  {
+    std::lock_guard<std::mutex> lock(this->sendRateMutex);
+    if (this->maxSendRate != 0)
+      this->RefillSendTokens();
+
+    // The messages already waiting go first.
+    double count = static_cast<double>(_buffers.size());
+    if (!this->sendQueue.empty() || this->sendInFlight ||
+        (this->maxSendRate != 0 && this->sendTokens < count))
+    {
+      for (const auto &buffer : _buffers)
+      {
+        if (this->sendQueue.size() >= kMaxSendQueue)
+        {
+          ++this->droppedSendDatagrams;
+          continue;
+        }
+        this->sendQueue.push_back(buffer);
+      }
+      this->sendCv.notify_one();
+      return true;
+    }
+
+    if (this->maxSendRate != 0)
+      this->sendTokens -= count;
+  }
+
+  return this->SendNow(_buffers);
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::SendNow(
+  const std::vector<std::vector<char>> &_buffers) const
+{
+  this->sentDatagrams += _buffers.size();
+  for (const auto &buffer : _buffers)
+    this->sentBytes += buffer.size();
+
+#ifndef _WIN32
+  this->LocalBroadcast(_buffers);
+#endif
+
+  for (const auto &sock : this->Sockets())
+  {
+    if (!this->SendDatagrams(sock, _buffers, {*this->MulticastAddr()}))
+    {
+      std::cerr << "Exception sending a message" << std::endl;
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(this->staticPeersMutex);
+  if (!this->staticPeers.empty() &&
+      !this->SendDatagrams(this->sockets.at(0), _buffers,
+        this->staticPeers))
+  {
+    std::cerr << "Exception sending a message to a static peer"
+              << std::endl;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RunSender()
+{
+  while (true)
+  {
+    std::vector<std::vector<char>> buffers;
+    {
+      std::unique_lock<std::mutex> lock(this->sendRateMutex);
+      this->sendInFlight = false;
+      this->sendCv.wait(lock, [this]
+      {
+        return this->sendExit || !this->sendQueue.empty();
+      });
+
+      if (this->sendQueue.empty())
+        break;
+
+      size_t count = this->sendQueue.size();
+      if (this->maxSendRate != 0 && !this->sendExit)
+      {
+        this->RefillSendTokens();
+        count = std::min(count,
+          static_cast<size_t>(std::max(0.0, this->sendTokens)));
+
+        // Wait for the next token.
+        if (count == 0)
+        {
+          std::chrono::duration<double> wait(
+            (1.0 - this->sendTokens) / this->maxSendRate);
+          this->sendCv.wait_for(lock,
+            std::chrono::duration_cast<std::chrono::microseconds>(wait));
+          continue;
+        }
+
+        this->sendTokens -= static_cast<double>(count);
+      }
+
+      buffers.assign(
+        std::make_move_iterator(this->sendQueue.begin()),
+        std::make_move_iterator(this->sendQueue.begin() + count));
+      this->sendQueue.erase(this->sendQueue.begin(),
+        this->sendQueue.begin() + count);
+
+      // Keep the order of the messages: Broadcast() queues its messages
+      // until these ones are sent.
+      this->sendInFlight = true;
+    }
+
+    this->SendNow(buffers);
+  }
+#ifdef _WIN32
+  std::lock_guard<std::mutex> lock(this->sendRateMutex);
+  this->threadSenderExiting = true;
+#endif
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RefillSendTokens() const
+{
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = now - this->timeLastRefill;
+  this->timeLastRefill = now;
+  this->sendTokens = std::min(this->SendBurst(),
+    this->sendTokens + elapsed.count() * this->maxSendRate);
+}
+
+//////////////////////////////////////////////////
+double DiscoveryEngine::SendBurst() const
+{
+  return std::max(1.0, this->maxSendRate / 5.0);
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::SendDatagrams(
+  const int _sock,
+  const std::vector<std::vector<char>> &_buffers,
+  const std::vector<sockaddr_in> &_dsts) const
+{
+  bool result = true;
+#ifdef __linux__
+  if (this->sendBatchIo)
+  {
+    std::vector<iovec> iovecs(_buffers.size());
+    for (size_t i = 0; i < _buffers.size(); ++i)
+    {
+      iovecs[i].iov_base = const_cast<char *>(_buffers[i].data());
+      iovecs[i].iov_len = _buffers[i].size();
+    }
+
+    std::vector<mmsghdr> msgs(_buffers.size() * _dsts.size());
+    memset(msgs.data(), 0, msgs.size() * sizeof(mmsghdr));
+    size_t n = 0;
+    for (const auto &dst : _dsts)
+    {
+      for (auto &iov : iovecs)
+      {
+        msgs[n].msg_hdr.msg_name = const_cast<sockaddr_in *>(&dst);
+        msgs[n].msg_hdr.msg_namelen = sizeof(dst);
+        msgs[n].msg_hdr.msg_iov = &iov;
+        msgs[n].msg_hdr.msg_iovlen = 1;
+        ++n;
+      }
+    }
+
+    size_t sent = 0;
+    while (sent < msgs.size())
+    {
+      int res = sendmmsg(_sock, &msgs[sent],
+        static_cast<unsigned int>(msgs.size() - sent), 0);
+      if (res < 0)
+      {
+        if (errno == ENOSYS)
+        {
+          this->sendBatchIo = false;
+          break;
+        }
+
+        // Skip the datagram that failed and go on with the rest.
+        result = false;
+        ++sent;
+        continue;
+      }
+      sent += static_cast<size_t>(res);
+    }
+
+    if (this->sendBatchIo)
+      return result;
+  }
+#endif
+
+  for (const auto &dst : _dsts)
+  {
+    for (const auto &buffer : _buffers)
+    {
+      int msgLength = static_cast<int>(buffer.size());
+      if (sendto(_sock, reinterpret_cast<const raw_type *>(
+        reinterpret_cast<const unsigned char*>(&buffer[0])),
+        msgLength, 0, reinterpret_cast<const sockaddr *>(&dst),
+        sizeof(dst)) != msgLength)
+      {
+        result = false;
+      }
+    }
+  }
+
+  return result;
+}
+
+#ifndef _WIN32
+//////////////////////////////////////////////////
+void DiscoveryEngine::RegisterLocal()
+{
+  // The registry is private to each user. Its entries are removed when
+  // they don't answer, so a directory writable by other users could be
+  // replaced by a link to a directory of the victim.
+  std::string baseDir;
+  std::string name = "ign-transport-" + std::to_string(this->port);
+  if (!env("XDG_RUNTIME_DIR", baseDir) || baseDir.empty())
+  {
+    if (!env("TMPDIR", baseDir) || baseDir.empty())
+      baseDir = "/tmp";
+    name += "-" + std::to_string(geteuid());
+  }
+  this->localDir = baseDir + "/" + name;
+
+  if (mkdir(this->localDir.c_str(), 0700) != 0 && errno != EEXIST)
+  {
+    std::cerr << "Discovery::RegisterLocal() error creating ["
+              << this->localDir << "]" << std::endl;
+    return;
+  }
+
+  // Only use a real directory of this user that nobody else can write.
+  struct stat info;
+  if (lstat(this->localDir.c_str(), &info) != 0 ||
+      !S_ISDIR(info.st_mode) || info.st_uid != geteuid() ||
+      (info.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+  {
+    std::cerr << "Discovery::RegisterLocal() [" << this->localDir
+              << "] is not a private directory of this user" << std::endl;
+    return;
+  }
+
+  sockaddr_un addr;
+  if (!localAddr(this->localDir, this->pUuid, addr))
+    return;
+
+  int sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (sock < 0)
+  {
+    std::cerr << "Discovery::RegisterLocal() socket error" << std::endl;
+    return;
+  }
+
+  unlink(addr.sun_path);
+  if (bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+  {
+    std::cerr << "Discovery::RegisterLocal() error binding ["
+              << addr.sun_path << "]" << std::endl;
+    close(sock);
+    return;
+  }
+
+  // The receive queue of a Unix datagram socket is short, so the
+  // sender waits for the receiver instead of dropping the message. The
+  // local sender thread waits at most kLocalSendTimeout ms. per
+  // message.
+  timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = static_cast<int>(kLocalSendTimeout * 1000);
+  if (setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO,
+      reinterpret_cast<const char *>(&timeout), sizeof(timeout)) != 0)
+  {
+    std::cerr << "Error setting socket option (SO_SNDTIMEO)."
+              << std::endl;
+  }
+
+  this->localSocket = sock;
+  this->RefreshLocal();
+
+  this->threadLocalSender =
+    std::thread(&DiscoveryEngine::RunLocalSender, this);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RefreshLocal()
+{
+  if (this->localSocket < 0)
+    return;
+
+  Timestamp now = std::chrono::steady_clock::now();
+  if (now < this->timeNextLocalRefresh)
+    return;
+
+  this->timeNextLocalRefresh =
+    now + std::chrono::milliseconds(kLocalRefreshInterval);
+
+  DIR *dir = opendir(this->localDir.c_str());
+  if (!dir)
+    return;
+
+  std::set<std::string> registry;
+  while (dirent *entry = readdir(dir))
+  {
+    std::string name = entry->d_name;
+    if (name != this->pUuid && isLocalSocket(this->localDir, name))
+      registry.insert(name);
+  }
+  closedir(dir);
+
+  std::lock_guard<std::mutex> lock(this->localRegistryMutex);
+  this->localRegistry.swap(registry);
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::LocalBroadcast(
+  const std::vector<std::vector<char>> &_buffers) const
+{
+  if (this->localSocket < 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->localSendMutex);
+    for (const auto &buffer : _buffers)
+    {
+      if (this->localQueue.size() >= kMaxLocalQueue)
+      {
+        ++this->droppedLocalDatagrams;
+        continue;
+      }
+      this->localQueue.push_back(buffer);
+    }
+  }
+  this->localSendCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::RunLocalSender()
+{
+  while (true)
+  {
+    std::vector<std::vector<char>> buffers;
+    {
+      std::unique_lock<std::mutex> lock(this->localSendMutex);
+      this->localSendCv.wait(lock, [this]
+      {
+        return this->localSendExit || !this->localQueue.empty();
+      });
+
+      if (this->localQueue.empty())
+        break;
+
+      buffers.assign(
+        std::make_move_iterator(this->localQueue.begin()),
+        std::make_move_iterator(this->localQueue.end()));
+      this->localQueue.clear();
+    }
+
+    this->LocalSend(buffers);
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryEngine::LocalSend(const std::vector<std::vector<char>> &_buffers)
+{
+  std::vector<std::string> registry;
+  {
+    std::lock_guard<std::mutex> lock(this->localRegistryMutex);
+    registry.assign(this->localRegistry.begin(),
+      this->localRegistry.end());
+  }
+
+  // The sends block while the queue of a process is full, so a burst
+  // of messages is paced to the speed of the receivers. But a process
+  // that doesn't accept a message within kLocalSendTimeout ms. is
+  // considered congested: the rest of the burst is dropped for it.
+  std::vector<std::string> stale;
+  for (const auto &name : registry)
+  {
+    sockaddr_un addr;
+    if (!localAddr(this->localDir, name, addr))
+      continue;
+
+    bool congested = false;
+    for (const auto &buffer : _buffers)
+    {
+      int flags = congested ? MSG_DONTWAIT : 0;
+      if (sendto(this->localSocket, buffer.data(), buffer.size(), flags,
+            reinterpret_cast<const sockaddr *>(&addr),
+            sizeof(addr)) >= 0)
+      {
+        continue;
+      }
+
+      if (errno == ECONNREFUSED || errno == ENOENT)
+      {
+        // Never remove anything but a socket of the registry.
+        if (isLocalSocket(this->localDir, name))
+          unlink(addr.sun_path);
+        stale.push_back(name);
+        break;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        ++this->droppedLocalDatagrams;
+        congested = true;
+      }
+    }
+  }
+
+  if (!stale.empty())
+  {
+    std::lock_guard<std::mutex> lock(this->localRegistryMutex);
+    for (const auto &name : stale)
+      this->localRegistry.erase(name);
+  }
+}
+
+#endif
+
+//////////////////////////////////////////////////
+const std::vector<int> &DiscoveryEngine::Sockets() const
+{
+  return this->sockets;
+}
+
+//////////////////////////////////////////////////
+const sockaddr_in *DiscoveryEngine::MulticastAddr() const
+{
+  return &this->mcastAddr;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::Verbose() const
+{
+  return this->verbose;
+}
+
+//////////////////////////////////////////////////
+uint8_t DiscoveryEngine::Version() const
+{
+  return this->kWireVersion;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryEngine::RegisterNetIface(const std::string &_ip)
+{
+  // Make a new socket for sending discovery information.
+  int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+  if (sock < 0)
+  {
+    std::cerr << "Socket creation failed." << std::endl;
+    return false;
+  }
+
+  // Socket option: IP_MULTICAST_IF.
+  // This socket option needs to be applied to each socket used to send
+  // data. This option selects the source interface for outgoing messages.
+  struct in_addr ifAddr;
+  ifAddr.s_addr = inet_addr(_ip.c_str());
+  if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF,
+    reinterpret_cast<const char*>(&ifAddr), sizeof(ifAddr)) != 0)
+  {
+    std::cerr << "Error setting socket option (IP_MULTICAST_IF)."
+              << std::endl;
+    return false;
+  }
+
+  this->sockets.push_back(sock);
+
+  // Join the multicast group. We have to do it for each network interface
+  // but we can do it on the same socket. We will use the socket at
+  // position 0 for receiving multicast information.
+  struct ip_mreq group;
+  group.imr_multiaddr.s_addr =
+    inet_addr(this->kMulticastGroup.c_str());
+  group.imr_interface.s_addr = inet_addr(_ip.c_str());
+  if (setsockopt(this->sockets.at(0), IPPROTO_IP, IP_ADD_MEMBERSHIP,
+    reinterpret_cast<const char*>(&group), sizeof(group)) != 0)
+  {
+    std::cerr << "Error setting socket option (IP_ADD_MEMBERSHIP)."
+              << std::endl;
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifdef _WIN32
+  #include <Winsock2.h>
+  #include <Ws2tcpip.h>
+  using raw_type = char;
+#else
+  #include <arpa/inet.h>
+  #include <sys/socket.h>
+  #include <sys/types.h>
+  #include <unistd.h>
+  using raw_type = void;
+#endif
+
+#ifdef _WIN32
+  #pragma warning(push, 0)
+#endif
+#include <zmq.hpp>
+#ifdef _WIN32
+  #pragma warning(pop)
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ignition/transport/DiscoveryRelay.hh"
+#include "ignition/transport/DiscoveryRelayPrivate.hh"
+#include "ignition/transport/NetUtils.hh"
+#include "ignition/transport/Packet.hh"
+
+using namespace ignition;
+using namespace transport;
+
+namespace
+{
+  /// \brief Close a socket.
+  /// \param[in] _sock Socket to close.
+  void closeSocket(const int _sock)
+  {
+#ifdef _WIN32
+    closesocket(_sock);
+#else
+    close(_sock);
+#endif
+  }
+
+  /// \brief Create a UDP socket bound to a port of all the interfaces.
+  /// \param[in] _port Port.
+  /// \param[in] _reuse True for sharing the port with other sockets.
+  /// \return The socket or -1 on error.
+  int bindSocket(const int _port, const bool _reuse)
+  {
+    int sock = static_cast<int>(socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (sock < 0)
+      return -1;
+
+    if (_reuse)
+    {
+      int reuse = 1;
+      setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
+        reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#ifdef SO_REUSEPORT
+      setsockopt(sock, SOL_SOCKET, SO_REUSEPORT,
+        reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+#endif
+    }
+
+    sockaddr_in localAddr;
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sin_family = AF_INET;
+    localAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    localAddr.sin_port = htons(static_cast<u_short>(_port));
+    if (bind(sock, reinterpret_cast<sockaddr *>(&localAddr),
+          sizeof(localAddr)) < 0)
+    {
+      closeSocket(sock);
+      return -1;
+    }
+
+    return sock;
+  }
+
+  /// \brief Send a message to an address.
+  /// \param[in] _sock Socket used for sending.
+  /// \param[in] _msg Message.
+  /// \param[in] _len Length of the message in bytes.
+  /// \param[in] _addr Destination.
+  void sendMsg(const int _sock, const char *_msg, const size_t _len,
+    const sockaddr_in &_addr)
+  {
+    if (sendto(_sock, reinterpret_cast<const raw_type *>(_msg),
+          static_cast<int>(_len), 0,
+          reinterpret_cast<const sockaddr *>(&_addr), sizeof(_addr)) < 0)
+    {
+      std::cerr << "DiscoveryRelay: Error sending a message" << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+DiscoveryRelay::DiscoveryRelay(const int _discoveryPort, const int _relayPort)
+  : dataPtr(new DiscoveryRelayPrivate())
+{
+  this->dataPtr->discoveryPort = _discoveryPort;
+  this->dataPtr->relayPort = _relayPort;
+
+  memset(&this->dataPtr->mcastAddr, 0, sizeof(this->dataPtr->mcastAddr));
+  this->dataPtr->mcastAddr.sin_family = AF_INET;
+  this->dataPtr->mcastAddr.sin_addr.s_addr =
+    inet_addr(this->dataPtr->kMulticastGroup.c_str());
+  this->dataPtr->mcastAddr.sin_port =
+    htons(static_cast<u_short>(_discoveryPort));
+}
+
+//////////////////////////////////////////////////
+DiscoveryRelay::~DiscoveryRelay()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryRelay::AddRelay(const std::string &_addr)
+{
+  std::string ip;
+  int port;
+  if (!parseAddress(_addr, this->dataPtr->relayPort, ip, port))
+  {
+    std::cerr << "DiscoveryRelay::AddRelay() error: Invalid address ["
+              << _addr << "]" << std::endl;
+    return false;
+  }
+
+  sockaddr_in relayAddr;
+  memset(&relayAddr, 0, sizeof(relayAddr));
+  relayAddr.sin_family = AF_INET;
+  relayAddr.sin_addr.s_addr = inet_addr(ip.c_str());
+  relayAddr.sin_port = htons(static_cast<u_short>(port));
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->relays.push_back(relayAddr);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool DiscoveryRelay::Start()
+{
+  if (this->dataPtr->running)
+    return true;
+
+  this->dataPtr->mcastSocket = bindSocket(this->dataPtr->discoveryPort, true);
+  this->dataPtr->relaySocket = bindSocket(this->dataPtr->relayPort, false);
+  if (this->dataPtr->mcastSocket < 0 || this->dataPtr->relaySocket < 0)
+  {
+    std::cerr << "DiscoveryRelay::Start() error: Unable to bind the ports ["
+              << this->dataPtr->discoveryPort << ", "
+              << this->dataPtr->relayPort << "]" << std::endl;
+    this->Stop();
+    return false;
+  }
+
+  // Join the multicast group of our segment on every interface.
+  std::vector<std::string> interfaces;
+  std::string ignIp;
+  if (env("IGN_IP", ignIp) && !ignIp.empty())
+    interfaces = {ignIp};
+  else
+    interfaces = determineInterfaces();
+
+  for (const auto &iface : interfaces)
+  {
+    struct ip_mreq group;
+    group.imr_multiaddr.s_addr =
+      inet_addr(this->dataPtr->kMulticastGroup.c_str());
+    group.imr_interface.s_addr = inet_addr(iface.c_str());
+    if (setsockopt(this->dataPtr->mcastSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+      reinterpret_cast<const char*>(&group), sizeof(group)) != 0)
+    {
+      std::cerr << "DiscoveryRelay::Start() error joining the multicast "
+                << "group on [" << iface << "]" << std::endl;
+    }
+  }
+
+  this->dataPtr->running = true;
+  this->dataPtr->thread =
+    std::thread(&DiscoveryRelay::RunForwardingTask, this);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryRelay::Stop()
+{
+  this->dataPtr->running = false;
+  if (this->dataPtr->thread.joinable())
+    this->dataPtr->thread.join();
+
+  if (this->dataPtr->mcastSocket >= 0)
+    closeSocket(this->dataPtr->mcastSocket);
+  if (this->dataPtr->relaySocket >= 0)
+    closeSocket(this->dataPtr->relaySocket);
+
+  this->dataPtr->mcastSocket = -1;
+  this->dataPtr->relaySocket = -1;
+}
+
+//////////////////////////////////////////////////
+uint64_t DiscoveryRelay::NumForwarded() const
+{
+  return this->dataPtr->numForwarded;
+}
+
+//////////////////////////////////////////////////
+void DiscoveryRelay::RunForwardingTask()
+{
+  std::vector<char> buffer(DiscoveryRelayPrivate::kMaxRcvStr);
+
+  while (this->dataPtr->running)
+  {
+    zmq::pollitem_t items[] =
+    {
+      {0, this->dataPtr->mcastSocket, ZMQ_POLLIN, 0},
+      {0, this->dataPtr->relaySocket, ZMQ_POLLIN, 0},
+    };
+
+    try
+    {
+      zmq::poll(&items[0], sizeof(items) / sizeof(items[0]),
+        this->dataPtr->kTimeout);
+    }
+    catch(...)
+    {
+      continue;
+    }
+
+    for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); ++i)
+    {
+      if (!(items[i].revents & ZMQ_POLLIN))
+        continue;
+
+      sockaddr_in srcAddr;
+      socklen_t addrLen = sizeof(srcAddr);
+      auto received = recvfrom(static_cast<int>(items[i].fd),
+        reinterpret_cast<raw_type *>(&buffer[0]),
+        DiscoveryRelayPrivate::kMaxRcvStr, 0,
+        reinterpret_cast<sockaddr *>(&srcAddr), &addrLen);
+      if (received <= 0)
+        continue;
+
+      std::string src = std::string(inet_ntoa(srcAddr.sin_addr)) + ":" +
+        std::to_string(ntohs(srcAddr.sin_port));
+
+      bool fromRelaySocket = i == 1;
+      if (fromRelaySocket)
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+        auto it = this->dataPtr->clients.find(src);
+        if (it != this->dataPtr->clients.end())
+          it->second.second = std::chrono::steady_clock::now();
+        else
+        {
+          // A static peer, unless it's one of the relays.
+          bool isRelay = false;
+          for (const auto &relay : this->dataPtr->relays)
+          {
+            isRelay = isRelay ||
+              (relay.sin_addr.s_addr == srcAddr.sin_addr.s_addr &&
+               relay.sin_port == srcAddr.sin_port);
+          }
+
+          if (!isRelay)
+          {
+            this->dataPtr->clients[src] =
+              std::make_pair(srcAddr, std::chrono::steady_clock::now());
+          }
+        }
+      }
+
+      this->Forward(&buffer[0], static_cast<size_t>(received),
+        fromRelaySocket, src);
+    }
+
+    // Forget the static peers that are gone.
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = this->dataPtr->clients.begin();
+         it != this->dataPtr->clients.end();)
+    {
+      if (now - it->second.second >
+          std::chrono::milliseconds(this->dataPtr->kClientTimeout))
+      {
+        it = this->dataPtr->clients.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void DiscoveryRelay::Forward(char *_msg, const size_t _len,
+  const bool _fromRelaySocket, const std::string &_src)
+{
+  Header header;
+  if (header.Unpack(_msg) == 0 ||
+      static_cast<size_t>(header.HeaderLength()) > _len)
+  {
+    return;
+  }
+
+  bool relayed = (header.Flags() & RelayFlag) != 0;
+
+  // A message already forwarded by a relay of our segment (or by us).
+  if (relayed && !_fromRelaySocket)
+    return;
+
+  // Flag the message, so it's never forwarded again.
+  if (!relayed)
+  {
+    header.SetFlags(header.Flags() | RelayFlag);
+    if (header.Pack(_msg) == 0)
+      return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  // Messages from other segments or from the static peers.
+  if (_fromRelaySocket)
+  {
+    sendMsg(this->dataPtr->mcastSocket, _msg, _len, this->dataPtr->mcastAddr);
+  }
+
+  // Messages from our segment or from the static peers.
+  if (!relayed)
+  {
+    for (const auto &relay : this->dataPtr->relays)
+      sendMsg(this->dataPtr->relaySocket, _msg, _len, relay);
+  }
+
+  for (const auto &client : this->dataPtr->clients)
+  {
+    if (client.first != _src)
+      sendMsg(this->dataPtr->relaySocket, _msg, _len, client.second.first);
+  }
+
+  ++this->dataPtr->numForwarded;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/DiscoveryRelay.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+using namespace transport;
+
+// Discovery ports of three network segments simulated on loopback.
+static const int g_segmentPort1 = 11331;
+static const int g_segmentPort2 = 11332;
+static const int g_segmentPort3 = 11333;
+
+// Ports of the relays.
+static const int g_relayPort1 = 11341;
+static const int g_relayPort2 = 11342;
+
+static std::string addr1   = "tcp://127.0.0.1:12345";
+static std::string ctrl1   = "tcp://127.0.0.1:12346";
+static std::string pUuid1  = transport::Uuid().ToString();
+static std::string nUuid1  = transport::Uuid().ToString();
+static std::string pUuid2  = transport::Uuid().ToString();
+static std::string pUuid3  = transport::Uuid().ToString();
+
+//////////////////////////////////////////////////
+/// \brief Check the validation of the relay addresses.
+TEST(DiscoveryRelayTest, AddRelay)
+{
+  DiscoveryRelay relay(g_segmentPort1, g_relayPort1);
+  EXPECT_TRUE(relay.AddRelay("127.0.0.1:" + std::to_string(g_relayPort2)));
+  EXPECT_TRUE(relay.AddRelay("127.0.0.1"));
+  EXPECT_FALSE(relay.AddRelay("127.0.0.1:port"));
+  EXPECT_EQ(relay.NumForwarded(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that two relays connect the discovery of two segments and
+/// that a process without multicast can use a relay as a static peer.
+TEST(DiscoveryRelayTest, TwoSegments)
+{
+  DiscoveryRelay relay1(g_segmentPort1, g_relayPort1);
+  DiscoveryRelay relay2(g_segmentPort2, g_relayPort2);
+  EXPECT_TRUE(relay1.AddRelay("127.0.0.1:" + std::to_string(g_relayPort2)));
+  EXPECT_TRUE(relay2.AddRelay("127.0.0.1:" + std::to_string(g_relayPort1)));
+  ASSERT_TRUE(relay1.Start());
+  ASSERT_TRUE(relay2.Start());
+
+  // A publisher in the first segment.
+  std::string topic = "/" + testing::getRandomNumber();
+  MsgDiscovery discovery1(pUuid1, g_segmentPort1);
+  discovery1.Start();
+  MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1,
+    Scope_t::ALL, "t");
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+
+  // A process in the second segment.
+  MsgDiscovery discovery2(pUuid2, g_segmentPort2);
+  discovery2.Start();
+
+  // A process that only talks to the first relay.
+  MsgDiscovery discovery3(pUuid3, g_segmentPort3);
+  EXPECT_TRUE(discovery3.AddStaticPeer(
+    "127.0.0.1:" + std::to_string(g_relayPort1)));
+  EXPECT_FALSE(discovery3.AddStaticPeer("127.0.0.1:port"));
+  discovery3.Start();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  MsgAddresses_M addresses;
+  EXPECT_TRUE(discovery2.Publishers(topic, addresses));
+  addresses.clear();
+  EXPECT_TRUE(discovery3.Publishers(topic, addresses));
+  EXPECT_GT(relay1.NumForwarded(), 0u);
+  EXPECT_GT(relay2.NumForwarded(), 0u);
+
+  // The topics scoped to a host never cross a relay.
+  std::string hostTopic = "/" + testing::getRandomNumber();
+  MessagePublisher hostPublisher(hostTopic, addr1, ctrl1, pUuid1, nUuid1,
+    Scope_t::HOST, "t");
+  EXPECT_TRUE(discovery1.Advertise(hostPublisher));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  addresses.clear();
+  EXPECT_FALSE(discovery2.Publishers(hostTopic, addresses));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
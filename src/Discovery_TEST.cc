@@ -15,11 +15,25 @@
  *
 */
 
+#ifndef _WIN32
+  #include <arpa/inet.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "ignition/transport/AdvertiseOptions.hh"
@@ -77,8 +91,7 @@ template<typename T> class DiscoveryDerived : public transport::Discovery<T>
   public: void TestActivity(const std::string &_pUuid,
                             const bool _expectedActivity) const
   {
-    EXPECT_EQ(this->activity.find(_pUuid) !=
-              this->activity.end(), _expectedActivity);
+    EXPECT_EQ(this->engine->PeerActive(_pUuid), _expectedActivity);
   };
 };
 
@@ -414,6 +427,628 @@ TEST(DiscoveryTest, TestNodeBye)
   EXPECT_TRUE(disconnectionExecuted);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that the topics advertised before a discovery node starts are
+/// learned from the batched ADVERTISE messages sent with the heartbeats.
+TEST(DiscoveryTest, TestHeartbeatAdvertiseBatch)
+{
+  const int numTopics = 200;
+  std::string prefix = testing::getRandomNumber() + "_";
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  discovery1.Start();
+
+  // The topics are advertised while discovery2 doesn't exist yet.
+  for (auto i = 0; i < numTopics; ++i)
+  {
+    MessagePublisher publisher(prefix + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, scope, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  discovery2.Start();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery1.HeartbeatInterval() * 2));
+
+  std::vector<std::string> topics;
+  discovery2.TopicList(topics);
+  auto numDiscovered = std::count_if(topics.begin(), topics.end(),
+    [&prefix](const std::string &_topic)
+    {
+      return _topic.compare(0, prefix.size(), prefix) == 0;
+    });
+  EXPECT_EQ(numDiscovered, numTopics);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the size of the receive buffer and that a burst of
+/// advertisements is received without drops.
+TEST(DiscoveryTest, TestReceiveBuffer)
+{
+  const int numTopics = 500;
+  std::string prefix = testing::getRandomNumber() + "_";
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+
+  EXPECT_FALSE(discovery1.SetReceiveBufferSize(0));
+  EXPECT_TRUE(discovery1.SetReceiveBufferSize(65536));
+  EXPECT_GE(discovery1.ReceiveBufferSize(), 65536);
+
+  discovery1.Start();
+  discovery2.Start();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Each advertisement is sent right away in its own datagram.
+  for (auto i = 0; i < numTopics; ++i)
+  {
+    MessagePublisher publisher(prefix + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, scope, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery1.HeartbeatInterval() * 2));
+
+  std::vector<std::string> topics;
+  discovery2.TopicList(topics);
+  auto numDiscovered = std::count_if(topics.begin(), topics.end(),
+    [&prefix](const std::string &_topic)
+    {
+      return _topic.compare(0, prefix.size(), prefix) == 0;
+    });
+  EXPECT_EQ(numDiscovered, numTopics);
+  EXPECT_EQ(discovery2.DroppedDatagrams(), 0u);
+  EXPECT_EQ(discovery1.DroppedLocalDatagrams(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the initialization phase ends as soon as the existing
+/// processes have answered, without waiting for their heartbeats.
+TEST(DiscoveryTest, TestFastInit)
+{
+  std::string topic = "/" + testing::getRandomNumber();
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  discovery1.Start();
+
+  MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1, scope, "t");
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+
+  // Wait until discovery1 is initialized.
+  std::vector<std::string> topics;
+  discovery1.TopicList(topics);
+
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  auto start = std::chrono::steady_clock::now();
+  discovery2.Start();
+  discovery2.TopicList(topics);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(
+    elapsed).count(), discovery2.HeartbeatInterval() / 2);
+  EXPECT_NE(std::find(topics.begin(), topics.end(), topic), topics.end());
+}
+
+#ifndef _WIN32
+//////////////////////////////////////////////////
+/// \brief Get the directory of the local registry of this user.
+/// \param[in] _port Discovery port.
+/// \return The path of the directory.
+std::string localRegistryDir(const int _port)
+{
+  std::string baseDir;
+  std::string name = "ign-transport-" + std::to_string(_port);
+  if (!env("XDG_RUNTIME_DIR", baseDir) || baseDir.empty())
+  {
+    if (!env("TMPDIR", baseDir) || baseDir.empty())
+      baseDir = "/tmp";
+    name += "-" + std::to_string(geteuid());
+  }
+  return baseDir + "/" + name;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the processes join and leave the local registry.
+TEST(DiscoveryTest, TestLocalRegistry)
+{
+  std::string dir = localRegistryDir(g_msgPort);
+  std::string path = dir + "/" + pUuid1;
+
+  // A stray file of the registry directory, which is not a socket.
+  std::string stray = dir + "/" + Uuid().ToString();
+
+  {
+    MsgDiscovery discovery1(pUuid1, g_msgPort);
+    EXPECT_EQ(access(path.c_str(), F_OK), 0);
+
+    struct stat info;
+    ASSERT_EQ(lstat(dir.c_str(), &info), 0);
+    EXPECT_TRUE(S_ISDIR(info.st_mode));
+    EXPECT_EQ(info.st_mode & (S_IRWXG | S_IRWXO), 0u);
+
+    std::ofstream(stray.c_str()) << "not a socket";
+
+    // A local process learns about the topics without waiting.
+    MsgDiscovery discovery2(pUuid2, g_msgPort);
+    discovery1.Start();
+    discovery2.Start();
+
+    std::string topic = "/" + testing::getRandomNumber();
+    MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1,
+      Scope_t::HOST, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    MsgAddresses_M addresses;
+    EXPECT_TRUE(discovery2.Publishers(topic, addresses));
+  }
+
+  EXPECT_NE(access(path.c_str(), F_OK), 0);
+
+  // The registry only removes its own sockets.
+  EXPECT_EQ(access(stray.c_str(), F_OK), 0);
+  unlink(stray.c_str());
+}
+#endif
+
+#ifndef _WIN32
+//////////////////////////////////////////////////
+/// \brief Raw sockets used to inject discovery messages, as if they were
+/// sent by another process.
+class DiscoveryProbe
+{
+  /// \brief Constructor. It joins the multicast group.
+  /// \param[in] _hostAddr Address of the interface used by discovery.
+  /// \param[in] _port Discovery port.
+  public: DiscoveryProbe(const std::string &_hostAddr, const int _port)
+    : port(_port)
+  {
+    this->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    this->localSock = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    int reuse = 1;
+    setsockopt(this->sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(this->sock, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+#endif
+    timeval timeout = {1, 0};
+    setsockopt(this->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+      sizeof(timeout));
+
+    memset(&this->groupAddr, 0, sizeof(this->groupAddr));
+    this->groupAddr.sin_family = AF_INET;
+    this->groupAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    this->groupAddr.sin_port = htons(static_cast<uint16_t>(_port));
+    EXPECT_EQ(bind(this->sock,
+      reinterpret_cast<sockaddr *>(&this->groupAddr),
+      sizeof(this->groupAddr)), 0);
+
+    ip_mreq group;
+    group.imr_multiaddr.s_addr = inet_addr("224.0.0.7");
+    group.imr_interface.s_addr = inet_addr(_hostAddr.c_str());
+    EXPECT_EQ(setsockopt(this->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group,
+      sizeof(group)), 0);
+    setsockopt(this->sock, IPPROTO_IP, IP_MULTICAST_IF, &group.imr_interface,
+      sizeof(group.imr_interface));
+    this->groupAddr.sin_addr.s_addr = group.imr_multiaddr.s_addr;
+  }
+
+  /// \brief Destructor.
+  public: ~DiscoveryProbe()
+  {
+    close(this->sock);
+    close(this->localSock);
+  }
+
+  /// \brief Wait for a discovery message to learn the wire version in use.
+  /// \param[out] _version Wire version.
+  /// \return True if a message was received.
+  public: bool WireVersion(uint16_t &_version)
+  {
+    char buffer[1024];
+    if (recv(this->sock, buffer, sizeof(buffer), 0) <= 0)
+      return false;
+
+    Header header;
+    header.Unpack(buffer);
+    _version = header.Version();
+    return true;
+  }
+
+  /// \brief Send a message to the multicast group.
+  /// \param[in] _msg Raw message.
+  public: void SendMulticast(const std::vector<char> &_msg)
+  {
+    EXPECT_EQ(sendto(this->sock, _msg.data(), _msg.size(), 0,
+      reinterpret_cast<sockaddr *>(&this->groupAddr),
+      sizeof(this->groupAddr)), static_cast<ssize_t>(_msg.size()));
+  }
+
+  /// \brief Send a message through the local registry of a process.
+  /// \param[in] _pUuid UUID of the destination process.
+  /// \param[in] _msg Raw message.
+  public: void SendLocal(const std::string &_pUuid,
+                         const std::vector<char> &_msg)
+  {
+    std::string path = localRegistryDir(this->port) + "/" + _pUuid;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    EXPECT_EQ(sendto(this->localSock, _msg.data(), _msg.size(), 0,
+      reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+      static_cast<ssize_t>(_msg.size()));
+  }
+
+  /// \brief Discovery port.
+  private: int port;
+
+  /// \brief Socket joined to the multicast group.
+  private: int sock;
+
+  /// \brief Socket used to send through the local registry.
+  private: int localSock;
+
+  /// \brief Address of the multicast group.
+  private: sockaddr_in groupAddr;
+};
+
+//////////////////////////////////////////////////
+/// \brief Pack a message that only has a header.
+/// \param[in] _header Header of the message.
+/// \return The raw message.
+std::vector<char> packHeader(const Header &_header)
+{
+  std::vector<char> msg(static_cast<size_t>(_header.HeaderLength()));
+  EXPECT_EQ(_header.Pack(msg.data()), msg.size());
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a truncated SYNC message is discarded instead of being
+/// parsed from the bytes of a previous datagram.
+TEST(DiscoveryTest, TestTruncatedSync)
+{
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  DiscoveryProbe probe(discovery1.HostAddr(), g_msgPort);
+
+  // No heartbeats during the test.
+  discovery1.SetHeartbeatInterval(10000);
+  discovery1.Start();
+
+  uint16_t version;
+  ASSERT_TRUE(probe.WireVersion(version));
+
+  std::string topic = "/" + testing::getRandomNumber();
+  MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1, scope, "t");
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // A SYNC request addressed to discovery1 is answered.
+  Header header(version, transport::Uuid(), SyncType);
+  SyncMsg syncMsg(header, pUuid1, 0);
+  std::vector<char> msg(syncMsg.MsgLength());
+  ASSERT_EQ(syncMsg.Pack(msg.data()), msg.size());
+
+  auto sent = discovery1.SentDatagrams();
+  probe.SendMulticast(msg);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_GT(discovery1.SentDatagrams(), sent);
+
+  // Leave the body of the request in the receive buffer, using a wire
+  // version that makes discovery1 discard it.
+  Header wrongHeader(version + 1, transport::Uuid(), SyncType);
+  syncMsg.SetHeader(wrongHeader);
+  std::vector<char> wrongMsg(syncMsg.MsgLength());
+  ASSERT_EQ(syncMsg.Pack(wrongMsg.data()), wrongMsg.size());
+
+  sent = discovery1.SentDatagrams();
+  probe.SendMulticast(wrongMsg);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(discovery1.SentDatagrams(), sent);
+
+  // The same request without its body is discarded.
+  probe.SendMulticast(packHeader(header));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(discovery1.SentDatagrams(), sent);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the multicast copies of the messages of a process of
+/// this host are used when their local copies are lost.
+TEST(DiscoveryTest, TestLocalPeerMulticast)
+{
+  DiscoveryDerived<MessagePublisher> discovery1(pUuid1, g_msgPort);
+  DiscoveryProbe probe(discovery1.HostAddr(), g_msgPort);
+  discovery1.SetActivityInterval(100);
+  discovery1.SetSilenceInterval(500);
+
+  std::string pUuid3 = transport::Uuid().ToString();
+  std::atomic<int> disconnections(0);
+  discovery1.DisconnectionsCb(
+    [&pUuid3, &disconnections](const MessagePublisher &_publisher)
+    {
+      if (_publisher.PUuid() == pUuid3)
+        ++disconnections;
+    });
+  discovery1.Start();
+
+  uint16_t version;
+  ASSERT_TRUE(probe.WireVersion(version));
+
+  // A process of this host sends its first heartbeat through both paths.
+  auto heartbeat = packHeader(Header(version, pUuid3, HeartbeatType));
+  probe.SendLocal(pUuid1, heartbeat);
+  probe.SendMulticast(heartbeat);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  discovery1.TestActivity(pUuid3, true);
+
+  // The next heartbeats only arrive through the multicast group.
+  for (int i = 0; i < 10; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    probe.SendMulticast(heartbeat);
+  }
+  discovery1.TestActivity(pUuid3, true);
+  EXPECT_EQ(disconnections, 0);
+
+  // So does its BYE.
+  probe.SendMulticast(packHeader(Header(version, pUuid3, ByeType)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  discovery1.TestActivity(pUuid3, false);
+  EXPECT_EQ(disconnections, 1);
+}
+#endif
+
+//////////////////////////////////////////////////
+/// \brief Check that a process that lost the discovery state of a remote
+/// process synchronizes it again after the next heartbeat.
+TEST(DiscoveryTest, TestStateSync)
+{
+  std::string prefix = testing::getRandomNumber() + "_";
+  auto countTopics = [&prefix](const MsgDiscovery &_discovery)
+  {
+    std::vector<std::string> topics;
+    _discovery.TopicList(topics);
+    return std::count_if(topics.begin(), topics.end(),
+      [&prefix](const std::string &_topic)
+      {
+        return _topic.compare(0, prefix.size(), prefix) == 0;
+      });
+  };
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  discovery1.Start();
+  discovery2.Start();
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    MessagePublisher publisher(prefix + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, scope, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(countTopics(discovery2), 3);
+
+  // The changes are propagated incrementally.
+  EXPECT_TRUE(discovery1.Unadvertise(prefix + "0", nUuid1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(countTopics(discovery2), 2);
+
+  // Forget everything about discovery1.
+  EXPECT_TRUE(discovery2.PeerDisconnected(pUuid1));
+  EXPECT_EQ(countTopics(discovery2), 0);
+
+  // The next heartbeat of discovery1 triggers a synchronization.
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery1.HeartbeatInterval() * 2));
+  EXPECT_EQ(countTopics(discovery2), 2);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the requests for the same topic received at the same
+/// time are answered only once.
+TEST(DiscoveryTest, TestAnswerSuppression)
+{
+  std::string topic = "/" + testing::getRandomNumber();
+  std::string pUuid3 = transport::Uuid().ToString();
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  MsgDiscovery discovery3(pUuid3, g_msgPort);
+
+  // No heartbeats during the test.
+  discovery1.SetHeartbeatInterval(10000);
+
+  discovery1.Start();
+  discovery2.Start();
+  discovery3.Start();
+
+  MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1, scope, "t");
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  auto sent = discovery1.SentDatagrams();
+  EXPECT_TRUE(discovery2.Discover(topic));
+  EXPECT_TRUE(discovery3.Discover(topic));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(discovery1.SentDatagrams(), sent + 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the QUERY requests received at the same time are
+/// answered with a single snapshot.
+TEST(DiscoveryTest, TestQuerySuppression)
+{
+  std::string topic = "/" + testing::getRandomNumber();
+  std::string pUuid3 = transport::Uuid().ToString();
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+
+  // No heartbeats during the test.
+  discovery1.SetHeartbeatInterval(10000);
+  discovery1.Start();
+
+  MessagePublisher publisher(topic, addr1, ctrl1, pUuid1, nUuid1, scope, "t");
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // Two processes start together.
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  MsgDiscovery discovery3(pUuid3, g_msgPort);
+  auto sent = discovery1.SentDatagrams();
+  discovery2.Start();
+  discovery3.Start();
+
+  discovery2.WaitForInit();
+  discovery3.WaitForInit();
+  EXPECT_TRUE(discovery2.Info().HasTopic(topic));
+  EXPECT_TRUE(discovery3.Info().HasTopic(topic));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(discovery1.SentDatagrams(), sent + 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the rate of datagrams sent is limited.
+TEST(DiscoveryTest, TestSendRate)
+{
+  std::string prefix = testing::getRandomNumber() + "_";
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  EXPECT_GT(discovery1.MaxSendRate(), 0u);
+
+  // A burst of 20 datagrams and 100 datagrams per second after that.
+  discovery1.SetMaxSendRate(100);
+  EXPECT_EQ(discovery1.MaxSendRate(), 100u);
+  discovery1.Start();
+
+  auto sent = discovery1.SentDatagrams();
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < 60; ++i)
+  {
+    MessagePublisher publisher(prefix + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, scope, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // The callers don't wait: the datagrams over the burst are queued.
+  EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(
+    elapsed).count(), 200);
+  EXPECT_LT(discovery1.SentDatagrams(), sent + 60);
+
+  // The queued datagrams are sent at the maximum rate.
+  auto deadline = start + std::chrono::seconds(3);
+  while (discovery1.SentDatagrams() < sent + 60 &&
+         std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_GE(discovery1.SentDatagrams(), sent + 60);
+  EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(
+    elapsed).count(), 350);
+  EXPECT_EQ(discovery1.DroppedSendDatagrams(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a slow callback doesn't delay the reception of the
+/// discovery messages.
+TEST(DiscoveryTest, TestSlowCallback)
+{
+  const int numTopics = 5;
+  std::string prefix = testing::getRandomNumber() + "_";
+  std::atomic<int> numCallbacks(0);
+
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+
+  discovery2.ConnectionsCb(
+    [&prefix, &numCallbacks](const MessagePublisher &_publisher)
+    {
+      if (_publisher.Topic().compare(0, prefix.size(), prefix) != 0)
+        return;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      ++numCallbacks;
+    });
+
+  discovery1.Start();
+  discovery2.Start();
+
+  for (auto i = 0; i < numTopics; ++i)
+  {
+    MessagePublisher publisher(prefix + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, scope, "t");
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // All the topics are known while the callbacks are still running.
+  std::vector<std::string> topics;
+  discovery2.TopicList(topics);
+  auto numDiscovered = std::count_if(topics.begin(), topics.end(),
+    [&prefix](const std::string &_topic)
+    {
+      return _topic.compare(0, prefix.size(), prefix) == 0;
+    });
+  EXPECT_EQ(numDiscovered, numTopics);
+  EXPECT_LT(numCallbacks, numTopics);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    200 * numTopics + 200));
+  EXPECT_EQ(numCallbacks, numTopics);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a remote process can be declared gone before its silence
+/// interval expires.
+TEST(DiscoveryTest, TestPeerDisconnected)
+{
+  reset();
+
+  // Create two discovery nodes.
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+
+  // Register one callback for receiving disconnect notifications.
+  discovery2.DisconnectionsCb(onDisconnection);
+
+  discovery1.Start();
+  discovery2.Start();
+
+  // Unknown processes and myself are ignored.
+  EXPECT_FALSE(discovery2.PeerDisconnected("unknown"));
+  EXPECT_FALSE(discovery2.PeerDisconnected(pUuid2));
+  EXPECT_FALSE(disconnectionExecuted);
+
+  // Wait for the heartbeats of discovery1.
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery1.HeartbeatInterval() * 2));
+
+  EXPECT_TRUE(discovery2.PeerDisconnected(pUuid1));
+
+  // The process is already gone.
+  EXPECT_FALSE(discovery2.PeerDisconnected(pUuid1));
+
+  // The notification is delivered by the event thread.
+  waitForCallback(10, 10, disconnectionExecuted);
+  EXPECT_TRUE(disconnectionExecuted);
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that the discovery detects two publishers advertising the same
 /// topic name.
@@ -475,13 +1110,110 @@ TEST(DiscoveryTest, TestTwoPublishersSameTopic)
   EXPECT_EQ(g_counter, 2);
 }
 
+//////////////////////////////////////////////////
+/// \brief Discover topics and services through two views of the same
+/// engine. Each kind should only reach the view of its kind.
+TEST(DiscoveryTest, TestSharedEngine)
+{
+  std::string name = "/" + testing::getRandomNumber();
+
+  auto engine1 = std::make_shared<DiscoveryEngine>(pUuid1, g_msgPort);
+  std::unique_ptr<MsgDiscovery> msgDiscovery1(new MsgDiscovery(engine1));
+  std::unique_ptr<SrvDiscovery> srvDiscovery1(new SrvDiscovery(engine1));
+  engine1.reset();
+  msgDiscovery1->Start();
+  srvDiscovery1->Start();
+
+  // A topic and a service with the same name.
+  MessagePublisher msgPublisher(name, addr1, ctrl1, pUuid1, nUuid1, scope,
+    "t");
+  ServicePublisher srvPublisher(name, addr1, id1, pUuid1, nUuid1, scope,
+    "reqType", "repType");
+  EXPECT_TRUE(msgDiscovery1->Advertise(msgPublisher));
+  EXPECT_TRUE(srvDiscovery1->Advertise(srvPublisher));
+
+  // The complete state received on startup contains both kinds.
+  auto engine2 = std::make_shared<DiscoveryEngine>(pUuid2, g_msgPort);
+  MsgDiscovery msgDiscovery2(engine2);
+  SrvDiscovery srvDiscovery2(engine2);
+  EXPECT_EQ(msgDiscovery2.Engine(), srvDiscovery2.Engine());
+
+  std::atomic<int> msgConnections(0);
+  std::atomic<int> srvConnections(0);
+  std::atomic<int> msgDisconnections(0);
+  std::atomic<int> srvDisconnections(0);
+  msgDiscovery2.ConnectionsCb([&](const MessagePublisher &_pub)
+  {
+    EXPECT_EQ(_pub.MsgTypeName(), "t");
+    ++msgConnections;
+  });
+  srvDiscovery2.ConnectionsCb([&](const ServicePublisher &_pub)
+  {
+    EXPECT_EQ(_pub.ReqTypeName(), "reqType");
+    ++srvConnections;
+  });
+  msgDiscovery2.DisconnectionsCb([&](const MessagePublisher &_pub)
+  {
+    if (_pub.PUuid() == pUuid1)
+      ++msgDisconnections;
+  });
+  srvDiscovery2.DisconnectionsCb([&](const ServicePublisher &_pub)
+  {
+    if (_pub.PUuid() == pUuid1)
+      ++srvDisconnections;
+  });
+
+  msgDiscovery2.Start();
+  srvDiscovery2.WaitForInit();
+
+  EXPECT_TRUE(msgDiscovery2.Info().HasTopic(name));
+  EXPECT_TRUE(srvDiscovery2.Info().HasTopic(name));
+
+  int i = 0;
+  while (i < MaxIters && (msgConnections < 1 || srvConnections < 1))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(msgConnections, 1);
+  EXPECT_EQ(srvConnections, 1);
+
+  // Unadvertising the service doesn't affect the topic.
+  EXPECT_TRUE(srvDiscovery1->Unadvertise(name, nUuid1));
+  i = 0;
+  while (i < MaxIters && srvDisconnections < 1)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(srvDisconnections, 1);
+  EXPECT_EQ(msgDisconnections, 0);
+  EXPECT_TRUE(msgDiscovery2.Info().HasTopic(name));
+  EXPECT_FALSE(srvDiscovery2.Info().HasTopic(name));
+
+  // The engine stops with its last view and both kinds are notified.
+  msgDiscovery1.reset();
+  EXPECT_TRUE(msgDiscovery2.Info().HasTopic(name));
+  srvDiscovery1.reset();
+
+  i = 0;
+  while (i < MaxIters && (msgDisconnections < 1 || srvDisconnections < 2))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(msgDisconnections, 1);
+  EXPECT_EQ(srvDisconnections, 2);
+  EXPECT_FALSE(msgDiscovery2.Info().HasTopic(name));
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that a discovery service sends messages if there are
 /// topics or services advertised in its process.
 TEST(DiscoveryTest, TestActivity)
 {
-  auto proc1Uuid = testing::getRandomNumber();
-  auto proc2Uuid = testing::getRandomNumber();
+  auto proc1Uuid = transport::Uuid().ToString();
+  auto proc2Uuid = transport::Uuid().ToString();
   MessagePublisher publisher(g_topic, addr1, ctrl1, proc1Uuid, nUuid1, scope,
     "type");
   ServicePublisher srvPublisher(service, addr1, id1, proc2Uuid,
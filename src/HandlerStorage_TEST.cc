@@ -15,8 +15,11 @@
  *
 */
 
+#include <algorithm>
+#include <cctype>
 #include <map>
 #include <string>
+#include <vector>
 #include <ignition/msgs.hh>
 
 #include "ignition/transport/HandlerStorage.hh"
@@ -29,8 +32,8 @@ using namespace ignition;
 
 // Global variables used for multiple tests.
 std::string topic   = "foo";
-std::string nUuid1  = "node-UUID-1";
-std::string nUuid2  = "node-UUID-2";
+std::string nUuid1  = "00000000-0000-4000-8000-000000000001";
+std::string nUuid2  = "00000000-0000-4000-8000-000000000002";
 std::string hUuid   = "handler-UUID";
 int intResult       = 4;
 bool cbExecuted = false;
@@ -239,6 +242,96 @@ TEST(RepStorageTest, SubStorageNoCallbacks)
   EXPECT_EQ(handler->HandlerUuid(), sub1HandlerPtr->HandlerUuid());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that the handlers are stored by the value of their node and
+/// handler UUIDs.
+TEST(RepStorageTest, UuidKeys)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  std::vector<transport::ISubscriptionHandlerPtr> handlers;
+
+  EXPECT_FALSE(subs.Handlers(topic, handlers));
+  EXPECT_TRUE(handlers.empty());
+
+  std::shared_ptr<transport::SubscriptionHandler<ignition::msgs::Int32>>
+    sub1HandlerPtr(new transport::SubscriptionHandler
+      <ignition::msgs::Int32>(nUuid1));
+  std::shared_ptr<transport::SubscriptionHandler<ignition::msgs::Int32>>
+    sub2HandlerPtr(new transport::SubscriptionHandler
+      <ignition::msgs::Int32>(nUuid2));
+
+  subs.AddHandler(topic, nUuid2, sub2HandlerPtr);
+  subs.AddHandler(topic, nUuid1, sub1HandlerPtr);
+
+  // The handlers are listed in the order of their node UUIDs.
+  EXPECT_TRUE(subs.Handlers(topic, handlers));
+  ASSERT_EQ(handlers.size(), 2u);
+  EXPECT_EQ(handlers[0], sub1HandlerPtr);
+  EXPECT_EQ(handlers[1], sub2HandlerPtr);
+
+  // The upper case form of a UUID refers to the same node and handler.
+  std::string upperNode = nUuid1;
+  std::string upperHandler = sub1HandlerPtr->HandlerUuid();
+  std::transform(upperNode.begin(), upperNode.end(), upperNode.begin(),
+    ::toupper);
+  std::transform(upperHandler.begin(), upperHandler.end(),
+    upperHandler.begin(), ::toupper);
+
+  transport::ISubscriptionHandlerPtr h;
+  EXPECT_TRUE(subs.HasHandlersForNode(topic, upperNode));
+  EXPECT_TRUE(subs.Handler(topic, upperNode, upperHandler, h));
+  EXPECT_EQ(h, sub1HandlerPtr);
+  EXPECT_TRUE(subs.RemoveHandler(topic, upperNode, upperHandler));
+  EXPECT_FALSE(subs.HasHandlersForNode(topic, nUuid1));
+
+  EXPECT_TRUE(subs.Handlers(topic, handlers));
+  ASSERT_EQ(handlers.size(), 1u);
+  EXPECT_EQ(handlers[0], sub2HandlerPtr);
+
+  // The binary UUIDs refer to the same node and handler.
+  transport::Uuid node2(nUuid2);
+  transport::Uuid handler2(sub2HandlerPtr->HandlerUuid());
+  EXPECT_TRUE(subs.HasHandlersForNode(topic, node2));
+  EXPECT_TRUE(subs.Handler(topic, node2, handler2, h));
+  EXPECT_EQ(h, sub2HandlerPtr);
+  EXPECT_FALSE(subs.RemoveHandler(topic, node2, transport::Uuid("")));
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, node2));
+  EXPECT_FALSE(subs.HasHandlersForTopic(topic));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the handlers whose node or handler UUID is not valid
+/// are rejected.
+TEST(RepStorageTest, InvalidUuids)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  std::shared_ptr<transport::SubscriptionHandler<ignition::msgs::Int32>>
+    subHandlerPtr(new transport::SubscriptionHandler
+      <ignition::msgs::Int32>(nUuid1));
+  transport::Uuid node(nUuid1);
+  transport::Uuid handler(subHandlerPtr->HandlerUuid());
+
+  // The node UUID is not the string representation of a UUID.
+  subs.AddHandler(topic, "node-UUID", subHandlerPtr);
+  subs.AddHandler(topic, "", subHandlerPtr);
+  EXPECT_FALSE(subs.HasHandlersForTopic(topic));
+
+  // Nil UUIDs.
+  subs.AddHandler(topic, transport::Uuid(""), handler, subHandlerPtr);
+  subs.AddHandler(topic, node, transport::Uuid(""), subHandlerPtr);
+  EXPECT_FALSE(subs.HasHandlersForTopic(topic));
+
+  // The lookups with an invalid UUID don't find anything.
+  subs.AddHandler(topic, nUuid1, subHandlerPtr);
+  transport::ISubscriptionHandlerPtr h;
+  EXPECT_TRUE(subs.HasHandlersForNode(topic, nUuid1));
+  EXPECT_FALSE(subs.HasHandlersForNode(topic, "node-UUID"));
+  EXPECT_FALSE(subs.Handler(topic, nUuid1, hUuid, h));
+  EXPECT_FALSE(subs.RemoveHandler(topic, nUuid1, hUuid));
+  EXPECT_TRUE(subs.Handler(topic, node, handler, h));
+  EXPECT_EQ(h, subHandlerPtr);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
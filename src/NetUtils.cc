@@ -124,6 +124,34 @@ int transport::hostnameToIp(char *_hostname, std::string &_ip)
   return 1;
 }
 
+//////////////////////////////////////////////////
+bool transport::parseAddress(const std::string &_addr, const int _defaultPort,
+  std::string &_ip, int &_port)
+{
+  std::string host = _addr;
+  _port = _defaultPort;
+
+  auto pos = _addr.rfind(':');
+  if (pos != std::string::npos)
+  {
+    host = _addr.substr(0, pos);
+    std::string port = _addr.substr(pos + 1);
+    if (port.empty() || port.size() > 5 ||
+        port.find_first_not_of("0123456789") != std::string::npos)
+    {
+      return false;
+    }
+    _port = std::stoi(port);
+  }
+
+  if (host.empty() || _port <= 0 || _port > 65535)
+    return false;
+
+  std::vector<char> hostname(host.begin(), host.end());
+  hostname.push_back('\0');
+  return hostnameToIp(&hostname[0], _ip) == 0;
+}
+
 //////////////////////////////////////////////////
 std::string transport::determineHost()
 {
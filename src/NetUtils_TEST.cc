@@ -34,6 +34,27 @@ TEST(NetUtilsTest, username)
   EXPECT_TRUE(!transport::username().empty());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the parseAddress() function.
+TEST(NetUtilsTest, parseAddress)
+{
+  std::string ip;
+  int port;
+  EXPECT_TRUE(transport::parseAddress("127.0.0.1", 11317, ip, port));
+  EXPECT_EQ(ip, "127.0.0.1");
+  EXPECT_EQ(port, 11317);
+
+  EXPECT_TRUE(transport::parseAddress("127.0.0.1:12000", 11317, ip, port));
+  EXPECT_EQ(ip, "127.0.0.1");
+  EXPECT_EQ(port, 12000);
+
+  EXPECT_FALSE(transport::parseAddress("", 11317, ip, port));
+  EXPECT_FALSE(transport::parseAddress(":12000", 11317, ip, port));
+  EXPECT_FALSE(transport::parseAddress("127.0.0.1:", 11317, ip, port));
+  EXPECT_FALSE(transport::parseAddress("127.0.0.1:port", 11317, ip, port));
+  EXPECT_FALSE(transport::parseAddress("127.0.0.1:70000", 11317, ip, port));
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -38,6 +38,8 @@
 #include "ignition/transport/NodeOptions.hh"
 #include "ignition/transport/NodePrivate.hh"
 #include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/TopicStatistics.hh"
+#include "ignition/transport/TopicStatisticsPrivate.hh"
 #include "ignition/transport/TopicUtils.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
@@ -128,6 +130,20 @@ Node::Node(const NodeOptions &_options)
 
   // Save the options.
   this->dataPtr->options = _options;
+
+  // Apply the liveness settings requested for the discovery.
+  if (_options.HeartbeatInterval() > 0 || _options.SilenceInterval() > 0)
+  {
+    this->Shared()->SetDiscoveryIntervals(_options.HeartbeatInterval(),
+      _options.SilenceInterval());
+  }
+
+  // Publish the statistics of this process if requested.
+  if (_options.StatisticsInterval() > 0)
+  {
+    this->Shared()->EnableStatistics(_options.Partition(),
+      _options.StatisticsInterval());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -236,7 +252,8 @@ bool Node::Publish(const std::string &_topic, const ProtoMsg &_msg)
 //////////////////////////////////////////////////
 bool Node::PublishHelper(const std::string &_topic, const ProtoMsg &_msg)
 {
-  std::map<std::string, ISubscriptionHandler_M> handlers;
+  std::vector<ISubscriptionHandlerPtr> handlers;
+  std::shared_ptr<TopicCounters> counters;
   bool hasLocalSubscribers;
   bool hasRemoteSubscribers;
   {
@@ -253,14 +270,15 @@ bool Node::PublishHelper(const std::string &_topic, const ProtoMsg &_msg)
       this->dataPtr->shared->localSubscriptions.Handlers(_topic, handlers);
     hasRemoteSubscribers =
       this->dataPtr->shared->remoteSubscribers.HasTopic(_topic);
+    counters = this->dataPtr->shared->Counters(_topic);
   }
 
   // Check that the msg type matches the type previously advertised
   // for topic '_topic'.
   MessagePublisher pub;
   auto &info = this->dataPtr->shared->msgDiscovery->Info();
-  std::string procUuid = this->dataPtr->shared->pUuid;
-  std::string nodeUuid = this->dataPtr->nUuid;
+  const Uuid &procUuid = this->dataPtr->shared->pUuid;
+  Uuid nodeUuid(this->dataPtr->nUuid);
   if (!info.Publisher(_topic, procUuid, nodeUuid, pub))
   {
     std::cerr << "Node::Publish() I cannot find the msgType registered for "
@@ -276,29 +294,37 @@ bool Node::PublishHelper(const std::string &_topic, const ProtoMsg &_msg)
     return false;
   }
 
+  auto bytes = static_cast<uint64_t>(_msg.ByteSize());
+
   // Local subscribers.
   if (hasLocalSubscribers)
   {
-    for (auto &node : handlers)
+    int64_t published = TopicCounters::Now();
+    bool handled = false;
+    counters->AddReceived(bytes);
+
+    for (auto &subscriptionHandlerPtr : handlers)
     {
-      for (auto &handler : node.second)
+      if (subscriptionHandlerPtr)
+      {
+        if (subscriptionHandlerPtr->TypeName() != _msg.GetTypeName())
+          continue;
+
+        int64_t start = TopicCounters::Now();
+        subscriptionHandlerPtr->RunLocalCallback(_msg);
+        counters->AddCallback(start - published,
+          TopicCounters::Now() - start);
+        handled = true;
+      }
+      else
       {
-        ISubscriptionHandlerPtr subscriptionHandlerPtr = handler.second;
-
-        if (subscriptionHandlerPtr)
-        {
-          if (subscriptionHandlerPtr->TypeName() != _msg.GetTypeName())
-            continue;
-
-          subscriptionHandlerPtr->RunLocalCallback(_msg);
-        }
-        else
-        {
-          std::cerr << "Node::Publish(): Subscription handler is NULL"
-                    << std::endl;
-        }
+        std::cerr << "Node::Publish(): Subscription handler is NULL"
+                  << std::endl;
       }
     }
+
+    if (!handled)
+      counters->AddDropped();
   }
 
   // Remote subscribers.
@@ -311,13 +337,18 @@ bool Node::PublishHelper(const std::string &_topic, const ProtoMsg &_msg)
       return false;
     }
 
-    this->dataPtr->shared->Publish(_topic, data,
-      _msg.GetTypeName());
+    // A message that couldn't be sent is only counted as dropped.
+    if (!this->dataPtr->shared->Publish(_topic, data, _msg.GetTypeName()))
+    {
+      counters->AddDropped();
+      return true;
+    }
   }
   // Debug output.
   // else
   //   std::cout << "There are no remote subscribers...SKIP" << std::endl;
 
+  counters->AddSent(bytes);
   return true;
 }
 
@@ -551,6 +582,20 @@ NodeOptions &Node::Options() const
   return this->dataPtr->options;
 }
 
+//////////////////////////////////////////////////
+bool Node::TopicStatistics(const std::string &_topic,
+  transport::TopicStatistics &_stats) const
+{
+  std::string fullyQualifiedTopic;
+  if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+    this->Options().NameSpace(), _topic, fullyQualifiedTopic))
+  {
+    return false;
+  }
+
+  return this->dataPtr->shared->TopicStats(fullyQualifiedTopic, _stats);
+}
+
 //////////////////////////////////////////////////
 bool Node::TopicInfo(const std::string &_topic,
                      std::vector<MessagePublisher> &_publishers) const
@@ -34,6 +34,19 @@ NodeOptions::NodeOptions()
   std::string ignPartition;
   if (env("IGN_PARTITION", ignPartition))
     this->SetPartition(ignPartition);
+
+  // Check if the environment variable IGN_STATISTICS is present.
+  std::string ignStatistics;
+  if (env("IGN_STATISTICS", ignStatistics) && !ignStatistics.empty())
+  {
+    if (ignStatistics.size() > 9 ||
+        ignStatistics.find_first_not_of("0123456789") != std::string::npos ||
+        !this->SetStatisticsInterval(std::stoi(ignStatistics)))
+    {
+      std::cerr << "Invalid value [" << ignStatistics << "] in "
+                << "IGN_STATISTICS" << std::endl;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -53,6 +66,9 @@ NodeOptions &NodeOptions::operator=(const NodeOptions &_other)
 {
   this->SetNameSpace(_other.NameSpace());
   this->SetPartition(_other.Partition());
+  this->dataPtr->heartbeatInterval = _other.HeartbeatInterval();
+  this->dataPtr->silenceInterval = _other.SilenceInterval();
+  this->dataPtr->statisticsInterval = _other.StatisticsInterval();
   return *this;
 }
 
@@ -91,3 +107,57 @@ bool NodeOptions::SetPartition(const std::string &_partition)
   this->dataPtr->partition = _partition;
   return true;
 }
+
+//////////////////////////////////////////////////
+unsigned int NodeOptions::HeartbeatInterval() const
+{
+  return this->dataPtr->heartbeatInterval;
+}
+
+//////////////////////////////////////////////////
+bool NodeOptions::SetHeartbeatInterval(const unsigned int _ms)
+{
+  if (_ms == 0)
+  {
+    std::cerr << "Invalid heartbeat interval [" << _ms << "]" << std::endl;
+    return false;
+  }
+  this->dataPtr->heartbeatInterval = _ms;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int NodeOptions::SilenceInterval() const
+{
+  return this->dataPtr->silenceInterval;
+}
+
+//////////////////////////////////////////////////
+bool NodeOptions::SetSilenceInterval(const unsigned int _ms)
+{
+  if (_ms == 0)
+  {
+    std::cerr << "Invalid silence interval [" << _ms << "]" << std::endl;
+    return false;
+  }
+  this->dataPtr->silenceInterval = _ms;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int NodeOptions::StatisticsInterval() const
+{
+  return this->dataPtr->statisticsInterval;
+}
+
+//////////////////////////////////////////////////
+bool NodeOptions::SetStatisticsInterval(const unsigned int _ms)
+{
+  if (_ms == 0)
+  {
+    std::cerr << "Invalid statistics interval [" << _ms << "]" << std::endl;
+    return false;
+  }
+  this->dataPtr->statisticsInterval = _ms;
+  return true;
+}
@@ -72,6 +72,57 @@ TEST(NodeOptionsTest, accessors)
   EXPECT_EQ(opts.Partition(), defaultPartition);
   EXPECT_TRUE(opts.SetPartition(aPartition));
   EXPECT_EQ(opts.Partition(), aPartition);
+
+  // Heartbeat interval.
+  EXPECT_EQ(opts.HeartbeatInterval(), 0u);
+  EXPECT_FALSE(opts.SetHeartbeatInterval(0));
+  EXPECT_EQ(opts.HeartbeatInterval(), 0u);
+  EXPECT_TRUE(opts.SetHeartbeatInterval(200));
+  EXPECT_EQ(opts.HeartbeatInterval(), 200u);
+
+  // Silence interval.
+  EXPECT_EQ(opts.SilenceInterval(), 0u);
+  EXPECT_FALSE(opts.SetSilenceInterval(0));
+  EXPECT_EQ(opts.SilenceInterval(), 0u);
+  EXPECT_TRUE(opts.SetSilenceInterval(600));
+  EXPECT_EQ(opts.SilenceInterval(), 600u);
+
+  // Statistics interval.
+  EXPECT_EQ(opts.StatisticsInterval(), 0u);
+  EXPECT_FALSE(opts.SetStatisticsInterval(0));
+  EXPECT_EQ(opts.StatisticsInterval(), 0u);
+  EXPECT_TRUE(opts.SetStatisticsInterval(1000));
+  EXPECT_EQ(opts.StatisticsInterval(), 1000u);
+
+  // Copy constructor.
+  transport::NodeOptions opts2(opts);
+  EXPECT_EQ(opts2.HeartbeatInterval(), 200u);
+  EXPECT_EQ(opts2.SilenceInterval(), 600u);
+  EXPECT_EQ(opts2.StatisticsInterval(), 1000u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that IGN_STATISTICS is used.
+TEST(NodeOptionsTest, ignStatistics)
+{
+  setenv("IGN_STATISTICS", "500", 1);
+  transport::NodeOptions opts;
+  EXPECT_EQ(opts.StatisticsInterval(), 500u);
+
+  // A value set by the user should overwrite IGN_STATISTICS.
+  EXPECT_TRUE(opts.SetStatisticsInterval(2000));
+  EXPECT_EQ(opts.StatisticsInterval(), 2000u);
+
+  // Invalid values are ignored.
+  setenv("IGN_STATISTICS", "0", 1);
+  transport::NodeOptions opts2;
+  EXPECT_EQ(opts2.StatisticsInterval(), 0u);
+
+  setenv("IGN_STATISTICS", "-100", 1);
+  transport::NodeOptions opts3;
+  EXPECT_EQ(opts3.StatisticsInterval(), 0u);
+
+  unsetenv("IGN_STATISTICS");
 }
 
 //////////////////////////////////////////////////
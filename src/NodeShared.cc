@@ -23,11 +23,15 @@
 #pragma warning(pop)
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <set>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -43,11 +47,17 @@
 
 #include "ignition/transport/Discovery.hh"
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/NetUtils.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeOptions.hh"
 #include "ignition/transport/NodeShared.hh"
 #include "ignition/transport/Packet.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
 #include "ignition/transport/SubscriptionHandler.hh"
+#include "ignition/transport/TopicStatistics.hh"
+#include "ignition/transport/TopicStatisticsPrivate.hh"
+#include "ignition/transport/TopicUtils.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
 
@@ -69,6 +79,16 @@ NodeShared *NodeShared::Instance()
 NodeShared::NodeShared()
   : timeout(Timeout),
     exit(false),
+    heartbeatInterval(0),
+    silenceInterval(0),
+    reroutedRequests(0),
+    requestTimeouts(RequestTimerResolution),
+    hedgeTimers(RequestTimerResolution),
+    hedgedRequests(0),
+    expiredRequests(0),
+    statsInterval(0),
+    statsLast(0),
+    receptionBusy(0),
     verbose(false),
     context(new zmq::context_t(1)),
     publisher(new zmq::socket_t(*context, ZMQ_PUB)),
@@ -76,7 +96,9 @@ NodeShared::NodeShared()
     control(new zmq::socket_t(*context, ZMQ_DEALER)),
     requester(new zmq::socket_t(*context, ZMQ_ROUTER)),
     responseReceiver(new zmq::socket_t(*context, ZMQ_ROUTER)),
-    replier(new zmq::socket_t(*context, ZMQ_ROUTER))
+    replier(new zmq::socket_t(*context, ZMQ_ROUTER)),
+    subscriberMonitor(new zmq::socket_t(*context, ZMQ_PAIR)),
+    requesterMonitor(new zmq::socket_t(*context, ZMQ_PAIR))
 {
   // If IGN_VERBOSE=1 enable the verbose mode.
   std::string ignVerbose;
@@ -84,13 +106,58 @@ NodeShared::NodeShared()
 
   char bindEndPoint[1024];
 
-  // My process UUID.
-  Uuid uuid;
-  this->pUuid = uuid.ToString();
+  // Initialize my discovery service. Topics and services are discovered by
+  // the same engine.
+  std::shared_ptr<DiscoveryEngine> discovery =
+    std::make_shared<DiscoveryEngine>(this->pUuid.ToString(),
+      this->kDiscPort);
+  this->msgDiscovery.reset(new MsgDiscovery(discovery));
+  this->srvDiscovery.reset(new SrvDiscovery(discovery));
+
+  // Static discovery peers for networks without multicast. IGN_DISCOVERY_PEERS
+  // is a comma separated list of "host[:port]". Without port, the peer is
+  // another process using the default discovery port. With port, the peer is
+  // usually a DiscoveryRelay listening on "port".
+  std::string ignPeers;
+  if (env("IGN_DISCOVERY_PEERS", ignPeers))
+  {
+    std::stringstream stream(ignPeers);
+    std::string peer;
+    while (std::getline(stream, peer, ','))
+    {
+      if (peer.empty())
+        continue;
+
+      std::string ip;
+      int port;
+      if (!parseAddress(peer, this->kDiscPort, ip, port))
+      {
+        std::cerr << "Invalid discovery peer [" << peer << "] in "
+                  << "IGN_DISCOVERY_PEERS" << std::endl;
+        continue;
+      }
+
+      discovery->AddStaticPeer(ip + ":" + std::to_string(port));
+    }
+  }
+
+  // Size of the kernel buffer of the discovery socket (bytes).
+  std::string ignRcvBuf;
+  if (env("IGN_DISCOVERY_RCVBUF", ignRcvBuf) && !ignRcvBuf.empty())
+  {
+    int rcvBufSize = 0;
+    if (ignRcvBuf.size() <= 9 &&
+        ignRcvBuf.find_first_not_of("0123456789") == std::string::npos)
+    {
+      rcvBufSize = std::stoi(ignRcvBuf);
+    }
 
-  // Initialize my discovery services.
-  this->msgDiscovery.reset(new MsgDiscovery(this->pUuid, this->kMsgDiscPort));
-  this->srvDiscovery.reset(new SrvDiscovery(this->pUuid, this->kSrvDiscPort));
+    if (rcvBufSize <= 0 || !discovery->SetReceiveBufferSize(rcvBufSize))
+    {
+      std::cerr << "Invalid value [" << ignRcvBuf << "] in "
+                << "IGN_DISCOVERY_RCVBUF" << std::endl;
+    }
+  }
 
   // Initialize the 0MQ objects.
   try
@@ -114,7 +181,8 @@ NodeShared::NodeShared()
     this->myControlAddress = bindEndPoint;
 
     // ResponseReceiver socket listening in a random port.
-    std::string id = this->responseReceiverId.ToString();
+    this->myResponseReceiverId = this->responseReceiverId.ToString();
+    std::string id = this->myResponseReceiverId;
     this->responseReceiver->setsockopt(ZMQ_IDENTITY, id.c_str(), id.size());
     this->responseReceiver->bind(anyTcpEp.c_str());
     this->responseReceiver->getsockopt(ZMQ_LAST_ENDPOINT, &bindEndPoint, &size);
@@ -133,6 +201,18 @@ NodeShared::NodeShared()
     this->requester->setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
     this->requester->setsockopt(ZMQ_ROUTER_MANDATORY, &RouteOn,
       sizeof(RouteOn));
+
+    // Monitor the connections with the remote publishers and responders, so
+    // a process that closes its connections is detected without waiting for
+    // the silence interval of the discovery. The format of the monitor
+    // events changed in ZeroMQ 4, the older versions rely on the silence
+    // interval only.
+#if ZMQ_VERSION >= ZMQ_MAKE_VERSION(4, 0, 0)
+    this->StartMonitor(*this->subscriber, *this->subscriberMonitor,
+      "subscriber");
+    this->StartMonitor(*this->requester, *this->requesterMonitor,
+      "requester");
+#endif
   }
   catch(const zmq::error_t& ze)
   {
@@ -177,9 +257,8 @@ NodeShared::NodeShared()
   srvDiscovery->DisconnectionsCb(std::bind(&NodeShared::OnNewSrvDisconnection,
     this, std::placeholders::_1));
 
-  // Start the discovery services.
-  msgDiscovery->Start();
-  srvDiscovery->Start();
+  // Start the discovery service.
+  discovery->Start();
 }
 
 //////////////////////////////////////////////////
@@ -190,6 +269,16 @@ NodeShared::~NodeShared()
   this->exit = true;
   this->exitMutex.unlock();
 
+  // Cancel the streaming responses in progress.
+  std::map<Uuid, std::thread> threads;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    for (auto &stream : this->srvStreams)
+      stream.second->cancelled = true;
+    this->streamCondition.notify_all();
+    threads.swap(this->streamThreads);
+  }
+
   // Don't join on Windows, because it can hang when this object
   // is destructed on process exit (e.g., when it's a global static).
   // I think that it's due to this bug:
@@ -198,7 +287,16 @@ NodeShared::~NodeShared()
   // Wait for the service thread before exit.
   if (this->threadReception.joinable())
     this->threadReception.join();
+
+  for (auto &thread : threads)
+  {
+    if (thread.second.joinable())
+      thread.second.join();
+  }
 #else
+  for (auto &thread : threads)
+    thread.second.detach();
+
   bool exitLoop = false;
   while (!exitLoop)
   {
@@ -215,6 +313,9 @@ NodeShared::~NodeShared()
   // destructor to hang (probably waiting for ZMQ sockets to terminate).
   // ToDo: Fix it.
 #endif
+
+  // The reception thread is gone, nobody else publishes statistics.
+  this->statsNode.reset();
 }
 
 //////////////////////////////////////////////////
@@ -229,17 +330,51 @@ void NodeShared::RunReceptionTask()
       {static_cast<void*>(*this->subscriber), 0, ZMQ_POLLIN, 0},
       {static_cast<void*>(*this->control), 0, ZMQ_POLLIN, 0},
       {static_cast<void*>(*this->replier), 0, ZMQ_POLLIN, 0},
-      {static_cast<void*>(*this->responseReceiver), 0, ZMQ_POLLIN, 0}
+      {static_cast<void*>(*this->responseReceiver), 0, ZMQ_POLLIN, 0},
+      {static_cast<void*>(*this->subscriberMonitor), 0, ZMQ_POLLIN, 0},
+      {static_cast<void*>(*this->requesterMonitor), 0, ZMQ_POLLIN, 0}
     };
+    // Wake up on time for the next timeout or hedging timer. The timers of
+    // the completed requests stay in the wheels until their deadline, so
+    // the wait depends on the next deadline instead of the pending timers.
+    int pollTimeout = this->timeout;
+    {
+      std::lock_guard<std::recursive_mutex> lock(this->mutex);
+      auto now = std::chrono::steady_clock::now();
+      Timestamp deadline;
+      for (auto wheel : {&this->requestTimeouts, &this->hedgeTimers})
+      {
+        if (!wheel->NextDeadline(deadline))
+          continue;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - now).count() + 1;
+        pollTimeout = std::min(pollTimeout,
+          static_cast<int>(std::max(remaining, static_cast<int64_t>(0))));
+      }
+
+      // Wake up on time for publishing the statistics.
+      if (this->statsNode)
+      {
+        int64_t next = this->statsLast +
+          static_cast<int64_t>(this->statsInterval) * 1000000;
+        int64_t remaining = (next - TopicCounters::Now()) / 1000000;
+        pollTimeout = std::min(pollTimeout,
+          static_cast<int>(std::max(remaining, static_cast<int64_t>(0))));
+      }
+    }
+
     try
     {
-      zmq::poll(&items[0], sizeof(items) / sizeof(items[0]), this->timeout);
+      zmq::poll(&items[0], sizeof(items) / sizeof(items[0]), pollTimeout);
     }
     catch(...)
     {
       continue;
     }
 
+    int64_t wakeUp = TopicCounters::Now();
+
     //  If we got a reply, process it.
     if (items[0].revents & ZMQ_POLLIN)
       this->RecvMsgUpdate();
@@ -249,6 +384,24 @@ void NodeShared::RunReceptionTask()
       this->RecvSrvRequest();
     if (items[3].revents & ZMQ_POLLIN)
       this->RecvSrvResponse();
+    if (items[4].revents & ZMQ_POLLIN)
+      this->RecvMonitorEvent(*this->subscriberMonitor);
+    if (items[5].revents & ZMQ_POLLIN)
+      this->RecvMonitorEvent(*this->requesterMonitor);
+
+    // Discard the service call requests that didn't receive a response.
+    this->ExpireRequests();
+
+    // Send the slow service call requests to a second responder.
+    this->HedgeRequests();
+
+    // Release the threads of the streaming services already finished.
+    this->JoinFinishedStreams();
+
+    this->receptionBusy += TopicCounters::Now() - wakeUp;
+
+    // Publish the statistics of this process (if enabled).
+    this->PublishStatistics();
 
     // Is it time to exit?
     {
@@ -306,8 +459,10 @@ void NodeShared::RecvMsgUpdate()
   // std::string sender;
   std::string data;
   std::string msgType;
-  std::map<std::string, ISubscriptionHandler_M> handlers;
+  std::vector<ISubscriptionHandlerPtr> handlers;
   ISubscriptionHandlerPtr firstSubscriberPtr;
+  std::shared_ptr<TopicCounters> counters;
+  int64_t received;
   bool handlersFound;
   bool firstHandlerFound;
 
@@ -332,6 +487,7 @@ void NodeShared::RecvMsgUpdate()
       if (!this->subscriber->recv(&msg, 0))
         return;
       msgType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      received = TopicCounters::Now();
     }
     catch(const zmq::error_t &_error)
     {
@@ -342,31 +498,38 @@ void NodeShared::RecvMsgUpdate()
     handlersFound = this->localSubscriptions.Handlers(topic, handlers);
     firstHandlerFound = this->localSubscriptions.FirstHandler(topic, msgType,
       firstSubscriberPtr);
+    counters = this->Counters(topic);
   }
 
+  counters->AddReceived(data.size());
+
   // Execute the callbacks registered.
   if (handlersFound && firstHandlerFound)
   {
     // Create the message.
     auto recvMsg = firstSubscriberPtr->CreateMsg(data);
 
-    for (const auto &node : handlers)
+    for (const auto &subscriptionHandlerPtr : handlers)
     {
-      for (const auto &handler : node.second)
+      if (subscriptionHandlerPtr)
       {
-        ISubscriptionHandlerPtr subscriptionHandlerPtr = handler.second;
-        if (subscriptionHandlerPtr)
+        if (subscriptionHandlerPtr->TypeName() == msgType)
         {
-          if (subscriptionHandlerPtr->TypeName() == msgType)
-            subscriptionHandlerPtr->RunLocalCallback(*recvMsg);
+          int64_t start = TopicCounters::Now();
+          subscriptionHandlerPtr->RunLocalCallback(*recvMsg);
+          counters->AddCallback(start - received,
+            TopicCounters::Now() - start);
         }
-        else
-          std::cerr << "Subscription handler is NULL" << std::endl;
       }
+      else
+        std::cerr << "Subscription handler is NULL" << std::endl;
     }
   }
   else
+  {
+    counters->AddDropped();
     std::cerr << "I am not subscribed to topic [" << topic << "]" << std::endl;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -442,14 +605,16 @@ void NodeShared::RecvSrvRequest()
   zmq::message_t msg(0);
   std::string topic;
   std::string sender;
-  std::string nodeUuid;
-  std::string reqUuid;
+  Uuid nodeUuid("");
+  Uuid reqUuid("");
+  bool validUuids = true;
   std::string req;
   std::string rep;
   std::string resultStr;
   std::string dstId;
   std::string reqType;
   std::string repType;
+  std::string kindStr;
 
   IRepHandlerPtr repHandler;
   bool hasHandler;
@@ -474,13 +639,20 @@ void NodeShared::RecvSrvRequest()
         return;
       dstId = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
+      // The node and request UUIDs are sent in binary form.
       if (!this->replier->recv(&msg, 0))
         return;
-      nodeUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (msg.size() == Uuid::ByteLength)
+        nodeUuid.Unpack(reinterpret_cast<char *>(msg.data()));
+      else
+        validUuids = false;
 
       if (!this->replier->recv(&msg, 0))
         return;
-      reqUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (msg.size() == Uuid::ByteLength)
+        reqUuid.Unpack(reinterpret_cast<char *>(msg.data()));
+      else
+        validUuids = false;
 
       if (!this->replier->recv(&msg, 0))
         return;
@@ -493,6 +665,10 @@ void NodeShared::RecvSrvRequest()
       if (!this->replier->recv(&msg, 0))
         return;
       repType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+
+      if (!this->replier->recv(&msg, 0))
+        return;
+      kindStr = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
     }
     catch(const zmq::error_t &_error)
     {
@@ -501,83 +677,108 @@ void NodeShared::RecvSrvRequest()
       return;
     }
 
-    hasHandler =
-      this->repliers.FirstHandler(topic, reqType, repType, repHandler);
-  }
-
-  // Get the REP handler.
-  if (hasHandler)
-  {
-    bool result;
-    // Run the service call and get the results.
-    repHandler->RunCallback(req, rep, result);
-
-    // If 'reptype' is msgs::Empty", this is a oneway request
-    // and we don't send response
-    if (repType == ignition::msgs::Empty().GetTypeName())
+    // All the frames are consumed before discarding a malformed request.
+    if (!validUuids)
     {
+      std::cerr << "NodeShared::RecvSrvRequest() invalid request UUIDs"
+                << std::endl;
       return;
     }
 
-    if (result)
-      resultStr = "1";
-    else
-      resultStr = "0";
-
+    // Flow control messages of a streaming response in progress.
+    if (kindStr == std::to_string(StreamCredit) ||
+        kindStr == std::to_string(StreamCancel))
     {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
-      // I am still not connected to this address.
-      if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-            sender) == this->srvConnections.end())
-      {
-        this->replier->connect(sender.c_str());
-        this->srvConnections.push_back(sender);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      auto it = this->srvStreams.find(reqUuid);
+      if (it == this->srvStreams.end())
+        return;
 
-        if (this->verbose)
+      if (kindStr == std::to_string(StreamCancel))
+        it->second->cancelled = true;
+      else
+      {
+        try
+        {
+          it->second->credits += std::stoul(req);
+        }
+        catch(...)
         {
-          std::cout << "\t* Connected to [" << sender
-                    << "] for sending a response" << std::endl;
+          std::cerr << "NodeShared::RecvSrvRequest() error parsing stream "
+                    << "credits [" << req << "]" << std::endl;
+          return;
         }
       }
-    }
 
-    // Send the reply.
-    try
-    {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
-      zmq::message_t response;
-
-      response.rebuild(dstId.size());
-      memcpy(response.data(), dstId.data(), dstId.size());
-      this->replier->send(response, ZMQ_SNDMORE);
+      this->streamCondition.notify_all();
+      return;
+    }
 
-      response.rebuild(topic.size());
-      memcpy(response.data(), topic.data(), topic.size());
-      this->replier->send(response, ZMQ_SNDMORE);
+    hasHandler =
+      this->repliers.FirstHandler(topic, reqType, repType, repHandler);
 
-      response.rebuild(nodeUuid.size());
-      memcpy(response.data(), nodeUuid.data(), nodeUuid.size());
-      this->replier->send(response, ZMQ_SNDMORE);
+    if (hasHandler && kindStr == std::to_string(StreamRequest))
+    {
+      std::shared_ptr<SrvStream> stream(new SrvStream());
+      stream->topic = topic;
+      stream->sender = sender;
+      stream->dstId = dstId;
+      stream->nodeUuid = nodeUuid;
+      stream->reqUuid = reqUuid;
+      this->StartStream(repHandler, stream, req);
+      return;
+    }
+  }
 
-      response.rebuild(reqUuid.size());
-      memcpy(response.data(), reqUuid.data(), reqUuid.size());
-      this->replier->send(response, ZMQ_SNDMORE);
+  // Get the REP handler.
+  if (hasHandler)
+  {
+    if (kindStr == std::to_string(BatchRequest))
+    {
+      BatchMsg reqs;
+      if (!reqs.Unpack(req.data(), req.size()))
+      {
+        std::cerr << "NodeShared::RecvSrvRequest() error unpacking batch "
+                  << "request" << std::endl;
+        return;
+      }
 
-      response.rebuild(rep.size());
-      memcpy(response.data(), rep.data(), rep.size());
-      this->replier->send(response, ZMQ_SNDMORE);
+      // Run the service call for each item. The responses are sent back
+      // together, with one result per item.
+      BatchMsg reps;
+      for (const auto &item : reqs.Items())
+      {
+        std::string itemRep;
+        bool itemResult;
+        repHandler->RunCallback(item, itemRep, itemResult);
+        reps.AddItem(itemRep);
+        resultStr += itemResult ? "1" : "0";
+      }
 
-      response.rebuild(resultStr.size());
-      memcpy(response.data(), resultStr.data(), resultStr.size());
-      this->replier->send(response, 0);
+      rep.resize(reps.MsgLength());
+      reps.Pack(&rep[0]);
     }
-    catch(const zmq::error_t &_error)
+    else
+    {
+      bool result;
+      // Run the service call and get the results.
+      repHandler->RunCallback(req, rep, result);
+
+      if (result)
+        resultStr = "1";
+      else
+        resultStr = "0";
+    }
+
+    // If 'reptype' is msgs::Empty", this is a oneway request
+    // and we don't send response
+    if (repType == ignition::msgs::Empty().GetTypeName())
     {
-      std::cerr << "NodeShared::RecvSrvRequest() error sending response: "
-                << _error.what() << std::endl;
       return;
     }
+
+    // Send the reply.
+    this->SendResponse(sender, dstId, topic, nodeUuid, reqUuid, rep,
+      resultStr, "");
   }
   // else
   //   std::cerr << "I do not have a service call registered for topic ["
@@ -592,11 +793,14 @@ void NodeShared::RecvSrvResponse()
 
   zmq::message_t msg(0);
   std::string topic;
-  std::string nodeUuid;
-  std::string reqUuid;
+  Uuid nodeUuid("");
+  Uuid reqUuid("");
+  bool validUuids = true;
   std::string rep;
   std::string resultStr;
-  bool result;
+  std::string streamInfo;
+  bool streaming = false;
+  bool last = true;
 
   IReqHandlerPtr reqHandlerPtr;
   bool hasHandler;
@@ -613,13 +817,20 @@ void NodeShared::RecvSrvResponse()
         return;
       topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
+      // The node and request UUIDs are sent in binary form.
       if (!this->responseReceiver->recv(&msg, 0))
         return;
-      nodeUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (msg.size() == Uuid::ByteLength)
+        nodeUuid.Unpack(reinterpret_cast<char *>(msg.data()));
+      else
+        validUuids = false;
 
       if (!this->responseReceiver->recv(&msg, 0))
         return;
-      reqUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (msg.size() == Uuid::ByteLength)
+        reqUuid.Unpack(reinterpret_cast<char *>(msg.data()));
+      else
+        validUuids = false;
 
       if (!this->responseReceiver->recv(&msg, 0))
         return;
@@ -628,7 +839,11 @@ void NodeShared::RecvSrvResponse()
       if (!this->responseReceiver->recv(&msg, 0))
         return;
       resultStr = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
-      result = resultStr == "1";
+
+      if (!this->responseReceiver->recv(&msg, 0))
+        return;
+      streamInfo =
+        std::string(reinterpret_cast<char *>(msg.data()), msg.size());
     }
     catch(const zmq::error_t &_error)
     {
@@ -637,25 +852,108 @@ void NodeShared::RecvSrvResponse()
       return;
     }
 
+    // All the frames are consumed before discarding a malformed response.
+    if (!validUuids)
+    {
+      std::cerr << "NodeShared::RecvSrvResponse() invalid response UUIDs"
+                << std::endl;
+      return;
+    }
+
     hasHandler =
       this->requests.Handler(topic, nodeUuid, reqUuid, reqHandlerPtr);
-  }
 
-  if (hasHandler)
-  {
-    // Notify the result.
-    reqHandlerPtr->NotifyResult(rep, result);
+    // A chunk of a streaming response ("seq:last").
+    streaming = hasHandler && !streamInfo.empty();
+    if (streaming)
+    {
+      uint64_t seq = 0;
+      bool valid = false;
+      auto sep = streamInfo.find(':');
+      if (sep != std::string::npos)
+      {
+        try
+        {
+          seq = std::stoull(streamInfo.substr(0, sep));
+          last = streamInfo.substr(sep + 1) == "1";
+          valid = true;
+        }
+        catch(...)
+        {
+        }
+      }
 
-    // Remove the handler.
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+      // The chunks should arrive in order and without gaps, otherwise the
+      // stream is aborted.
+      auto &expected = this->streamSeqs[reqUuid];
+      if (!valid || seq != expected)
+      {
+        std::cerr << "NodeShared::RecvSrvResponse(): Unexpected chunk ["
+                  << streamInfo << "] in stream [" << reqUuid << "]"
+                  << std::endl;
+        this->SendStreamControl(topic, reqHandlerPtr, StreamCancel, "");
+        rep.clear();
+        resultStr = "0";
+        last = true;
+      }
+      else
+        ++expected;
+    }
+
+    if (hasHandler && last)
     {
-      if (!this->requests.RemoveHandler(topic, nodeUuid, reqUuid))
+      // Remove the handler before notifying the result, this way the request
+      // can't expire while the callback is running.
+      if (!this->RemoveRequest(topic, reqHandlerPtr))
       {
         std::cerr << "NodeShare::RecvSrvResponse(): "
                   << "Error removing request handler" << std::endl;
       }
+
+      // Keep track of the service latency (the duration of a stream is not
+      // representative).
+      if (!streaming)
+      {
+        auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - reqHandlerPtr->SentTime()).count();
+        auto &samples = this->srvLatencies[topic];
+        samples.push_back(static_cast<unsigned int>(latency));
+        if (samples.size() > MaxLatencySamples)
+          samples.pop_front();
+      }
+
+      // The other responder might answer too, or an aborted stream might
+      // receive more chunks.
+      if (reqHandlerPtr->Hedged() || streaming)
+        this->AddCompletedRequest(reqUuid);
+    }
+    else if (this->completedRequests.find(reqUuid) !=
+             this->completedRequests.end())
+    {
+      // Duplicated response of a hedged request or late response of an
+      // expired request.
+      return;
+    }
+  }
+
+  if (streaming)
+  {
+    // Notify the chunk.
+    reqHandlerPtr->NotifyChunk(rep, resultStr == "1", last);
+
+    // Let the responder know that we are ready for more chunks.
+    unsigned int credits = reqHandlerPtr->StreamCredits();
+    if (!last && credits > 0)
+    {
+      this->SendStreamControl(topic, reqHandlerPtr, StreamCredit,
+        std::to_string(credits));
     }
   }
+  else if (hasHandler)
+  {
+    // Notify the result.
+    reqHandlerPtr->NotifyResults(rep, resultStr);
+  }
   else
   {
     std::cerr << "Received a service call response but I don't have a handler"
@@ -664,158 +962,1151 @@ void NodeShared::RecvSrvResponse()
 }
 
 //////////////////////////////////////////////////
-void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
-  const std::string &_reqType, const std::string &_repType)
+bool NodeShared::StartMonitor(zmq::socket_t &_socket, zmq::socket_t &_monitor,
+  const std::string &_name)
 {
-  std::string responserAddr;
-  std::string responserId;
-  SrvAddresses_M addresses;
-  this->srvDiscovery->Publishers(_topic, addresses);
-  if (addresses.empty())
-    return;
+  std::string ep = "inproc://ign-transport-monitor-" + _name + "-" +
+    this->pUuid.ToString();
+
+  if (zmq_socket_monitor(static_cast<void*>(_socket), ep.c_str(),
+        ZMQ_EVENT_DISCONNECTED) != 0)
+  {
+    std::cerr << "NodeShared::StartMonitor() Error monitoring the "
+              << _name << " socket" << std::endl;
+    return false;
+  }
+
+  _monitor.connect(ep.c_str());
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RecvMonitorEvent(zmq::socket_t &_monitor)
+{
+  uint16_t event = 0;
+  std::string endpoint;
+  Uuid procUuid("");
 
-  // Find a publisher that offers this service with a particular pair of REQ/REP
-  // types.
-  bool found = false;
-  for (auto &proc : addresses)
   {
-    auto &v = proc.second;
-    for (auto &pub : v)
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    // Each event is composed of two frames: the event id and value, followed
+    // by the endpoint affected.
+    zmq::message_t msg;
+    try
     {
-      if (pub.ReqTypeName() == _reqType && pub.RepTypeName() == _repType)
-      {
-        found = true;
-        responserAddr = pub.Addr();
-        responserId = pub.SocketId();
-        break;
-      }
+      if (!_monitor.recv(&msg, 0))
+        return;
+      if (msg.size() >= sizeof(event))
+        memcpy(&event, msg.data(), sizeof(event));
+
+      if (!_monitor.recv(&msg, 0))
+        return;
+      endpoint = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+    }
+    catch(const zmq::error_t &_error)
+    {
+      std::cerr << "Error: " << _error.what() << std::endl;
+      return;
     }
-    if (found)
-      break;
-  }
 
-  if (!found)
-    return;
+    if (event != ZMQ_EVENT_DISCONNECTED)
+      return;
 
-  if (verbose)
+    auto it = this->endpointProcs.find(endpoint);
+    if (it == this->endpointProcs.end())
+      return;
+
+    procUuid = it->second;
+  }
+
+  if (this->verbose)
   {
-    std::cout << "Found a service call responser at ["
-              << responserAddr << "]" << std::endl;
+    std::cout << "Connection with [" << endpoint << "] lost. Process ["
+              << procUuid << "] is gone" << std::endl;
   }
 
+  // Notify the disconnection through the discovery, as if the silence
+  // interval had expired.
+  this->msgDiscovery->PeerDisconnected(procUuid);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendPendingRemoteReqs(const std::string &_topic,
+  const std::string &_reqType, const std::string &_repType)
+{
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-  // I am still not connected to this address.
-  if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-        responserAddr) == this->srvConnections.end())
+  // Get the requests not sent yet for this service and pair of REQ/REP types.
+  auto queuePtr = this->srvQueues.Find(_topic, _reqType, _repType);
+  if (!queuePtr)
+    return false;
+
+  // Get the publishers that offer this service with the same pair of REQ/REP
+  // types. The cache is only refreshed from the discovery when it's empty.
+  auto &queue = *queuePtr;
+  if (queue.Empty())
+    return !queue.Responders().empty();
+
+  this->UpdateResponders(_topic, _reqType, _repType, queue);
+  const auto &responders = queue.Responders();
+  if (responders.empty())
+    return false;
+
+  // Send all the pending REQs. The requests removed while waiting (e.g.:
+  // expired) are skipped by the queue.
+  std::vector<IReqHandlerPtr> failed;
+  std::vector<IReqHandlerPtr> invalid;
+  IReqHandlerPtr handler;
+  while (queue.Pop(handler))
   {
-    this->requester->connect(responserAddr.c_str());
-    this->srvConnections.push_back(responserAddr);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    if (this->verbose)
+    // Check if this service call has been already requested.
+    if (handler->Requested())
+      continue;
+
+    // A request that can't be serialized will never be sent.
+    std::string data;
+    if (!handler->Serialize(data))
     {
-      std::cout << "\t* Connected to [" << responserAddr
-                << "] for service requests" << std::endl;
+      this->requests.RemoveHandler(_topic, handler->NodeId(),
+        handler->HandlerId());
+      invalid.push_back(handler);
+      continue;
     }
-  }
 
-  // Send all the pending REQs.
-  IReqHandler_M reqs;
-  if (!this->requests.Handlers(_topic, reqs))
-    return;
+    auto index = this->SelectResponder(_topic, responders, handler->Policy());
+    const auto &responder = responders.at(index);
 
-  for (auto &node : reqs)
-  {
-    for (auto &req : node.second)
+    // The request couldn't be sent, it will be queued again. Its timeout is
+    // still in place.
+    if (!this->SendRequest(_topic, responder, handler, data))
     {
-      // Check if this service call has been already requested.
-      if (req.second->Requested())
-        continue;
+      failed.push_back(handler);
+      continue;
+    }
 
-      // Check that the pending service call has types that match the responser.
-      if (req.second->ReqTypeName() != _reqType ||
-          req.second->RepTypeName() != _repType)
-      {
-        continue;
-      }
+    // Mark the handler as requested.
+    handler->Requested(true);
+
+    // Remove the handler associated to this service request. We won't
+    // receive a response because this is a oneway request.
+    if (_repType == ignition::msgs::Empty().GetTypeName())
+    {
+      this->requests.RemoveHandler(_topic, handler->NodeId(),
+        handler->HandlerId());
+      continue;
+    }
 
-      // Mark the handler as requested.
-      req.second->Requested(true);
+    // Keep track of the requests waiting for a response.
+    handler->Responder(responder.SocketId());
+    handler->ResponderProcess(responder.ProcessUuid());
+    handler->SentTime(std::chrono::steady_clock::now());
+    ++this->outstandingRequests[responder.SocketId()];
 
-      std::string data;
-      if (!req.second->Serialize(data))
-        continue;
+    SentRequest sent;
+    sent.topic = _topic;
+    sent.responderNUuid = responder.NodeUuid();
+    sent.handler = handler;
+    this->sentRequests[responder.ProcessUuid()][handler->HandlerId()] = sent;
 
-      auto nodeUuid = req.second->NodeUuid();
-      auto reqUuid = req.second->HandlerUuid();
+    // Schedule a second request in case this one is slow.
+    if (handler->Hedge() && responders.size() > 1)
+    {
+      unsigned int delay = handler->HedgeDelay();
+      if (delay == 0 && !this->LatencyP95(_topic, delay))
+        delay = DefaultHedgeDelay;
+
+      RequestTimer entry;
+      entry.topic = _topic;
+      entry.nUuid = handler->NodeId();
+      entry.hUuid = handler->HandlerId();
+      this->hedgeTimers.Add(
+        handler->SentTime() + std::chrono::milliseconds(delay), entry);
+    }
+  }
 
-      try
-      {
-        zmq::message_t msg;
+  // Forget the cached responders after a send error, they'll be refreshed
+  // from the discovery in the next attempt.
+  if (!failed.empty())
+  {
+    queue.PushFront(failed);
+    queue.ClearResponders();
+  }
 
-        msg.rebuild(responserId.size());
-        memcpy(msg.data(), responserId.data(), responserId.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  // Notify the failure once the queue is consistent. The user callbacks might
+  // make new requests.
+  bool available = !queue.Responders().empty();
+  for (auto &handler : invalid)
+    handler->NotifyResult("", false);
 
-        msg.rebuild(_topic.size());
-        memcpy(msg.data(), _topic.data(), _topic.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  return available;
+}
 
-        msg.rebuild(this->myRequesterAddress.size());
-        memcpy(msg.data(), this->myRequesterAddress.data(),
-          this->myRequesterAddress.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::AddRequest(const std::string &_topic,
+  const IReqHandlerPtr &_handler)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-        std::string myId = this->responseReceiverId.ToString();
-        msg.rebuild(myId.size());
-        memcpy(msg.data(), myId.data(), myId.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  this->requests.AddHandler(_topic, _handler->NodeId(),
+    _handler->HandlerId(), _handler);
 
-        msg.rebuild(nodeUuid.size());
-        memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  this->srvQueues.Queue(_topic, _handler->ReqTypeName(),
+    _handler->RepTypeName()).Push(_handler);
+}
 
-        msg.rebuild(reqUuid.size());
-        memcpy(msg.data(), reqUuid.data(), reqUuid.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::UpdateResponders(const std::string &_topic,
+  const std::string &_reqType, const std::string &_repType,
+  SrvRequestQueue &_queue)
+{
+  // The cache is kept up to date by the discovery callbacks.
+  if (!_queue.Responders().empty())
+    return;
 
-        msg.rebuild(data.size());
-        memcpy(msg.data(), data.data(), data.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  SrvAddresses_M addresses;
+  if (!this->srvDiscovery->Publishers(_topic, addresses))
+    return;
 
-        msg.rebuild(_reqType.size());
-        memcpy(msg.data(), _reqType.data(), _reqType.size());
-        this->requester->send(msg, ZMQ_SNDMORE);
+  for (auto &proc : addresses)
+  {
+    for (auto &pub : proc.second)
+    {
+      if (pub.ReqTypeName() == _reqType && pub.RepTypeName() == _repType)
+        _queue.AddResponder(pub);
+    }
+  }
+}
 
-        msg.rebuild(_repType.size());
-        memcpy(msg.data(), _repType.data(), _repType.size());
-        this->requester->send(msg, 0);
-      }
-      catch(const zmq::error_t& /*ze*/)
-      {
-        // Debug output.
-        // std::cerr << "Error connecting [" << ze.what() << "]\n";
-      }
+//////////////////////////////////////////////////
+size_t NodeShared::SelectResponder(const std::string &_topic,
+  const std::vector<ServicePublisher> &_responders,
+  const ResponderPolicy_t _policy)
+{
+  size_t n = _responders.size();
+  size_t start = this->nextResponder[_topic]++ % n;
+
+  if (_policy == ResponderPolicy_t::ROUND_ROBIN)
+    return start;
+
+  // Look for the responder with less outstanding requests, starting at the
+  // round-robin position to break ties. With SAME_HOST_FIRST, the first pass
+  // only considers responders running in this host.
+  bool sameHostOnly = _policy == ResponderPolicy_t::SAME_HOST_FIRST;
+  std::string myHost = "tcp://" + this->hostAddr + ":";
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    bool found = false;
+    size_t best = start;
+    unsigned int bestCount = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      size_t candidate = (start + i) % n;
+      const auto &pub = _responders.at(candidate);
+      if (sameHostOnly && pub.Addr().compare(0, myHost.size(), myHost) != 0)
+        continue;
 
-      // Remove the handler associated to this service request. We won't
-      // receive a response because this is a oneway request.
-      if (_repType == ignition::msgs::Empty().GetTypeName())
+      unsigned int count = this->OutstandingRequests(pub.SocketId());
+      if (!found || count < bestCount)
       {
-        this->requests.RemoveHandler(_topic, nodeUuid, reqUuid);
+        found = true;
+        best = candidate;
+        bestCount = count;
       }
     }
+
+    if (found)
+      return best;
+
+    // There are no responders in this host.
+    sameHostOnly = false;
   }
+
+  return start;
 }
 
 //////////////////////////////////////////////////
-void NodeShared::OnNewConnection(const MessagePublisher &_pub)
+bool NodeShared::SendRequest(const std::string &_topic,
+  const ServicePublisher &_responder, const IReqHandlerPtr &_handler,
+  const std::string &_data)
+{
+  std::string responserAddr = _responder.Addr();
+  std::string responserId = _responder.SocketId();
+
+  if (verbose)
+  {
+    std::cout << "Found a service call responser at ["
+              << responserAddr << "]" << std::endl;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  this->endpointProcs[responserAddr] = _responder.ProcessUuid();
+
+  // I am still not connected to this address.
+  if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
+        responserAddr) == this->srvConnections.end())
+  {
+    this->requester->connect(responserAddr.c_str());
+    this->srvConnections.push_back(responserAddr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (this->verbose)
+    {
+      std::cout << "\t* Connected to [" << responserAddr
+                << "] for service requests" << std::endl;
+    }
+  }
+
+  return this->SendRequestFrames(responserId, _topic, _handler->NodeId(),
+    _handler->HandlerId(), _data, _handler->ReqTypeName(),
+    _handler->RepTypeName(), _handler->Kind());
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendRequestFrames(const std::string &_responderId,
+  const std::string &_topic, const Uuid &_nodeUuid,
+  const Uuid &_reqUuid, const std::string &_data,
+  const std::string &_reqType, const std::string &_repType,
+  const uint8_t _kind)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  auto kind = std::to_string(_kind);
+
+  try
+  {
+    zmq::message_t msg;
+
+    msg.rebuild(_responderId.size());
+    memcpy(msg.data(), _responderId.data(), _responderId.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(_topic.size());
+    memcpy(msg.data(), _topic.data(), _topic.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(this->myRequesterAddress.size());
+    memcpy(msg.data(), this->myRequesterAddress.data(),
+      this->myRequesterAddress.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(this->myResponseReceiverId.size());
+    memcpy(msg.data(), this->myResponseReceiverId.data(),
+      this->myResponseReceiverId.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(Uuid::ByteLength);
+    _nodeUuid.Pack(reinterpret_cast<char *>(msg.data()));
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(Uuid::ByteLength);
+    _reqUuid.Pack(reinterpret_cast<char *>(msg.data()));
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(_data.size());
+    memcpy(msg.data(), _data.data(), _data.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(_reqType.size());
+    memcpy(msg.data(), _reqType.data(), _reqType.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(_repType.size());
+    memcpy(msg.data(), _repType.data(), _repType.size());
+    this->requester->send(msg, ZMQ_SNDMORE);
+
+    msg.rebuild(kind.size());
+    memcpy(msg.data(), kind.data(), kind.size());
+    this->requester->send(msg, 0);
+  }
+  catch(const zmq::error_t& ze)
+  {
+    if (this->verbose)
+    {
+      std::cerr << "NodeShared::SendRequestFrames() Error: " << ze.what()
+                << std::endl;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendResponse(const std::string &_sender,
+  const std::string &_dstId, const std::string &_topic,
+  const Uuid &_nodeUuid, const Uuid &_reqUuid,
+  const std::string &_rep, const std::string &_resultStr,
+  const std::string &_streamInfo)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  // I am still not connected to this address.
+  if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
+        _sender) == this->srvConnections.end())
+  {
+    this->replier->connect(_sender.c_str());
+    this->srvConnections.push_back(_sender);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    if (this->verbose)
+    {
+      std::cout << "\t* Connected to [" << _sender
+                << "] for sending a response" << std::endl;
+    }
+  }
+
+  // Send the reply.
+  try
+  {
+    zmq::message_t response;
+
+    response.rebuild(_dstId.size());
+    memcpy(response.data(), _dstId.data(), _dstId.size());
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(_topic.size());
+    memcpy(response.data(), _topic.data(), _topic.size());
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(Uuid::ByteLength);
+    _nodeUuid.Pack(reinterpret_cast<char *>(response.data()));
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(Uuid::ByteLength);
+    _reqUuid.Pack(reinterpret_cast<char *>(response.data()));
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(_rep.size());
+    memcpy(response.data(), _rep.data(), _rep.size());
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(_resultStr.size());
+    memcpy(response.data(), _resultStr.data(), _resultStr.size());
+    this->replier->send(response, ZMQ_SNDMORE);
+
+    response.rebuild(_streamInfo.size());
+    memcpy(response.data(), _streamInfo.data(), _streamInfo.size());
+    this->replier->send(response, 0);
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::SendResponse() error sending response: "
+              << _error.what() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendStreamControl(const std::string &_topic,
+  const IReqHandlerPtr &_handler, const uint8_t _kind,
+  const std::string &_data)
+{
+  // The request hasn't been sent yet.
+  if (_handler->Responder().empty())
+    return false;
+
+  return this->SendRequestFrames(_handler->Responder(), _topic,
+    _handler->NodeId(), _handler->HandlerId(), _data,
+    _handler->ReqTypeName(), _handler->RepTypeName(), _kind);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::StartStream(const IRepHandlerPtr &_handler,
+  const std::shared_ptr<SrvStream> &_stream, const std::string &_data)
+{
+  // The request is sent along with the initial credits.
+  BatchMsg batch;
+  if (!batch.Unpack(_data.data(), _data.size()) || batch.Items().size() != 2)
+  {
+    std::cerr << "NodeShared::StartStream() error unpacking the request"
+              << std::endl;
+    return;
+  }
+
+  try
+  {
+    _stream->credits = std::stoull(batch.Items()[1]);
+  }
+  catch(...)
+  {
+    std::cerr << "NodeShared::StartStream() error parsing the initial "
+              << "credits" << std::endl;
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  // Duplicated request.
+  if (this->srvStreams.find(_stream->reqUuid) != this->srvStreams.end())
+    return;
+
+  // Each stream runs in its own thread, don't let the requesters create an
+  // unbounded number of them.
+  if (this->srvStreams.size() >= MaxStreams)
+  {
+    std::cerr << "NodeShared::StartStream() too many streams in progress. "
+              << "Streaming request for [" << _stream->topic << "] rejected"
+              << std::endl;
+    this->SendResponse(_stream->sender, _stream->dstId, _stream->topic,
+      _stream->nodeUuid, _stream->reqUuid, "", "0", "0:1");
+    return;
+  }
+
+  this->srvStreams[_stream->reqUuid] = _stream;
+  this->streamThreads[_stream->reqUuid] = std::thread(&NodeShared::RunStream,
+    this, _handler, _stream, batch.Items()[0]);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::JoinFinishedStreams()
+{
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    for (const auto &reqUuid : this->finishedStreams)
+    {
+      auto it = this->streamThreads.find(reqUuid);
+      if (it == this->streamThreads.end())
+        continue;
+
+      threads.push_back(std::move(it->second));
+      this->streamThreads.erase(it);
+    }
+    this->finishedStreams.clear();
+  }
+
+  // The threads are about to finish, they might need the mutex for that.
+  for (auto &thread : threads)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RunStream(IRepHandlerPtr _handler,
+  std::shared_ptr<SrvStream> _stream, std::string _req)
+{
+  bool result;
+  _handler->RunStreamCallback(_req,
+    [this, &_stream](const std::string &_chunk, const bool _last,
+                     const bool _result)
+    {
+      return this->SendStreamChunk(*_stream, _chunk, _last, _result);
+    }, result);
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  this->srvStreams.erase(_stream->reqUuid);
+  this->finishedStreams.push_back(_stream->reqUuid);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::SendStreamChunk(SrvStream &_stream, const std::string &_chunk,
+  const bool _last, const bool _result)
+{
+  std::unique_lock<std::recursive_mutex> lk(this->mutex);
+
+  // Wait until the requester is ready for more chunks. The final chunk only
+  // closes the stream, so it doesn't need credits.
+  auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(static_cast<int>(StreamCreditTimeout));
+  if (!_last && !this->streamCondition.wait_until(lk, deadline, [&_stream]
+        {
+          return _stream.credits > 0 || _stream.cancelled;
+        }))
+  {
+    if (this->verbose)
+    {
+      std::cout << "Stream [" << _stream.reqUuid << "] for ["
+                << _stream.topic << "] cancelled: no credits" << std::endl;
+    }
+    _stream.cancelled = true;
+  }
+
+  if (_stream.cancelled)
+    return false;
+
+  if (!_last)
+    --_stream.credits;
+  std::string streamInfo =
+    std::to_string(_stream.seq++) + ":" + (_last ? "1" : "0");
+
+  return this->SendResponse(_stream.sender, _stream.dstId, _stream.topic,
+    _stream.nodeUuid, _stream.reqUuid, _chunk, _result ? "1" : "0",
+    streamInfo);
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::RemoveRequest(const std::string &_topic,
+  const IReqHandlerPtr &_handler)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  if (!this->requests.RemoveHandler(_topic, _handler->NodeId(),
+        _handler->HandlerId()))
+  {
+    return false;
+  }
+
+  this->streamSeqs.erase(_handler->HandlerId());
+
+  // The request is not waiting for its responders anymore.
+  for (const auto &proc :
+         {_handler->ResponderProcess(), _handler->HedgeResponderProcess()})
+  {
+    auto it = this->sentRequests.find(proc);
+    if (it == this->sentRequests.end())
+      continue;
+
+    it->second.erase(_handler->HandlerId());
+    if (it->second.empty())
+      this->sentRequests.erase(it);
+  }
+
+  // The request might be still waiting for a responder. It's marked as
+  // removed and skipped when popped from the queue.
+  // The queue is forgotten when nothing else is waiting and there is no
+  // responder to cache.
+  if (!_handler->Requested())
+    this->srvQueues.RemoveRequest(_topic, _handler);
+
+  // The responders are not processing this request anymore.
+  for (const auto &responder :
+         {_handler->Responder(), _handler->HedgeResponder()})
+  {
+    auto it = this->outstandingRequests.find(responder);
+    if (it == this->outstandingRequests.end())
+      continue;
+
+    if (it->second <= 1)
+      this->outstandingRequests.erase(it);
+    else
+      --it->second;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int NodeShared::OutstandingRequests(
+  const std::string &_responderId)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  auto it = this->outstandingRequests.find(_responderId);
+  if (it == this->outstandingRequests.end())
+    return 0;
+
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddRequestTimeout(const std::string &_topic,
+  const IReqHandlerPtr &_handler, const unsigned int _timeout)
+{
+  if (_timeout == 0 || !_handler)
+    return;
+
+  RequestTimer entry;
+  entry.topic = _topic;
+  entry.nUuid = _handler->NodeId();
+  entry.hUuid = _handler->HandlerId();
+
+  auto deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(_timeout);
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  this->requestTimeouts.Add(deadline, entry);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::ExpireRequests()
+{
+  std::vector<IReqHandlerPtr> expiredHandlers;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    if (this->requestTimeouts.Empty())
+      return;
+
+    std::vector<RequestTimer> expired;
+    if (this->requestTimeouts.Advance(std::chrono::steady_clock::now(),
+          expired) == 0)
+    {
+      return;
+    }
+
+    for (const auto &entry : expired)
+    {
+      // The response might have arrived before the deadline.
+      IReqHandlerPtr handler;
+      if (!this->requests.Handler(entry.topic, entry.nUuid, entry.hUuid,
+            handler))
+      {
+        continue;
+      }
+
+      this->RemoveRequest(entry.topic, handler);
+      this->AddCompletedRequest(entry.hUuid);
+      expiredHandlers.push_back(handler);
+
+      // Let the responder know that nobody is consuming the stream.
+      if (handler->Kind() == StreamRequest)
+        this->SendStreamControl(entry.topic, handler, StreamCancel, "");
+
+      if (this->verbose)
+      {
+        std::cout << "Service call request [" << entry.hUuid << "] for ["
+                  << entry.topic << "] expired" << std::endl;
+      }
+    }
+  }
+
+  // Notify the timeouts without holding the mutex. The user callbacks might
+  // make new requests.
+  for (auto &handler : expiredHandlers)
+  {
+    ++this->expiredRequests;
+    handler->NotifyResult("", false);
+  }
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::ExpiredRequests() const
+{
+  return this->expiredRequests;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::HedgeRequests()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  if (this->hedgeTimers.Empty())
+    return;
+
+  std::vector<RequestTimer> expired;
+  if (this->hedgeTimers.Advance(std::chrono::steady_clock::now(), expired) == 0)
+    return;
+
+  for (const auto &entry : expired)
+  {
+    // The response might have arrived before the hedging delay.
+    IReqHandlerPtr handler;
+    if (!this->requests.Handler(entry.topic, entry.nUuid, entry.hUuid,
+          handler) || handler->Hedged())
+    {
+      continue;
+    }
+
+    // Find another responder offering this service.
+    auto reqType = handler->ReqTypeName();
+    auto repType = handler->RepTypeName();
+    auto &queue = this->srvQueues.Queue(entry.topic, reqType, repType);
+    this->UpdateResponders(entry.topic, reqType, repType, queue);
+
+    std::vector<ServicePublisher> responders;
+    for (const auto &pub : queue.Responders())
+    {
+      if (pub.SocketId() != handler->Responder())
+        responders.push_back(pub);
+    }
+
+    if (responders.empty())
+      continue;
+
+    auto index =
+      this->SelectResponder(entry.topic, responders, handler->Policy());
+    const auto &responder = responders.at(index);
+
+    std::string data;
+    if (!handler->Serialize(data) ||
+        !this->SendRequest(entry.topic, responder, handler, data))
+    {
+      continue;
+    }
+
+    handler->HedgeResponder(responder.SocketId(), responder.ProcessUuid());
+    ++this->outstandingRequests[responder.SocketId()];
+    ++this->hedgedRequests;
+
+    SentRequest sent;
+    sent.topic = entry.topic;
+    sent.responderNUuid = responder.NodeUuid();
+    sent.handler = handler;
+    this->sentRequests[responder.ProcessUuid()][handler->HandlerId()] = sent;
+
+    if (this->verbose)
+    {
+      std::cout << "Service call request [" << entry.hUuid << "] for ["
+                << entry.topic << "] hedged to [" << responder.Addr() << "]"
+                << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::HedgedRequests() const
+{
+  return this->hedgedRequests;
+}
+
+//////////////////////////////////////////////////
+uint64_t NodeShared::ReroutedRequests() const
+{
+  return this->reroutedRequests;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::FailOverRequests(const Uuid &_pUuid,
+  const std::string &_topic, const Uuid &_nUuid,
+  std::vector<IReqHandlerPtr> &_failed)
+{
+  auto procIt = this->sentRequests.find(_pUuid);
+  if (procIt == this->sentRequests.end())
+    return;
+
+  // Requests sent to the responder that is gone.
+  std::vector<SentRequest> affected;
+  for (const auto &sent : procIt->second)
+  {
+    if (_topic.empty() || (sent.second.topic == _topic &&
+                           sent.second.responderNUuid == _nUuid))
+    {
+      affected.push_back(sent.second);
+    }
+  }
+
+  std::set<SrvRequestQueueStorage::Key> pendingKeys;
+  for (const auto &sent : affected)
+  {
+    const auto &handler = sent.handler;
+
+    // A hedged request is still being processed by the other responder.
+    auto otherProcess = handler->ResponderProcess() == _pUuid ?
+      handler->HedgeResponderProcess() : handler->ResponderProcess();
+    if (handler->Hedged() && !otherProcess.IsNil() && otherProcess != _pUuid)
+    {
+      // Keep only the responder that is still alive.
+      auto gone = handler->HedgeResponder();
+      if (handler->ResponderProcess() == _pUuid)
+      {
+        gone = handler->Responder();
+        handler->Responder(handler->HedgeResponder());
+        handler->ResponderProcess(handler->HedgeResponderProcess());
+      }
+      handler->HedgeResponder("", Uuid(""));
+
+      auto outIt = this->outstandingRequests.find(gone);
+      if (outIt != this->outstandingRequests.end())
+      {
+        if (outIt->second <= 1)
+          this->outstandingRequests.erase(outIt);
+        else
+          --outIt->second;
+      }
+
+      auto it = this->sentRequests.find(_pUuid);
+      if (it != this->sentRequests.end())
+      {
+        it->second.erase(handler->HandlerId());
+        if (it->second.empty())
+          this->sentRequests.erase(it);
+      }
+      continue;
+    }
+
+    this->RemoveRequest(sent.topic, handler);
+
+    // Look for another responder in the cache. The discovery service can't
+    // be queried from its own callback.
+    auto key = std::make_tuple(sent.topic, handler->ReqTypeName(),
+      handler->RepTypeName());
+    bool available = this->srvQueues.HasResponders(sent.topic,
+      handler->ReqTypeName(), handler->RepTypeName());
+
+    // Streams can't be resumed transparently, some chunks might have been
+    // delivered already.
+    if (!available || handler->Kind() == StreamRequest)
+    {
+      this->AddCompletedRequest(handler->HandlerId());
+      _failed.push_back(handler);
+      continue;
+    }
+
+    // Queue the request again. Its timeout is still in place.
+    handler->ResetResponders();
+    this->AddRequest(sent.topic, handler);
+    pendingKeys.insert(key);
+    ++this->reroutedRequests;
+
+    if (this->verbose)
+    {
+      std::cout << "Service call request [" << handler->HandlerId()
+                << "] for [" << sent.topic << "] re-routed" << std::endl;
+    }
+  }
+
+  for (const auto &key : pendingKeys)
+  {
+    this->SendPendingRemoteReqs(std::get<0>(key), std::get<1>(key),
+      std::get<2>(key));
+  }
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::LatencyP95(const std::string &_topic,
+  unsigned int &_latency)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  auto it = this->srvLatencies.find(_topic);
+  if (it == this->srvLatencies.end() || it->second.empty())
+    return false;
+
+  std::vector<unsigned int> samples(it->second.begin(), it->second.end());
+  size_t index = (samples.size() * 95) / 100;
+  if (index >= samples.size())
+    index = samples.size() - 1;
+
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  _latency = samples.at(index);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<TopicCounters> NodeShared::Counters(const std::string &_topic)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  auto &counters = this->topicCounters[_topic];
+  if (!counters)
+    counters = std::make_shared<TopicCounters>();
+  return counters;
+}
+
+//////////////////////////////////////////////////
+bool NodeShared::TopicStats(const std::string &_topic,
+  TopicStatistics &_stats)
+{
+  std::shared_ptr<TopicCounters> counters;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    auto it = this->topicCounters.find(_topic);
+    if (it == this->topicCounters.end())
+      return false;
+    counters = it->second;
+  }
+
+  _stats = counters->Snapshot();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::EnableStatistics(const std::string &_partition,
+  const unsigned int _interval)
+{
+  if (_interval == 0)
+    return;
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    bool enabled = this->statsInterval > 0;
+    if (!enabled || _interval < this->statsInterval)
+      this->statsInterval = _interval;
+
+    if (enabled)
+      return;
+  }
+
+  // Don't hold the mutex while advertising, the discovery might be
+  // executing one of our callbacks. Note that the constructor of the node
+  // might call this function again (IGN_STATISTICS), it returns above. The
+  // interval is reset on failure, so the statistics can be enabled again.
+  NodeOptions opts;
+  std::string topic;
+  if (!opts.SetPartition(_partition) ||
+      !TopicUtils::FullyQualifiedName(_partition, "", this->kStatisticsTopic,
+        topic))
+  {
+    std::cerr << "Invalid partition [" << _partition << "] for publishing "
+              << "the statistics" << std::endl;
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->statsInterval = 0;
+    return;
+  }
+
+  std::unique_ptr<Node> node(new Node(opts));
+  if (!node->Advertise<ignition::msgs::StringMsg>(this->kStatisticsTopic))
+  {
+    std::cerr << "Unable to advertise the statistics topic ["
+              << this->kStatisticsTopic << "]" << std::endl;
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    this->statsInterval = 0;
+    return;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  this->statsTopic = topic;
+  this->statsLast = TopicCounters::Now();
+  this->statsNode = std::move(node);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::PublishStatistics()
+{
+  ignition::msgs::StringMsg msg;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    if (!this->statsNode)
+      return;
+
+    int64_t now = TopicCounters::Now();
+    int64_t period = now - this->statsLast;
+    if (period < static_cast<int64_t>(this->statsInterval) * 1000000)
+      return;
+
+    msg.set_data(this->StatisticsReport(period));
+    this->statsLast = now;
+    this->receptionBusy = 0;
+  }
+
+  // Publish without holding the mutex, the local subscribers are notified
+  // from this thread. The node lives until the reception thread finishes.
+  this->statsNode->Publish(this->kStatisticsTopic, msg);
+}
+
+//////////////////////////////////////////////////
+std::string NodeShared::StatisticsReport(const int64_t _period)
+{
+  double seconds = _period / 1e9;
+
+  size_t unsent = this->srvQueues.Unsent();
+
+  unsigned int outstanding = 0;
+  for (const auto &responder : this->outstandingRequests)
+    outstanding += responder.second;
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(2)
+         << "process=" << this->pUuid
+         << " period_ms=" << _period / 1000000
+         << " reception_busy_pct=" << 100.0 * this->receptionBusy / _period
+         << " unsent_requests=" << unsent
+         << " outstanding_requests=" << outstanding
+         << " streams=" << this->srvStreams.size() << std::endl;
+
+  for (const auto &topic : this->topicCounters)
+  {
+    // The statistics topic doesn't report itself.
+    if (topic.first == this->statsTopic)
+      continue;
+
+    TopicStatistics stats = topic.second->Snapshot();
+    TopicStatistics &prev = this->statsPrevious[topic.first];
+    uint64_t sentMsgs = stats.SentMessages() - prev.SentMessages();
+    uint64_t sentBytes = stats.SentBytes() - prev.SentBytes();
+    uint64_t recvMsgs = stats.ReceivedMessages() - prev.ReceivedMessages();
+    uint64_t recvBytes = stats.ReceivedBytes() - prev.ReceivedBytes();
+    uint64_t dropped = stats.Dropped() - prev.Dropped();
+    uint64_t callbacks = stats.Callbacks() - prev.Callbacks();
+
+    // Mean latency of the callbacks executed during this period.
+    double latency = 0;
+    if (callbacks > 0)
+    {
+      latency = (stats.MeanLatency() * stats.Callbacks() -
+        prev.MeanLatency() * prev.Callbacks()) / callbacks;
+    }
+
+    prev = stats;
+
+    if (sentMsgs == 0 && recvMsgs == 0 && dropped == 0)
+      continue;
+
+    report << "topic=" << topic.first
+           << " sent_msgs_s=" << sentMsgs / seconds
+           << " sent_bytes_s=" << sentBytes / seconds
+           << " recv_msgs_s=" << recvMsgs / seconds
+           << " recv_bytes_s=" << recvBytes / seconds
+           << " dropped=" << dropped
+           << " latency_us=" << latency << std::endl;
+  }
+
+  return report.str();
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SetDiscoveryIntervals(const unsigned int _heartbeat,
+  const unsigned int _silence)
+{
+  unsigned int heartbeat;
+  unsigned int silence;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    if (_heartbeat > 0 &&
+        (this->heartbeatInterval == 0 || _heartbeat < this->heartbeatInterval))
+    {
+      this->heartbeatInterval = _heartbeat;
+    }
+
+    if (_silence > 0 &&
+        (this->silenceInterval == 0 || _silence < this->silenceInterval))
+    {
+      this->silenceInterval = _silence;
+    }
+
+    heartbeat = this->heartbeatInterval;
+    silence = this->silenceInterval;
+  }
+
+  // Don't hold the mutex while accessing the discovery, it might be
+  // executing one of our callbacks. The settings are shared by the topics
+  // and the services.
+  if (heartbeat > 0)
+    this->msgDiscovery->SetHeartbeatInterval(heartbeat);
+
+  if (silence > 0)
+    this->msgDiscovery->SetSilenceInterval(silence);
+
+  if (this->msgDiscovery->SilenceInterval() <=
+      this->msgDiscovery->HeartbeatInterval())
+  {
+    std::cerr << "Warning: The silence interval ["
+              << this->msgDiscovery->SilenceInterval() << " ms] should be "
+              << "longer than the heartbeat interval ["
+              << this->msgDiscovery->HeartbeatInterval() << " ms]"
+              << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddCompletedRequest(const Uuid &_reqUuid)
+{
+  if (!this->completedRequests.insert(_reqUuid).second)
+    return;
+
+  this->completedRequestsOrder.push_back(_reqUuid);
+  if (this->completedRequestsOrder.size() > MaxCompletedRequests)
+  {
+    this->completedRequests.erase(this->completedRequestsOrder.front());
+    this->completedRequestsOrder.pop_front();
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::OnNewConnection(const MessagePublisher &_pub)
 {
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   std::string topic = _pub.Topic();
   std::string addr = _pub.Addr();
   std::string ctrl = _pub.Ctrl();
-  std::string procUuid = _pub.PUuid();
+  const Uuid &procUuid = _pub.ProcessUuid();
 
   if (this->verbose)
   {
@@ -825,13 +2116,14 @@ void NodeShared::OnNewConnection(const MessagePublisher &_pub)
 
   // Check if we are interested in this topic.
   if (this->localSubscriptions.HasHandlersForTopic(topic) &&
-      this->pUuid.compare(procUuid) != 0)
+      this->pUuid != procUuid)
   {
     try
     {
       // I am not connected to the process.
       if (!this->connections.HasPublisher(addr))
         this->subscriber->connect(addr.c_str());
+      this->endpointProcs[addr] = procUuid;
 
       // Add a new filter for the topic.
       this->subscriber->setsockopt(ZMQ_SUBSCRIBE, topic.data(), topic.size());
@@ -855,36 +2147,35 @@ void NodeShared::OnNewConnection(const MessagePublisher &_pub)
 
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
-      std::map<std::string, ISubscriptionHandler_M> handlers;
+      // The control frames contain the text form of the UUIDs.
+      std::string procStr = this->pUuid.ToString();
+      std::vector<ISubscriptionHandlerPtr> handlers;
       if (this->localSubscriptions.Handlers(topic, handlers))
       {
-        for (auto &node : handlers)
+        for (auto &handler : handlers)
         {
-          for (auto &handler : node.second)
-          {
-            if (handler.second->TypeName() != _pub.MsgTypeName())
-              continue;
-
-            std::string nodeUuid = handler.second->NodeUuid();
-
-            zmq::message_t msg;
-            msg.rebuild(topic.size());
-            memcpy(msg.data(), topic.data(), topic.size());
-            socket.send(msg, ZMQ_SNDMORE);
-
-            msg.rebuild(this->pUuid.size());
-            memcpy(msg.data(), this->pUuid.data(), this->pUuid.size());
-            socket.send(msg, ZMQ_SNDMORE);
-
-            msg.rebuild(nodeUuid.size());
-            memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
-            socket.send(msg, ZMQ_SNDMORE);
-
-            std::string data = std::to_string(NewConnection);
-            msg.rebuild(data.size());
-            memcpy(msg.data(), data.data(), data.size());
-            socket.send(msg, 0);
-          }
+          if (handler->TypeName() != _pub.MsgTypeName())
+            continue;
+
+          std::string nodeUuid = handler->NodeUuid();
+
+          zmq::message_t msg;
+          msg.rebuild(topic.size());
+          memcpy(msg.data(), topic.data(), topic.size());
+          socket.send(msg, ZMQ_SNDMORE);
+
+          msg.rebuild(procStr.size());
+          memcpy(msg.data(), procStr.data(), procStr.size());
+          socket.send(msg, ZMQ_SNDMORE);
+
+          msg.rebuild(nodeUuid.size());
+          memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
+          socket.send(msg, ZMQ_SNDMORE);
+
+          std::string data = std::to_string(NewConnection);
+          msg.rebuild(data.size());
+          memcpy(msg.data(), data.data(), data.size());
+          socket.send(msg, 0);
         }
       }
     }
@@ -901,8 +2192,8 @@ void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
   std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
   std::string topic = _pub.Topic();
-  std::string procUuid = _pub.PUuid();
-  std::string nUuid = _pub.NUuid();
+  const Uuid &procUuid = _pub.ProcessUuid();
+  const Uuid &nUuid = _pub.NodeUuid();
 
   if (this->verbose)
   {
@@ -911,7 +2202,7 @@ void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
   }
 
   // A remote subscriber[s] has been disconnected.
-  if (topic != "" && nUuid != "")
+  if (topic != "" && !nUuid.IsNil())
   {
     this->remoteSubscribers.DelPublisherByNode(topic, procUuid, nUuid);
 
@@ -926,6 +2217,16 @@ void NodeShared::OnNewDisconnection(const MessagePublisher &_pub)
   {
     this->remoteSubscribers.DelPublishersByProc(procUuid);
 
+    // Forget the endpoints of the process.
+    for (auto it = this->endpointProcs.begin();
+         it != this->endpointProcs.end();)
+    {
+      if (it->second == procUuid)
+        this->endpointProcs.erase(it++);
+      else
+        ++it;
+    }
+
     MsgAddresses_M info;
     if (!this->connections.Publishers(topic, info))
       return;
@@ -951,6 +2252,8 @@ void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
     std::cout << _pub;
   }
 
+  this->endpointProcs[addr] = _pub.ProcessUuid();
+
   // I am still not connected to this address.
   if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
         addr) == this->srvConnections.end())
@@ -965,10 +2268,16 @@ void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
     }
   }
 
+  auto queue = this->srvQueues.Find(topic, reqType, repType);
+  if (!queue)
+    return;
+
+  // Update the cache of responders.
+  queue->AddResponder(_pub);
+
   // Check if there's a pending service request with this specific combination
   // of request and response types.
-  IReqHandlerPtr handler;
-  if (this->requests.FirstHandler(topic, reqType, repType, handler))
+  if (!queue->Empty())
   {
     // Request all pending service calls for this topic and req/rep types.
     this->SendPendingRemoteReqs(topic, reqType, repType);
@@ -979,17 +2288,36 @@ void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
 void NodeShared::OnNewSrvDisconnection(const ServicePublisher &_pub)
 {
   std::string addr = _pub.Addr();
+  std::vector<IReqHandlerPtr> failed;
 
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-  // Remove the address from the list of connected addresses.
-  this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
-    std::end(this->srvConnections), addr.c_str()),
-    std::end(this->srvConnections));
+    // Remove the address from the list of connected addresses.
+    this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
+      std::end(this->srvConnections), addr.c_str()),
+      std::end(this->srvConnections));
 
-  if (this->verbose)
-  {
-    std::cout << "Service call disconnection callback" << std::endl;
-    std::cout << _pub;
+    // Remove the responders from the cache and forget the queues without
+    // requests waiting nor responders. The publisher might contain only the
+    // process UUID when the whole process is gone.
+    const Uuid &procUuid = _pub.ProcessUuid();
+    std::string topic = _pub.Topic();
+    const Uuid &nUuid = _pub.NodeUuid();
+    this->srvQueues.RemoveResponders(procUuid, topic, nUuid);
+
+    // Don't wait for the responses that will never arrive.
+    this->FailOverRequests(procUuid, topic, nUuid, failed);
+
+    if (this->verbose)
+    {
+      std::cout << "Service call disconnection callback" << std::endl;
+      std::cout << _pub;
+    }
   }
+
+  // Notify the failed requests without holding the mutex. The user callbacks
+  // might make new requests.
+  for (auto &handler : failed)
+    handler->NotifyResult("", false);
 }
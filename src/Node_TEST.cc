@@ -28,7 +28,10 @@
 #include "ignition/transport/AdvertiseOptions.hh"
 #include "ignition/transport/Node.hh"
 #include "ignition/transport/NodeOptions.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/RequestOptions.hh"
 #include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/Uuid.hh"
 #include "ignition/transport/test_config.h"
 
 using namespace ignition;
@@ -743,6 +746,56 @@ TEST(NodeTest, TypeMismatch)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the statistics of a topic published and subscribed in the
+/// same process.
+TEST(NodeTest, TopicStatistics)
+{
+  reset();
+
+  std::string topic = "/stats";
+  ignition::msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  transport::TopicStatistics stats;
+  EXPECT_FALSE(node.TopicStatistics("invalid topic", stats));
+  EXPECT_FALSE(node.TopicStatistics(topic, stats));
+
+  EXPECT_TRUE(node.Advertise<ignition::msgs::Int32>(topic));
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+
+  for (auto i = 0; i < 3; ++i)
+    EXPECT_TRUE(node.Publish(topic, msg));
+
+  ASSERT_TRUE(node.TopicStatistics(topic, stats));
+  EXPECT_EQ(stats.SentMessages(), 3u);
+  EXPECT_EQ(stats.SentBytes(), 3u * msg.ByteSize());
+  EXPECT_EQ(stats.ReceivedMessages(), 3u);
+  EXPECT_EQ(stats.ReceivedBytes(), 3u * msg.ByteSize());
+  EXPECT_EQ(stats.Callbacks(), 3u);
+  EXPECT_EQ(stats.Dropped(), 0u);
+  EXPECT_EQ(counter, 3);
+
+  uint64_t total = 0;
+  for (auto bucket : stats.CallbackDurations())
+    total += bucket;
+  EXPECT_EQ(total, 3u);
+
+  // A subscriber with the wrong type can't handle the messages.
+  transport::Node node2;
+  EXPECT_TRUE(node.Unsubscribe(topic));
+  EXPECT_TRUE(node2.Subscribe(topic, cbVector));
+  EXPECT_TRUE(node.Publish(topic, msg));
+
+  ASSERT_TRUE(node2.TopicStatistics(topic, stats));
+  EXPECT_EQ(stats.SentMessages(), 4u);
+  EXPECT_EQ(stats.Callbacks(), 3u);
+  EXPECT_EQ(stats.Dropped(), 1u);
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Make an asynchronous service call using free function.
 TEST(NodeTest, ServiceCallAsync)
@@ -1293,6 +1346,267 @@ TEST(NodeTest, ServiceCallWithoutInputSyncTimeout)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Check a timeout in an asynchronous service call.
+TEST(NodeTest, ServiceCallAsyncTimeout)
+{
+  reset();
+
+  ignition::msgs::Int32 req;
+  req.set_data(data);
+
+  transport::Node node;
+  transport::RequestOptions opts;
+  opts.SetTimeout(300);
+
+  auto shared = transport::NodeShared::Instance();
+  auto expiredBefore = shared->ExpiredRequests();
+
+  std::function<void(const ignition::msgs::Int32 &, const bool)> cb =
+    [](const ignition::msgs::Int32 &/*_rep*/, const bool _result)
+  {
+    EXPECT_FALSE(_result);
+    responseExecuted = true;
+    ++counter;
+  };
+
+  // Nobody is offering this service.
+  auto t1 = std::chrono::steady_clock::now();
+  EXPECT_TRUE(node.Request(g_topic, req, cb, opts));
+
+  int i = 0;
+  while (i < 100 && !responseExecuted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  // The callback should be executed once, with a false result, after the
+  // timeout expired.
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_EQ(counter, 1);
+  EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(
+    t2 - t1).count(), 300);
+  EXPECT_EQ(shared->ExpiredRequests(), expiredBefore + 1);
+
+  // The expired request should not be notified again.
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  EXPECT_EQ(counter, 1);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Request handler whose request can't be serialized.
+class UnserializableReqHandler
+  : public transport::ReqHandler<ignition::msgs::Int32, ignition::msgs::Int32>
+{
+  // Documentation inherited.
+  public: explicit UnserializableReqHandler(const std::string &_nUuid)
+    : transport::ReqHandler<ignition::msgs::Int32,
+        ignition::msgs::Int32>(_nUuid)
+  {
+  }
+
+  // Documentation inherited.
+  public: bool Serialize(std::string &/*_buffer*/) const
+  {
+    return false;
+  }
+};
+
+//////////////////////////////////////////////////
+/// \brief A request that can't be serialized fails right away and doesn't
+/// block the requests queued behind it.
+TEST(NodeTest, ServiceCallUnserializable)
+{
+  reset();
+
+  std::function<void(const ignition::msgs::Int32 &, ignition::msgs::Int32 &,
+    bool &)> advCb = [](const ignition::msgs::Int32 &_req,
+      ignition::msgs::Int32 &_rep, bool &_result)
+  {
+    _rep.set_data(_req.data());
+    _result = true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE((node.Advertise<ignition::msgs::Int32,
+        ignition::msgs::Int32>(g_topic, advCb)));
+
+  transport::NodeOptions opts;
+  std::string topic;
+  ASSERT_TRUE(transport::TopicUtils::FullyQualifiedName(opts.Partition(),
+    opts.NameSpace(), g_topic, topic));
+  std::string nUuid = transport::Uuid().ToString();
+  std::string type = ignition::msgs::Int32().GetTypeName();
+
+  bool invalidNotified = false;
+  bool invalidResult = true;
+  std::shared_ptr<UnserializableReqHandler> invalid(
+    new UnserializableReqHandler(nUuid));
+  invalid->SetCallback(
+    [&invalidNotified, &invalidResult](const ignition::msgs::Int32 &,
+      const bool _result)
+  {
+    invalidNotified = true;
+    invalidResult = _result;
+  });
+
+  ignition::msgs::Int32 req;
+  req.set_data(data);
+  std::shared_ptr<transport::ReqHandler<ignition::msgs::Int32,
+    ignition::msgs::Int32>> valid(new transport::ReqHandler<
+      ignition::msgs::Int32, ignition::msgs::Int32>(nUuid));
+  valid->SetMessage(req);
+
+  auto shared = transport::NodeShared::Instance();
+  {
+    std::lock_guard<std::recursive_mutex> lk(shared->mutex);
+    shared->AddRequest(topic, invalid);
+    shared->AddRequest(topic, valid);
+    EXPECT_TRUE(shared->SendPendingRemoteReqs(topic, type, type));
+
+    // The invalid request is notified and discarded, the valid one is sent.
+    EXPECT_TRUE(invalidNotified);
+    EXPECT_FALSE(invalidResult);
+    EXPECT_FALSE(invalid->Requested());
+    EXPECT_TRUE(valid->Requested());
+
+    shared->RemoveRequest(topic, valid);
+  }
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Make a batch of service calls (asynchronous and synchronous).
+TEST(NodeTest, ServiceCallBatch)
+{
+  reset();
+
+  // Requests with odd values fail.
+  std::function<void(const ignition::msgs::Int32 &, ignition::msgs::Int32 &,
+    bool &)> advCb = [](const ignition::msgs::Int32 &_req,
+      ignition::msgs::Int32 &_rep, bool &_result)
+  {
+    _rep.set_data(_req.data() * 2);
+    _result = _req.data() % 2 == 0;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE((node.Advertise<ignition::msgs::Int32,
+        ignition::msgs::Int32>(g_topic, advCb)));
+
+  std::vector<ignition::msgs::Int32> reqs(4);
+  for (size_t i = 0; i < reqs.size(); ++i)
+    reqs[i].set_data(static_cast<int>(i));
+
+  std::function<void(const std::vector<ignition::msgs::Int32> &,
+    const std::vector<bool> &)> reqCb =
+    [](const std::vector<ignition::msgs::Int32> &_reps,
+       const std::vector<bool> &_results)
+  {
+    ASSERT_EQ(_reps.size(), 4u);
+    ASSERT_EQ(_results.size(), 4u);
+    for (size_t i = 0; i < _reps.size(); ++i)
+    {
+      EXPECT_EQ(_reps[i].data(), static_cast<int>(i) * 2);
+      EXPECT_EQ(_results[i], i % 2 == 0);
+    }
+    responseExecuted = true;
+  };
+
+  // An empty batch is not allowed.
+  std::vector<ignition::msgs::Int32> emptyReqs;
+  EXPECT_FALSE(node.RequestBatch(g_topic, emptyReqs, reqCb));
+
+  // Request an invalid service name.
+  EXPECT_FALSE(node.RequestBatch("invalid service", reqs, reqCb));
+
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, reqCb));
+  EXPECT_TRUE(responseExecuted);
+
+  // Synchronous version.
+  std::vector<ignition::msgs::Int32> reps;
+  std::vector<bool> results;
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, 1000, reps, results));
+  ASSERT_EQ(reps.size(), reqs.size());
+  ASSERT_EQ(results.size(), reqs.size());
+  for (size_t i = 0; i < reps.size(); ++i)
+  {
+    EXPECT_EQ(reps[i].data(), static_cast<int>(i) * 2);
+    EXPECT_EQ(results[i], i % 2 == 0);
+  }
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Make a streaming service call.
+TEST(NodeTest, ServiceCallStream)
+{
+  reset();
+
+  // Send as many messages as requested.
+  std::function<void(const ignition::msgs::Int32 &,
+    transport::StreamWriter<ignition::msgs::Int32> &, bool &)> advCb =
+    [](const ignition::msgs::Int32 &_req,
+       transport::StreamWriter<ignition::msgs::Int32> &_writer, bool &_result)
+  {
+    for (int i = 0; i < _req.data(); ++i)
+    {
+      ignition::msgs::Int32 rep;
+      rep.set_data(i);
+      if (!_writer.Write(rep))
+        return;
+    }
+    _result = true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE((node.AdvertiseStream<ignition::msgs::Int32,
+        ignition::msgs::Int32>(g_topic, advCb)));
+
+  std::vector<int> received;
+  std::function<void(const ignition::msgs::Int32 &, const bool, const bool)>
+    reqCb = [&received](const ignition::msgs::Int32 &_rep, const bool _result,
+      const bool _last)
+  {
+    EXPECT_TRUE(_result);
+    if (_last)
+      responseExecuted = true;
+    else
+      received.push_back(_rep.data());
+  };
+
+  ignition::msgs::Int32 req;
+  req.set_data(data);
+
+  // Request an invalid service name.
+  EXPECT_FALSE(node.RequestStream("invalid service", req, reqCb));
+
+  EXPECT_TRUE(node.RequestStream(g_topic, req, reqCb));
+
+  // All the messages should be received in order, and the end of the stream
+  // notified.
+  EXPECT_TRUE(responseExecuted);
+  ASSERT_EQ(received.size(), static_cast<size_t>(data));
+  for (int i = 0; i < data; ++i)
+    EXPECT_EQ(received[i], i);
+
+  // A stream without messages still notifies the end of the stream.
+  reset();
+  received.clear();
+  req.set_data(0);
+  EXPECT_TRUE(node.RequestStream(g_topic, req, reqCb));
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_TRUE(received.empty());
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Create a publisher that sends messages "forever". This function will
 /// be used emiting a SIGINT or SIGTERM signal, to make sure that the transport
@@ -1696,6 +2010,40 @@ TEST(NodeTest, ServiceList)
       (elapsed).count(), 2);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that the discovery intervals requested through NodeOptions
+/// are applied and that the shortest intervals requested are used.
+TEST(NodeTest, DiscoveryIntervals)
+{
+  auto shared = transport::NodeShared::Instance();
+
+  transport::NodeOptions opts;
+  EXPECT_TRUE(opts.SetHeartbeatInterval(500));
+  EXPECT_TRUE(opts.SetSilenceInterval(2000));
+  transport::Node node(opts);
+
+  EXPECT_EQ(shared->msgDiscovery->HeartbeatInterval(), 500u);
+  EXPECT_EQ(shared->msgDiscovery->SilenceInterval(), 2000u);
+  EXPECT_EQ(shared->srvDiscovery->HeartbeatInterval(), 500u);
+  EXPECT_EQ(shared->srvDiscovery->SilenceInterval(), 2000u);
+
+  // Longer intervals requested by another node are ignored.
+  transport::NodeOptions opts2;
+  EXPECT_TRUE(opts2.SetHeartbeatInterval(800));
+  EXPECT_TRUE(opts2.SetSilenceInterval(1500));
+  transport::Node node2(opts2);
+
+  EXPECT_EQ(shared->msgDiscovery->HeartbeatInterval(), 500u);
+  EXPECT_EQ(shared->msgDiscovery->SilenceInterval(), 1500u);
+  EXPECT_EQ(shared->srvDiscovery->HeartbeatInterval(), 500u);
+  EXPECT_EQ(shared->srvDiscovery->SilenceInterval(), 1500u);
+
+  // A node without specific intervals doesn't change them.
+  transport::Node node3;
+  EXPECT_EQ(shared->msgDiscovery->HeartbeatInterval(), 500u);
+  EXPECT_EQ(shared->msgDiscovery->SilenceInterval(), 1500u);
+}
+
 //////////////////////////////////////////////////
 /// \brief Create a separate thread, block it calling waitForShutdown() and
 /// emit a SIGINT signal. Check that the transport library captures the signal
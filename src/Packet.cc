@@ -18,8 +18,10 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include "ignition/transport/Packet.hh"
+#include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 using namespace transport;
@@ -36,6 +38,18 @@ Header::Header(const uint16_t _version,
   this->SetFlags(_flags);
 }
 
+//////////////////////////////////////////////////
+Header::Header(const uint16_t _version,
+               const Uuid &_pUuid,
+               const uint8_t _type,
+               const uint16_t _flags)
+{
+  this->SetVersion(_version);
+  this->SetPUuid(_pUuid);
+  this->SetType(_type);
+  this->SetFlags(_flags);
+}
+
 //////////////////////////////////////////////////
 uint16_t Header::Version() const
 {
@@ -44,6 +58,12 @@ uint16_t Header::Version() const
 
 //////////////////////////////////////////////////
 std::string Header::PUuid() const
+{
+  return this->pUuid.ToString();
+}
+
+//////////////////////////////////////////////////
+const Uuid &Header::ProcessUuid() const
 {
   return this->pUuid;
 }
@@ -68,6 +88,12 @@ void Header::SetVersion(const uint16_t _version)
 
 //////////////////////////////////////////////////
 void Header::SetPUuid(const std::string &_pUuid)
+{
+  this->pUuid = Uuid(_pUuid);
+}
+
+//////////////////////////////////////////////////
+void Header::SetPUuid(const Uuid &_pUuid)
 {
   this->pUuid = _pUuid;
 }
@@ -84,19 +110,32 @@ void Header::SetFlags(const uint16_t _flags)
   this->flags = _flags;
 }
 
+//////////////////////////////////////////////////
+uint32_t Header::StateVersion() const
+{
+  return this->stateVersion;
+}
+
+//////////////////////////////////////////////////
+void Header::SetStateVersion(const uint32_t _stateVersion)
+{
+  this->stateVersion = _stateVersion;
+}
+
 //////////////////////////////////////////////////
 int Header::HeaderLength() const
 {
   return static_cast<int>(sizeof(this->version) +
-         sizeof(uint16_t) + this->pUuid.size() +
-         sizeof(this->type) + sizeof(this->flags));
+         Uuid::ByteLength +
+         sizeof(this->type) + sizeof(this->flags) +
+         sizeof(this->stateVersion));
 }
 
 //////////////////////////////////////////////////
 size_t Header::Pack(char *_buffer) const
 {
   // Uninitialized.
-  if ((this->version == 0) || (this->pUuid == "") ||
+  if ((this->version == 0) || this->pUuid.IsNil() ||
       (this->type  == Uninitialized))
   {
     std::cerr << "Header::Pack() error: You're trying to pack an incomplete "
@@ -115,14 +154,8 @@ size_t Header::Pack(char *_buffer) const
   memcpy(_buffer, &this->version, sizeof(this->version));
   _buffer += sizeof(this->version);
 
-  // Pack the process UUID length.
-  uint16_t pUuidLength = static_cast<uint16_t>(this->pUuid.size());
-  memcpy(_buffer, &pUuidLength, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
-  // Pack the process UUID.
-  memcpy(_buffer, this->pUuid.data(), static_cast<size_t>(pUuidLength));
-  _buffer += pUuidLength;
+  // Pack the process UUID (16 bytes).
+  _buffer += this->pUuid.Pack(_buffer);
 
   // Pack the message type (ADVERTISE, SUBSCRIPTION, ...), which is uint8_t
   memcpy(_buffer, &this->type, sizeof(this->type));
@@ -130,6 +163,10 @@ size_t Header::Pack(char *_buffer) const
 
   // Pack the flags, which is uint16_t
   memcpy(_buffer, &this->flags, sizeof(this->flags));
+  _buffer += sizeof(this->flags);
+
+  // Pack the discovery state version, which is uint32_t
+  memcpy(_buffer, &this->stateVersion, sizeof(this->stateVersion));
 
   return this->HeaderLength();
 }
@@ -148,14 +185,8 @@ size_t Header::Unpack(const char *_buffer)
   memcpy(&this->version, _buffer, sizeof(this->version));
   _buffer += sizeof(this->version);
 
-  // Unpack the process UUID length.
-  uint16_t pUuidLength;
-  memcpy(&pUuidLength, _buffer, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
   // Unpack the process UUID.
-  this->pUuid = std::string(_buffer, _buffer + pUuidLength);
-  _buffer += pUuidLength;
+  _buffer += this->pUuid.Unpack(_buffer);
 
   // Unpack the message type.
   memcpy(&this->type, _buffer, sizeof(this->type));
@@ -165,6 +196,10 @@ size_t Header::Unpack(const char *_buffer)
   memcpy(&this->flags, _buffer, sizeof(this->flags));
   _buffer += sizeof(this->flags);
 
+  // Unpack the discovery state version.
+  memcpy(&this->stateVersion, _buffer, sizeof(this->stateVersion));
+  _buffer += sizeof(this->stateVersion);
+
   return this->HeaderLength();
 }
 
@@ -255,3 +290,253 @@ size_t SubscriptionMsg::Unpack(char *_buffer)
 
   return sizeof(topicLength) + static_cast<size_t>(topicLength);
 }
+
+//////////////////////////////////////////////////
+size_t SubscriptionMsg::Unpack(const char *_buffer, const size_t _size)
+{
+  // null buffer.
+  if (!_buffer)
+  {
+    std::cerr << "SubscriptionMsg::Unpack() error: NULL input buffer"
+              << std::endl;
+    return 0;
+  }
+
+  // Unpack the topic length.
+  uint16_t topicLength;
+  if (_size < sizeof(topicLength))
+    return 0;
+
+  memcpy(&topicLength, _buffer, sizeof(topicLength));
+  _buffer += sizeof(topicLength);
+
+  // The topic can't be read past the end of the body.
+  if (_size - sizeof(topicLength) < topicLength)
+    return 0;
+
+  // Unpack the topic.
+  this->topic = std::string(_buffer, _buffer + topicLength);
+
+  return sizeof(topicLength) + static_cast<size_t>(topicLength);
+}
+
+//////////////////////////////////////////////////
+SyncMsg::SyncMsg(const transport::Header &_header,
+                 const std::string &_target,
+                 const uint32_t _knownVersion)
+{
+  this->SetHeader(_header);
+  this->SetTarget(_target);
+  this->SetKnownVersion(_knownVersion);
+}
+
+//////////////////////////////////////////////////
+SyncMsg::SyncMsg(const transport::Header &_header,
+                 const Uuid &_target,
+                 const uint32_t _knownVersion)
+{
+  this->SetHeader(_header);
+  this->SetTarget(_target);
+  this->SetKnownVersion(_knownVersion);
+}
+
+//////////////////////////////////////////////////
+transport::Header SyncMsg::Header() const
+{
+  return this->header;
+}
+
+//////////////////////////////////////////////////
+std::string SyncMsg::Target() const
+{
+  return this->target.ToString();
+}
+
+//////////////////////////////////////////////////
+const Uuid &SyncMsg::TargetUuid() const
+{
+  return this->target;
+}
+
+//////////////////////////////////////////////////
+uint32_t SyncMsg::KnownVersion() const
+{
+  return this->knownVersion;
+}
+
+//////////////////////////////////////////////////
+void SyncMsg::SetHeader(const transport::Header &_header)
+{
+  this->header = _header;
+}
+
+//////////////////////////////////////////////////
+void SyncMsg::SetTarget(const std::string &_target)
+{
+  this->target = Uuid(_target);
+}
+
+//////////////////////////////////////////////////
+void SyncMsg::SetTarget(const Uuid &_target)
+{
+  this->target = _target;
+}
+
+//////////////////////////////////////////////////
+void SyncMsg::SetKnownVersion(const uint32_t _knownVersion)
+{
+  this->knownVersion = _knownVersion;
+}
+
+//////////////////////////////////////////////////
+size_t SyncMsg::MsgLength() const
+{
+  return this->header.HeaderLength() + Uuid::ByteLength +
+    sizeof(this->knownVersion);
+}
+
+//////////////////////////////////////////////////
+size_t SyncMsg::Pack(char *_buffer) const
+{
+  // Pack the header.
+  size_t headerLen = this->header.Pack(_buffer);
+  if (headerLen == 0)
+    return 0;
+
+  if (this->target.IsNil())
+  {
+    std::cerr << "SyncMsg::Pack() error: You're trying to pack a "
+              << "message with an invalid target" << std::endl;
+    return 0;
+  }
+
+  _buffer += headerLen;
+
+  // Pack the target (16 bytes).
+  _buffer += this->target.Pack(_buffer);
+
+  // Pack the known version.
+  memcpy(_buffer, &this->knownVersion, sizeof(this->knownVersion));
+
+  return this->MsgLength();
+}
+
+//////////////////////////////////////////////////
+size_t SyncMsg::Unpack(char *_buffer)
+{
+  // null buffer.
+  if (!_buffer)
+  {
+    std::cerr << "SyncMsg::Unpack() error: NULL input buffer" << std::endl;
+    return 0;
+  }
+
+  // Unpack the target.
+  _buffer += this->target.Unpack(_buffer);
+
+  // Unpack the known version.
+  memcpy(&this->knownVersion, _buffer, sizeof(this->knownVersion));
+
+  return Uuid::ByteLength + sizeof(this->knownVersion);
+}
+
+//////////////////////////////////////////////////
+BatchMsg::BatchMsg(const std::vector<std::string> &_items)
+  : items(_items)
+{
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::string> &BatchMsg::Items() const
+{
+  return this->items;
+}
+
+//////////////////////////////////////////////////
+void BatchMsg::AddItem(const std::string &_item)
+{
+  this->items.push_back(_item);
+}
+
+//////////////////////////////////////////////////
+size_t BatchMsg::MsgLength() const
+{
+  size_t len = sizeof(uint32_t);
+  for (const auto &item : this->items)
+    len += sizeof(uint32_t) + item.size();
+
+  return len;
+}
+
+//////////////////////////////////////////////////
+size_t BatchMsg::Pack(char *_buffer) const
+{
+  if (!_buffer)
+  {
+    std::cerr << "BatchMsg::Pack() error: NULL output buffer" << std::endl;
+    return 0;
+  }
+
+  // Pack the number of items.
+  uint32_t numItems = static_cast<uint32_t>(this->items.size());
+  memcpy(_buffer, &numItems, sizeof(numItems));
+  _buffer += sizeof(numItems);
+
+  for (const auto &item : this->items)
+  {
+    // Pack the item length.
+    uint32_t itemLength = static_cast<uint32_t>(item.size());
+    memcpy(_buffer, &itemLength, sizeof(itemLength));
+    _buffer += sizeof(itemLength);
+
+    // Pack the item.
+    memcpy(_buffer, item.data(), item.size());
+    _buffer += item.size();
+  }
+
+  return this->MsgLength();
+}
+
+//////////////////////////////////////////////////
+size_t BatchMsg::Unpack(const char *_buffer, const size_t _size)
+{
+  // null buffer.
+  if (!_buffer)
+  {
+    std::cerr << "BatchMsg::Unpack() error: NULL input buffer" << std::endl;
+    return 0;
+  }
+
+  this->items.clear();
+
+  // Unpack the number of items.
+  uint32_t numItems;
+  if (_size < sizeof(numItems))
+    return 0;
+  memcpy(&numItems, _buffer, sizeof(numItems));
+  size_t pos = sizeof(numItems);
+
+  for (uint32_t i = 0; i < numItems; ++i)
+  {
+    // Unpack the item length.
+    uint32_t itemLength;
+    if (_size - pos < sizeof(itemLength))
+    {
+      this->items.clear();
+      return 0;
+    }
+    memcpy(&itemLength, _buffer + pos, sizeof(itemLength));
+    pos += sizeof(itemLength);
+
+    // Unpack the item.
+    if (_size - pos < itemLength)
+    {
+      this->items.clear();
+      return 0;
+    }
+    this->items.push_back(std::string(_buffer + pos, itemLength));
+    pos += itemLength;
+  }
+
+  return pos;
+}
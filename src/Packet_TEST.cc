@@ -16,12 +16,15 @@
 */
 
 #include <limits.h>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "ignition/transport/Packet.hh"
 #include "ignition/transport/Publisher.hh"
+#include "ignition/transport/Uuid.hh"
 #include "gtest/gtest.h"
 
 using namespace ignition;
@@ -31,7 +34,7 @@ using namespace transport;
 /// \brief Check the getters and setters.
 TEST(PacketTest, BasicHeaderAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
   Header header(version, pUuid, AdvType);
 
@@ -40,22 +43,33 @@ TEST(PacketTest, BasicHeaderAPI)
   EXPECT_EQ(pUuid, header.PUuid());
   EXPECT_EQ(header.Type(), AdvType);
   EXPECT_EQ(header.Flags(), 0);
+  EXPECT_EQ(header.StateVersion(), 0u);
   int headerLength = static_cast<int>(sizeof(header.Version()) +
-    sizeof(uint16_t) + header.PUuid().size() +
-    sizeof(header.Type()) + sizeof(header.Flags()));
+    Uuid::ByteLength +
+    sizeof(header.Type()) + sizeof(header.Flags()) +
+    sizeof(header.StateVersion()));
   EXPECT_EQ(header.HeaderLength(), headerLength);
 
   // Check Header setters.
-  pUuid = "Different-process-UUID-1";
+  pUuid = "00112233-4455-6677-8899-aabbccddeeff";
   header.SetPUuid(pUuid);
   EXPECT_EQ(header.PUuid(), pUuid);
+  EXPECT_EQ(header.ProcessUuid(), Uuid(pUuid));
+  Uuid binUuid;
+  header.SetPUuid(binUuid);
+  EXPECT_EQ(header.ProcessUuid(), binUuid);
+  EXPECT_EQ(header.PUuid(), binUuid.ToString());
+  header.SetPUuid(pUuid);
   header.SetType(SubType);
   EXPECT_EQ(header.Type(), SubType);
   header.SetFlags(1);
   EXPECT_EQ(header.Flags(), 1);
+  header.SetStateVersion(0);
+  EXPECT_EQ(header.StateVersion(), 0u);
   headerLength = static_cast<int>(sizeof(header.Version()) +
-    sizeof(uint16_t) + header.PUuid().size() +
-    sizeof(header.Type()) + sizeof(header.Flags()));
+    Uuid::ByteLength +
+    sizeof(header.Type()) + sizeof(header.Flags()) +
+    sizeof(header.StateVersion()));
   EXPECT_EQ(header.HeaderLength(), headerLength);
 
   // Check << operator
@@ -65,9 +79,10 @@ TEST(PacketTest, BasicHeaderAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 1\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: 00112233-4455-6677-8899-aabbccddeeff\n"
     "\tType: SUBSCRIBE\n"
-    "\tFlags: 1\n";
+    "\tFlags: 1\n"
+    "\tState version: 0\n";
 
   EXPECT_EQ(output.str(), expectedOutput);
 }
@@ -76,7 +91,7 @@ TEST(PacketTest, BasicHeaderAPI)
 /// \brief Check the serialization and unserialization of a header.
 TEST(PacketTest, HeaderIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
 
   // Try to pack an empty header.
@@ -86,6 +101,7 @@ TEST(PacketTest, HeaderIO)
 
   // Pack a Header.
   Header header(version, pUuid, AdvType, 2);
+  header.SetStateVersion(1234);
 
   buffer.resize(header.HeaderLength());
   int bytes = static_cast<int>(header.Pack(&buffer[0]));
@@ -100,11 +116,16 @@ TEST(PacketTest, HeaderIO)
   EXPECT_EQ(header.PUuid(), otherHeader.PUuid());
   EXPECT_EQ(header.Type(), otherHeader.Type());
   EXPECT_EQ(header.Flags(), otherHeader.Flags());
+  EXPECT_EQ(header.StateVersion(), otherHeader.StateVersion());
   EXPECT_EQ(header.HeaderLength(), otherHeader.HeaderLength());
 
   // Try to pack a header passing a NULL buffer.
   EXPECT_EQ(otherHeader.Pack(nullptr), 0u);
 
+  // Try to pack a header with a process UUID that is not a valid UUID.
+  Header badHeader(version, "Process-UUID-1", AdvType, 2);
+  EXPECT_EQ(badHeader.Pack(&buffer[0]), 0u);
+
   // Try to unpack a header passing a NULL buffer.
   EXPECT_EQ(otherHeader.Unpack(nullptr), 0u);
 }
@@ -113,7 +134,7 @@ TEST(PacketTest, HeaderIO)
 /// \brief Check the basic API for creating/reading an ADV message.
 TEST(PacketTest, BasicSubscriptionAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
 
   Header otherHeader(version, pUuid, SubType, 3);
@@ -140,9 +161,10 @@ TEST(PacketTest, BasicSubscriptionAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 1\n"
-    "\tProcess UUID: Process-UUID-1\n"
+    "\tProcess UUID: 0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0\n"
     "\tType: SUBSCRIBE\n"
     "\tFlags: 3\n"
+    "\tState version: 0\n"
     "Body:\n"
     "\tTopic: [a_new_topic_test]\n";
 
@@ -153,7 +175,7 @@ TEST(PacketTest, BasicSubscriptionAPI)
 /// \brief Check the serialization and unserialization of a SUB message.
 TEST(PacketTest, SubscriptionIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
 
   // Try to pack an empty SubscriptionMsg.
@@ -202,7 +224,7 @@ TEST(PacketTest, SubscriptionIO)
 /// \brief Check the basic API for creating/reading an ADV message.
 TEST(PacketTest, BasicAdvertiseMsgAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
 
   Header otherHeader(version, pUuid, AdvType, 3);
@@ -210,8 +232,8 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string procUuid = "procUUID";
-  std::string nodeUuid = "nodeUUID";
+  std::string procUuid = "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90";
+  std::string nodeUuid = "11111111-2222-3333-4444-555555555555";
   Scope_t scope = Scope_t::ALL;
   std::string typeName = "StringMsg";
   MessagePublisher pub(topic, addr, ctrl, procUuid, nodeUuid, scope, typeName);
@@ -236,13 +258,12 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     sizeof(uint16_t) + topic.size() +
     sizeof(uint16_t) + addr.size() +
     sizeof(uint16_t) + ctrl.size() +
-    sizeof(uint16_t) + procUuid.size() +
-    sizeof(uint16_t) + nodeUuid.size() +
+    2 * Uuid::ByteLength +
     sizeof(uint8_t)  +
     sizeof(uint16_t) + typeName.size();
   EXPECT_EQ(advMsg.MsgLength(), msgLength);
 
-  pUuid = "Different-process-UUID-1";
+  pUuid = "00112233-4455-6677-8899-aabbccddeeff";
 
   // Check AdvertiseMsg setters.
   Header anotherHeader(version + 1, pUuid, AdvType, 3);
@@ -255,15 +276,16 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
   EXPECT_EQ(header.Type(), AdvType);
   EXPECT_EQ(header.Flags(), 3);
   size_t headerLength = sizeof(header.Version()) +
-    sizeof(uint16_t) + header.PUuid().size() +
-    sizeof(header.Type()) + sizeof(header.Flags());
+    Uuid::ByteLength +
+    sizeof(header.Type()) + sizeof(header.Flags()) +
+    sizeof(header.StateVersion());
   EXPECT_EQ(static_cast<size_t>(header.HeaderLength()), headerLength);
 
   topic = "a_new_topic_test";
   addr = "inproc://local";
   ctrl = "inproc://control";
-  procUuid = "procUUID";
-  nodeUuid = "nodeUUID2";
+  procUuid = "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90";
+  nodeUuid = "66666666-7777-8888-9999-000000000000";
   scope = Scope_t::HOST;
   typeName = "Int";
   advMsg.Publisher().SetTopic(topic);
@@ -288,14 +310,15 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: 00112233-4455-6677-8899-aabbccddeeff\n"
     "\tType: ADVERTISE\n"
     "\tFlags: 3\n"
+    "\tState version: 0\n"
     "Publisher:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
-    "\tProcess UUID: procUUID\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tProcess UUID: a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90\n"
+    "\tNode UUID: 66666666-7777-8888-9999-000000000000\n"
     "\tTopic Scope: Host\n"
     "\tControl address: inproc://control\n"
     "\tMessage type: Int\n";
@@ -309,14 +332,15 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: 00112233-4455-6677-8899-aabbccddeeff\n"
     "\tType: ADVERTISE\n"
     "\tFlags: 3\n"
+    "\tState version: 0\n"
     "Publisher:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
-    "\tProcess UUID: procUUID\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tProcess UUID: a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90\n"
+    "\tNode UUID: 66666666-7777-8888-9999-000000000000\n"
     "\tTopic Scope: Process\n"
     "\tControl address: inproc://control\n"
     "\tMessage type: Int\n";
@@ -331,14 +355,15 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: 00112233-4455-6677-8899-aabbccddeeff\n"
     "\tType: ADVERTISE\n"
     "\tFlags: 3\n"
+    "\tState version: 0\n"
     "Publisher:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
-    "\tProcess UUID: procUUID\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tProcess UUID: a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90\n"
+    "\tNode UUID: 66666666-7777-8888-9999-000000000000\n"
     "\tTopic Scope: All\n"
     "\tControl address: inproc://control\n"
     "\tMessage type: Int\n";
@@ -350,13 +375,13 @@ TEST(PacketTest, BasicAdvertiseMsgAPI)
 /// \brief Check the serialization and unserialization of an ADV message.
 TEST(PacketTest, AdvertiseMsgIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string ctrl = "tcp://10.0.0.1:60011";
-  std::string procUuid = "procUUID";
-  std::string nodeUuid = "nodeUUID";
+  std::string procUuid = "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90";
+  std::string nodeUuid = "11111111-2222-3333-4444-555555555555";
   Scope_t scope = Scope_t::HOST;
   std::string typeName = "StringMsg";
 
@@ -434,11 +459,61 @@ TEST(PacketTest, AdvertiseMsgIO)
   EXPECT_EQ(otherAdvMsg.Unpack(nullptr), 0u);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that truncated ADV and SUB messages are not unpacked past the
+/// end of their body.
+TEST(PacketTest, TruncatedMsgIO)
+{
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
+  uint8_t version   = 1;
+  std::string topic = "topic_test";
+
+  // A body with only a topic length longer than the rest of the body.
+  uint16_t topicLength = UINT16_MAX;
+  std::vector<char> body(sizeof(topicLength));
+  memcpy(&body[0], &topicLength, sizeof(topicLength));
+
+  AdvertiseMessage<MessagePublisher> advMsg;
+  EXPECT_EQ(advMsg.Unpack(&body[0], body.size()), 0u);
+  EXPECT_EQ(advMsg.Unpack(&body[0], 0), 0u);
+  EXPECT_EQ(advMsg.Unpack(nullptr, body.size()), 0u);
+
+  SubscriptionMsg subMsg;
+  EXPECT_EQ(subMsg.Unpack(&body[0], body.size()), 0u);
+  EXPECT_EQ(subMsg.Unpack(&body[0], 1), 0u);
+  EXPECT_EQ(subMsg.Unpack(nullptr, body.size()), 0u);
+
+  // A complete ADV message is unpacked, but not with a byte less.
+  MessagePublisher publisher(topic, "tcp://10.0.0.1:6000",
+    "tcp://10.0.0.1:60011", "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90",
+    "11111111-2222-3333-4444-555555555555", Scope_t::ALL, "StringMsg");
+  Header header(version, pUuid, AdvType);
+  AdvertiseMessage<MessagePublisher> fullAdvMsg(header, publisher);
+  std::vector<char> buffer(fullAdvMsg.MsgLength());
+  ASSERT_EQ(fullAdvMsg.Pack(&buffer[0]), buffer.size());
+  char *pBody = &buffer[0] + header.HeaderLength();
+  size_t bodyBytes = buffer.size() - header.HeaderLength();
+  EXPECT_EQ(advMsg.Unpack(pBody, bodyBytes - 1), 0u);
+  EXPECT_EQ(advMsg.Unpack(pBody, bodyBytes), bodyBytes);
+  EXPECT_EQ(advMsg.Publisher().Topic(), topic);
+
+  // The same for a SUB message.
+  header.SetType(SubType);
+  SubscriptionMsg fullSubMsg(header, topic);
+  buffer.resize(fullSubMsg.MsgLength());
+  ASSERT_EQ(fullSubMsg.Pack(&buffer[0]), buffer.size());
+  pBody = &buffer[0] + header.HeaderLength();
+  bodyBytes = buffer.size() - header.HeaderLength();
+  EXPECT_EQ(subMsg.Unpack(pBody, bodyBytes - 1), 0u);
+  EXPECT_EQ(subMsg.Unpack(pBody, bodyBytes), bodyBytes);
+  EXPECT_EQ(subMsg.Topic(), topic);
+}
+
 //////////////////////////////////////////////////
 /// \brief Check the basic API for creating/reading an ADV SRV message.
 TEST(PacketTest, BasicAdvertiseSrvAPI)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
 
   Header otherHeader(version, pUuid, AdvType, 3);
@@ -446,7 +521,7 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string id = "socketID";
-  std::string nodeUuid = "nodeUUID";
+  std::string nodeUuid = "11111111-2222-3333-4444-555555555555";
   Scope_t scope = Scope_t::ALL;
   std::string reqType = "StringMsg";
   std::string repType = "Int";
@@ -476,14 +551,13 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
     sizeof(uint16_t) + topic.size() +
     sizeof(uint16_t) + addr.size() +
     sizeof(uint16_t) + id.size() +
-    sizeof(uint16_t) + pUuid.size() +
-    sizeof(uint16_t) + nodeUuid.size() +
+    2 * Uuid::ByteLength +
     sizeof(uint8_t)  +
     sizeof(uint16_t) + advSrv.Publisher().ReqTypeName().size() +
     sizeof(uint16_t) + advSrv.Publisher().RepTypeName().size();
   EXPECT_EQ(advSrv.MsgLength(), msgLength);
 
-  pUuid = "Different-process-UUID-1";
+  pUuid = "00112233-4455-6677-8899-aabbccddeeff";
 
   // Check AdvertiseSrv setters.
   Header anotherHeader(version + 1, pUuid, AdvType, 3);
@@ -494,15 +568,16 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
   EXPECT_EQ(header.Type(), AdvType);
   EXPECT_EQ(header.Flags(), 3);
   size_t headerLength = sizeof(header.Version()) +
-    sizeof(uint16_t) + header.PUuid().size() +
-    sizeof(header.Type()) + sizeof(header.Flags());
+    Uuid::ByteLength +
+    sizeof(header.Type()) + sizeof(header.Flags()) +
+    sizeof(header.StateVersion());
   EXPECT_EQ(static_cast<size_t>(header.HeaderLength()), headerLength);
 
   topic = "a_new_topic_test";
   addr = "inproc://local";
   id = "aSocketID";
-  pUuid = "procUUID";
-  nodeUuid = "nodeUUID2";
+  pUuid = "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90";
+  nodeUuid = "66666666-7777-8888-9999-000000000000";
   scope = Scope_t::HOST;
   reqType = "Type1";
   repType = "Type2";
@@ -530,14 +605,15 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
     "--------------------------------------\n"
     "Header:\n"
     "\tVersion: 2\n"
-    "\tProcess UUID: Different-process-UUID-1\n"
+    "\tProcess UUID: 00112233-4455-6677-8899-aabbccddeeff\n"
     "\tType: ADVERTISE\n"
     "\tFlags: 3\n"
+    "\tState version: 0\n"
     "Publisher:\n"
     "\tTopic: [a_new_topic_test]\n"
     "\tAddress: inproc://local\n"
-    "\tProcess UUID: procUUID\n"
-    "\tNode UUID: nodeUUID2\n"
+    "\tProcess UUID: a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90\n"
+    "\tNode UUID: 66666666-7777-8888-9999-000000000000\n"
     "\tTopic Scope: Host\n"
     "\tSocket ID: aSocketID\n"
     "\tRequest type: Type1\n"
@@ -550,13 +626,13 @@ TEST(PacketTest, BasicAdvertiseSrvAPI)
 /// \brief Check the serialization and unserialization of an ADV SRV message.
 TEST(PacketTest, AdvertiseSrvIO)
 {
-  std::string pUuid = "Process-UUID-1";
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
   uint8_t version   = 1;
   std::string topic = "topic_test";
   std::string addr = "tcp://10.0.0.1:6000";
   std::string id = "socketId";
-  std::string procUuid = "procUUID";
-  std::string nodeUuid = "nodeUUID";
+  std::string procUuid = "a1b2c3d4-e5f6-0718-293a-4b5c6d7e8f90";
+  std::string nodeUuid = "11111111-2222-3333-4444-555555555555";
   Scope_t scope = Scope_t::HOST;
   std::string reqType = "StringMsg";
   std::string repType = "Int";
@@ -621,3 +697,182 @@ TEST(PacketTest, AdvertiseSrvIO)
   // Try to unpack an AdvertiseSrv passing a NULL buffer.
   EXPECT_EQ(otherAdvSrv.Unpack(nullptr), 0u);
 }
+
+//////////////////////////////////////////////////
+/// \brief Check the serialization and unserialization of an
+/// AdvertiseBatchMessage.
+TEST(PacketTest, AdvertiseBatchMsgIO)
+{
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
+  uint8_t version   = 1;
+  std::string addr = "tcp://10.0.0.1:6000";
+  std::string ctrl = "tcp://10.0.0.1:60011";
+  std::string nodeUuid = "11111111-2222-3333-4444-555555555555";
+  Scope_t scope = Scope_t::ALL;
+  std::string typeName = "StringMsg";
+
+  Header header(version, pUuid, AdvBatchType);
+
+  // An empty batch is valid (empty snapshot).
+  AdvertiseBatchMessage<MessagePublisher> emptyMsg(header);
+  EXPECT_EQ(emptyMsg.Part(), 0u);
+  EXPECT_EQ(emptyMsg.NumParts(), 1u);
+  std::vector<char> buffer(emptyMsg.MsgLength());
+  EXPECT_EQ(emptyMsg.Pack(&buffer[0]), emptyMsg.MsgLength());
+
+  // Try to pack a batch with an invalid part number.
+  emptyMsg.SetPart(2, 2);
+  EXPECT_EQ(emptyMsg.Pack(&buffer[0]), 0u);
+
+  // Try to pack a batch with an incomplete publisher (empty topic).
+  AdvertiseBatchMessage<MessagePublisher> noTopicMsg(header);
+  noTopicMsg.AddPublisher(MessagePublisher("", addr, ctrl, pUuid, nodeUuid,
+    scope, typeName));
+  buffer.resize(noTopicMsg.MsgLength());
+  EXPECT_EQ(noTopicMsg.Pack(&buffer[0]), 0u);
+
+  // Pack a batch.
+  AdvertiseBatchMessage<MessagePublisher> batchMsg(header);
+  batchMsg.SetPart(1, 3);
+  for (auto i = 0; i < 10; ++i)
+  {
+    batchMsg.AddPublisher(MessagePublisher("topic" + std::to_string(i), addr,
+      ctrl, pUuid, nodeUuid, scope, typeName));
+  }
+  EXPECT_EQ(batchMsg.Publishers().size(), 10u);
+  buffer.resize(batchMsg.MsgLength());
+  size_t bytes = batchMsg.Pack(&buffer[0]);
+  EXPECT_EQ(bytes, batchMsg.MsgLength());
+
+  // Unpack the batch.
+  Header otherHeader;
+  size_t headerBytes = otherHeader.Unpack(&buffer[0]);
+  EXPECT_EQ(headerBytes, static_cast<size_t>(otherHeader.HeaderLength()));
+  EXPECT_EQ(otherHeader.Type(), AdvBatchType);
+  AdvertiseBatchMessage<MessagePublisher> otherBatchMsg(otherHeader);
+  char *pBody = &buffer[0] + headerBytes;
+  size_t bodyBytes = otherBatchMsg.Unpack(pBody, bytes - headerBytes);
+  EXPECT_EQ(bodyBytes, bytes - headerBytes);
+  EXPECT_EQ(otherBatchMsg.MsgLength(), batchMsg.MsgLength());
+  EXPECT_EQ(otherBatchMsg.Part(), 1u);
+  EXPECT_EQ(otherBatchMsg.NumParts(), 3u);
+
+  // Check that after Pack() and Unpack() the data does not change.
+  ASSERT_EQ(otherBatchMsg.Publishers().size(), batchMsg.Publishers().size());
+  for (size_t i = 0; i < batchMsg.Publishers().size(); ++i)
+  {
+    const auto &pub = batchMsg.Publishers().at(i);
+    const auto &otherPub = otherBatchMsg.Publishers().at(i);
+    EXPECT_EQ(otherPub.Topic(), pub.Topic());
+    EXPECT_EQ(otherPub.Addr(), pub.Addr());
+    EXPECT_EQ(otherPub.Ctrl(), pub.Ctrl());
+    EXPECT_EQ(otherPub.NUuid(), pub.NUuid());
+    EXPECT_EQ(otherPub.Scope(), pub.Scope());
+    EXPECT_EQ(otherPub.MsgTypeName(), pub.MsgTypeName());
+  }
+
+  // Try to unpack a truncated batch.
+  EXPECT_EQ(otherBatchMsg.Unpack(pBody, 1), 0u);
+  EXPECT_EQ(otherBatchMsg.Unpack(pBody, bytes - headerBytes - 1), 0u);
+  EXPECT_TRUE(otherBatchMsg.Publishers().empty());
+
+  // Try to unpack a batch whose last publisher has a topic longer than the
+  // rest of the body.
+  std::vector<char> body(pBody, pBody + bytes - headerBytes);
+  size_t lastPub = body.size() - batchMsg.Publishers().back().MsgLength();
+  uint16_t topicLength = UINT16_MAX;
+  memcpy(&body[lastPub], &topicLength, sizeof(topicLength));
+  EXPECT_EQ(otherBatchMsg.Unpack(&body[0], body.size()), 0u);
+  EXPECT_TRUE(otherBatchMsg.Publishers().empty());
+
+  // Remove all the publishers.
+  batchMsg.Clear();
+  EXPECT_TRUE(batchMsg.Publishers().empty());
+
+  // Try to unpack a batch passing a NULL buffer.
+  EXPECT_EQ(otherBatchMsg.Unpack(nullptr, 10), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the serialization and unserialization of a SyncMsg.
+TEST(PacketTest, SyncMsgIO)
+{
+  std::string pUuid = "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
+  std::string target = "8c3b5d1e-2f4a-4b6c-9d7e-0a1b2c3d4e5f";
+  uint8_t version   = 1;
+
+  Header header(version, pUuid, SyncType);
+  header.SetStateVersion(3);
+
+  // Try to pack a message without target.
+  SyncMsg emptyMsg(header, "", 0);
+  std::vector<char> buffer(emptyMsg.MsgLength());
+  EXPECT_EQ(emptyMsg.Pack(&buffer[0]), 0u);
+
+  // Pack a SyncMsg.
+  SyncMsg syncMsg(header, target, 7);
+  EXPECT_EQ(syncMsg.Target(), target);
+  EXPECT_EQ(syncMsg.KnownVersion(), 7u);
+  buffer.resize(syncMsg.MsgLength());
+  size_t bytes = syncMsg.Pack(&buffer[0]);
+  EXPECT_EQ(bytes, syncMsg.MsgLength());
+
+  // Unpack the SyncMsg.
+  Header otherHeader;
+  size_t headerBytes = otherHeader.Unpack(&buffer[0]);
+  EXPECT_EQ(otherHeader.Type(), SyncType);
+  EXPECT_EQ(otherHeader.StateVersion(), 3u);
+  SyncMsg otherSyncMsg;
+  otherSyncMsg.SetHeader(otherHeader);
+  size_t bodyBytes = otherSyncMsg.Unpack(&buffer[0] + headerBytes);
+  EXPECT_EQ(bodyBytes, bytes - headerBytes);
+
+  // Check that after Pack() and Unpack() the data does not change.
+  EXPECT_EQ(otherSyncMsg.Target(), syncMsg.Target());
+  EXPECT_EQ(otherSyncMsg.TargetUuid(), Uuid(target));
+  EXPECT_EQ(otherSyncMsg.KnownVersion(), syncMsg.KnownVersion());
+  EXPECT_EQ(otherSyncMsg.MsgLength(), syncMsg.MsgLength());
+
+  // Try to unpack a SyncMsg passing a NULL buffer.
+  EXPECT_EQ(otherSyncMsg.Unpack(nullptr), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the serialization and unserialization of a BatchMsg.
+TEST(PacketTest, BatchMsgIO)
+{
+  std::vector<std::string> items = {"first", "", std::string("a\0b", 3)};
+  BatchMsg batch(items);
+  EXPECT_EQ(batch.Items(), items);
+  batch.AddItem("last");
+  items.push_back("last");
+  EXPECT_EQ(batch.Items(), items);
+
+  // Pack a BatchMsg.
+  std::vector<char> buffer(batch.MsgLength());
+  size_t bytes = batch.Pack(&buffer[0]);
+  EXPECT_EQ(bytes, batch.MsgLength());
+
+  // Unpack a BatchMsg.
+  BatchMsg otherBatch;
+  EXPECT_EQ(otherBatch.Unpack(&buffer[0], buffer.size()), bytes);
+  EXPECT_EQ(otherBatch.Items(), items);
+  EXPECT_EQ(otherBatch.MsgLength(), batch.MsgLength());
+
+  // Try to unpack a truncated BatchMsg.
+  BatchMsg truncatedBatch;
+  EXPECT_EQ(truncatedBatch.Unpack(&buffer[0], buffer.size() - 1), 0u);
+  EXPECT_TRUE(truncatedBatch.Items().empty());
+  EXPECT_EQ(truncatedBatch.Unpack(&buffer[0], 2), 0u);
+
+  // An empty batch.
+  BatchMsg emptyBatch;
+  buffer.resize(emptyBatch.MsgLength());
+  EXPECT_EQ(emptyBatch.Pack(&buffer[0]), sizeof(uint32_t));
+  EXPECT_EQ(otherBatch.Unpack(&buffer[0], buffer.size()), sizeof(uint32_t));
+  EXPECT_TRUE(otherBatch.Items().empty());
+
+  // Try to pack/unpack a BatchMsg passing a NULL buffer.
+  EXPECT_EQ(batch.Pack(nullptr), 0u);
+  EXPECT_EQ(otherBatch.Unpack(nullptr, 10), 0u);
+}
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <string>
 
 #include "ignition/transport/Publisher.hh"
@@ -25,6 +26,33 @@
 using namespace ignition;
 using namespace transport;
 
+namespace
+{
+  /// \brief Unpack a string prefixed by its length.
+  /// \param[in, out] _buffer Input buffer. It is advanced past the string.
+  /// \param[in, out] _left Bytes left in the input buffer.
+  /// \param[out] _str Unpacked string.
+  /// \return True if the string fits in the input buffer.
+  bool unpackString(const char *&_buffer, size_t &_left, std::string &_str)
+  {
+    uint16_t len;
+    if (_left < sizeof(len))
+      return false;
+
+    memcpy(&len, _buffer, sizeof(len));
+    _buffer += sizeof(len);
+    _left -= sizeof(len);
+
+    if (_left < len)
+      return false;
+
+    _str.assign(_buffer, len);
+    _buffer += len;
+    _left -= len;
+    return true;
+  }
+}
+
 //////////////////////////////////////////////////
 Publisher::Publisher(const std::string &_topic, const std::string &_addr,
   const std::string &_pUuid, const std::string &_nUuid, const Scope_t &_scope)
@@ -50,12 +78,28 @@ std::string Publisher::Addr() const
 
 //////////////////////////////////////////////////
 std::string Publisher::PUuid() const
+{
+  if (this->pUuid.IsNil())
+    return "";
+  return this->pUuid.ToString();
+}
+
+//////////////////////////////////////////////////
+const Uuid &Publisher::ProcessUuid() const
 {
   return this->pUuid;
 }
 
 //////////////////////////////////////////////////
 std::string Publisher::NUuid() const
+{
+  if (this->nUuid.IsNil())
+    return "";
+  return this->nUuid.ToString();
+}
+
+//////////////////////////////////////////////////
+const Uuid &Publisher::NodeUuid() const
 {
   return this->nUuid;
 }
@@ -80,12 +124,24 @@ void Publisher::SetAddr(const std::string &_addr)
 
 //////////////////////////////////////////////////
 void Publisher::SetPUuid(const std::string &_pUuid)
+{
+  this->pUuid = Uuid(_pUuid);
+}
+
+//////////////////////////////////////////////////
+void Publisher::SetPUuid(const Uuid &_pUuid)
 {
   this->pUuid = _pUuid;
 }
 
 //////////////////////////////////////////////////
 void Publisher::SetNUuid(const std::string &_nUuid)
+{
+  this->nUuid = Uuid(_nUuid);
+}
+
+//////////////////////////////////////////////////
+void Publisher::SetNUuid(const Uuid &_nUuid)
 {
   this->nUuid = _nUuid;
 }
@@ -100,7 +156,7 @@ void Publisher::SetScope(const Scope_t &_scope)
 size_t Publisher::Pack(char *_buffer) const
 {
   if (this->topic.empty() || this->addr.empty() ||
-      this->pUuid.empty() || this->nUuid.empty())
+      this->pUuid.IsNil() || this->nUuid.IsNil())
   {
     std::cerr << "Publisher::Pack() error: You're trying to pack an "
               << "incomplete Publisher:" << std::endl << *this;
@@ -132,23 +188,9 @@ size_t Publisher::Pack(char *_buffer) const
   memcpy(_buffer, this->addr.data(), static_cast<size_t>(addrLength));
   _buffer += addrLength;
 
-  // Pack the process UUID length.
-  uint16_t pUuidLength = static_cast<uint16_t>(this->pUuid.size());
-  memcpy(_buffer, &pUuidLength, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
-  // Pack the process UUID.
-  memcpy(_buffer, this->pUuid.data(), static_cast<size_t>(pUuidLength));
-  _buffer += pUuidLength;
-
-  // Pack the node UUID length.
-  uint16_t nUuidLength = static_cast<uint16_t>(this->nUuid.size());
-  memcpy(_buffer, &nUuidLength, sizeof(nUuidLength));
-  _buffer += sizeof(nUuidLength);
-
-  // Pack the node UUID.
-  memcpy(_buffer, this->nUuid.data(), static_cast<size_t>(nUuidLength));
-  _buffer += nUuidLength;
+  // Pack the process and node UUIDs (binary form).
+  _buffer += this->pUuid.Pack(_buffer);
+  _buffer += this->nUuid.Pack(_buffer);
 
   // Pack the topic scope.
   uint8_t intscope = static_cast<uint8_t>(this->scope);
@@ -159,6 +201,12 @@ size_t Publisher::Pack(char *_buffer) const
 
 //////////////////////////////////////////////////
 size_t Publisher::Unpack(char *_buffer)
+{
+  return this->Unpack(_buffer, std::numeric_limits<size_t>::max());
+}
+
+//////////////////////////////////////////////////
+size_t Publisher::Unpack(const char *_buffer, const size_t _size)
 {
   // null buffer.
   if (!_buffer)
@@ -168,41 +216,20 @@ size_t Publisher::Unpack(char *_buffer)
     return 0;
   }
 
-  // Unpack the topic length.
-  uint16_t topicLength;
-  memcpy(&topicLength, _buffer, sizeof(topicLength));
-  _buffer += sizeof(topicLength);
-
-  // Unpack the topic.
-  this->topic = std::string(_buffer, _buffer + topicLength);
-  _buffer += topicLength;
-
-  // Unpack the zeromq address length.
-  uint16_t addrLength;
-  memcpy(&addrLength, _buffer, sizeof(addrLength));
-  _buffer += sizeof(addrLength);
-
-  // Unpack the zeromq address.
-  this->addr = std::string(_buffer, _buffer + addrLength);
-  _buffer += addrLength;
-
-  // Unpack the process UUID length.
-  uint16_t pUuidLength;
-  memcpy(&pUuidLength, _buffer, sizeof(pUuidLength));
-  _buffer += sizeof(pUuidLength);
-
-  // Unpack the process UUID.
-  this->pUuid = std::string(_buffer, _buffer + pUuidLength);
-  _buffer += pUuidLength;
-
-  // Unpack the node UUID length.
-  uint16_t nUuidLength;
-  memcpy(&nUuidLength, _buffer, sizeof(nUuidLength));
-  _buffer += sizeof(nUuidLength);
+  // Unpack the topic and the zeromq address.
+  size_t left = _size;
+  if (!unpackString(_buffer, left, this->topic) ||
+      !unpackString(_buffer, left, this->addr) ||
+      left < 2 * Uuid::ByteLength + sizeof(uint8_t))
+  {
+    std::cerr << "Publisher::Unpack() error: Truncated input buffer"
+              << std::endl;
+    return 0;
+  }
 
-  // Unpack the node UUID.
-  this->nUuid = std::string(_buffer, _buffer + nUuidLength);
-  _buffer += nUuidLength;
+  // Unpack the process and node UUIDs (binary form).
+  _buffer += this->pUuid.Unpack(_buffer);
+  _buffer += this->nUuid.Unpack(_buffer);
 
   // Unpack the topic scope.
   uint8_t intscope;
@@ -217,8 +244,7 @@ size_t Publisher::MsgLength() const
 {
   return sizeof(uint16_t) + this->topic.size() +
          sizeof(uint16_t) + this->addr.size() +
-         sizeof(uint16_t) + this->pUuid.size() +
-         sizeof(uint16_t) + this->nUuid.size() +
+         2 * Uuid::ByteLength +
          sizeof(uint8_t);
 }
 
@@ -287,38 +313,37 @@ size_t MessagePublisher::Pack(char *_buffer) const
 
 //////////////////////////////////////////////////
 size_t MessagePublisher::Unpack(char *_buffer)
+{
+  return this->Unpack(_buffer, std::numeric_limits<size_t>::max());
+}
+
+//////////////////////////////////////////////////
+size_t MessagePublisher::Unpack(const char *_buffer, const size_t _size)
 {
   // null buffer.
   if (!_buffer)
   {
-    std::cerr << "MessagePublisher::UnpackBody() error: NULL input buffer"
+    std::cerr << "MessagePublisher::Unpack() error: NULL input buffer"
               << std::endl;
     return 0;
   }
 
   // Unpack the common part of any Publisher message.
-  size_t len = Publisher::Unpack(_buffer);
+  size_t len = Publisher::Unpack(_buffer, _size);
   if (len == 0)
     return 0;
 
   _buffer += len;
 
-  // Unpack the zeromq control address length.
-  uint16_t ctrlLength;
-  memcpy(&ctrlLength, _buffer, sizeof(ctrlLength));
-  _buffer += sizeof(ctrlLength);
-
-  // Unpack the zeromq control address.
-  this->ctrl = std::string(_buffer, _buffer + ctrlLength);
-  _buffer += ctrlLength;
-
-  // Unpack the type name length.
-  uint16_t typeNameLength;
-  memcpy(&typeNameLength, _buffer, sizeof(typeNameLength));
-  _buffer += sizeof(typeNameLength);
-
-  // Unpack the type name.
-  this->msgTypeName = std::string(_buffer, _buffer + typeNameLength);
+  // Unpack the zeromq control address and the type name.
+  size_t left = _size - len;
+  if (!unpackString(_buffer, left, this->ctrl) ||
+      !unpackString(_buffer, left, this->msgTypeName))
+  {
+    std::cerr << "MessagePublisher::Unpack() error: Truncated input buffer"
+              << std::endl;
+    return 0;
+  }
 
   return this->MsgLength();
 }
@@ -430,48 +455,38 @@ size_t ServicePublisher::Pack(char *_buffer) const
 
 //////////////////////////////////////////////////
 size_t ServicePublisher::Unpack(char *_buffer)
+{
+  return this->Unpack(_buffer, std::numeric_limits<size_t>::max());
+}
+
+//////////////////////////////////////////////////
+size_t ServicePublisher::Unpack(const char *_buffer, const size_t _size)
 {
   // null buffer.
   if (!_buffer)
   {
-    std::cerr << "MessagePublisher::Unpack() error: NULL input buffer"
+    std::cerr << "ServicePublisher::Unpack() error: NULL input buffer"
               << std::endl;
     return 0;
   }
 
   // Unpack the common part of any Publisher message.
-  size_t len = Publisher::Unpack(_buffer);
+  size_t len = Publisher::Unpack(_buffer, _size);
   if (len == 0)
     return 0;
 
   _buffer += len;
 
-  // Unpack the socket ID length.
-  uint16_t socketIdLength;
-  memcpy(&socketIdLength, _buffer, sizeof(socketIdLength));
-  _buffer += sizeof(socketIdLength);
-
-  // Unpack the socket ID.
-  this->socketId = std::string(_buffer, _buffer + socketIdLength);
-  _buffer += socketIdLength;
-
-  // Unpack the request type length.
-  uint16_t reqTypeLength;
-  memcpy(&reqTypeLength, _buffer, sizeof(reqTypeLength));
-  _buffer += sizeof(reqTypeLength);
-
-  // Unpack the request type.
-  this->reqTypeName = std::string(_buffer, _buffer + reqTypeLength);
-  _buffer += reqTypeLength;
-
-  // Unpack the response type length.
-  uint16_t repTypeLength;
-  memcpy(&repTypeLength, _buffer, sizeof(repTypeLength));
-  _buffer += sizeof(repTypeLength);
-
-  // Unpack the response type.
-  this->repTypeName = std::string(_buffer, _buffer + repTypeLength);
-  _buffer += repTypeLength;
+  // Unpack the socket ID and the request and response types.
+  size_t left = _size - len;
+  if (!unpackString(_buffer, left, this->socketId) ||
+      !unpackString(_buffer, left, this->reqTypeName) ||
+      !unpackString(_buffer, left, this->repTypeName))
+  {
+    std::cerr << "ServicePublisher::Unpack() error: Truncated input buffer"
+              << std::endl;
+    return 0;
+  }
 
   return this->MsgLength();
 }
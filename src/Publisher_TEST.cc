@@ -15,7 +15,9 @@
  *
 */
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "ignition/transport/AdvertiseOptions.hh"
 #include "ignition/transport/Publisher.hh"
@@ -27,8 +29,10 @@ using namespace transport;
 // Global constants.
 static const std::string Topic       = "/topic";
 static const std::string Addr        = "tcp://myAddress";
-static const std::string PUuid       = "processUUID";
-static const std::string NUuid       = "nodeUUID";
+static const std::string PUuid       =
+  "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0";
+static const std::string NUuid       =
+  "00112233-4455-6677-8899-aabbccddeeff";
 static const Scope_t     Scope       = Scope_t::ALL;
 static const std::string Ctrl        = "controlAddress";
 static const std::string SocketId    = "socketId";
@@ -38,8 +42,10 @@ static const std::string RepTypeName = "ResponseType";
 
 static const std::string NewTopic       = "/newTopic";
 static const std::string NewAddr        = "tcp://anotherAddress";
-static const std::string NewPUuid       = "processUUID2";
-static const std::string NewNUuid       = "nodeUUID2";
+static const std::string NewPUuid       =
+  "10203040-5060-7080-90a0-b0c0d0e0f000";
+static const std::string NewNUuid       =
+  "ffeeddcc-bbaa-9988-7766-554433221100";
 static const Scope_t     NewScope       = Scope_t::HOST;
 static const std::string NewCtrl        = "controlAddress2";
 static const std::string NewSocketId    = "socketId2";
@@ -59,8 +65,7 @@ TEST(PublisherTest, Publisher)
   EXPECT_EQ(publisher.Scope(), Scope);
   size_t msgLength = sizeof(uint16_t) + publisher.Topic().size() +
     sizeof(uint16_t) + publisher.Addr().size() +
-    sizeof(uint16_t) + publisher.PUuid().size() +
-    sizeof(uint16_t) + publisher.NUuid().size() +
+    2 * Uuid::ByteLength +
     sizeof(uint8_t);
   EXPECT_EQ(publisher.MsgLength(), msgLength);
 
@@ -69,8 +74,7 @@ TEST(PublisherTest, Publisher)
   EXPECT_FALSE(publisher != pub2);
   msgLength = sizeof(uint16_t) + pub2.Topic().size() +
     sizeof(uint16_t) + pub2.Addr().size() +
-    sizeof(uint16_t) + pub2.PUuid().size() +
-    sizeof(uint16_t) + pub2.NUuid().size() +
+    2 * Uuid::ByteLength +
     sizeof(uint8_t);
   EXPECT_EQ(pub2.MsgLength(), msgLength);
 
@@ -88,8 +92,7 @@ TEST(PublisherTest, Publisher)
   EXPECT_EQ(publisher.Scope(), NewScope);
   msgLength = sizeof(uint16_t) + publisher.Topic().size() +
     sizeof(uint16_t) + publisher.Addr().size() +
-    sizeof(uint16_t) + publisher.PUuid().size() +
-    sizeof(uint16_t) + publisher.NUuid().size() +
+    2 * Uuid::ByteLength +
     sizeof(uint8_t);
   EXPECT_EQ(publisher.MsgLength(), msgLength);
 }
@@ -126,6 +129,42 @@ TEST(PublisherTest, PublisherIO)
 
   // Try to unpack a header passing a NULL buffer.
   EXPECT_EQ(otherPublisher.Unpack(nullptr), 0u);
+
+  // Unpack the publisher without reading past the end of the buffer.
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes), bytes);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes - 1), 0u);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], 1), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the process and node UUIDs are stored in binary form.
+TEST(PublisherTest, PublisherUuids)
+{
+  Publisher publisher(Topic, Addr, PUuid, NUuid, Scope);
+  EXPECT_EQ(publisher.ProcessUuid(), Uuid(PUuid));
+  EXPECT_EQ(publisher.NodeUuid(), Uuid(NUuid));
+
+  // The upper case form of a UUID is the same UUID.
+  std::string upper = NewPUuid;
+  std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+  publisher.SetPUuid(upper);
+  EXPECT_EQ(publisher.PUuid(), NewPUuid);
+
+  publisher.SetNUuid(Uuid(NewNUuid));
+  EXPECT_EQ(publisher.NUuid(), NewNUuid);
+
+  // A string that is not a UUID leaves the UUID unset, and the publisher
+  // can't be packed.
+  publisher.SetPUuid("processUUID");
+  EXPECT_TRUE(publisher.PUuid().empty());
+  EXPECT_TRUE(publisher.ProcessUuid().IsNil());
+
+  std::vector<char> buffer(publisher.MsgLength());
+  EXPECT_EQ(publisher.Pack(&buffer[0]), 0u);
+
+  Publisher other(Topic, Addr, PUuid, "nodeUUID", Scope);
+  EXPECT_TRUE(other.NUuid().empty());
+  EXPECT_EQ(other.Pack(&buffer[0]), 0u);
 }
 
 //////////////////////////////////////////////////
@@ -211,6 +250,11 @@ TEST(PublisherTest, MessagePublisherIO)
 
   // Try to unpack a header passing a NULL buffer.
   EXPECT_EQ(otherPublisher.Unpack(nullptr), 0u);
+
+  // Unpack the publisher without reading past the end of the buffer.
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes), bytes);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes - 1), 0u);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], 1), 0u);
 }
 
 //////////////////////////////////////////////////
@@ -303,4 +347,9 @@ TEST(PublisherTest, ServicePublisherIO)
 
   // Try to unpack a header passing a NULL buffer.
   EXPECT_EQ(otherPublisher.Unpack(nullptr), 0u);
+
+  // Unpack the publisher without reading past the end of the buffer.
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes), bytes);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], bytes - 1), 0u);
+  EXPECT_EQ(otherPublisher.Unpack(&buffer[0], 1), 0u);
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ignition/transport/RequestOptions.hh"
+#include "ignition/transport/RequestOptionsPrivate.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const unsigned int RequestOptions::kDefaultTimeout;
+const unsigned int RequestOptions::kDefaultStreamWindow;
+
+//////////////////////////////////////////////////
+RequestOptions::RequestOptions()
+  : dataPtr(new RequestOptionsPrivate())
+{
+}
+
+//////////////////////////////////////////////////
+RequestOptions::RequestOptions(const RequestOptions &_other)
+  : dataPtr(new RequestOptionsPrivate())
+{
+  (*this) = _other;
+}
+
+//////////////////////////////////////////////////
+RequestOptions::~RequestOptions()
+{
+}
+
+//////////////////////////////////////////////////
+RequestOptions &RequestOptions::operator=(const RequestOptions &_other)
+{
+  this->SetTimeout(_other.Timeout());
+  this->SetPolicy(_other.Policy());
+  this->SetHedge(_other.Hedge());
+  this->SetHedgeDelay(_other.HedgeDelay());
+  this->SetStreamWindow(_other.StreamWindow());
+  return *this;
+}
+
+//////////////////////////////////////////////////
+unsigned int RequestOptions::Timeout() const
+{
+  return this->dataPtr->timeout;
+}
+
+//////////////////////////////////////////////////
+void RequestOptions::SetTimeout(const unsigned int _timeout)
+{
+  this->dataPtr->timeout = _timeout;
+}
+
+//////////////////////////////////////////////////
+const ResponderPolicy_t &RequestOptions::Policy() const
+{
+  return this->dataPtr->policy;
+}
+
+//////////////////////////////////////////////////
+void RequestOptions::SetPolicy(const ResponderPolicy_t &_policy)
+{
+  this->dataPtr->policy = _policy;
+}
+
+//////////////////////////////////////////////////
+bool RequestOptions::Hedge() const
+{
+  return this->dataPtr->hedge;
+}
+
+//////////////////////////////////////////////////
+void RequestOptions::SetHedge(const bool _hedge)
+{
+  this->dataPtr->hedge = _hedge;
+}
+
+//////////////////////////////////////////////////
+unsigned int RequestOptions::HedgeDelay() const
+{
+  return this->dataPtr->hedgeDelay;
+}
+
+//////////////////////////////////////////////////
+void RequestOptions::SetHedgeDelay(const unsigned int _delay)
+{
+  this->dataPtr->hedgeDelay = _delay;
+}
+
+//////////////////////////////////////////////////
+unsigned int RequestOptions::StreamWindow() const
+{
+  return this->dataPtr->streamWindow;
+}
+
+//////////////////////////////////////////////////
+void RequestOptions::SetStreamWindow(const unsigned int _window)
+{
+  this->dataPtr->streamWindow = _window > 0 ? _window : 1;
+}
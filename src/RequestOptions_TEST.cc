@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "ignition/transport/RequestOptions.hh"
+#include "ignition/transport/test_config.h"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check the copy constructor.
+TEST(RequestOptionsTest, copyConstructor)
+{
+  transport::RequestOptions opts1;
+  opts1.SetTimeout(500);
+  opts1.SetPolicy(transport::ResponderPolicy_t::ROUND_ROBIN);
+  opts1.SetHedge(true);
+  opts1.SetHedgeDelay(20);
+  opts1.SetStreamWindow(4);
+  transport::RequestOptions opts2(opts1);
+  EXPECT_EQ(opts2.Timeout(), opts1.Timeout());
+  EXPECT_EQ(opts2.Policy(), opts1.Policy());
+  EXPECT_EQ(opts2.Hedge(), opts1.Hedge());
+  EXPECT_EQ(opts2.HedgeDelay(), opts1.HedgeDelay());
+  EXPECT_EQ(opts2.StreamWindow(), opts1.StreamWindow());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the assignment operator.
+TEST(RequestOptionsTest, assignmentOp)
+{
+  transport::RequestOptions opts1;
+  transport::RequestOptions opts2;
+  opts1.SetTimeout(0);
+  opts1.SetPolicy(transport::ResponderPolicy_t::SAME_HOST_FIRST);
+  opts1.SetHedge(true);
+  opts1.SetHedgeDelay(30);
+  opts1.SetStreamWindow(8);
+  opts2 = opts1;
+  EXPECT_EQ(opts2.Timeout(), opts1.Timeout());
+  EXPECT_EQ(opts2.Policy(), opts1.Policy());
+  EXPECT_EQ(opts2.Hedge(), opts1.Hedge());
+  EXPECT_EQ(opts2.HedgeDelay(), opts1.HedgeDelay());
+  EXPECT_EQ(opts2.StreamWindow(), opts1.StreamWindow());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the accessors.
+TEST(RequestOptionsTest, accessors)
+{
+  // Timeout.
+  transport::RequestOptions opts;
+  EXPECT_EQ(opts.Timeout(), transport::RequestOptions::kDefaultTimeout);
+  opts.SetTimeout(1000);
+  EXPECT_EQ(opts.Timeout(), 1000u);
+  opts.SetTimeout(0);
+  EXPECT_EQ(opts.Timeout(), 0u);
+
+  // Policy.
+  EXPECT_EQ(opts.Policy(), transport::ResponderPolicy_t::LEAST_OUTSTANDING);
+  opts.SetPolicy(transport::ResponderPolicy_t::ROUND_ROBIN);
+  EXPECT_EQ(opts.Policy(), transport::ResponderPolicy_t::ROUND_ROBIN);
+  opts.SetPolicy(transport::ResponderPolicy_t::SAME_HOST_FIRST);
+  EXPECT_EQ(opts.Policy(), transport::ResponderPolicy_t::SAME_HOST_FIRST);
+
+  // Hedging.
+  EXPECT_FALSE(opts.Hedge());
+  EXPECT_EQ(opts.HedgeDelay(), 0u);
+  opts.SetHedge(true);
+  EXPECT_TRUE(opts.Hedge());
+  opts.SetHedgeDelay(25);
+  EXPECT_EQ(opts.HedgeDelay(), 25u);
+
+  // Stream window.
+  EXPECT_EQ(opts.StreamWindow(),
+    transport::RequestOptions::kDefaultStreamWindow);
+  opts.SetStreamWindow(2);
+  EXPECT_EQ(opts.StreamWindow(), 2u);
+  opts.SetStreamWindow(0);
+  EXPECT_EQ(opts.StreamWindow(), 1u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
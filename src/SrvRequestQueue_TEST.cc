@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/ReqHandler.hh"
+#include "ignition/transport/SrvRequestQueue.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+// Global variables used for multiple tests.
+std::string topic  = "/foo";
+std::string nUuid1 = "00000000-0000-4000-8000-000000000001";
+std::string nUuid2 = "00000000-0000-4000-8000-000000000002";
+std::string pUuid1 = "00000000-0000-4000-8000-000000000011";
+std::string pUuid2 = "00000000-0000-4000-8000-000000000012";
+std::string reqType = ignition::msgs::Int32().GetTypeName();
+std::string repType = ignition::msgs::Vector3d().GetTypeName();
+
+//////////////////////////////////////////////////
+/// \brief Create a request handler.
+/// \return The new request handler.
+transport::IReqHandlerPtr newRequest()
+{
+  return std::make_shared<transport::ReqHandler<
+    ignition::msgs::Int32, ignition::msgs::Vector3d>>(nUuid1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Create a responder of a service.
+/// \param[in] _topic Service name.
+/// \param[in] _addr Responder's address.
+/// \param[in] _pUuid Process UUID of the responder.
+/// \param[in] _nUuid Node UUID of the responder.
+/// \return The new responder.
+transport::ServicePublisher newResponder(const std::string &_topic,
+  const std::string &_addr, const std::string &_pUuid,
+  const std::string &_nUuid)
+{
+  return transport::ServicePublisher(_topic, _addr,
+    transport::Uuid().ToString(), _pUuid, _nUuid, transport::Scope_t::ALL,
+    reqType, repType);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the requests are taken in arrival order and that the
+/// removed requests are skipped.
+TEST(SrvRequestQueueTest, PushPop)
+{
+  transport::SrvRequestQueue queue;
+  transport::IReqHandlerPtr handler;
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Pop(handler));
+
+  auto req1 = newRequest();
+  auto req2 = newRequest();
+  auto req3 = newRequest();
+  queue.Push(req1);
+  queue.Push(req2);
+  queue.Push(req3);
+  EXPECT_EQ(queue.Size(), 3u);
+
+  // A removed request still waits in the queue, but it isn't counted.
+  queue.Remove(req2);
+  EXPECT_TRUE(req2->Removed());
+  EXPECT_EQ(queue.Size(), 2u);
+
+  // Removing it twice has no effect.
+  queue.Remove(req2);
+  EXPECT_EQ(queue.Size(), 2u);
+
+  ASSERT_TRUE(queue.Pop(handler));
+  EXPECT_EQ(handler, req1);
+  EXPECT_EQ(queue.Size(), 1u);
+
+  // The removed request is skipped.
+  ASSERT_TRUE(queue.Pop(handler));
+  EXPECT_EQ(handler, req3);
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Pop(handler));
+
+  // All the requests removed.
+  queue.Push(req1);
+  queue.Remove(req1);
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Pop(handler));
+  EXPECT_EQ(queue.Size(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the requests that couldn't be sent are queued again
+/// before the newer requests.
+TEST(SrvRequestQueueTest, PushFront)
+{
+  transport::SrvRequestQueue queue;
+  transport::IReqHandlerPtr handler;
+
+  auto req1 = newRequest();
+  auto req2 = newRequest();
+  auto req3 = newRequest();
+  auto req4 = newRequest();
+  queue.Push(req1);
+  queue.Push(req2);
+  queue.Push(req3);
+
+  // req1 and req2 failed, req3 is still waiting and req4 arrives later.
+  ASSERT_TRUE(queue.Pop(handler));
+  ASSERT_TRUE(queue.Pop(handler));
+  queue.Push(req4);
+  queue.PushFront({req1, req2});
+  EXPECT_EQ(queue.Size(), 4u);
+
+  for (const auto &expected : {req1, req2, req3, req4})
+  {
+    ASSERT_TRUE(queue.Pop(handler));
+    EXPECT_EQ(handler, expected);
+  }
+  EXPECT_TRUE(queue.Empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the cache of responders.
+TEST(SrvRequestQueueTest, Responders)
+{
+  transport::SrvRequestQueue queue;
+  EXPECT_TRUE(queue.Idle());
+
+  auto responder1 = newResponder(topic, "tcp://10.0.0.1:6001", pUuid1, nUuid1);
+  auto responder2 = newResponder(topic, "tcp://10.0.0.1:6002", pUuid1, nUuid2);
+  auto responder3 = newResponder(topic, "tcp://10.0.0.2:6001", pUuid2, nUuid1);
+
+  EXPECT_TRUE(queue.AddResponder(responder1));
+  EXPECT_FALSE(queue.AddResponder(responder1));
+  EXPECT_TRUE(queue.AddResponder(responder2));
+  EXPECT_TRUE(queue.AddResponder(responder3));
+  EXPECT_EQ(queue.Responders().size(), 3u);
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.Idle());
+
+  // A node stops offering the service.
+  queue.RemoveResponders(transport::Uuid(pUuid1), topic,
+    transport::Uuid(nUuid2));
+  ASSERT_EQ(queue.Responders().size(), 2u);
+  EXPECT_EQ(queue.Responders().at(0), responder1);
+  EXPECT_EQ(queue.Responders().at(1), responder3);
+
+  // Another service of the same node doesn't affect this cache.
+  queue.RemoveResponders(transport::Uuid(pUuid1), "/bar",
+    transport::Uuid(nUuid1));
+  EXPECT_EQ(queue.Responders().size(), 2u);
+
+  // A whole process is gone.
+  queue.RemoveResponders(transport::Uuid(pUuid2), "", transport::Uuid(""));
+  ASSERT_EQ(queue.Responders().size(), 1u);
+  EXPECT_EQ(queue.Responders().at(0), responder1);
+
+  queue.ClearResponders();
+  EXPECT_TRUE(queue.Responders().empty());
+  EXPECT_TRUE(queue.Idle());
+
+  // A queue with requests waiting isn't idle.
+  queue.Push(newRequest());
+  EXPECT_FALSE(queue.Idle());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that there is a queue for each service and pair of
+/// request/response types.
+TEST(SrvRequestQueueTest, StorageKeys)
+{
+  transport::SrvRequestQueueStorage storage;
+  EXPECT_EQ(storage.Size(), 0u);
+  EXPECT_EQ(storage.Find(topic, reqType, repType), nullptr);
+  EXPECT_FALSE(storage.HasResponders(topic, reqType, repType));
+
+  auto &queue1 = storage.Queue(topic, reqType, repType);
+  auto &queue2 = storage.Queue(topic, repType, reqType);
+  auto &queue3 = storage.Queue("/bar", reqType, repType);
+  EXPECT_NE(&queue1, &queue2);
+  EXPECT_NE(&queue1, &queue3);
+  EXPECT_EQ(&storage.Queue(topic, reqType, repType), &queue1);
+  EXPECT_EQ(storage.Find(topic, reqType, repType), &queue1);
+  EXPECT_EQ(storage.Size(), 3u);
+
+  queue1.Push(newRequest());
+  queue1.Push(newRequest());
+  queue3.Push(newRequest());
+  EXPECT_EQ(storage.Unsent(), 3u);
+
+  queue2.AddResponder(
+    newResponder(topic, "tcp://10.0.0.1:6001", pUuid1, nUuid1));
+  EXPECT_TRUE(storage.HasResponders(topic, repType, reqType));
+  EXPECT_FALSE(storage.HasResponders(topic, reqType, repType));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the queues are forgotten when a removed request leaves
+/// them idle.
+TEST(SrvRequestQueueTest, RemoveRequest)
+{
+  transport::SrvRequestQueueStorage storage;
+  auto req1 = newRequest();
+  auto req2 = newRequest();
+
+  EXPECT_FALSE(storage.RemoveRequest(topic, req1));
+
+  auto &queue = storage.Queue(topic, reqType, repType);
+  queue.Push(req1);
+  queue.Push(req2);
+
+  // Another request is still waiting.
+  EXPECT_TRUE(storage.RemoveRequest(topic, req1));
+  EXPECT_TRUE(req1->Removed());
+  EXPECT_EQ(storage.Size(), 1u);
+  EXPECT_EQ(storage.Unsent(), 1u);
+
+  // The last request removed.
+  EXPECT_TRUE(storage.RemoveRequest(topic, req2));
+  EXPECT_EQ(storage.Size(), 0u);
+  EXPECT_EQ(storage.Unsent(), 0u);
+  EXPECT_EQ(storage.Find(topic, reqType, repType), nullptr);
+
+  // A queue with cached responders is kept.
+  auto req3 = newRequest();
+  auto &queue2 = storage.Queue(topic, reqType, repType);
+  queue2.Push(req3);
+  queue2.AddResponder(
+    newResponder(topic, "tcp://10.0.0.1:6001", pUuid1, nUuid1));
+  EXPECT_TRUE(storage.RemoveRequest(topic, req3));
+  EXPECT_EQ(storage.Size(), 1u);
+  EXPECT_TRUE(storage.HasResponders(topic, reqType, repType));
+  EXPECT_EQ(storage.Unsent(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the queues are forgotten when their responders are gone
+/// and no requests are waiting.
+TEST(SrvRequestQueueTest, RemoveResponders)
+{
+  transport::SrvRequestQueueStorage storage;
+  auto responder1 = newResponder(topic, "tcp://10.0.0.1:6001", pUuid1, nUuid1);
+  auto responder2 = newResponder("/baz", "tcp://10.0.0.2:6001", pUuid2, nUuid2);
+
+  // Only responders.
+  storage.Queue(topic, reqType, repType).AddResponder(responder1);
+
+  // Responders and requests waiting.
+  auto &queue2 = storage.Queue("/bar", reqType, repType);
+  queue2.AddResponder(responder1);
+  queue2.Push(newRequest());
+
+  // Responders of two processes.
+  auto &queue3 = storage.Queue("/baz", reqType, repType);
+  queue3.AddResponder(responder1);
+  queue3.AddResponder(responder2);
+  EXPECT_EQ(storage.Size(), 3u);
+
+  // The responders of the process are removed from all the caches.
+  storage.RemoveResponders(transport::Uuid(pUuid1), "", transport::Uuid(""));
+  EXPECT_EQ(storage.Size(), 2u);
+  EXPECT_EQ(storage.Find(topic, reqType, repType), nullptr);
+
+  auto queue = storage.Find("/bar", reqType, repType);
+  ASSERT_NE(queue, nullptr);
+  EXPECT_TRUE(queue->Responders().empty());
+  EXPECT_EQ(queue->Size(), 1u);
+
+  queue = storage.Find("/baz", reqType, repType);
+  ASSERT_NE(queue, nullptr);
+  ASSERT_EQ(queue->Responders().size(), 1u);
+  EXPECT_EQ(queue->Responders().at(0), responder2);
+
+  // The last responder stops offering the service.
+  storage.RemoveResponders(transport::Uuid(pUuid2), "/baz",
+    transport::Uuid(nUuid2));
+  EXPECT_EQ(storage.Size(), 1u);
+  EXPECT_EQ(storage.Find("/baz", reqType, repType), nullptr);
+  EXPECT_EQ(storage.Unsent(), 1u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ignition/transport/TimerWheel.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check that elements expire after their deadlines.
+TEST(TimerWheelTest, Expiration)
+{
+  transport::TimerWheel<std::string> wheel(10, 8);
+  EXPECT_TRUE(wheel.Empty());
+  EXPECT_EQ(wheel.Resolution(), 10u);
+
+  auto now = std::chrono::steady_clock::now();
+  wheel.Add(now + std::chrono::milliseconds(20), "a");
+  wheel.Add(now + std::chrono::milliseconds(55), "b");
+  wheel.Add(now + std::chrono::milliseconds(55), "c");
+  EXPECT_FALSE(wheel.Empty());
+  EXPECT_EQ(wheel.Size(), 3u);
+
+  // Nothing should expire before the deadlines.
+  std::vector<std::string> expired;
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(15), expired), 0u);
+  EXPECT_TRUE(expired.empty());
+
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(40), expired), 1u);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired.at(0), "a");
+  EXPECT_EQ(wheel.Size(), 2u);
+
+  // Advancing to the same time should not expire anything else.
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(40), expired), 0u);
+
+  expired.clear();
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(100), expired), 2u);
+  ASSERT_EQ(expired.size(), 2u);
+  EXPECT_EQ(expired.at(0), "b");
+  EXPECT_EQ(expired.at(1), "c");
+  EXPECT_TRUE(wheel.Empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check deadlines beyond one revolution of the wheel.
+TEST(TimerWheelTest, MultipleRevolutions)
+{
+  // One revolution covers 40 ms.
+  transport::TimerWheel<int> wheel(10, 4);
+
+  auto now = std::chrono::steady_clock::now();
+  wheel.Add(now + std::chrono::milliseconds(15), 1);
+  wheel.Add(now + std::chrono::milliseconds(95), 2);
+  wheel.Add(now + std::chrono::milliseconds(1000), 3);
+
+  std::vector<int> expired;
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(50), expired), 1u);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired.at(0), 1);
+
+  // Element 2 shares slot with element 1 but belongs to a later revolution.
+  expired.clear();
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(90), expired), 0u);
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(120), expired), 1u);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired.at(0), 2);
+
+  // Jump several revolutions at once.
+  expired.clear();
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(900), expired), 0u);
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(5000), expired), 1u);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired.at(0), 3);
+  EXPECT_TRUE(wheel.Empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Elements added with a deadline in the past expire in the next
+/// advance.
+TEST(TimerWheelTest, PastDeadline)
+{
+  transport::TimerWheel<int> wheel(10, 16);
+
+  auto now = std::chrono::steady_clock::now();
+  std::vector<int> expired;
+  wheel.Advance(now + std::chrono::milliseconds(200), expired);
+  EXPECT_TRUE(expired.empty());
+
+  wheel.Add(now, 1);
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(200), expired), 0u);
+  EXPECT_EQ(wheel.Advance(now + std::chrono::milliseconds(210), expired), 1u);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired.at(0), 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the deadline of the next element to expire.
+TEST(TimerWheelTest, NextDeadline)
+{
+  // One revolution covers 40 ms.
+  transport::TimerWheel<int> wheel(10, 4);
+
+  transport::Timestamp deadline;
+  EXPECT_FALSE(wheel.NextDeadline(deadline));
+
+  auto now = std::chrono::steady_clock::now();
+  auto first = now + std::chrono::milliseconds(25);
+  auto second = now + std::chrono::milliseconds(125);
+  wheel.Add(second, 2);
+  wheel.Add(first, 1);
+
+  // The deadline is rounded up to the resolution of the wheel.
+  ASSERT_TRUE(wheel.NextDeadline(deadline));
+  EXPECT_GT(deadline, first);
+  EXPECT_LE(deadline, first + std::chrono::milliseconds(10));
+
+  // The next element is beyond one revolution.
+  std::vector<int> expired;
+  EXPECT_EQ(wheel.Advance(deadline, expired), 1u);
+  ASSERT_TRUE(wheel.NextDeadline(deadline));
+  EXPECT_GT(deadline, second);
+  EXPECT_LE(deadline, second + std::chrono::milliseconds(10));
+
+  // An earlier element replaces the cached deadline.
+  auto third = now + std::chrono::milliseconds(75);
+  wheel.Add(third, 3);
+  ASSERT_TRUE(wheel.NextDeadline(deadline));
+  EXPECT_GT(deadline, third);
+  EXPECT_LE(deadline, third + std::chrono::milliseconds(10));
+
+  EXPECT_EQ(wheel.Advance(second + std::chrono::milliseconds(10), expired),
+    2u);
+  EXPECT_FALSE(wheel.NextDeadline(deadline));
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include "ignition/transport/TopicStatistics.hh"
+#include "ignition/transport/TopicStatisticsPrivate.hh"
+
+using namespace ignition;
+using namespace transport;
+
+const size_t TopicStatistics::HistogramBuckets;
+
+//////////////////////////////////////////////////
+TopicStatistics::TopicStatistics()
+  : dataPtr(new TopicStatisticsPrivate())
+{
+}
+
+//////////////////////////////////////////////////
+TopicStatistics::TopicStatistics(const TopicStatisticsPrivate &_data)
+  : dataPtr(new TopicStatisticsPrivate(_data))
+{
+}
+
+//////////////////////////////////////////////////
+TopicStatistics::TopicStatistics(const TopicStatistics &_other)
+  : dataPtr(new TopicStatisticsPrivate())
+{
+  (*this) = _other;
+}
+
+//////////////////////////////////////////////////
+TopicStatistics::~TopicStatistics()
+{
+}
+
+//////////////////////////////////////////////////
+TopicStatistics &TopicStatistics::operator=(const TopicStatistics &_other)
+{
+  *this->dataPtr = *_other.dataPtr;
+  return *this;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::SentMessages() const
+{
+  return this->dataPtr->sentMsgs;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::SentBytes() const
+{
+  return this->dataPtr->sentBytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::ReceivedMessages() const
+{
+  return this->dataPtr->recvMsgs;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::ReceivedBytes() const
+{
+  return this->dataPtr->recvBytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::Dropped() const
+{
+  return this->dataPtr->dropped;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::Callbacks() const
+{
+  return this->dataPtr->callbacks;
+}
+
+//////////////////////////////////////////////////
+uint64_t TopicStatistics::Duration() const
+{
+  return this->dataPtr->duration / 1000000;
+}
+
+//////////////////////////////////////////////////
+double TopicStatistics::SentRate() const
+{
+  if (this->dataPtr->duration == 0)
+    return 0;
+
+  return this->dataPtr->sentMsgs * 1e9 / this->dataPtr->duration;
+}
+
+//////////////////////////////////////////////////
+double TopicStatistics::ReceivedRate() const
+{
+  if (this->dataPtr->duration == 0)
+    return 0;
+
+  return this->dataPtr->recvMsgs * 1e9 / this->dataPtr->duration;
+}
+
+//////////////////////////////////////////////////
+double TopicStatistics::MeanLatency() const
+{
+  if (this->dataPtr->callbacks == 0)
+    return 0;
+
+  return this->dataPtr->latencySum / 1e3 / this->dataPtr->callbacks;
+}
+
+//////////////////////////////////////////////////
+double TopicStatistics::MaxLatency() const
+{
+  return this->dataPtr->latencyMax / 1e3;
+}
+
+//////////////////////////////////////////////////
+std::vector<uint64_t> TopicStatistics::CallbackDurations() const
+{
+  return this->dataPtr->histogram;
+}
+
+//////////////////////////////////////////////////
+TopicCounters::TopicCounters()
+  : sentMsgs(0),
+    sentBytes(0),
+    recvMsgs(0),
+    recvBytes(0),
+    dropped(0),
+    callbacks(0),
+    latencySum(0),
+    latencyMax(0),
+    start(Now())
+{
+  for (auto &bucket : this->histogram)
+    bucket = 0;
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddSent(const uint64_t _bytes)
+{
+  this->sentMsgs.fetch_add(1, std::memory_order_relaxed);
+  this->sentBytes.fetch_add(_bytes, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddReceived(const uint64_t _bytes)
+{
+  this->recvMsgs.fetch_add(1, std::memory_order_relaxed);
+  this->recvBytes.fetch_add(_bytes, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddDropped()
+{
+  this->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void TopicCounters::AddCallback(const int64_t _latency,
+  const int64_t _duration)
+{
+  auto latency = static_cast<uint64_t>(std::max<int64_t>(_latency, 0));
+  this->callbacks.fetch_add(1, std::memory_order_relaxed);
+  this->latencySum.fetch_add(latency, std::memory_order_relaxed);
+
+  uint64_t max = this->latencyMax.load(std::memory_order_relaxed);
+  while (latency > max &&
+         !this->latencyMax.compare_exchange_weak(max, latency,
+           std::memory_order_relaxed))
+  {
+  }
+
+  // Power of two buckets in microseconds.
+  size_t bucket = 0;
+  for (int64_t limit = 1000; _duration >= limit &&
+       bucket < TopicStatistics::HistogramBuckets - 1; limit *= 2)
+  {
+    ++bucket;
+  }
+  this->histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+TopicStatistics TopicCounters::Snapshot() const
+{
+  TopicStatisticsPrivate stats;
+  stats.sentMsgs = this->sentMsgs.load(std::memory_order_relaxed);
+  stats.sentBytes = this->sentBytes.load(std::memory_order_relaxed);
+  stats.recvMsgs = this->recvMsgs.load(std::memory_order_relaxed);
+  stats.recvBytes = this->recvBytes.load(std::memory_order_relaxed);
+  stats.dropped = this->dropped.load(std::memory_order_relaxed);
+  stats.callbacks = this->callbacks.load(std::memory_order_relaxed);
+  stats.latencySum = this->latencySum.load(std::memory_order_relaxed);
+  stats.latencyMax = this->latencyMax.load(std::memory_order_relaxed);
+  stats.duration = static_cast<uint64_t>(Now() - this->start);
+  for (size_t i = 0; i < this->histogram.size(); ++i)
+    stats.histogram[i] = this->histogram[i].load(std::memory_order_relaxed);
+
+  return TopicStatistics(stats);
+}
+
+//////////////////////////////////////////////////
+int64_t TopicCounters::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
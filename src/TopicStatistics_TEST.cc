@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ignition/transport/TopicStatistics.hh"
+#include "ignition/transport/TopicStatisticsPrivate.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Check the default values of the statistics.
+TEST(TopicStatisticsTest, Defaults)
+{
+  transport::TopicStatistics stats;
+  EXPECT_EQ(stats.SentMessages(), 0u);
+  EXPECT_EQ(stats.SentBytes(), 0u);
+  EXPECT_EQ(stats.ReceivedMessages(), 0u);
+  EXPECT_EQ(stats.ReceivedBytes(), 0u);
+  EXPECT_EQ(stats.Dropped(), 0u);
+  EXPECT_EQ(stats.Callbacks(), 0u);
+  EXPECT_EQ(stats.Duration(), 0u);
+  EXPECT_DOUBLE_EQ(stats.SentRate(), 0);
+  EXPECT_DOUBLE_EQ(stats.ReceivedRate(), 0);
+  EXPECT_DOUBLE_EQ(stats.MeanLatency(), 0);
+  EXPECT_DOUBLE_EQ(stats.MaxLatency(), 0);
+  EXPECT_EQ(stats.CallbackDurations().size(),
+    transport::TopicStatistics::HistogramBuckets);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the counters are reflected in the snapshots.
+TEST(TopicStatisticsTest, Counters)
+{
+  transport::TopicCounters counters;
+  counters.AddSent(10);
+  counters.AddSent(20);
+  counters.AddReceived(5);
+  counters.AddDropped();
+
+  // Latencies of 1 and 3 us. Durations of 0.5 us, 1.5 us, 3 ms and 1 hour.
+  counters.AddCallback(1000, 500);
+  counters.AddCallback(3000, 1500);
+  counters.AddCallback(1000, 3000000);
+  counters.AddCallback(3000, 3600000000000);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  auto stats = counters.Snapshot();
+  EXPECT_EQ(stats.SentMessages(), 2u);
+  EXPECT_EQ(stats.SentBytes(), 30u);
+  EXPECT_EQ(stats.ReceivedMessages(), 1u);
+  EXPECT_EQ(stats.ReceivedBytes(), 5u);
+  EXPECT_EQ(stats.Dropped(), 1u);
+  EXPECT_EQ(stats.Callbacks(), 4u);
+  EXPECT_GE(stats.Duration(), 20u);
+  EXPECT_GT(stats.SentRate(), 0);
+  EXPECT_GT(stats.SentRate(), stats.ReceivedRate());
+  EXPECT_DOUBLE_EQ(stats.MeanLatency(), 2);
+  EXPECT_DOUBLE_EQ(stats.MaxLatency(), 3);
+
+  auto histogram = stats.CallbackDurations();
+  ASSERT_EQ(histogram.size(), transport::TopicStatistics::HistogramBuckets);
+  EXPECT_EQ(histogram[0], 1u);
+  EXPECT_EQ(histogram[1], 1u);
+  EXPECT_EQ(histogram[12], 1u);
+  EXPECT_EQ(histogram.back(), 1u);
+
+  // The snapshot doesn't change with new activity.
+  counters.AddSent(10);
+  EXPECT_EQ(stats.SentMessages(), 2u);
+  EXPECT_EQ(counters.Snapshot().SentMessages(), 3u);
+
+  // Copies are independent.
+  transport::TopicStatistics copy(stats);
+  EXPECT_EQ(copy.SentBytes(), 30u);
+  EXPECT_EQ(copy.CallbackDurations(), histogram);
+  copy = counters.Snapshot();
+  EXPECT_EQ(copy.SentMessages(), 3u);
+  EXPECT_EQ(stats.SentMessages(), 2u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the counters can be updated from several threads.
+TEST(TopicStatisticsTest, Concurrency)
+{
+  transport::TopicCounters counters;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&counters]
+      {
+        for (auto j = 0; j < 1000; ++j)
+        {
+          counters.AddReceived(2);
+          counters.AddCallback(j, j);
+        }
+      });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  auto stats = counters.Snapshot();
+  EXPECT_EQ(stats.ReceivedMessages(), 4000u);
+  EXPECT_EQ(stats.ReceivedBytes(), 8000u);
+  EXPECT_EQ(stats.Callbacks(), 4000u);
+  EXPECT_DOUBLE_EQ(stats.MaxLatency(), 0.999);
+}
@@ -15,11 +15,16 @@
  *
 */
 
+#include <algorithm>
+#include <cctype>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "ignition/transport/AdvertiseOptions.hh"
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/TopicStorage.hh"
+#include "ignition/transport/Uuid.hh"
 #include "gtest/gtest.h"
 
 using namespace ignition;
@@ -31,18 +36,18 @@ TEST(TopicStorageTest, TopicStorageAPI)
   std::string topic  = "foo";
   std::string topic2 = "foo2";
 
-  std::string nUuid1 = "node-UUID-1";
+  std::string nUuid1 = "00000000-0000-4000-8000-000000000011";
   transport::Scope_t scope1 = transport::Scope_t::ALL;
-  std::string nUuid2  = "node-UUID-2";
+  std::string nUuid2  = "00000000-0000-4000-8000-000000000012";
   transport::Scope_t scope2 = transport::Scope_t::PROCESS;
-  std::string nUuid3  = "node-UUID-3";
+  std::string nUuid3  = "00000000-0000-4000-8000-000000000013";
   transport::Scope_t scope3 = transport::Scope_t::HOST;
-  std::string nUuid4  = "node-UUID-4";
+  std::string nUuid4  = "00000000-0000-4000-8000-000000000014";
   transport::Scope_t scope4 = transport::Scope_t::ALL;
 
-  std::string pUuid1 = "process-UUID-1";
+  std::string pUuid1 = "00000000-0000-4000-8000-000000000001";
   std::string addr1  = "tcp://10.0.0.1:6001";
-  std::string pUuid2  = "process-UUID-2";
+  std::string pUuid2 = "00000000-0000-4000-8000-000000000002";
   std::string addr2  = "tcp://10.0.0.1:6002";
 
   std::map<std::string, std::vector<transport::Publisher>> m;
@@ -368,3 +373,167 @@ TEST(TopicStorageTest, TopicStorageAPI)
   EXPECT_TRUE(test.AddPublisher(publisher8));
   EXPECT_TRUE(test.DelPublishersByProc(pUuid1));
 }
+
+//////////////////////////////////////////////////
+/// \brief Check that the lookups by process and address stay consistent with
+/// the stored publishers.
+TEST(TopicStorageTest, ProcAndAddrLookups)
+{
+  std::string addr1  = "tcp://10.0.0.1:6001";
+  std::string addr2  = "tcp://10.0.0.1:6002";
+  std::string pUuid1 = "00000000-0000-4000-8000-000000000001";
+  std::string pUuid2 = "00000000-0000-4000-8000-000000000002";
+  auto scope = transport::Scope_t::ALL;
+  std::string n1 = "00000000-0000-4000-8000-000000000011";
+  std::string n2 = "00000000-0000-4000-8000-000000000012";
+  std::string n3 = "00000000-0000-4000-8000-000000000013";
+
+  std::map<std::string, std::vector<transport::Publisher>> pubs;
+  transport::TopicStorage<transport::Publisher> test;
+
+  // Two nodes of the same process share an address on two topics.
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid1, n1, scope)));
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid1, n2, scope)));
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t2", addr1, pUuid1, n1, scope)));
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t2", addr2, pUuid2, n3, scope)));
+
+  test.PublishersByProc(pUuid1, pubs);
+  ASSERT_EQ(pubs.size(), 2u);
+  EXPECT_EQ(pubs["t1"].size(), 2u);
+  EXPECT_EQ(pubs["t2"].size(), 1u);
+
+  // The address is in use until its last publisher is removed.
+  EXPECT_TRUE(test.DelPublisherByNode("t1", pUuid1, n1));
+  EXPECT_TRUE(test.HasPublisher(addr1));
+  EXPECT_TRUE(test.DelPublisherByNode("t1", pUuid1, n2));
+  EXPECT_TRUE(test.HasPublisher(addr1));
+  EXPECT_FALSE(test.HasTopic("t1"));
+
+  test.PublishersByProc(pUuid1, pubs);
+  ASSERT_EQ(pubs.size(), 1u);
+  EXPECT_EQ(pubs.begin()->first, "t2");
+
+  // Removing a process keeps the publishers of the other processes.
+  EXPECT_TRUE(test.DelPublishersByProc(pUuid1));
+  EXPECT_FALSE(test.DelPublishersByProc(pUuid1));
+  EXPECT_FALSE(test.HasPublisher(addr1));
+  EXPECT_TRUE(test.HasPublisher(addr2));
+  EXPECT_TRUE(test.HasAnyPublishers("t2", pUuid2));
+  test.PublishersByProc(pUuid1, pubs);
+  EXPECT_TRUE(pubs.empty());
+
+  EXPECT_TRUE(test.DelPublisherByNode("t2", pUuid2, n3));
+  EXPECT_FALSE(test.HasPublisher(addr2));
+  test.PublishersByProc(pUuid2, pubs);
+  EXPECT_TRUE(pubs.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that removing a node releases its own address when the
+/// process has publishers with different addresses on the same topic.
+TEST(TopicStorageTest, DelPublisherByNodeAddresses)
+{
+  std::string addr1  = "tcp://10.0.0.1:6001";
+  std::string addr2  = "tcp://10.0.0.1:6002";
+  std::string pUuid1 = "00000000-0000-4000-8000-000000000001";
+  auto scope = transport::Scope_t::ALL;
+  std::string n1 = "00000000-0000-4000-8000-000000000011";
+  std::string n2 = "00000000-0000-4000-8000-000000000012";
+
+  transport::TopicStorage<transport::Publisher> test;
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid1, n1, scope)));
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr2, pUuid1, n2, scope)));
+
+  EXPECT_TRUE(test.DelPublisherByNode("t1", pUuid1, n1));
+  EXPECT_FALSE(test.HasPublisher(addr1));
+  EXPECT_TRUE(test.HasPublisher(addr2));
+
+  transport::Publisher pub;
+  EXPECT_TRUE(test.Publisher("t1", pUuid1, n2, pub));
+  EXPECT_EQ(pub.Addr(), addr2);
+
+  EXPECT_TRUE(test.DelPublisherByNode("t1", pUuid1, n2));
+  EXPECT_FALSE(test.HasPublisher(addr2));
+  EXPECT_FALSE(test.HasTopic("t1"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the publishers are stored by the value of their process
+/// UUID, so its binary and string forms find the same entries.
+TEST(TopicStorageTest, ProcessUuidKeys)
+{
+  std::string addr1 = "tcp://10.0.0.1:6001";
+  transport::Uuid pUuid;
+  auto scope = transport::Scope_t::ALL;
+  std::string n1 = "00000000-0000-4000-8000-000000000011";
+
+  std::map<std::string, std::vector<transport::Publisher>> pubs;
+  transport::TopicStorage<transport::Publisher> test;
+
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid.ToString(), n1, scope)));
+
+  // The upper case form of the UUID is the same process.
+  std::string upper = pUuid.ToString();
+  std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+  EXPECT_FALSE(test.AddPublisher(
+    transport::Publisher("t1", addr1, upper, n1, scope)));
+
+  EXPECT_TRUE(test.HasAnyPublishers("t1", pUuid));
+  EXPECT_TRUE(test.HasAnyPublishers("t1", upper));
+  EXPECT_FALSE(test.HasAnyPublishers("t1", transport::Uuid()));
+
+  transport::Publisher pub;
+  EXPECT_TRUE(test.Publisher("t1", pUuid, transport::Uuid(n1), pub));
+  EXPECT_EQ(pub.PUuid(), pUuid.ToString());
+
+  test.PublishersByProc(pUuid, pubs);
+  ASSERT_EQ(pubs.size(), 1u);
+  EXPECT_EQ(pubs["t1"].size(), 1u);
+
+  // The map of publishers is keyed by the string form of the process UUID.
+  ASSERT_TRUE(test.Publishers("t1", pubs));
+  ASSERT_EQ(pubs.size(), 1u);
+  EXPECT_EQ(pubs.begin()->first, pUuid.ToString());
+
+  EXPECT_TRUE(test.DelPublisherByNode("t1", upper, n1));
+  EXPECT_FALSE(test.HasTopic("t1"));
+  EXPECT_FALSE(test.DelPublishersByProc(pUuid));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the publishers whose process or node UUID is not the
+/// string representation of a Uuid are rejected.
+TEST(TopicStorageTest, InvalidUuids)
+{
+  std::string addr1 = "tcp://10.0.0.1:6001";
+  std::string pUuid = transport::Uuid().ToString();
+  std::string nUuid = transport::Uuid().ToString();
+  auto scope = transport::Scope_t::ALL;
+
+  transport::TopicStorage<transport::Publisher> test;
+  EXPECT_FALSE(test.AddPublisher(
+    transport::Publisher("t1", addr1, "process-UUID-1", nUuid, scope)));
+  EXPECT_FALSE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid, "node-UUID-1", scope)));
+  EXPECT_FALSE(test.AddPublisher(
+    transport::Publisher("t1", addr1, "", "", scope)));
+  EXPECT_FALSE(test.HasTopic("t1"));
+  EXPECT_FALSE(test.HasPublisher(addr1));
+
+  // The lookups with an invalid UUID don't find anything.
+  EXPECT_TRUE(test.AddPublisher(
+    transport::Publisher("t1", addr1, pUuid, nUuid, scope)));
+  transport::Publisher pub;
+  EXPECT_FALSE(test.Publisher("t1", pUuid, "node-UUID-1", pub));
+  EXPECT_FALSE(test.HasAnyPublishers("t1", "process-UUID-1"));
+  EXPECT_FALSE(test.DelPublisherByNode("t1", "process-UUID-1", nUuid));
+  EXPECT_FALSE(test.DelPublishersByProc("process-UUID-1"));
+  EXPECT_TRUE(test.Publisher("t1", pUuid, nUuid, pub));
+}
@@ -15,76 +15,186 @@
  *
 */
 
+
+#include <cstring>
 #include <string>
-#include <vector>
 
 #include "ignition/transport/Uuid.hh"
 
 using namespace ignition;
 using namespace transport;
 
+const size_t Uuid::ByteLength;
+
+namespace
+{
+  /// \brief Get the value of an hexadecimal digit.
+  /// \param[in] _c Hexadecimal digit.
+  /// \return The value or -1 if _c is not an hexadecimal digit.
+  int hexValue(const char _c)
+  {
+    if (_c >= '0' && _c <= '9')
+      return _c - '0';
+    if (_c >= 'a' && _c <= 'f')
+      return _c - 'a' + 10;
+    if (_c >= 'A' && _c <= 'F')
+      return _c - 'A' + 10;
+    return -1;
+  }
+
+  /// \brief Check if a hyphen precedes a byte in the string representation.
+  /// \param[in] _index Index of the byte.
+  /// \return True if there's a hyphen before the byte.
+  bool hyphenBefore(const size_t _index)
+  {
+    return _index == 4 || _index == 6 || _index == 8 || _index == 10;
+  }
+}
+
 #ifdef _WIN32
 /* Windows implementation using libuuid library */
 //////////////////////////////////////////////////
 Uuid::Uuid()
 {
-  RPC_STATUS Result = ::UuidCreate(&this->data);
+  UUID uuid;
+  RPC_STATUS Result = ::UuidCreate(&uuid);
   if (Result != RPC_S_OK)
   {
     std::cerr << "Call to UuidCreate return a non success RPC call. " <<
                  "Return code: " << Result << std::endl;
   }
+
+  // The first three fields are stored in host byte order.
+  for (size_t i = 0; i < 4; ++i)
+    this->data[i] = static_cast<unsigned char>(uuid.Data1 >> (24 - 8 * i));
+  for (size_t i = 0; i < 2; ++i)
+  {
+    this->data[4 + i] = static_cast<unsigned char>(uuid.Data2 >> (8 - 8 * i));
+    this->data[6 + i] = static_cast<unsigned char>(uuid.Data3 >> (8 - 8 * i));
+  }
+  memcpy(&this->data[8], uuid.Data4, sizeof(uuid.Data4));
 }
+#else
+/* Unix implementation using libuuid library */
+//////////////////////////////////////////////////
+Uuid::Uuid()
+{
+  uuid_generate(this->data);
+}
+#endif
 
 //////////////////////////////////////////////////
-Uuid::~Uuid()
+Uuid::Uuid(const std::string &_str)
 {
-  // No method in windows to release the uuid
+  memset(this->data, 0, ByteLength);
+
+  if (_str.size() != static_cast<size_t>(Uuid::UuidStrLen - 1))
+    return;
+
+  unsigned char bytes[ByteLength];
+  size_t pos = 0;
+  for (size_t i = 0; i < ByteLength; ++i)
+  {
+    if (hyphenBefore(i) && _str[pos++] != '-')
+      return;
+
+    int high = hexValue(_str[pos]);
+    int low = hexValue(_str[pos + 1]);
+    if (high < 0 || low < 0)
+      return;
+
+    bytes[i] = static_cast<unsigned char>((high << 4) | low);
+    pos += 2;
+  }
+
+  memcpy(this->data, bytes, ByteLength);
 }
 
 //////////////////////////////////////////////////
 std::string Uuid::ToString() const
 {
-  std::string uuidStr;
-  char* szUuid = NULL;
-  if (::UuidToStringA(&this->data, reinterpret_cast<RPC_CSTR*>(&szUuid)) ==
-    RPC_S_OK)
+  static const char kHexDigits[] = "0123456789abcdef";
+
+  // Do not include the \0 in the string.
+  std::string uuidStr(Uuid::UuidStrLen - 1, '-');
+
+  size_t pos = 0;
+  for (size_t i = 0; i < ByteLength; ++i)
   {
-        uuidStr = szUuid;
-        ::RpcStringFreeA(reinterpret_cast<RPC_CSTR*>(&szUuid));
+    if (hyphenBefore(i))
+      ++pos;
+
+    uuidStr[pos++] = kHexDigits[this->data[i] >> 4];
+    uuidStr[pos++] = kHexDigits[this->data[i] & 0x0f];
   }
 
   return uuidStr;
 }
-#else
-/* Unix implementation using libuuid library */
 
 //////////////////////////////////////////////////
-Uuid::Uuid()
+bool Uuid::IsNil() const
 {
-  uuid_generate(this->data);
+  for (size_t i = 0; i < ByteLength; ++i)
+  {
+    if (this->data[i] != 0)
+      return false;
+  }
+  return true;
 }
 
 //////////////////////////////////////////////////
-Uuid::~Uuid()
+size_t Uuid::Pack(char *_buffer) const
 {
-  uuid_clear(this->data);
+  if (_buffer == nullptr)
+  {
+    std::cerr << "Uuid::Pack() error: NULL output buffer" << std::endl;
+    return 0;
+  }
+
+  memcpy(_buffer, this->data, ByteLength);
+  return ByteLength;
 }
 
 //////////////////////////////////////////////////
-std::string Uuid::ToString() const
+size_t Uuid::Unpack(const char *_buffer)
 {
-  std::vector<char> uuidStr(Uuid::UuidStrLen);
+  if (_buffer == nullptr)
+  {
+    std::cerr << "Uuid::Unpack() error: NULL input buffer" << std::endl;
+    return 0;
+  }
 
-  snprintf(&uuidStr[0], Uuid::UuidStrLen,
-    "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-    this->data[0], this->data[1], this->data[2], this->data[3],
-    this->data[4], this->data[5], this->data[6], this->data[7],
-    this->data[8], this->data[9], this->data[10], this->data[11],
-    this->data[12], this->data[13], this->data[14], this->data[15]);
+  memcpy(this->data, _buffer, ByteLength);
+  return ByteLength;
+}
 
-  // Do not include the \0 in the string.
-  return std::string(uuidStr.begin(), uuidStr.end() - 1);
+//////////////////////////////////////////////////
+size_t Uuid::Hash() const
+{
+  // FNV-1a over the 16 bytes of the UUID.
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < ByteLength; ++i)
+  {
+    hash ^= this->data[i];
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
 }
 
-#endif
+//////////////////////////////////////////////////
+bool Uuid::operator==(const Uuid &_other) const
+{
+  return memcmp(this->data, _other.data, ByteLength) == 0;
+}
+
+//////////////////////////////////////////////////
+bool Uuid::operator!=(const Uuid &_other) const
+{
+  return !(*this == _other);
+}
+
+//////////////////////////////////////////////////
+bool Uuid::operator<(const Uuid &_other) const
+{
+  return memcmp(this->data, _other.data, ByteLength) < 0;
+}
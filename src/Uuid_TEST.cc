@@ -16,6 +16,7 @@
 */
 
 #include <cctype>
+#include <functional>
 #include <iostream>
 #include <string>
 
@@ -52,6 +53,74 @@ TEST(UuidTest, testToString)
     EXPECT_GT(isxdigit(output.str()[i]), 0);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the conversion from and to the string representation.
+TEST(UuidTest, testFromString)
+{
+  transport::Uuid uuid1;
+  transport::Uuid uuid2(uuid1.ToString());
+  EXPECT_EQ(uuid1, uuid2);
+  EXPECT_EQ(uuid1.ToString(), uuid2.ToString());
+  EXPECT_FALSE(uuid2.IsNil());
+
+  std::string str = "0F1E2D3C-4B5A-6978-8796-A5B4C3D2E1F0";
+  transport::Uuid uuid3(str);
+  EXPECT_FALSE(uuid3.IsNil());
+  EXPECT_EQ(uuid3.ToString(), "0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0");
+
+  // Invalid strings produce the nil UUID.
+  for (const auto &invalid : {std::string(""), std::string("procUUID"),
+       std::string("0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f"),
+       std::string("0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1fg"),
+       std::string("0f1e2d3c04b5a-6978-8796-a5b4c3d2e1f0")})
+  {
+    transport::Uuid uuid(invalid);
+    EXPECT_TRUE(uuid.IsNil());
+    EXPECT_EQ(uuid.ToString(), "00000000-0000-0000-0000-000000000000");
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the comparison operators and the hash.
+TEST(UuidTest, testCompare)
+{
+  transport::Uuid uuid1("00112233-4455-6677-8899-aabbccddeeff");
+  transport::Uuid uuid2("00112233-4455-6677-8899-aabbccddeef0");
+  transport::Uuid uuid3(uuid1.ToString());
+
+  EXPECT_EQ(uuid1, uuid3);
+  EXPECT_NE(uuid1, uuid2);
+  EXPECT_TRUE(uuid2 < uuid1);
+  EXPECT_FALSE(uuid1 < uuid2);
+  EXPECT_FALSE(uuid1 < uuid3);
+
+  EXPECT_EQ(uuid1.Hash(), uuid3.Hash());
+  EXPECT_NE(uuid1.Hash(), uuid2.Hash());
+  EXPECT_EQ(std::hash<transport::Uuid>()(uuid1), uuid1.Hash());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the binary serialization.
+TEST(UuidTest, testPackUnpack)
+{
+  transport::Uuid uuid1;
+  char buffer[transport::Uuid::ByteLength];
+  EXPECT_EQ(uuid1.Pack(buffer), transport::Uuid::ByteLength);
+
+  // The binary form is the network byte order of the string representation.
+  transport::Uuid uuid2("00112233-4455-6677-8899-aabbccddeeff");
+  EXPECT_EQ(uuid2.Pack(buffer), transport::Uuid::ByteLength);
+  for (size_t i = 0; i < transport::Uuid::ByteLength; ++i)
+    EXPECT_EQ(static_cast<unsigned char>(buffer[i]), i * 0x11);
+
+  transport::Uuid uuid3("");
+  EXPECT_EQ(uuid3.Unpack(buffer), transport::Uuid::ByteLength);
+  EXPECT_EQ(uuid2, uuid3);
+
+  EXPECT_EQ(uuid1.Pack(nullptr), 0u);
+  EXPECT_EQ(uuid3.Unpack(nullptr), 0u);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeOptions.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+static std::string g_statsTopic = "/ign/transport/statistics";
+
+static std::mutex reportsMutex;
+static std::vector<std::string> reports;
+
+//////////////////////////////////////////////////
+/// \brief Function called each time a statistics report is received.
+void cbStats(const ignition::msgs::StringMsg &_msg)
+{
+  std::lock_guard<std::mutex> lk(reportsMutex);
+  reports.push_back(_msg.data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Function called each time a topic update is received.
+void cb(const ignition::msgs::Int32 &/*_msg*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a node requesting the statistics makes the process
+/// publish periodically a report with the activity of its topics.
+TEST(StatisticsTopicTest, PeriodicReport)
+{
+  transport::Node subscriber;
+  EXPECT_TRUE(subscriber.Subscribe(g_statsTopic, cbStats));
+  EXPECT_TRUE(subscriber.Subscribe(g_topic, cb));
+
+  transport::NodeOptions opts;
+  EXPECT_TRUE(opts.SetStatisticsInterval(200));
+  transport::Node node(opts);
+  EXPECT_TRUE(node.Advertise<ignition::msgs::Int32>(g_topic));
+
+  ignition::msgs::Int32 msg;
+  msg.set_data(5);
+  for (auto i = 0; i < 20; ++i)
+  {
+    EXPECT_TRUE(node.Publish(g_topic, msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  std::lock_guard<std::mutex> lk(reportsMutex);
+
+  // One report every 200 ms during one second.
+  EXPECT_GE(reports.size(), 3u);
+
+  // Every report starts with the process line.
+  for (auto const &report : reports)
+  {
+    EXPECT_EQ(report.find("process="), 0u);
+    EXPECT_NE(report.find(" reception_busy_pct="), std::string::npos);
+    EXPECT_NE(report.find(" unsent_requests=0"), std::string::npos);
+    EXPECT_EQ(report.find(g_statsTopic + " "), std::string::npos);
+  }
+
+  // The topic is reported while it's active.
+  ASSERT_FALSE(reports.empty());
+  std::string last = reports.back();
+  auto pos = last.find(g_topic + " sent_msgs_s=");
+  ASSERT_NE(pos, std::string::npos);
+  EXPECT_NE(last.find(" recv_msgs_s=", pos), std::string::npos);
+  EXPECT_NE(last.find(" dropped=0", pos), std::string::npos);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
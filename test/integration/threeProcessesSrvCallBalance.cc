@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/RequestOptions.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+
+/// \brief Number of responses received from each replica.
+static std::map<int, int> responses;
+static std::mutex responsesMutex;
+
+//////////////////////////////////////////////////
+/// \brief Service call response callback.
+void response(const ignition::msgs::Int32 &_rep, const bool _result)
+{
+  EXPECT_TRUE(_result);
+
+  std::lock_guard<std::mutex> lk(responsesMutex);
+  ++responses[_rep.data()];
+}
+
+//////////////////////////////////////////////////
+/// \brief Count the number of responses received.
+int totalResponses()
+{
+  std::lock_guard<std::mutex> lk(responsesMutex);
+  int total = 0;
+  for (auto const &r : responses)
+    total += r.second;
+  return total;
+}
+
+//////////////////////////////////////////////////
+/// \brief Launch two replicas of a service and make requests with a given
+/// policy. Check that both replicas receive requests.
+void balanceRequests(const transport::ResponderPolicy_t _policy)
+{
+  std::string responser_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierId_aux");
+
+  testing::forkHandlerType pi1 = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+  testing::forkHandlerType pi2 = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  {
+    std::lock_guard<std::mutex> lk(responsesMutex);
+    responses.clear();
+  }
+
+  transport::Node node;
+
+  // Wait until both replicas are discovered.
+  std::vector<transport::ServicePublisher> publishers;
+  int i = 0;
+  while (i < 300 && publishers.size() < 2u)
+  {
+    node.ServiceInfo(g_topic, publishers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  ASSERT_EQ(publishers.size(), 2u);
+
+  transport::RequestOptions opts;
+  opts.SetPolicy(_policy);
+
+  ignition::msgs::Int32 req;
+  req.set_data(1);
+
+  const int kNumRequests = 10;
+  for (int j = 0; j < kNumRequests; ++j)
+    EXPECT_TRUE(node.Request(g_topic, req, response, opts));
+
+  i = 0;
+  while (i < 300 && totalResponses() < kNumRequests)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  EXPECT_EQ(totalResponses(), kNumRequests);
+
+  // Both replicas should have received requests.
+  {
+    std::lock_guard<std::mutex> lk(responsesMutex);
+    EXPECT_EQ(responses.size(), 2u);
+  }
+
+  // Need to kill the responser nodes running on external processes.
+  testing::killFork(pi1);
+  testing::killFork(pi2);
+}
+
+//////////////////////////////////////////////////
+/// \brief Requests with the round-robin policy.
+TEST(threeProcSrvCallBalance, RoundRobin)
+{
+  balanceRequests(transport::ResponderPolicy_t::ROUND_ROBIN);
+}
+
+//////////////////////////////////////////////////
+/// \brief Requests with the least outstanding requests policy.
+TEST(threeProcSrvCallBalance, LeastOutstanding)
+{
+  balanceRequests(transport::ResponderPolicy_t::LEAST_OUTSTANDING);
+}
+
+//////////////////////////////////////////////////
+/// \brief Requests with the same host first policy. Both replicas run in
+/// this host.
+TEST(threeProcSrvCallBalance, SameHostFirst)
+{
+  balanceRequests(transport::ResponderPolicy_t::SAME_HOST_FIRST);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
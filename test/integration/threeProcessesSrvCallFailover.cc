@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/RequestOptions.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+static int counter = 0;
+static bool lastResult = false;
+static std::mutex counterMutex;
+
+//////////////////////////////////////////////////
+/// \brief Initialize some global variables.
+void reset()
+{
+  std::lock_guard<std::mutex> lk(counterMutex);
+  counter = 0;
+  lastResult = false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Service call response callback.
+void response(const ignition::msgs::Int32 &/*_rep*/, const bool _result)
+{
+  std::lock_guard<std::mutex> lk(counterMutex);
+  lastResult = _result;
+  ++counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the number of responses received.
+int responses()
+{
+  std::lock_guard<std::mutex> lk(counterMutex);
+  return counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait until a number of providers of the service are discovered.
+/// \param[in] _node Node used for the discovery.
+/// \param[in] _numPublishers Expected number of providers.
+/// \return True if all the providers were discovered.
+bool waitForPublishers(transport::Node &_node, const size_t _numPublishers)
+{
+  std::vector<transport::ServicePublisher> publishers;
+  int i = 0;
+  while (i < 300 && publishers.size() < _numPublishers)
+  {
+    _node.ServiceInfo(g_topic, publishers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  return publishers.size() == _numPublishers;
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait for the response of a request.
+/// \return Time elapsed until the response arrived (ms.).
+int64_t waitForResponse()
+{
+  auto t1 = std::chrono::steady_clock::now();
+  int i = 0;
+  while (i < 1000 && responses() == 0)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - t1).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief A request without timeout is sent to a responder that never
+/// answers. When the responder dies, the request should fail as soon as the
+/// discovery detects it, instead of waiting forever.
+TEST(threeProcSrvCallFailover, FailWhenResponderIsGone)
+{
+  std::string hang_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierHang_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(hang_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  transport::Node node;
+  ASSERT_TRUE(waitForPublishers(node, 1u));
+
+  transport::RequestOptions opts;
+  opts.SetTimeout(0);
+
+  ignition::msgs::Int32 req;
+  req.set_data(1);
+  EXPECT_TRUE(node.Request(g_topic, req, response, opts));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(responses(), 0);
+
+  testing::killFork(pi);
+
+  // The connection with the responder is closed when it dies, so there's
+  // no need to wait for the silence interval of the discovery.
+  auto elapsed = waitForResponse();
+  EXPECT_EQ(responses(), 1);
+  EXPECT_FALSE(lastResult);
+#if ZMQ_VERSION >= ZMQ_MAKE_VERSION(4, 0, 0)
+  EXPECT_LT(elapsed, 1000);
+#else
+  EXPECT_LT(elapsed, 6000);
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief A request is sent to a responder that never answers. When the
+/// responder dies, the request should be re-routed to another responder.
+TEST(threeProcSrvCallFailover, RerouteWhenResponderIsGone)
+{
+  std::string hang_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierHang_aux");
+  std::string replier_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierId_aux");
+
+  testing::forkHandlerType pi1 = testing::forkAndRun(hang_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  transport::Node node;
+  ASSERT_TRUE(waitForPublishers(node, 1u));
+
+  auto shared = transport::NodeShared::Instance();
+  auto reroutedBefore = shared->ReroutedRequests();
+
+  // The only responder available never answers.
+  ignition::msgs::Int32 req;
+  req.set_data(1);
+  EXPECT_TRUE(node.Request(g_topic, req, response));
+
+  // Launch a second responder.
+  testing::forkHandlerType pi2 = testing::forkAndRun(replier_path.c_str(),
+    partition.c_str());
+  ASSERT_TRUE(waitForPublishers(node, 2u));
+
+  testing::killFork(pi1);
+
+  // The request should be answered by the second responder.
+  auto elapsed = waitForResponse();
+  EXPECT_EQ(responses(), 1);
+  EXPECT_TRUE(lastResult);
+  EXPECT_LT(elapsed, 6000);
+  EXPECT_EQ(shared->ReroutedRequests(), reroutedBefore + 1);
+
+  testing::killFork(pi2);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/RequestOptions.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+static int counter = 0;
+static std::mutex counterMutex;
+
+//////////////////////////////////////////////////
+/// \brief Service call response callback.
+void response(const ignition::msgs::Int32 &/*_rep*/, const bool _result)
+{
+  EXPECT_TRUE(_result);
+
+  std::lock_guard<std::mutex> lk(counterMutex);
+  ++counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the number of responses received.
+int responses()
+{
+  std::lock_guard<std::mutex> lk(counterMutex);
+  return counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait until a number of providers of the service are discovered.
+/// \param[in] _node Node used for the discovery.
+/// \param[in] _numPublishers Expected number of providers.
+/// \return True if all the providers were discovered.
+bool waitForPublishers(transport::Node &_node, const size_t _numPublishers)
+{
+  std::vector<transport::ServicePublisher> publishers;
+  int i = 0;
+  while (i < 300 && publishers.size() < _numPublishers)
+  {
+    _node.ServiceInfo(g_topic, publishers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  return publishers.size() == _numPublishers;
+}
+
+//////////////////////////////////////////////////
+/// \brief Launch a slow and a fast replica of a service and make hedged
+/// requests. All the requests should be answered by the fast replica and the
+/// late responses of the slow replica should be discarded.
+TEST(threeProcSrvCallHedge, SlowReplica)
+{
+  std::string slow_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierSlow_aux");
+  std::string fast_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_threeProcessesSrvCallReplierId_aux");
+
+  testing::forkHandlerType pi1 = testing::forkAndRun(slow_path.c_str(),
+    partition.c_str());
+  testing::forkHandlerType pi2 = testing::forkAndRun(fast_path.c_str(),
+    partition.c_str());
+
+  transport::Node node;
+  ASSERT_TRUE(waitForPublishers(node, 2u));
+
+  auto shared = transport::NodeShared::Instance();
+  auto hedgedBefore = shared->HedgedRequests();
+
+  transport::RequestOptions opts;
+  opts.SetPolicy(transport::ResponderPolicy_t::ROUND_ROBIN);
+  opts.SetHedge(true);
+  opts.SetHedgeDelay(100);
+
+  ignition::msgs::Int32 req;
+  req.set_data(1);
+
+  // With round-robin, half of the requests go to the slow replica.
+  const int kNumRequests = 4;
+  for (int j = 0; j < kNumRequests; ++j)
+    EXPECT_TRUE(node.Request(g_topic, req, response, opts));
+
+  int i = 0;
+  while (i < 100 && responses() < kNumRequests)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  // All the responses should arrive before the slow replica answers.
+  EXPECT_EQ(responses(), kNumRequests);
+  EXPECT_GE(shared->HedgedRequests(), hedgedBefore + kNumRequests / 2);
+
+  // The late responses from the slow replica should be discarded.
+  std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+  EXPECT_EQ(responses(), kNumRequests);
+
+  // Need to kill the responser nodes running on external processes.
+  testing::killFork(pi1);
+  testing::killFork(pi2);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static bool responseExecuted;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+static int counter = 0;
+
+//////////////////////////////////////////////////
+/// \brief Initialize some global variables.
+void reset()
+{
+  responseExecuted = false;
+  counter = 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Two different nodes running in two different processes. One node
+/// advertises a service and the other requests a batch of service calls.
+TEST(twoProcSrvCallBatch, SrvTwoProcs)
+{
+  std::string responser_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_twoProcessesSrvCallReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  std::vector<ignition::msgs::Int32> reqs(10);
+  for (size_t i = 0; i < reqs.size(); ++i)
+    reqs[i].set_data(static_cast<int>(i));
+
+  std::function<void(const std::vector<ignition::msgs::Int32> &,
+    const std::vector<bool> &)> cb =
+    [&reqs](const std::vector<ignition::msgs::Int32> &_reps,
+            const std::vector<bool> &_results)
+  {
+    EXPECT_EQ(_reps.size(), reqs.size());
+    EXPECT_EQ(_results.size(), reqs.size());
+    for (size_t i = 0; i < _reps.size() && i < _results.size(); ++i)
+    {
+      EXPECT_EQ(_reps[i].data(), static_cast<int>(i));
+      EXPECT_TRUE(_results[i]);
+    }
+    responseExecuted = true;
+    ++counter;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, cb));
+
+  int i = 0;
+  while (i < 300 && !responseExecuted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  // All the responses arrive together.
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_EQ(counter, 1);
+
+  // Synchronous version.
+  std::vector<ignition::msgs::Int32> reps;
+  std::vector<bool> results;
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, 1000, reps, results));
+  ASSERT_EQ(reps.size(), reqs.size());
+  ASSERT_EQ(results.size(), reqs.size());
+  for (size_t j = 0; j < reps.size(); ++j)
+  {
+    EXPECT_EQ(reps[j].data(), static_cast<int>(j));
+    EXPECT_TRUE(results[j]);
+  }
+
+  reset();
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  // Enable verbose mode.
+  // setenv("IGN_VERBOSE", "1", 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static bool responseExecuted;
+
+static std::string partition;
+static std::string g_topic = "/foo";
+static std::string g_slowTopic = "/slow";
+static std::vector<int> received;
+static std::vector<std::chrono::steady_clock::time_point> receivedTimes;
+static bool allResults;
+
+//////////////////////////////////////////////////
+/// \brief Initialize some global variables.
+void reset()
+{
+  responseExecuted = false;
+  received.clear();
+  receivedTimes.clear();
+  allResults = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Callback executed for each message of the response.
+void response(const ignition::msgs::Int32 &_rep, const bool _result,
+  const bool _last)
+{
+  EXPECT_FALSE(responseExecuted);
+  allResults = allResults && _result;
+  received.push_back(_rep.data());
+  if (_last)
+    responseExecuted = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Callback executed for each message of a streaming response. The
+/// final call only notifies the end of the stream.
+void chunkResponse(const ignition::msgs::Int32 &_rep, const bool _result,
+  const bool _last)
+{
+  EXPECT_FALSE(responseExecuted);
+  allResults = allResults && _result;
+  if (_last)
+  {
+    responseExecuted = true;
+    return;
+  }
+
+  received.push_back(_rep.data());
+  receivedTimes.push_back(std::chrono::steady_clock::now());
+}
+
+//////////////////////////////////////////////////
+/// \brief Two different nodes running in two different processes. One node
+/// advertises a streaming service and the other requests a long stream with
+/// a small flow control window.
+TEST(twoProcSrvCallStream, SrvTwoProcs)
+{
+  std::string responser_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_twoProcessesSrvCallStreamReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  const int numMsgs = 100;
+  ignition::msgs::Int32 req;
+  req.set_data(numMsgs);
+
+  transport::RequestOptions opts;
+  opts.SetStreamWindow(4);
+
+  std::function<void(const ignition::msgs::Int32 &, const bool, const bool)>
+    cb = chunkResponse;
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestStream(g_topic, req, cb, opts));
+
+  int i = 0;
+  while (i < 300 && !responseExecuted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  // All the messages arrive in order and the end of the stream is notified.
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_TRUE(allResults);
+  ASSERT_EQ(received.size(), static_cast<size_t>(numMsgs));
+  for (int j = 0; j < numMsgs; ++j)
+    EXPECT_EQ(received[j], j);
+
+  reset();
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief Each message of a stream is delivered as soon as the responser
+/// writes it, without waiting for the next one.
+TEST(twoProcSrvCallStream, SrvSlowProducer)
+{
+  std::string responser_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_twoProcessesSrvCallStreamReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  // The responser writes a message every second.
+  ignition::msgs::Int32 req;
+  req.set_data(2);
+
+  std::function<void(const ignition::msgs::Int32 &, const bool, const bool)>
+    cb = chunkResponse;
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestStream(g_slowTopic, req, cb));
+
+  int i = 0;
+  while (i < 500 && !responseExecuted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_TRUE(allResults);
+  ASSERT_EQ(received.size(), 2u);
+  EXPECT_EQ(received[0], 0);
+  EXPECT_EQ(received[1], 1);
+
+  // The first message arrived before the second one was written.
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+    receivedTimes[1] - receivedTimes[0]).count();
+  EXPECT_GE(elapsed, 500);
+
+  reset();
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief A streaming request to a regular service receives its only
+/// response as the last message of the stream.
+TEST(twoProcSrvCallStream, SrvRegularReplier)
+{
+  std::string responser_path = testing::portablePathUnion(
+    PROJECT_BINARY_PATH,
+    "test/integration/INTEGRATION_twoProcessesSrvCallReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  reset();
+
+  ignition::msgs::Int32 req;
+  req.set_data(5);
+
+  std::function<void(const ignition::msgs::Int32 &, const bool, const bool)>
+    cb = response;
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestStream(g_topic, req, cb));
+
+  int i = 0;
+  while (i < 300 && !responseExecuted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+
+  EXPECT_TRUE(responseExecuted);
+  EXPECT_TRUE(allResults);
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0], 5);
+
+  reset();
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  // Enable verbose mode.
+  // setenv("IGN_VERBOSE", "1", 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string g_topic = "/foo";
+static std::string g_slowTopic = "/slow";
+
+//////////////////////////////////////////////////
+/// \brief Provide a streaming service. It sends as many messages as
+/// requested.
+void srvStream(const ignition::msgs::Int32 &_req,
+  transport::StreamWriter<ignition::msgs::Int32> &_writer, bool &_result)
+{
+  for (int i = 0; i < _req.data(); ++i)
+  {
+    ignition::msgs::Int32 rep;
+    rep.set_data(i);
+    if (!_writer.Write(rep))
+      return;
+  }
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Provide a slow streaming service. It sends as many messages as
+/// requested, one every second.
+void srvSlowStream(const ignition::msgs::Int32 &_req,
+  transport::StreamWriter<ignition::msgs::Int32> &_writer, bool &_result)
+{
+  for (int i = 0; i < _req.data(); ++i)
+  {
+    if (i > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ignition::msgs::Int32 rep;
+    rep.set_data(i);
+    if (!_writer.Write(rep))
+      return;
+  }
+  _result = true;
+}
+
+//////////////////////////////////////////////////
+void runReplier()
+{
+  std::function<void(const ignition::msgs::Int32 &,
+    transport::StreamWriter<ignition::msgs::Int32> &, bool &)> cb = srvStream;
+
+  transport::Node node;
+  EXPECT_TRUE((node.AdvertiseStream<ignition::msgs::Int32,
+    ignition::msgs::Int32>(g_topic, cb)));
+
+  std::function<void(const ignition::msgs::Int32 &,
+    transport::StreamWriter<ignition::msgs::Int32> &, bool &)> slowCb =
+      srvSlowStream;
+  EXPECT_TRUE((node.AdvertiseStream<ignition::msgs::Int32,
+    ignition::msgs::Int32>(g_slowTopic, slowCb)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(6000));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  runReplier();
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_TEST_BENCHMARK_UTILS_HH_
+#define IGNITION_TRANSPORT_TEST_BENCHMARK_UTILS_HH_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ignition/transport/Helpers.hh"
+
+/// \brief Helpers shared by the performance benchmarks.
+namespace bench
+{
+  /// \brief Current time of the steady clock in nanoseconds. On the same
+  /// host, this clock is shared by every process, so it can be used for
+  /// measuring latencies between processes.
+  /// \return The time.
+  inline int64_t nowNs()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /// \brief Read a positive integer from an environment variable.
+  /// \param[in] _name Name of the variable.
+  /// \param[in] _default Value used when the variable is not set or invalid.
+  /// \return The value.
+  inline int envInt(const std::string &_name, const int _default)
+  {
+    std::string value;
+    if (!ignition::transport::env(_name, value) || value.empty() ||
+        value.size() > 9 ||
+        value.find_first_not_of("0123456789") != std::string::npos)
+    {
+      return _default;
+    }
+
+    return std::max(1, std::stoi(value));
+  }
+
+  /// \brief Read a comma separated list of positive integers from an
+  /// environment variable, e.g. "16,1024,65536".
+  /// \param[in] _name Name of the variable.
+  /// \param[in] _default Value used when the variable is not set or invalid.
+  /// \return The list of values.
+  inline std::vector<int> envIntList(const std::string &_name,
+    const std::vector<int> &_default)
+  {
+    std::string value;
+    if (!ignition::transport::env(_name, value) || value.empty() ||
+        value.find_first_not_of("0123456789,") != std::string::npos)
+    {
+      return _default;
+    }
+
+    std::vector<int> result;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+      if (!item.empty() && item.size() <= 9)
+        result.push_back(std::max(1, std::stoi(item)));
+    }
+
+    return result.empty() ? _default : result;
+  }
+
+  /// \brief Get a percentile of a set of samples (nearest rank).
+  /// \param[in] _sorted Samples sorted in ascending order.
+  /// \param[in] _p Percentile [0, 100].
+  /// \return The percentile or 0 if there are no samples.
+  inline double percentile(const std::vector<double> &_sorted,
+    const double _p)
+  {
+    if (_sorted.empty())
+      return 0;
+
+    auto rank = static_cast<size_t>(_p / 100.0 * _sorted.size() + 0.5);
+    rank = std::min(std::max(rank, static_cast<size_t>(1)), _sorted.size());
+    return _sorted[rank - 1];
+  }
+
+  /// \brief Build a latency histogram with power of two buckets. Bucket 0
+  /// counts the samples below 1 and bucket i > 0 counts the samples in
+  /// [2^(i-1), 2^i).
+  /// \param[in] _samples Samples.
+  /// \return Number of samples in each bucket, up to the last non-empty one.
+  inline std::vector<uint64_t> histogram(const std::vector<double> &_samples)
+  {
+    std::vector<uint64_t> buckets;
+    for (auto sample : _samples)
+    {
+      size_t bucket = 0;
+      for (double limit = 1; sample >= limit && bucket < 63; limit *= 2)
+        ++bucket;
+
+      if (buckets.size() <= bucket)
+        buckets.resize(bucket + 1, 0);
+      ++buckets[bucket];
+    }
+
+    return buckets;
+  }
+
+  /// \brief Format a histogram built by histogram(), skipping the empty
+  /// buckets, e.g. "<1:3 <2:120 <4:17".
+  /// \param[in] _buckets Histogram.
+  /// \return The histogram as text.
+  inline std::string histogramText(const std::vector<uint64_t> &_buckets)
+  {
+    std::ostringstream stream;
+    for (size_t i = 0; i < _buckets.size(); ++i)
+    {
+      if (_buckets[i] == 0)
+        continue;
+
+      if (stream.tellp() > 0)
+        stream << " ";
+      stream << "<" << (uint64_t(1) << i) << ":" << _buckets[i];
+    }
+
+    return stream.str();
+  }
+
+  /// \brief One result of a benchmark, stored as a JSON object. Records are
+  /// appended, one per line, to the file set in IGN_BENCH_OUTPUT, so results
+  /// can be compared between releases.
+  class Record
+  {
+    /// \brief Constructor.
+    /// \param[in] _benchmark Name of the benchmark.
+    public: explicit Record(const std::string &_benchmark)
+    {
+      this->Add("benchmark", _benchmark);
+    }
+
+    /// \brief Add a text field.
+    /// \param[in] _key Name of the field.
+    /// \param[in] _value Value of the field.
+    public: void Add(const std::string &_key, const std::string &_value)
+    {
+      this->Key(_key);
+      this->stream << "\"" << _value << "\"";
+    }
+
+    /// \brief Add a numeric field.
+    /// \param[in] _key Name of the field.
+    /// \param[in] _value Value of the field.
+    public: void Add(const std::string &_key, const double _value)
+    {
+      this->Key(_key);
+      this->stream << std::setprecision(12) << _value;
+    }
+
+    /// \brief Add a list of numbers.
+    /// \param[in] _key Name of the field.
+    /// \param[in] _values Values of the field.
+    public: void Add(const std::string &_key,
+      const std::vector<uint64_t> &_values)
+    {
+      this->Key(_key);
+      this->stream << "[";
+      for (size_t i = 0; i < _values.size(); ++i)
+        this->stream << (i > 0 ? "," : "") << _values[i];
+      this->stream << "]";
+    }
+
+    /// \brief Get the record as a JSON object.
+    /// \return The JSON object.
+    public: std::string Json() const
+    {
+      return "{" + this->stream.str() + "}";
+    }
+
+    /// \brief Append the record to the file set in IGN_BENCH_OUTPUT.
+    /// \return False if the variable is set but the file can't be written.
+    public: bool Save() const
+    {
+      std::string path;
+      if (!ignition::transport::env("IGN_BENCH_OUTPUT", path) || path.empty())
+        return true;
+
+      std::ofstream file(path, std::ios::app);
+      file << this->Json() << std::endl;
+      return file.good();
+    }
+
+    /// \brief Start a new field.
+    /// \param[in] _key Name of the field.
+    private: void Key(const std::string &_key)
+    {
+      if (this->stream.tellp() > 0)
+        this->stream << ",";
+      this->stream << "\"" << _key << "\":";
+    }
+
+    /// \brief Fields of the record.
+    private: std::ostringstream stream;
+  };
+}
+
+#endif
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "discoveryScalability.hh"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Length of the steady state measurement in heartbeats.
+static const int kSteadyHeartbeats = 5;
+
+/// \brief Maximum time waiting for the convergence or the disconnection
+/// (ms.).
+static const int kMaxWait = 60000;
+
+static std::string partition;
+
+//////////////////////////////////////////////////
+/// \brief Count the topics of this run starting with a prefix.
+/// \param[in] _discovery Discovery node.
+/// \param[in] _prefix Prefix of the topics, after the partition.
+/// \return Number of topics.
+size_t countTopics(const MsgDiscovery &_discovery, const std::string &_prefix)
+{
+  std::string prefix = "/" + partition + "/" + _prefix;
+  std::vector<std::string> topics;
+  _discovery.TopicList(topics);
+  return static_cast<size_t>(std::count_if(topics.begin(), topics.end(),
+    [&prefix](const std::string &_topic)
+    {
+      return _topic.compare(0, prefix.size(), prefix) == 0;
+    }));
+}
+
+//////////////////////////////////////////////////
+/// \brief Wait until the number of topics starting with a prefix reaches a
+/// value.
+/// \param[in] _discovery Discovery node.
+/// \param[in] _prefix Prefix of the topics, after the partition.
+/// \param[in] _expected Number of topics expected.
+/// \return Time elapsed (ms.) or -1 if the wait timed out.
+int64_t waitForTopics(const MsgDiscovery &_discovery,
+  const std::string &_prefix, const size_t _expected)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(kMaxWait);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    if (countTopics(_discovery, _prefix) == _expected)
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  return -1;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the CPU time consumed by a process.
+/// \param[in] _pid Process. 0 for this process.
+/// \return The CPU time (user + system) in seconds or -1 if it's not
+/// available.
+double cpuTime(const testing::forkHandlerType _pid)
+{
+#ifdef __linux__
+  if (_pid == 0)
+  {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return -1;
+
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  }
+
+  // Fields 14 and 15 of /proc/<pid>/stat are the user and system times in
+  // clock ticks. The name of the executable (field 2) may contain spaces,
+  // so the fields are counted after its closing parenthesis.
+  std::ifstream file("/proc/" + std::to_string(_pid) + "/stat");
+  std::string stat((std::istreambuf_iterator<char>(file)),
+    std::istreambuf_iterator<char>());
+  auto pos = stat.rfind(')');
+  if (pos == std::string::npos)
+    return -1;
+
+  std::istringstream fields(stat.substr(pos + 2));
+  std::string field;
+  double ticks = 0;
+  for (int i = 3; i <= 15 && fields >> field; ++i)
+  {
+    if (i >= 14)
+      ticks += std::stod(field);
+  }
+
+  return ticks / sysconf(_SC_CLK_TCK);
+#else
+  static_cast<void>(_pid);
+  return -1;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Simulate N processes advertising M topics each, hosted by forked
+/// processes. This process observes the discovery traffic and reports:
+/// - The time until it knows every topic.
+/// - The discovery traffic in steady state (packets and bytes per second).
+/// - The CPU used by each simulated process in steady state.
+/// - The time needed to detect that a group of processes crashed.
+/// The size of the run is controlled by IGN_BENCH_PROCS and
+/// IGN_BENCH_TOPICS.
+TEST(discoveryScalability, ManyProcesses)
+{
+  std::string auxPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/performance/PERFORMANCE_discoveryScalability_aux");
+
+  int numProcs = bench::envInt("IGN_BENCH_PROCS", bench::kDefNumProcs);
+  int numTopics = bench::envInt("IGN_BENCH_TOPICS", bench::kDefNumTopics);
+  int numForks = (numProcs + bench::kProcsPerFork - 1) / bench::kProcsPerFork;
+
+  MsgDiscovery discovery(Uuid().ToString(), bench::kScalabilityPort);
+  discovery.Start();
+
+  // Each forked process hosts a group of simulated processes. Its topics
+  // are named "/<partition>/<group>/<process>/<topic>".
+  std::vector<testing::forkHandlerType> children;
+  for (auto i = 0; i < numForks; ++i)
+  {
+    std::string group = partition + "/" + std::to_string(i);
+    children.push_back(testing::forkAndRun(auxPath.c_str(), group.c_str()));
+  }
+
+  // Time to convergence.
+  size_t expected = static_cast<size_t>(numProcs * numTopics);
+  int64_t convergence = waitForTopics(discovery, "", expected);
+
+  // Steady state.
+  std::vector<double> cpuBefore;
+  for (const auto &child : children)
+    cpuBefore.push_back(cpuTime(child));
+  double ownCpuBefore = cpuTime(0);
+  auto packetsBefore = discovery.ReceivedDatagrams();
+  auto bytesBefore = discovery.ReceivedBytes();
+  auto steadyStart = std::chrono::steady_clock::now();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery.HeartbeatInterval() * kSteadyHeartbeats));
+
+  std::chrono::duration<double> steady =
+    std::chrono::steady_clock::now() - steadyStart;
+  double packetsPerSec =
+    (discovery.ReceivedDatagrams() - packetsBefore) / steady.count();
+  double bytesPerSec =
+    (discovery.ReceivedBytes() - bytesBefore) / steady.count();
+
+  double childrenCpu = 0;
+  bool cpuAvailable = true;
+  for (size_t i = 0; i < children.size(); ++i)
+  {
+    double after = cpuTime(children[i]);
+    if (after < 0 || cpuBefore[i] < 0)
+      cpuAvailable = false;
+    childrenCpu += after - cpuBefore[i];
+  }
+  double ownCpu = cpuTime(0) - ownCpuBefore;
+
+  // Disconnection of a group of processes that crashed: it didn't send any
+  // BYE message.
+  testing::killFork(children.front());
+  testing::waitAndCleanupFork(children.front());
+  int64_t disconnection = waitForTopics(discovery, "0/", 0);
+
+  std::cout << "Processes: " << numProcs << " (" << numForks
+            << " forked processes)" << std::endl
+            << "Topics per process: " << numTopics << std::endl
+            << "Time to convergence: " << convergence << " ms" << std::endl
+            << "Steady state traffic: " << packetsPerSec << " packets/s, "
+            << bytesPerSec << " bytes/s" << std::endl;
+
+  if (cpuAvailable)
+  {
+    std::cout << "Steady state CPU per process: "
+              << 100.0 * childrenCpu / numProcs / steady.count() << " %"
+              << std::endl
+              << "Steady state CPU of the observer: "
+              << 100.0 * ownCpu / steady.count() << " %" << std::endl;
+  }
+
+  std::cout << "Disconnection detected in: " << disconnection << " ms"
+            << " (silence interval: " << discovery.SilenceInterval()
+            << " ms)" << std::endl;
+
+  EXPECT_GE(convergence, 0);
+  EXPECT_GE(disconnection, 0);
+
+  for (size_t i = 1; i < children.size(); ++i)
+  {
+    testing::killFork(children[i]);
+    testing::waitAndCleanupFork(children[i]);
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random prefix for the topics of this run.
+  partition = testing::getRandomNumber();
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_TEST_DISCOVERY_SCALABILITY_HH_
+#define IGNITION_TRANSPORT_TEST_DISCOVERY_SCALABILITY_HH_
+
+#include "benchmarkUtils.hh"
+
+/// \brief Settings shared by the discovery scalability benchmark and the
+/// processes that host its simulated processes.
+namespace bench
+{
+  /// \brief Discovery port used by the benchmark.
+  static const int kScalabilityPort = 11351;
+
+  /// \brief Default number of simulated processes (IGN_BENCH_PROCS).
+  static const int kDefNumProcs = 100;
+
+  /// \brief Default number of topics advertised by each simulated process
+  /// (IGN_BENCH_TOPICS).
+  static const int kDefNumTopics = 10;
+
+  /// \brief Number of simulated processes hosted by each forked process.
+  static const int kProcsPerFork = 25;
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "discoveryScalability.hh"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Time alive if nobody kills this process (ms.).
+static const int kMaxLife = 300000;
+
+//////////////////////////////////////////////////
+/// \brief Host a group of simulated processes. Each one has its own
+/// discovery engine and advertises its topics.
+/// Usage: discoveryScalability_aux <partition>/<group>
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  std::string group = argv[1];
+  auto pos = group.rfind('/');
+  if (pos == std::string::npos)
+  {
+    std::cerr << "Invalid group [" << group << "]" << std::endl;
+    return -1;
+  }
+
+  int index = std::stoi(group.substr(pos + 1));
+  int numProcs = bench::envInt("IGN_BENCH_PROCS", bench::kDefNumProcs);
+  int numTopics = bench::envInt("IGN_BENCH_TOPICS", bench::kDefNumTopics);
+  int numLocal = std::min(bench::kProcsPerFork,
+    numProcs - index * bench::kProcsPerFork);
+
+  std::vector<std::unique_ptr<MsgDiscovery>> discoveries;
+  for (auto i = 0; i < numLocal; ++i)
+  {
+    std::string pUuid = Uuid().ToString();
+    std::string nUuid = Uuid().ToString();
+    std::unique_ptr<MsgDiscovery> discovery(
+      new MsgDiscovery(pUuid, bench::kScalabilityPort));
+    discovery->Start();
+
+    for (auto j = 0; j < numTopics; ++j)
+    {
+      MessagePublisher publisher("/" + group + "/" + pUuid + "/" +
+        std::to_string(j), "tcp://127.0.0.1:60000", "tcp://127.0.0.1:60001",
+        pUuid, nUuid, Scope_t::ALL, "t");
+      discovery->Advertise(publisher);
+    }
+
+    discoveries.push_back(std::move(discovery));
+  }
+
+  // Stay alive until the benchmark kills this process.
+  std::this_thread::sleep_for(std::chrono::milliseconds(kMaxLife));
+}
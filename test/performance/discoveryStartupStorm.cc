@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Discovery port used by the benchmark. It must match the port used
+/// in discoveryStartupStorm_aux.cc.
+static const int kPort = 11350;
+
+/// \brief Number of processes launched at the same time.
+static const int kNumProcs = 30;
+
+/// \brief Number of topics advertised by each process.
+static const int kNumTopics = 20;
+
+/// \brief Maximum time waiting for the convergence (ms.).
+static const int kMaxWait = 30000;
+
+static std::string partition;
+
+//////////////////////////////////////////////////
+/// \brief Count the topics of this run known by a discovery node.
+/// \param[in] _discovery Discovery node.
+/// \return Number of topics.
+size_t countTopics(const MsgDiscovery &_discovery)
+{
+  std::string prefix = "/" + partition + "/";
+  std::vector<std::string> topics;
+  _discovery.TopicList(topics);
+  return static_cast<size_t>(std::count_if(topics.begin(), topics.end(),
+    [&prefix](const std::string &_topic)
+    {
+      return _topic.compare(0, prefix.size(), prefix) == 0;
+    }));
+}
+
+//////////////////////////////////////////////////
+/// \brief Launch many processes at the same time. All of them ask for the
+/// same topics and advertise their own. Report how long it takes until this
+/// process knows every topic and how many datagrams were needed.
+TEST(discoveryStartupStorm, ManyProcesses)
+{
+  std::string auxPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/performance/PERFORMANCE_discoveryStartupStorm_aux");
+
+  std::string pUuid = Uuid().ToString();
+  std::string nUuid = Uuid().ToString();
+  MsgDiscovery discovery(pUuid, kPort);
+  discovery.Start();
+
+  // The topics that every process asks for.
+  for (auto i = 0; i < kNumTopics; ++i)
+  {
+    MessagePublisher publisher("/" + partition + "/shared/" +
+      std::to_string(i), "tcp://127.0.0.1:60000", "tcp://127.0.0.1:60001",
+      pUuid, nUuid, Scope_t::ALL, "t");
+    EXPECT_TRUE(discovery.Advertise(publisher));
+  }
+
+  auto sentBefore = discovery.SentDatagrams();
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<testing::forkHandlerType> children;
+  for (auto i = 0; i < kNumProcs; ++i)
+  {
+    children.push_back(
+      testing::forkAndRun(auxPath.c_str(), partition.c_str()));
+  }
+
+  // Wait until every topic of every process is known.
+  size_t expected = static_cast<size_t>(kNumTopics * (kNumProcs + 1));
+  size_t known = 0;
+  auto deadline = start + std::chrono::milliseconds(kMaxWait);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    known = countTopics(discovery);
+    if (known == expected)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  auto convergence = std::chrono::steady_clock::now() - start;
+  auto sentConvergence = discovery.SentDatagrams() - sentBefore;
+
+  // Steady state.
+  auto steadySentBefore = discovery.SentDatagrams();
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery.HeartbeatInterval() * 3));
+  auto steadySent = discovery.SentDatagrams() - steadySentBefore;
+
+  std::cout << "Processes: " << kNumProcs + 1 << std::endl
+            << "Topics per process: " << kNumTopics << std::endl
+            << "Time to convergence: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 convergence).count() << " ms" << std::endl
+            << "Datagrams sent until convergence: " << sentConvergence
+            << std::endl
+            << "Datagrams sent in steady state (3 heartbeats): "
+            << steadySent << std::endl
+            << "Datagrams dropped by the kernel: "
+            << discovery.DroppedDatagrams() << std::endl
+            << "Datagrams dropped in the local registry: "
+            << discovery.DroppedLocalDatagrams() << std::endl;
+
+  EXPECT_EQ(known, expected);
+
+  for (const auto &child : children)
+  {
+    testing::killFork(child);
+    testing::waitAndCleanupFork(child);
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random prefix for the topics of this run.
+  partition = testing::getRandomNumber();
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
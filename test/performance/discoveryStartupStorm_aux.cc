@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Discovery port used by the benchmark. It must match the port used
+/// in discoveryStartupStorm.cc.
+static const int kPort = 11350;
+
+/// \brief Number of topics advertised by each process.
+static const int kNumTopics = 20;
+
+/// \brief Time alive if nobody kills this process (ms.).
+static const int kMaxLife = 60000;
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  std::string prefix = std::string("/") + argv[1] + "/";
+  std::string pUuid = Uuid().ToString();
+  std::string nUuid = Uuid().ToString();
+
+  auto start = std::chrono::steady_clock::now();
+
+  MsgDiscovery discovery(pUuid, kPort);
+  discovery.Start();
+
+  for (auto i = 0; i < kNumTopics; ++i)
+  {
+    MessagePublisher publisher(prefix + pUuid + "/" + std::to_string(i),
+      "tcp://127.0.0.1:60000", "tcp://127.0.0.1:60001", pUuid, nUuid,
+      Scope_t::ALL, "t");
+    discovery.Advertise(publisher);
+  }
+
+  // Every process asks for the same topics at the same time.
+  for (auto i = 0; i < kNumTopics; ++i)
+    discovery.Discover(prefix + "shared/" + std::to_string(i));
+
+  std::string shared = prefix + "shared/";
+  size_t known = 0;
+  auto deadline = start + std::chrono::milliseconds(kMaxLife);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    std::vector<std::string> topics;
+    discovery.TopicList(topics);
+    known = static_cast<size_t>(std::count_if(topics.begin(), topics.end(),
+      [&shared](const std::string &_topic)
+      {
+        return _topic.compare(0, shared.size(), shared) == 0;
+      }));
+
+    if (known == static_cast<size_t>(kNumTopics))
+      break;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::cout << "[" << pUuid << "] Shared topics discovered in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - start).count()
+            << " ms (" << known << "/" << kNumTopics << ")" << std::endl;
+
+  // Stay alive until the benchmark finishes.
+  std::this_thread::sleep_until(deadline);
+}
@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/HandlerStorage.hh"
+#include "ignition/transport/Packet.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/SubscriptionHandler.hh"
+#include "ignition/transport/TopicStorage.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/TransportTypes.hh"
+#include "ignition/transport/Uuid.hh"
+#include "gtest/gtest.h"
+#include "benchmarkUtils.hh"
+
+using namespace ignition;
+using namespace transport;
+
+/// \brief Default number of topics (IGN_BENCH_TOPICS).
+static const int kDefNumTopics = 5000;
+
+/// \brief Default number of iterations of the cheap operations
+/// (IGN_BENCH_ITERATIONS). Operations that scan every topic run 100 times
+/// less.
+static const int kDefIterations = 200000;
+
+/// \brief Number of processes publishing.
+static const int kNumProcs = 8;
+
+/// \brief Number of nodes of each process.
+static const int kNodesPerProc = 4;
+
+/// \brief Number of nodes publishing (or subscribed to) each topic.
+static const int kNodesPerTopic = 4;
+
+/// \brief Number of publishers of an ADVERTISE_BATCH message.
+static const int kBatchSize = 50;
+
+/// \brief Number of memory allocations made by this process.
+static std::atomic<uint64_t> allocations(0);
+
+/// \brief Results of the operations, so they're not optimized away.
+static volatile size_t sink = 0;
+
+//////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  ++allocations;
+  void *ptr = std::malloc(_size ? _size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+//////////////////////////////////////////////////
+void *operator new[](std::size_t _size)
+{
+  return operator new(_size);
+}
+
+//////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+//////////////////////////////////////////////////
+void operator delete[](void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/// \brief Data set shared by the benchmarks: thousands of topics published
+/// by dozens of nodes.
+struct DataSet
+{
+  /// \brief Constructor.
+  DataSet()
+  {
+    int numTopics = bench::envInt("IGN_BENCH_TOPICS", kDefNumTopics);
+    for (auto p = 0; p < kNumProcs; ++p)
+    {
+      this->pUuids.push_back(Uuid().ToString());
+      for (auto n = 0; n < kNodesPerProc; ++n)
+        this->nUuids.push_back(Uuid().ToString());
+    }
+
+    for (auto t = 0; t < numTopics; ++t)
+    {
+      std::string name = "/robot_" + std::to_string(t % 50) + "/sensor_" +
+        std::to_string(t) + "/data";
+      this->names.push_back(name);
+      this->topics.push_back("@/partition@" + name);
+
+      for (auto i = 0; i < kNodesPerTopic; ++i)
+      {
+        auto node = (t + i * 7) % this->nUuids.size();
+        auto proc = node / kNodesPerProc;
+        this->publishers.push_back(MessagePublisher(this->topics.back(),
+          "tcp://10.0.0." + std::to_string(proc) + ":45123",
+          "tcp://10.0.0." + std::to_string(proc) + ":45124",
+          this->pUuids[proc], this->nUuids[node], Scope_t::ALL,
+          "ignition.msgs.Int32"));
+      }
+    }
+  }
+
+  /// \brief Topic names, without partition.
+  std::vector<std::string> names;
+
+  /// \brief Fully qualified topic names.
+  std::vector<std::string> topics;
+
+  /// \brief Process UUIDs.
+  std::vector<std::string> pUuids;
+
+  /// \brief Node UUIDs.
+  std::vector<std::string> nUuids;
+
+  /// \brief kNodesPerTopic publishers of each topic.
+  std::vector<MessagePublisher> publishers;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the number of iterations of the cheap operations.
+/// \return The number of iterations.
+int iterations()
+{
+  return bench::envInt("IGN_BENCH_ITERATIONS", kDefIterations);
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure an operation and report the time and the memory
+/// allocations per call.
+/// \param[in] _group Name of the group of operations.
+/// \param[in] _name Name of the operation.
+/// \param[in] _iterations Number of calls measured.
+/// \param[in] _op Operation. It receives the number of the call.
+/// \param[in] _warmup Whether to make some calls before measuring.
+template<typename F>
+void measure(const std::string &_group, const std::string &_name,
+  const int _iterations, F _op, const bool _warmup = true)
+{
+  if (_warmup)
+  {
+    for (auto i = 0; i < std::min(_iterations / 10, 1000); ++i)
+      _op(i);
+  }
+
+  uint64_t allocsBefore = allocations;
+  int64_t start = bench::nowNs();
+  for (auto i = 0; i < _iterations; ++i)
+    _op(i);
+  double nsPerOp = static_cast<double>(bench::nowNs() - start) / _iterations;
+  double allocsPerOp =
+    static_cast<double>(allocations - allocsBefore) / _iterations;
+
+  std::cout << std::left << std::setw(18) << _group
+            << std::setw(34) << _name
+            << std::right << std::setw(10) << _iterations << std::fixed
+            << std::setprecision(1) << std::setw(14) << nsPerOp
+            << std::setprecision(2) << std::setw(12) << allocsPerOp
+            << std::defaultfloat << std::endl;
+
+  bench::Record record("micro");
+  record.Add("group", _group);
+  record.Add("operation", _name);
+  record.Add("iterations", _iterations);
+  record.Add("ns_per_op", nsPerOp);
+  record.Add("allocs_per_op", allocsPerOp);
+  EXPECT_TRUE(record.Save());
+}
+
+//////////////////////////////////////////////////
+/// \brief Serialization of the discovery messages.
+TEST(microBenchmarks, Packet)
+{
+  DataSet data;
+  int n = iterations();
+
+  Header header(10, data.pUuids.front(), AdvType);
+  std::vector<char> buffer(65536);
+  measure("Header", "Pack", n, [&](int)
+    {
+      sink += header.Pack(buffer.data());
+    });
+
+  Header unpacked;
+  measure("Header", "Unpack", n, [&](int)
+    {
+      sink += unpacked.Unpack(buffer.data());
+    });
+
+  AdvertiseMessage<MessagePublisher> advMsg(header, data.publishers.front());
+  measure("AdvertiseMessage", "Pack", n, [&](int)
+    {
+      sink += advMsg.Pack(buffer.data());
+    });
+
+  AdvertiseMessage<MessagePublisher> advUnpacked;
+  char *body = buffer.data() + header.HeaderLength();
+  measure("AdvertiseMessage", "Unpack", n, [&](int)
+    {
+      sink += advUnpacked.Unpack(body);
+    });
+
+  AdvertiseBatchMessage<MessagePublisher> batchMsg(
+    Header(10, data.pUuids.front(), AdvBatchType));
+  for (auto i = 0; i < kBatchSize; ++i)
+    batchMsg.AddPublisher(data.publishers[i]);
+  std::string batchName =
+    "Pack (" + std::to_string(kBatchSize) + " publishers)";
+  measure("AdvertiseBatch", batchName, n / 100, [&](int)
+    {
+      sink += batchMsg.Pack(buffer.data());
+    });
+
+  size_t bodySize = batchMsg.MsgLength() - header.HeaderLength();
+  AdvertiseBatchMessage<MessagePublisher> batchUnpacked;
+  batchName = "Unpack (" + std::to_string(kBatchSize) + " publishers)";
+  measure("AdvertiseBatch", batchName, n / 100, [&](int)
+    {
+      sink += batchUnpacked.Unpack(body, bodySize);
+    });
+}
+
+//////////////////////////////////////////////////
+/// \brief Storage of the publishers known by the discovery.
+TEST(microBenchmarks, TopicStorage)
+{
+  DataSet data;
+  int n = iterations();
+  size_t numTopics = data.topics.size();
+
+  TopicStorage<MessagePublisher> storage;
+  measure("TopicStorage", "AddPublisher",
+    static_cast<int>(data.publishers.size()), [&](int _i)
+    {
+      sink += storage.AddPublisher(data.publishers[_i]);
+    }, false);
+
+  measure("TopicStorage", "HasTopic", n, [&](int _i)
+    {
+      sink += storage.HasTopic(data.topics[_i % numTopics]);
+    });
+
+  MessagePublisher publisher;
+  measure("TopicStorage", "Publisher", n, [&](int _i)
+    {
+      const auto &pub = data.publishers[_i % data.publishers.size()];
+      sink += storage.Publisher(pub.Topic(), pub.PUuid(), pub.NUuid(),
+        publisher);
+    });
+
+  std::map<std::string, std::vector<MessagePublisher>> info;
+  measure("TopicStorage", "Publishers", n, [&](int _i)
+    {
+      sink += storage.Publishers(data.topics[_i % numTopics], info);
+    });
+
+  std::map<std::string, std::vector<MessagePublisher>> byProc;
+  measure("TopicStorage", "PublishersByProc", n / 100, [&](int _i)
+    {
+      storage.PublishersByProc(data.pUuids[_i % data.pUuids.size()], byProc);
+      sink += byProc.size();
+    });
+
+  std::vector<std::string> topics;
+  measure("TopicStorage", "TopicList", n / 100, [&](int)
+    {
+      topics.clear();
+      storage.TopicList(topics);
+      sink += topics.size();
+    });
+}
+
+//////////////////////////////////////////////////
+/// \brief Storage of the local subscription handlers.
+TEST(microBenchmarks, HandlerStorage)
+{
+  DataSet data;
+  int n = iterations();
+  size_t numTopics = data.topics.size();
+
+  // kNodesPerTopic handlers per topic.
+  std::vector<ISubscriptionHandlerPtr> handlers;
+  for (auto const &pub : data.publishers)
+  {
+    handlers.push_back(ISubscriptionHandlerPtr(
+      new SubscriptionHandler<msgs::Int32>(pub.NUuid())));
+  }
+
+  HandlerStorage<ISubscriptionHandler> storage;
+  measure("HandlerStorage", "AddHandler",
+    static_cast<int>(handlers.size()), [&](int _i)
+    {
+      storage.AddHandler(data.publishers[_i].Topic(),
+        data.publishers[_i].NUuid(), handlers[_i]);
+    }, false);
+
+  measure("HandlerStorage", "HasHandlersForTopic", n, [&](int _i)
+    {
+      sink += storage.HasHandlersForTopic(data.topics[_i % numTopics]);
+    });
+
+  std::map<std::string, std::map<std::string, ISubscriptionHandlerPtr>> m;
+  measure("HandlerStorage", "Handlers", n, [&](int _i)
+    {
+      sink += storage.Handlers(data.topics[_i % numTopics], m);
+    });
+
+  std::vector<ISubscriptionHandlerPtr> v;
+  measure("HandlerStorage", "HandlersList", n, [&](int _i)
+    {
+      sink += storage.Handlers(data.topics[_i % numTopics], v);
+    });
+
+  ISubscriptionHandlerPtr handler;
+  std::string typeName = msgs::Int32().GetTypeName();
+  measure("HandlerStorage", "FirstHandler", n, [&](int _i)
+    {
+      sink += storage.FirstHandler(data.topics[_i % numTopics], typeName,
+        handler);
+    });
+}
+
+//////////////////////////////////////////////////
+/// \brief Validation and composition of names.
+TEST(microBenchmarks, TopicUtils)
+{
+  DataSet data;
+  int n = iterations();
+  size_t numTopics = data.names.size();
+
+  measure("TopicUtils", "IsValidTopic", n, [&](int _i)
+    {
+      sink += TopicUtils::IsValidTopic(data.names[_i % numTopics]);
+    });
+
+  std::string name;
+  measure("TopicUtils", "FullyQualifiedName", n, [&](int _i)
+    {
+      sink += TopicUtils::FullyQualifiedName("partition", "ns",
+        data.names[_i % numTopics], name);
+    });
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  std::cout << std::left << std::setw(18) << "group"
+            << std::setw(34) << "operation"
+            << std::right << std::setw(10) << "calls"
+            << std::setw(14) << "ns/op"
+            << std::setw(12) << "allocs/op" << std::endl;
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
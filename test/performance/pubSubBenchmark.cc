@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/NetUtils.hh"
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "benchmarkUtils.hh"
+#include "pubSubBenchmark.hh"
+
+using namespace ignition;
+
+/// \brief Default message sizes (bytes) used with a single subscriber.
+/// Overridden by IGN_BENCH_SIZES.
+static const std::vector<int> kDefSizes =
+  {16, 256, 4096, 65536, 1 << 20, 16 << 20};
+
+/// \brief Default number of subscribers used with kFanOutSize messages.
+/// Overridden by IGN_BENCH_FANOUTS.
+static const std::vector<int> kDefFanOuts = {1, 2, 4, 8, 16, 32};
+
+/// \brief Message size (bytes) used in the default fan-out sweep.
+static const int kFanOutSize = 1024;
+
+/// \brief Latency samples discarded before measuring.
+static const int kWarmup = 10;
+
+/// \brief Bounds of the number of latency samples of each case.
+static const int kMinLatencySamples = 100;
+static const int kMaxLatencySamples = 2000;
+
+/// \brief Bytes published by the latency phase of each case. The number of
+/// samples is derived from it, within the bounds above.
+static const int64_t kLatencyBytes = int64_t(1) << 28;
+
+/// \brief Bounds of the number of messages of the throughput phase.
+static const int kMinThroughputMsgs = 100;
+static const int kMaxThroughputMsgs = 20000;
+
+/// \brief Bytes published by the throughput phase of each case.
+static const int64_t kThroughputBytes = int64_t(1) << 30;
+
+/// \brief Maximum time waiting for the answers to a latency sample (ms.).
+static const int kSampleTimeout = 1000;
+
+/// \brief Maximum time waiting for the subscribers to be ready or to report
+/// (ms.).
+static const int kMaxWait = 30000;
+
+static std::string partition;
+
+/// \brief A benchmark case.
+struct Case
+{
+  /// \brief Size of the payload (bytes).
+  int size;
+
+  /// \brief Number of subscribers.
+  int fanOut;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the cases to run. By default, the message size sweep runs with
+/// one subscriber and the fan-out sweep with kFanOutSize messages. If
+/// IGN_BENCH_SIZES or IGN_BENCH_FANOUTS are set (e.g. "16,1024"), every
+/// combination is run.
+/// \return The cases, grouped by fan-out.
+std::vector<Case> cases()
+{
+  std::string value;
+  bool custom = transport::env("IGN_BENCH_SIZES", value) ||
+    transport::env("IGN_BENCH_FANOUTS", value);
+  auto sizes = bench::envIntList("IGN_BENCH_SIZES", kDefSizes);
+  auto fanOuts = bench::envIntList("IGN_BENCH_FANOUTS", kDefFanOuts);
+
+  std::vector<Case> result;
+  for (auto fanOut : fanOuts)
+  {
+    if (custom || fanOut == 1)
+    {
+      for (auto size : sizes)
+        result.push_back({size, fanOut});
+    }
+    else
+      result.push_back({kFanOutSize, fanOut});
+  }
+
+  return result;
+}
+
+/// \brief Publisher side of the pub/sub benchmark. It drives the subscribers
+/// and collects their answers.
+class BenchPublisher
+{
+  /// \brief Constructor.
+  /// \param[in] _transport Name of the transport measured.
+  public: explicit BenchPublisher(const std::string &_transport)
+    : transport(_transport)
+  {
+    this->dataPub = this->node.Advertise<msgs::StringMsg>(bench::kDataTopic);
+    EXPECT_TRUE(this->dataPub);
+    EXPECT_TRUE(this->node.Subscribe(bench::kReplyTopic,
+      &BenchPublisher::OnReply, this));
+
+    std::cout << std::left << std::setw(16) << "transport"
+              << std::right << std::setw(10) << "size"
+              << std::setw(8) << "fan-out"
+              << std::setw(12) << "p50(us)"
+              << std::setw(12) << "p99(us)"
+              << std::setw(12) << "p99.9(us)"
+              << std::setw(12) << "msgs/s"
+              << std::setw(12) << "MB/s"
+              << std::setw(8) << "loss(%)" << std::endl;
+  }
+
+  /// \brief Wait until a number of subscribers answer the handshake.
+  /// \param[in] _count Number of subscribers.
+  /// \return True if all the subscribers are ready or false on timeout.
+  public: bool WaitForSubscribers(const size_t _count)
+  {
+    msgs::StringMsg msg;
+    msg.mutable_data()->assign(bench::kHeaderSize, 0);
+    uint32_t ping;
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      ping = ++this->seq;
+      this->pingSeq = ping;
+      this->pingAnswers.clear();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(kMaxWait);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+      bench::writeHeader(bench::Kind::PING, ping, bench::nowNs(),
+        *msg.mutable_data());
+      this->node.Publish(this->dataPub, msg);
+
+      std::unique_lock<std::mutex> lk(this->mutex);
+      if (this->condition.wait_for(lk, std::chrono::milliseconds(100),
+            [this, _count] {return this->pingAnswers.size() >= _count;}))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /// \brief Run a case and report its results.
+  /// \param[in] _case Case.
+  public: void Run(const Case &_case)
+  {
+    int size = std::max(_case.size, static_cast<int>(bench::kHeaderSize));
+    auto fanOut = static_cast<size_t>(_case.fanOut);
+    msgs::StringMsg msg;
+    msg.mutable_data()->assign(size, 'x');
+    std::string &data = *msg.mutable_data();
+
+    // Latency: one message in flight at a time.
+    int samples = static_cast<int>(std::min<int64_t>(kMaxLatencySamples,
+      std::max<int64_t>(kMinLatencySamples, kLatencyBytes / size)));
+    uint64_t lost = 0;
+    for (auto i = 0; i < kWarmup + samples; ++i)
+    {
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        if (i == kWarmup)
+          this->latencies.clear();
+        this->latencySeq = ++this->seq;
+        this->latencyAnswers = 0;
+      }
+
+      bench::writeHeader(bench::Kind::LATENCY, this->latencySeq,
+        bench::nowNs(), data);
+      this->node.Publish(this->dataPub, msg);
+
+      std::unique_lock<std::mutex> lk(this->mutex);
+      this->condition.wait_for(lk, std::chrono::milliseconds(kSampleTimeout),
+        [this, fanOut] {return this->latencyAnswers >= fanOut;});
+      if (i >= kWarmup)
+        lost += fanOut - std::min(fanOut, this->latencyAnswers);
+    }
+
+    std::vector<double> sorted;
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      sorted = this->latencies;
+      this->reports.clear();
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // Throughput: publish as fast as possible.
+    int messages = static_cast<int>(std::min<int64_t>(kMaxThroughputMsgs,
+      std::max<int64_t>(kMinThroughputMsgs, kThroughputBytes / size)));
+    int64_t start = bench::nowNs();
+    for (auto i = 0; i < messages; ++i)
+    {
+      bench::writeHeader(bench::Kind::THROUGHPUT, ++this->seq,
+        bench::nowNs(), data);
+      this->node.Publish(this->dataPub, msg);
+    }
+
+    // The reports are queued after the throughput messages, so they are
+    // answered once every message has been processed (or dropped).
+    auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(kMaxWait);
+    bool reported = false;
+    while (!reported && std::chrono::steady_clock::now() < deadline)
+    {
+      bench::writeHeader(bench::Kind::REPORT, ++this->seq, bench::nowNs(),
+        data);
+      this->node.Publish(this->dataPub, msg);
+
+      std::unique_lock<std::mutex> lk(this->mutex);
+      reported = this->condition.wait_for(lk, std::chrono::milliseconds(100),
+        [this, fanOut] {return this->reports.size() >= fanOut;});
+    }
+    EXPECT_TRUE(reported);
+
+    double msgsPerSec = 0;
+    uint64_t received = 0;
+    {
+      std::lock_guard<std::mutex> lk(this->mutex);
+      for (auto const &report : this->reports)
+      {
+        received += report.second.first;
+        int64_t elapsed = report.second.second - start;
+        if (report.second.first > 0 && elapsed > 0)
+          msgsPerSec += report.second.first * 1e9 / elapsed;
+      }
+    }
+
+    // Rates are per subscriber.
+    msgsPerSec /= fanOut;
+    double mbPerSec = msgsPerSec * _case.size / 1e6;
+    double loss = 100.0 * (1.0 - static_cast<double>(received) /
+      (static_cast<double>(messages) * fanOut));
+
+    double p50 = bench::percentile(sorted, 50);
+    double p99 = bench::percentile(sorted, 99);
+    double p999 = bench::percentile(sorted, 99.9);
+
+    std::cout << std::left << std::setw(16) << this->transport
+              << std::right << std::setw(10) << _case.size
+              << std::setw(8) << _case.fanOut << std::fixed
+              << std::setprecision(1)
+              << std::setw(12) << p50
+              << std::setw(12) << p99
+              << std::setw(12) << p999
+              << std::setprecision(0)
+              << std::setw(12) << msgsPerSec
+              << std::setprecision(1)
+              << std::setw(12) << mbPerSec
+              << std::setw(8) << loss << std::defaultfloat << std::endl;
+
+    bench::Record record("pubsub");
+    record.Add("transport", this->transport);
+    record.Add("size", _case.size);
+    record.Add("fanout", _case.fanOut);
+    record.Add("samples", sorted.size());
+    record.Add("lost_samples", lost);
+    record.Add("p50_us", p50);
+    record.Add("p99_us", p99);
+    record.Add("p999_us", p999);
+    record.Add("msgs_per_s", msgsPerSec);
+    record.Add("mb_per_s", mbPerSec);
+    record.Add("loss_pct", loss);
+    EXPECT_TRUE(record.Save());
+  }
+
+  /// \brief Callback executed for each answer of a subscriber.
+  /// \param[in] _msg Answer "<subscriber> <kind> <sequence> [<value> ...]".
+  private: void OnReply(const msgs::StringMsg &_msg)
+  {
+    std::istringstream stream(_msg.data());
+    std::string id;
+    int kind;
+    uint32_t number;
+    if (!(stream >> id >> kind >> number))
+      return;
+
+    std::lock_guard<std::mutex> lk(this->mutex);
+    switch (static_cast<bench::Kind>(kind))
+    {
+      case bench::Kind::PING:
+        if (number == this->pingSeq)
+          this->pingAnswers.insert(id);
+        break;
+      case bench::Kind::LATENCY:
+      {
+        int64_t latency;
+        if (number == this->latencySeq && stream >> latency)
+        {
+          this->latencies.push_back(latency / 1000.0);
+          ++this->latencyAnswers;
+        }
+        break;
+      }
+      case bench::Kind::REPORT:
+      {
+        uint64_t count;
+        int64_t last;
+        if (stream >> count >> last)
+          this->reports[id] = std::make_pair(count, last);
+        break;
+      }
+      default:
+        return;
+    }
+
+    this->condition.notify_all();
+  }
+
+  /// \brief Name of the transport measured.
+  private: std::string transport;
+
+  /// \brief Protects the answers below.
+  private: std::mutex mutex;
+
+  /// \brief Notified when an answer arrives.
+  private: std::condition_variable condition;
+
+  /// \brief Last sequence number used.
+  private: uint32_t seq = 0;
+
+  /// \brief Sequence number of the current handshake.
+  private: uint32_t pingSeq = 0;
+
+  /// \brief Subscribers that answered the current handshake.
+  private: std::set<std::string> pingAnswers;
+
+  /// \brief Sequence number of the current latency sample.
+  private: uint32_t latencySeq = 0;
+
+  /// \brief Answers received for the current latency sample.
+  private: size_t latencyAnswers = 0;
+
+  /// \brief Latencies measured (us).
+  private: std::vector<double> latencies;
+
+  /// \brief Throughput reports: number of messages received and time when
+  /// the last one arrived (ns), per subscriber.
+  private: std::map<std::string, std::pair<uint64_t, int64_t>> reports;
+
+  /// \brief Node used for publishing and collecting the answers.
+  private: transport::Node node;
+
+  /// \brief Publisher of the benchmark messages.
+  private: transport::Node::PublisherId dataPub;
+};
+
+//////////////////////////////////////////////////
+/// \brief Publisher and subscribers in the same process. The messages are
+/// passed to the callbacks without serialization.
+TEST(pubSubBenchmark, IntraProcess)
+{
+  BenchPublisher publisher("intra-process");
+
+  auto all = cases();
+  for (auto it = all.begin(); it != all.end();)
+  {
+    // Cases are grouped by fan-out: the same subscribers serve the group.
+    int fanOut = it->fanOut;
+    std::vector<std::unique_ptr<bench::Subscriber>> subscribers;
+    for (auto i = 0; i < fanOut; ++i)
+      subscribers.emplace_back(new bench::Subscriber());
+
+    for (; it != all.end() && it->fanOut == fanOut; ++it)
+    {
+      ASSERT_TRUE(publisher.WaitForSubscribers(fanOut));
+      publisher.Run(*it);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Publisher and subscribers in different processes of the same host.
+/// Every endpoint is bound to the host address selected by the transport,
+/// so the messages go through the TCP stack and the kernel loopback, even
+/// when that address belongs to a network interface. Set IGN_IP=127.0.0.1
+/// to pin the loopback interface explicitly.
+TEST(pubSubBenchmark, InterProcess)
+{
+  std::string subscriberPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/performance/PERFORMANCE_pubSubBenchmark_aux");
+
+  BenchPublisher publisher("tcp://" + transport::determineHost());
+
+  auto all = cases();
+  for (auto it = all.begin(); it != all.end();)
+  {
+    // Cases are grouped by fan-out: the same subscribers serve the group.
+    int fanOut = it->fanOut;
+    std::vector<testing::forkHandlerType> children;
+    for (auto i = 0; i < fanOut; ++i)
+    {
+      children.push_back(testing::forkAndRun(subscriberPath.c_str(),
+        partition.c_str()));
+    }
+
+    bool ready = true;
+    for (; ready && it != all.end() && it->fanOut == fanOut; ++it)
+    {
+      ready = publisher.WaitForSubscribers(fanOut);
+      EXPECT_TRUE(ready);
+      if (ready)
+        publisher.Run(*it);
+    }
+
+    for (auto const &child : children)
+    {
+      testing::killFork(child);
+      testing::waitAndCleanupFork(child);
+    }
+
+    if (!ready)
+      return;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_TEST_PUBSUB_BENCHMARK_HH_
+#define IGNITION_TRANSPORT_TEST_PUBSUB_BENCHMARK_HH_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/Uuid.hh"
+#include "benchmarkUtils.hh"
+
+/// \brief Protocol shared by the publisher and the subscribers of the pub/sub
+/// benchmark. The publisher sends ignition::msgs::StringMsg messages whose
+/// data starts with a binary header (kind, sequence number and send time).
+/// The subscribers answer on a reply topic with a small text message:
+/// "<subscriber> <kind> <sequence> [<value> ...]".
+namespace bench
+{
+  /// \brief Topic used for the benchmark data.
+  static const std::string kDataTopic = "/bench/data";
+
+  /// \brief Topic used for the answers of the subscribers.
+  static const std::string kReplyTopic = "/bench/reply";
+
+  /// \brief Kind of a benchmark message.
+  enum class Kind : uint8_t
+  {
+    /// \brief Handshake. The subscriber answers and resets its counters.
+    PING = 0,
+
+    /// \brief Latency sample. The subscriber answers with the latency (ns).
+    LATENCY = 1,
+
+    /// \brief Throughput sample. The subscriber only counts it.
+    THROUGHPUT = 2,
+
+    /// \brief The subscriber answers with the number of throughput samples
+    /// received and the time when the last one arrived.
+    REPORT = 3
+  };
+
+  /// \brief Size of the header: kind (1), sequence (4) and time (8).
+  static const size_t kHeaderSize = 13;
+
+  /// \brief Write the header at the beginning of a payload.
+  /// \param[in] _kind Kind of message.
+  /// \param[in] _seq Sequence number.
+  /// \param[in] _stamp Send time (ns).
+  /// \param[in, out] _data Payload. Its size must be at least kHeaderSize.
+  inline void writeHeader(const Kind _kind, const uint32_t _seq,
+    const int64_t _stamp, std::string &_data)
+  {
+    _data[0] = static_cast<char>(_kind);
+    memcpy(&_data[1], &_seq, sizeof(_seq));
+    memcpy(&_data[5], &_stamp, sizeof(_stamp));
+  }
+
+  /// \brief Read the header at the beginning of a payload.
+  /// \param[in] _data Payload.
+  /// \param[out] _kind Kind of message.
+  /// \param[out] _seq Sequence number.
+  /// \param[out] _stamp Send time (ns).
+  /// \return False if the payload is too short.
+  inline bool readHeader(const std::string &_data, Kind &_kind,
+    uint32_t &_seq, int64_t &_stamp)
+  {
+    if (_data.size() < kHeaderSize)
+      return false;
+
+    _kind = static_cast<Kind>(_data[0]);
+    memcpy(&_seq, &_data[1], sizeof(_seq));
+    memcpy(&_stamp, &_data[5], sizeof(_stamp));
+    return true;
+  }
+
+  /// \brief Subscriber side of the pub/sub benchmark. It uses its own node.
+  class Subscriber
+  {
+    /// \brief Constructor.
+    public: Subscriber()
+      : id(ignition::transport::Uuid().ToString())
+    {
+      this->replyPub =
+        this->node.Advertise<ignition::msgs::StringMsg>(kReplyTopic);
+      this->node.Subscribe(kDataTopic, &Subscriber::OnData, this);
+    }
+
+    /// \brief Callback executed for each benchmark message.
+    /// \param[in] _msg Benchmark message.
+    private: void OnData(const ignition::msgs::StringMsg &_msg)
+    {
+      int64_t now = nowNs();
+      Kind kind;
+      uint32_t seq;
+      int64_t stamp;
+      if (!readHeader(_msg.data(), kind, seq, stamp))
+        return;
+
+      std::string answer = this->id + " " +
+        std::to_string(static_cast<int>(kind)) + " " + std::to_string(seq);
+
+      switch (kind)
+      {
+        case Kind::PING:
+          this->received = 0;
+          this->lastReceived = 0;
+          break;
+        case Kind::LATENCY:
+          answer += " " + std::to_string(now - stamp);
+          break;
+        case Kind::THROUGHPUT:
+          ++this->received;
+          this->lastReceived = now;
+          return;
+        case Kind::REPORT:
+          answer += " " + std::to_string(this->received) + " " +
+            std::to_string(this->lastReceived);
+          break;
+        default:
+          return;
+      }
+
+      ignition::msgs::StringMsg reply;
+      reply.set_data(answer);
+      this->node.Publish(this->replyPub, reply);
+    }
+
+    /// \brief Unique identifier of this subscriber.
+    private: std::string id;
+
+    /// \brief Number of throughput samples received.
+    private: uint64_t received = 0;
+
+    /// \brief Time when the last throughput sample arrived (ns).
+    private: int64_t lastReceived = 0;
+
+    /// \brief Node used for subscribing and answering.
+    private: ignition::transport::Node node;
+
+    /// \brief Publisher of the answers.
+    private: ignition::transport::Node::PublisherId replyPub;
+  };
+}
+
+#endif
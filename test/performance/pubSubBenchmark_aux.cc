@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "ignition/transport/test_config.h"
+#include "pubSubBenchmark.hh"
+
+/// \brief Time alive if nobody kills this process (ms.).
+static const int kMaxLife = 600000;
+
+//////////////////////////////////////////////////
+/// \brief A subscriber of the pub/sub benchmark running in its own process.
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  bench::Subscriber subscriber;
+
+  // Stay alive until the benchmark kills this process.
+  std::this_thread::sleep_for(std::chrono::milliseconds(kMaxLife));
+}
@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Helpers.hh"
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+#include "benchmarkUtils.hh"
+#include "serviceBenchmark.hh"
+
+using namespace ignition;
+
+/// \brief Default payload sizes (bytes) used with a single client.
+/// Overridden by IGN_BENCH_SIZES.
+static const std::vector<int> kDefSizes = {16, 1024, 65536, 1 << 20};
+
+/// \brief Default number of concurrent clients used with kClientsSize
+/// payloads. Overridden by IGN_BENCH_CLIENTS.
+static const std::vector<int> kDefClients = {1, 2, 4, 8, 16};
+
+/// \brief Payload size (bytes) used in the default concurrent clients sweep.
+static const int kClientsSize = 1024;
+
+/// \brief Maximum number of callback requests in flight per client.
+static const int kWindow = 16;
+
+/// \brief Blocking calls used for warming up before each case.
+static const int kWarmup = 10;
+
+/// \brief Bounds of the number of calls of each case.
+static const int kMinCalls = 100;
+static const int kMaxCalls = 5000;
+
+/// \brief Bytes requested by each case. The number of calls is derived from
+/// it, within the bounds above.
+static const int64_t kCallBytes = int64_t(1) << 28;
+
+/// \brief Timeout of each call (ms.).
+static const unsigned int kTimeout = 5000;
+
+/// \brief Maximum time waiting for the replier (ms.).
+static const int kMaxWait = 30000;
+
+static std::string partition;
+
+/// \brief How the calls are made.
+enum class Mode
+{
+  /// \brief Blocking requests, one at a time.
+  BLOCKING,
+
+  /// \brief Non-blocking requests with a callback, up to kWindow in flight.
+  CALLBACK,
+
+  /// \brief Oneway requests. The latency is the time spent in Request().
+  ONEWAY
+};
+
+/// \brief A benchmark case.
+struct Case
+{
+  /// \brief How the calls are made.
+  Mode mode;
+
+  /// \brief Size of the payload (bytes).
+  int size;
+
+  /// \brief Number of concurrent clients, each one with its own node.
+  int clients;
+};
+
+/// \brief Results of one client.
+struct ClientResult
+{
+  /// \brief Latency of each successful call (us).
+  std::vector<double> latencies;
+
+  /// \brief Number of calls that failed or timed out.
+  uint64_t failed = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the name of a mode.
+/// \param[in] _mode Mode.
+/// \return The name.
+std::string modeName(const Mode _mode)
+{
+  switch (_mode)
+  {
+    case Mode::BLOCKING:
+      return "blocking";
+    case Mode::CALLBACK:
+      return "callback";
+    case Mode::ONEWAY:
+    default:
+      return "oneway";
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the cases to run. By default, the payload size sweep runs with
+/// one client and the concurrent clients sweep with kClientsSize payloads.
+/// If IGN_BENCH_SIZES or IGN_BENCH_CLIENTS are set (e.g. "16,1024"), every
+/// combination is run. Each combination runs in every mode.
+/// \return The cases.
+std::vector<Case> cases()
+{
+  std::string value;
+  bool custom = transport::env("IGN_BENCH_SIZES", value) ||
+    transport::env("IGN_BENCH_CLIENTS", value);
+  auto sizes = bench::envIntList("IGN_BENCH_SIZES", kDefSizes);
+  auto clients = bench::envIntList("IGN_BENCH_CLIENTS", kDefClients);
+
+  std::vector<Case> result;
+  for (auto numClients : clients)
+  {
+    std::vector<int> caseSizes = sizes;
+    if (!custom && numClients > 1)
+      caseSizes = {kClientsSize};
+
+    for (auto size : caseSizes)
+    {
+      for (auto mode : {Mode::BLOCKING, Mode::CALLBACK, Mode::ONEWAY})
+        result.push_back({mode, size, numClients});
+    }
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Make calls from a client with its own node.
+/// \param[in] _mode How the calls are made.
+/// \param[in] _req Request.
+/// \param[in] _calls Number of calls.
+/// \param[out] _result Results of the client.
+void runClient(const Mode _mode, const msgs::StringMsg &_req,
+  const int _calls, ClientResult &_result)
+{
+  transport::Node node;
+  msgs::StringMsg rep;
+  bool result;
+
+  // Callback requests in flight.
+  std::mutex mutex;
+  std::condition_variable condition;
+  int inFlight = 0;
+
+  for (auto i = 0; i < _calls; ++i)
+  {
+    int64_t start = bench::nowNs();
+    switch (_mode)
+    {
+      case Mode::BLOCKING:
+        if (node.Request(bench::kEchoService, _req, kTimeout, rep, result) &&
+            result)
+        {
+          _result.latencies.push_back((bench::nowNs() - start) / 1000.0);
+        }
+        else
+          ++_result.failed;
+        break;
+      case Mode::CALLBACK:
+      {
+        std::function<void(const msgs::StringMsg &, const bool)> cb =
+          [&mutex, &condition, &inFlight, &_result, start](
+            const msgs::StringMsg &/*_rep*/, const bool _ok)
+          {
+            std::lock_guard<std::mutex> lk(mutex);
+            if (_ok)
+              _result.latencies.push_back((bench::nowNs() - start) / 1000.0);
+            else
+              ++_result.failed;
+            --inFlight;
+            condition.notify_all();
+          };
+
+        {
+          std::unique_lock<std::mutex> lk(mutex);
+          condition.wait(lk, [&inFlight] {return inFlight < kWindow;});
+          ++inFlight;
+        }
+
+        if (!node.Request(bench::kEchoService, _req, cb))
+        {
+          std::lock_guard<std::mutex> lk(mutex);
+          --inFlight;
+          ++_result.failed;
+        }
+        break;
+      }
+      case Mode::ONEWAY:
+      default:
+        if (node.Request(bench::kOnewayService, _req))
+          _result.latencies.push_back((bench::nowNs() - start) / 1000.0);
+        else
+          ++_result.failed;
+        break;
+    }
+  }
+
+  // Every callback request ends with a response or a timeout.
+  std::unique_lock<std::mutex> lk(mutex);
+  condition.wait(lk, [&inFlight] {return inFlight == 0;});
+}
+
+/// \brief Driver of the service benchmark.
+class BenchClient
+{
+  /// \brief Constructor.
+  /// \param[in] _setup Name of the setup measured.
+  public: explicit BenchClient(const std::string &_setup)
+    : setup(_setup)
+  {
+    std::cout << std::left << std::setw(15) << "setup"
+              << std::setw(10) << "mode"
+              << std::right << std::setw(9) << "size"
+              << std::setw(8) << "clients"
+              << std::setw(11) << "p50(us)"
+              << std::setw(11) << "p90(us)"
+              << std::setw(11) << "p99(us)"
+              << std::setw(11) << "p99.9(us)"
+              << std::setw(11) << "calls/s"
+              << std::setw(8) << "failed" << std::endl;
+  }
+
+  /// \brief Wait until the echo service answers.
+  /// \return True if the service is available or false on timeout.
+  public: bool WaitForReplier()
+  {
+    msgs::StringMsg req;
+    msgs::StringMsg rep;
+    bool result;
+    auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(kMaxWait);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+      if (this->node.Request(bench::kEchoService, req, 500, rep, result) &&
+          result)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /// \brief Run a case and report its results.
+  /// \param[in] _case Case.
+  public: void Run(const Case &_case)
+  {
+    msgs::StringMsg req;
+    req.mutable_data()->assign(_case.size, 'x');
+
+    // Warm up the connections with this payload size.
+    msgs::StringMsg rep;
+    bool result;
+    for (auto i = 0; i < kWarmup; ++i)
+      this->node.Request(bench::kEchoService, req, kTimeout, rep, result);
+
+    int calls = static_cast<int>(std::min<int64_t>(kMaxCalls,
+      std::max<int64_t>(kMinCalls, kCallBytes / _case.size)));
+    calls = std::max(1, calls / _case.clients);
+
+    int countBefore = this->OnewayCount();
+    std::vector<ClientResult> results(_case.clients);
+    int64_t start = bench::nowNs();
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < _case.clients; ++i)
+    {
+      threads.emplace_back(runClient, _case.mode, std::cref(req), calls,
+        std::ref(results[i]));
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    std::vector<double> sorted;
+    uint64_t failed = 0;
+    for (auto const &clientResult : results)
+    {
+      sorted.insert(sorted.end(), clientResult.latencies.begin(),
+        clientResult.latencies.end());
+      failed += clientResult.failed;
+    }
+    uint64_t completed = sorted.size();
+
+    // Oneway calls are completed once the replier has received them.
+    if (_case.mode == Mode::ONEWAY)
+    {
+      auto expected = static_cast<int>(completed);
+      auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(kMaxWait);
+      int received = this->OnewayCount() - countBefore;
+      while (received < expected &&
+             std::chrono::steady_clock::now() < deadline)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        received = this->OnewayCount() - countBefore;
+      }
+      failed += static_cast<uint64_t>(expected - std::min(expected, received));
+      completed = static_cast<uint64_t>(std::min(expected, received));
+    }
+
+    double elapsed = (bench::nowNs() - start) / 1e9;
+    double callsPerSec = elapsed > 0 ? completed / elapsed : 0;
+    std::sort(sorted.begin(), sorted.end());
+    double p50 = bench::percentile(sorted, 50);
+    double p90 = bench::percentile(sorted, 90);
+    double p99 = bench::percentile(sorted, 99);
+    double p999 = bench::percentile(sorted, 99.9);
+    auto histogram = bench::histogram(sorted);
+
+    std::cout << std::left << std::setw(15) << this->setup
+              << std::setw(10) << modeName(_case.mode)
+              << std::right << std::setw(9) << _case.size
+              << std::setw(8) << _case.clients << std::fixed
+              << std::setprecision(1)
+              << std::setw(11) << p50
+              << std::setw(11) << p90
+              << std::setw(11) << p99
+              << std::setw(11) << p999
+              << std::setprecision(0)
+              << std::setw(11) << callsPerSec
+              << std::setw(8) << failed << std::defaultfloat << std::endl
+              << "  histogram (us): " << bench::histogramText(histogram)
+              << std::endl;
+
+    bench::Record record("service");
+    record.Add("setup", this->setup);
+    record.Add("mode", modeName(_case.mode));
+    record.Add("size", _case.size);
+    record.Add("clients", _case.clients);
+    record.Add("calls", completed);
+    record.Add("failed", failed);
+    record.Add("p50_us", p50);
+    record.Add("p90_us", p90);
+    record.Add("p99_us", p99);
+    record.Add("p999_us", p999);
+    record.Add("calls_per_s", callsPerSec);
+    record.Add("histogram_us_log2", histogram);
+    EXPECT_TRUE(record.Save());
+  }
+
+  /// \brief Get the number of oneway requests received by the replier.
+  /// \return The number of requests or 0 if the replier didn't answer.
+  private: int OnewayCount()
+  {
+    msgs::Int32 rep;
+    bool result;
+    if (!this->node.Request(bench::kCountService, kTimeout, rep, result) ||
+        !result)
+    {
+      return 0;
+    }
+
+    return rep.data();
+  }
+
+  /// \brief Name of the setup measured.
+  private: std::string setup;
+
+  /// \brief Node used for warming up and for the oneway counts.
+  private: transport::Node node;
+};
+
+//////////////////////////////////////////////////
+/// \brief Clients and replier in the same process.
+TEST(serviceBenchmark, InProcess)
+{
+  bench::Replier replier;
+  BenchClient client("in-process");
+  ASSERT_TRUE(client.WaitForReplier());
+
+  for (auto const &c : cases())
+    client.Run(c);
+}
+
+//////////////////////////////////////////////////
+/// \brief Clients and replier in two different processes.
+TEST(serviceBenchmark, TwoProcesses)
+{
+  std::string replierPath = testing::portablePathUnion(
+     PROJECT_BINARY_PATH,
+     "test/performance/PERFORMANCE_serviceBenchmark_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(replierPath.c_str(),
+    partition.c_str());
+
+  BenchClient client("two-processes");
+  bool ready = client.WaitForReplier();
+  EXPECT_TRUE(ready);
+  if (ready)
+  {
+    for (auto const &c : cases())
+      client.Run(c);
+  }
+
+  testing::killFork(pi);
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
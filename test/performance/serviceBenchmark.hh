@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_TEST_SERVICE_BENCHMARK_HH_
+#define IGNITION_TRANSPORT_TEST_SERVICE_BENCHMARK_HH_
+
+#include <atomic>
+#include <string>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+
+/// \brief Services offered to the service benchmark.
+namespace bench
+{
+  /// \brief Service that answers with a copy of the request.
+  static const std::string kEchoService = "/bench/echo";
+
+  /// \brief Oneway service that counts the requests received.
+  static const std::string kOnewayService = "/bench/oneway";
+
+  /// \brief Service that answers with the number of oneway requests
+  /// received.
+  static const std::string kCountService = "/bench/count";
+
+  /// \brief Replier side of the service benchmark. It uses its own node.
+  class Replier
+  {
+    /// \brief Constructor.
+    public: Replier()
+    {
+      this->node.Advertise(kEchoService, &Replier::Echo, this);
+      this->node.Advertise(kOnewayService, &Replier::Oneway, this);
+      this->node.Advertise(kCountService, &Replier::Count, this);
+    }
+
+    /// \brief Echo service.
+    /// \param[in] _req Request.
+    /// \param[out] _rep Copy of the request.
+    /// \param[out] _result Always true.
+    private: void Echo(const ignition::msgs::StringMsg &_req,
+      ignition::msgs::StringMsg &_rep, bool &_result)
+    {
+      _rep.set_data(_req.data());
+      _result = true;
+    }
+
+    /// \brief Oneway service.
+    /// \param[in] _req Request.
+    private: void Oneway(const ignition::msgs::StringMsg &/*_req*/)
+    {
+      ++this->oneway;
+    }
+
+    /// \brief Count service.
+    /// \param[out] _rep Number of oneway requests received.
+    /// \param[out] _result Always true.
+    private: void Count(ignition::msgs::Int32 &_rep, bool &_result)
+    {
+      _rep.set_data(this->oneway);
+      _result = true;
+    }
+
+    /// \brief Number of oneway requests received.
+    private: std::atomic<int> oneway{0};
+
+    /// \brief Node offering the services.
+    private: ignition::transport::Node node;
+  };
+}
+
+#endif